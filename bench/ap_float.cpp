@@ -0,0 +1,58 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Each timed call goes through a batch of operands, so that the clock reads
+// don't dominate.
+constexpr std::size_t batch = 1024;
+
+template <typename F>
+std::vector<F> random_floats() {
+  std::vector<F> result;
+  for (std::size_t i = 0; i < batch; ++i) {
+    auto num = std::int64_t(bench::rng()() >> 1);
+    auto den = std::int64_t(bench::rng()() >> 12) | 1;
+    result.push_back(bench::rng()() % 2 ? F{num} / F{den} : -F{num} / F{den});
+  }
+  return result;
+}
+
+template <typename F, typename Op>
+void bench_op(const std::string& name, Op op) {
+  auto a = random_floats<F>();
+  auto b = random_floats<F>();
+  auto c = random_floats<F>();
+  auto calls = bench::rate([&] {
+    for (std::size_t i = 0; i < batch; ++i) {
+      auto r = op(a[i], b[i], c[i]);
+      bench::do_not_optimize(r);
+    }
+  });
+  bench::report(name, calls * batch / 1e6, "Mops/s");
+}
+
+template <std::size_t M, std::size_t E>
+void bench_format() {
+  using F = vecpp::Ap_float<M, E>;
+  std::string suffix = "<" + std::to_string(M) + "," + std::to_string(E) + ">";
+
+  bench_op<F>("add" + suffix,
+              [](const F& a, const F& b, const F&) { return a + b; });
+  bench_op<F>("mul" + suffix,
+              [](const F& a, const F& b, const F&) { return a * b; });
+  bench_op<F>("div" + suffix,
+              [](const F& a, const F& b, const F&) { return a / b; });
+  bench_op<F>("fma" + suffix, [](const F& a, const F& b, const F& c) {
+    return vecpp::fma(a, b, c);
+  });
+}
+
+int main() {
+  bench_format<113, 15>();
+  bench_format<237, 19>();
+  return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef VECPP_AP_MATH_BENCH_UTIL_H_INCLUDED
+#define VECPP_AP_MATH_BENCH_UTIL_H_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace bench {
+
+// Runs f() repeatedly until at least min_seconds have elapsed, returns the
+// number of calls per second.
+template <typename F>
+double rate(F&& f, double min_seconds = 0.5) {
+  using clock = std::chrono::steady_clock;
+  std::uint64_t calls = 0;
+  auto start = clock::now();
+  std::chrono::duration<double> elapsed{0};
+  do {
+    f();
+    ++calls;
+    elapsed = clock::now() - start;
+  } while (elapsed.count() < min_seconds);
+  return double(calls) / elapsed.count();
+}
+
+inline void report(const std::string& name, double value,
+                   const std::string& unit) {
+  std::cout << name << ": " << value << " " << unit << "\n";
+}
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T>
+void do_not_optimize(const T& v) {
+#if defined(_MSC_VER)
+  static volatile const void* sink;
+  sink = &v;
+#else
+  asm volatile("" : : "g"(&v) : "memory");
+#endif
+}
+
+inline std::mt19937_64& rng() {
+  static std::mt19937_64 gen{42};
+  return gen;
+}
+
+// Uniformly random value with the top bit set.
+template <typename T>
+T random_full_width() {
+  T result{0};
+  for (auto& w : result.data_.data_) {
+    w = rng()();
+  }
+  result.data_.clear_unused_bits();
+  result.data_.set_bit(T::Storage::size - 1);
+  return result;
+}
+}  // namespace bench
+
+#endif
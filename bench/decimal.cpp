@@ -0,0 +1,61 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+using Decimal64_t = vecpp::Ap_decimal<16, 384>;
+
+constexpr std::size_t count = 1 << 12;
+
+template <typename Op>
+void bench_op(const std::string& name, const std::vector<Decimal64_t>& a,
+              const std::vector<Decimal64_t>& b, Op op) {
+  auto calls = bench::rate([&] {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      auto r = op(a[i], b[i]);
+      bench::do_not_optimize(r);
+    }
+  });
+  bench::report(name, calls * a.size() / 1e6, "Mops/s");
+}
+
+// Prices with two decimals take the word sized fast paths, full 16 digit
+// values the general ones.
+std::vector<Decimal64_t> random_values(bool prices) {
+  std::uniform_int_distribution<std::int64_t> cents(-1000000, 1000000);
+  std::uniform_int_distribution<std::int64_t> full(1000000000000000,
+                                                   9999999999999999);
+  std::uniform_int_distribution<int> exponent(-20, 20);
+  std::vector<Decimal64_t> result;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto parts = prices ? std::to_string(cents(bench::rng())) + "E-2"
+                        : std::to_string(full(bench::rng())) + "E" +
+                              std::to_string(exponent(bench::rng()));
+    result.emplace_back(parts);
+  }
+  return result;
+}
+
+int main() {
+  for (bool prices : {true, false}) {
+    auto a = random_values(prices);
+    auto b = random_values(prices);
+    std::string kind = prices ? "prices " : "16 digits ";
+    bench_op(kind + "add", a, b,
+             [](const Decimal64_t& x, const Decimal64_t& y) { return x + y; });
+    bench_op(kind + "mul", a, b,
+             [](const Decimal64_t& x, const Decimal64_t& y) { return x * y; });
+    bench_op(kind + "div", a, b,
+             [](const Decimal64_t& x, const Decimal64_t& y) { return x / y; });
+    bench_op(kind + "quantize", a, b, [](const Decimal64_t& x,
+                                         const Decimal64_t&) {
+      constexpr Decimal64_t cents{"0.01"};
+      return quantize(x, cents);
+    });
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+constexpr std::size_t count = 1024;
+
+// Sums and products of values of about value_bits bits, with the width
+// fixed to the worst case or following the values.
+template <std::size_t value_bits>
+void bench_width() {
+  using Fixed = vecpp::Ap_int<2048>;
+  using Dyn = vecpp::Dyn_ap_int<>;
+  std::vector<Fixed> fixed;
+  std::vector<Dyn> dyn;
+  for (std::size_t i = 0; i < count; ++i) {
+    Fixed v{0};
+    for (std::size_t k = 0; 64 * k < value_bits; ++k) {
+      v.limbs()[k] = bench::rng()() >> 1;
+    }
+    fixed.push_back(v);
+    dyn.push_back(v);
+  }
+
+  std::string prefix = std::to_string(value_bits) + " bits values, ";
+  bench::report(prefix + "Ap_int<2048> add",
+                count * bench::rate([&] {
+                  Fixed sum{0};
+                  for (const auto& v : fixed) {
+                    sum += v;
+                  }
+                  bench::do_not_optimize(sum);
+                }) / 1e6,
+                "Mops/s");
+  bench::report(prefix + "Dyn_ap_int add", count * bench::rate([&] {
+                                             Dyn sum;
+                                             for (const auto& v : dyn) {
+                                               sum += v;
+                                             }
+                                             bench::do_not_optimize(sum);
+                                           }) / 1e6,
+                "Mops/s");
+  bench::report(prefix + "Ap_int<2048> mul",
+                count * bench::rate([&] {
+                  for (std::size_t i = 1; i < count; ++i) {
+                    bench::do_not_optimize(fixed[i - 1] * fixed[i]);
+                  }
+                }) / 1e6,
+                "Mops/s");
+  bench::report(prefix + "Dyn_ap_int mul", count * bench::rate([&] {
+                                             for (std::size_t i = 1; i < count;
+                                                  ++i) {
+                                               bench::do_not_optimize(
+                                                   dyn[i - 1] * dyn[i]);
+                                             }
+                                           }) / 1e6,
+                "Mops/s");
+}
+
+// A multiply / divide chain on heap sized values, with the words from
+// new / delete or from a Limb_pool.
+void bench_chain(const std::string& name,
+                 const vecpp::Dyn_ap_int<>::allocator_type& alloc) {
+  using Dyn = vecpp::Dyn_ap_int<>;
+  Dyn a(Dyn(bench::rng()()) << 500, alloc);
+  Dyn b(Dyn(bench::rng()()) << 300, alloc);
+  Dyn x(alloc);
+  bench::report(name + " mul / div chain", bench::rate([&] {
+                                             x = a * b;
+                                             x = x / b + a;
+                                             bench::do_not_optimize(x);
+                                           }) / 1e6,
+                "Mops/s");
+}
+
+int main() {
+  bench_width<64>();
+  bench_width<256>();
+  bench_width<1024>();
+
+  bench_chain("new / delete", std::pmr::new_delete_resource());
+  vecpp::Limb_pool pool;
+  bench_chain("Limb_pool", &pool);
+  return 0;
+}
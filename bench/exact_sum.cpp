@@ -0,0 +1,44 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+constexpr std::size_t count = 1 << 20;
+
+template <typename Sum>
+void bench_sum(const std::string& name, const std::vector<double>& values,
+               Sum sum) {
+  auto calls = bench::rate([&] {
+    double r = sum(values.data(), values.size());
+    bench::do_not_optimize(r);
+  });
+  bench::report(name, calls * values.size() / 1e6, "Mvalues/s");
+}
+
+int main() {
+  std::uniform_real_distribution<double> value(-1, 1);
+  std::uniform_int_distribution<int> exponent(-60, 60);
+  std::vector<double> values;
+  for (std::size_t i = 0; i < count; ++i) {
+    values.push_back(std::ldexp(value(bench::rng()), exponent(bench::rng())));
+  }
+
+  bench_sum("naive", values, [](const double* v, std::size_t n) {
+    double sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      sum += v[i];
+    }
+    return sum;
+  });
+  bench_sum("exact_sum", values, [](const double* v, std::size_t n) {
+    return vecpp::exact_sum(v, n);
+  });
+  bench_sum("parallel_exact_sum", values, [](const double* v, std::size_t n) {
+    return vecpp::parallel_exact_sum(v, n);
+  });
+  return 0;
+}
@@ -0,0 +1,62 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+constexpr std::size_t count = 1 << 12;
+
+template <typename T, typename Op>
+void bench_op(const std::string& name, const std::vector<T>& a,
+              const std::vector<T>& b, Op op) {
+  auto calls = bench::rate([&] {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      auto r = op(a[i], b[i]);
+      bench::do_not_optimize(r);
+    }
+  });
+  bench::report(name, calls * a.size() / 1e6, "Mops/s");
+}
+
+// Ap_fixed<I, F> products against the same fixed point arithmetic emulated
+// on a Large_ap_int: a full width multiply, then a shift.
+template <std::size_t I, std::size_t F>
+void bench_format() {
+  using Fixed = vecpp::Ap_fixed<I, F>;
+  using Emulated = vecpp::Large_ap_int<2 * (I + F)>;
+  std::uniform_real_distribution<double> value(-1000, 1000);
+
+  std::vector<Fixed> a;
+  std::vector<Fixed> b;
+  std::vector<Emulated> ea;
+  std::vector<Emulated> eb;
+  for (std::size_t i = 0; i < count; ++i) {
+    a.emplace_back(value(bench::rng()));
+    b.emplace_back(value(bench::rng()));
+    ea.push_back(Emulated{std::int64_t(double(a.back()) * 65536)} << (F - 16));
+    eb.push_back(Emulated{std::int64_t(double(b.back()) * 65536)} << (F - 16));
+  }
+
+  std::string format =
+      "Ap_fixed<" + std::to_string(I) + ", " + std::to_string(F) + "> ";
+  bench_op(format + "mul", a, b,
+           [](const Fixed& x, const Fixed& y) { return x * y; });
+  bench_op(format + "mul toward_zero", a, b, [](const Fixed& x, const Fixed& y) {
+    return mul(x, y, vecpp::Rounding::toward_zero);
+  });
+  bench_op(format + "div", a, b,
+           [](const Fixed& x, const Fixed& y) { return x / y; });
+  bench_op("Large_ap_int<" + std::to_string(2 * (I + F)) + "> (a * b) >> F",
+           ea, eb, [](const Emulated& x, const Emulated& y) {
+             return (x * y) >> F;
+           });
+}
+
+int main() {
+  bench_format<32, 32>();
+  bench_format<64, 64>();
+  bench_format<128, 128>();
+  return 0;
+}
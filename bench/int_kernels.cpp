@@ -0,0 +1,92 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The Int_storage operations that go through the run time dispatched
+// kernels. Run with VECPP_AP_MATH_ISA=generic to time the portable code.
+template <std::size_t bits>
+void bench_width() {
+  using Value = vecpp::Large_ap_uint<bits>;
+  constexpr std::size_t count = 256;
+  std::vector<Value> a;
+  std::vector<Value> b;
+  for (std::size_t i = 0; i < count; ++i) {
+    a.push_back(bench::random_full_width<Value>());
+    b.push_back(bench::random_full_width<Value>());
+  }
+  std::uint64_t w = bench::rng()() | 1;
+
+  auto run = [&](const std::string& name, auto op) {
+    auto calls = bench::rate([&] {
+      for (std::size_t i = 0; i < count; ++i) {
+        auto r = op(a[i], b[i]);
+        bench::do_not_optimize(r);
+      }
+    });
+    bench::report(std::to_string(bits) + " bits " + name,
+                  calls * count / 1e6, "Mops/s");
+  };
+  run("add", [](const Value& x, const Value& y) { return x + y; });
+  run("sub", [](const Value& x, const Value& y) { return x - y; });
+  run("mul by word", [&](const Value& x, const Value&) { return x * w; });
+  run("mul", [](const Value& x, const Value& y) { return x * y; });
+  run("shift", [](const Value& x, const Value&) { return x << 13; });
+  run("div by word", [&](const Value& x, const Value&) { return x / w; });
+}
+
+// Values whose bit length is uniform in [1, bits], like accumulators that
+// start small and grow. Loops bounded by the used words pay for the value,
+// not for the storage.
+template <std::size_t bits>
+void bench_magnitudes() {
+  using Value = vecpp::Large_ap_uint<bits>;
+  constexpr std::size_t count = 256;
+  std::vector<Value> a;
+  std::vector<Value> b;
+  for (std::size_t i = 0; i < 2 * count; ++i) {
+    Value v = bench::random_full_width<Value>();
+    v >>= bench::rng()() % bits;
+    (i % 2 == 0 ? a : b).push_back(v);
+  }
+  std::uint64_t w = bench::rng()() | 1;
+
+  auto run = [&](const std::string& name, auto op) {
+    auto calls = bench::rate([&] {
+      for (std::size_t i = 0; i < count; ++i) {
+        auto r = op(a[i], b[i]);
+        bench::do_not_optimize(r);
+      }
+    });
+    bench::report(std::to_string(bits) + " bits, any magnitude, " + name,
+                  calls * count / 1e6, "Mops/s");
+  };
+  run("add", [](const Value& x, const Value& y) { return x + y; });
+  run("sub", [](const Value& x, const Value& y) { return x - y; });
+  run("compare", [](const Value& x, const Value& y) { return x < y; });
+  run("mul by word", [&](const Value& x, const Value&) { return x * w; });
+  run("mul", [](const Value& x, const Value& y) { return x * y; });
+  run("div by word", [&](const Value& x, const Value&) { return x / w; });
+  run("div", [](const Value& x, const Value& y) { return x / (y | Value{1}); });
+  run("print", [](const Value& x, const Value&) {
+    std::ostringstream out;
+    out << x;
+    return out.str().size();
+  });
+}
+
+int main() {
+  std::cout << "kernels: "
+            << vecpp::detail::isa_names[int(vecpp::detail::isa())] << "\n";
+  bench_width<256>();
+  bench_width<512>();
+  bench_width<1024>();
+  bench_width<4096>();
+  bench_magnitudes<1024>();
+  bench_magnitudes<4096>();
+  return 0;
+}
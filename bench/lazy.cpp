@@ -0,0 +1,57 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Chains of operations with the regular operators, a temporary and a pass
+// over the limbs each, against the same chains through lazy().
+template <std::size_t bits>
+void bench_width() {
+  using Value = vecpp::Large_ap_uint<bits>;
+  using vecpp::lazy;
+  constexpr std::size_t count = 256;
+  std::vector<Value> v;
+  for (std::size_t i = 0; i < count + 3; ++i) {
+    v.push_back(bench::random_full_width<Value>());
+  }
+  std::vector<Value> out(count, Value{0});
+
+  auto run = [&](const std::string& name, auto op) {
+    auto calls = bench::rate([&] {
+      for (std::size_t i = 0; i < count; ++i) {
+        out[i] = op(v[i], v[i + 1], v[i + 2], v[i + 3]);
+      }
+      bench::do_not_optimize(out);
+    });
+    bench::report(std::to_string(bits) + " bits " + name,
+                  calls * count / 1e6, "Mops/s");
+  };
+  run("a + b + c - d", [](const Value& a, const Value& b, const Value& c,
+                          const Value& d) { return a + b + c - d; });
+  run("lazy a + b + c - d",
+      [](const Value& a, const Value& b, const Value& c, const Value& d) {
+        return Value(lazy(a) + b + c - d);
+      });
+  run("a * b + c", [](const Value& a, const Value& b, const Value& c,
+                      const Value&) { return a * b + c; });
+  run("lazy a * b + c",
+      [](const Value& a, const Value& b, const Value& c, const Value&) {
+        return Value(lazy(a) * b + c);
+      });
+  run("a * b - c * d", [](const Value& a, const Value& b, const Value& c,
+                          const Value& d) { return a * b - c * d; });
+  run("lazy a * b - c * d",
+      [](const Value& a, const Value& b, const Value& c, const Value& d) {
+        return Value(lazy(a) * b - lazy(c) * d);
+      });
+}
+
+int main() {
+  bench_width<256>();
+  bench_width<1024>();
+  bench_width<4096>();
+  return 0;
+}
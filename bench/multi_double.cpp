@@ -0,0 +1,83 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Each timed call goes through a batch of operands, so that the clock reads
+// don't dominate.
+constexpr std::size_t batch = 1024;
+
+template <typename F>
+std::vector<F> random_floats() {
+  std::vector<F> result;
+  for (std::size_t i = 0; i < batch; ++i) {
+    auto num = std::int64_t(bench::rng()() >> 1);
+    auto den = std::int64_t(bench::rng()() >> 12) | 1;
+    result.push_back(bench::rng()() % 2 ? F{num} / F{den} : -F{num} / F{den});
+  }
+  return result;
+}
+
+template <typename F, typename Op>
+double bench_op(Op op) {
+  auto a = random_floats<F>();
+  auto b = random_floats<F>();
+  auto calls = bench::rate([&] {
+    for (std::size_t i = 0; i < batch; ++i) {
+      auto r = op(a[i], b[i]);
+      bench::do_not_optimize(r);
+    }
+  });
+  return calls * batch / 1e6;
+}
+
+// The same operation on both backends, and how much faster the native one
+// is.
+template <typename Native, typename Ap, typename Op>
+void compare(const std::string& name, Op op) {
+  double native = bench_op<Native>(op);
+  double ap = bench_op<Ap>(op);
+  bench::report(name + " native", native, "Mops/s");
+  bench::report(name + " Ap_float", ap, "Mops/s");
+  bench::report(name + " speedup", native / ap, "x");
+}
+
+template <typename Native, typename Ap>
+void bench_format(const std::string& suffix) {
+  compare<Native, Ap>("add" + suffix,
+                      [](const auto& a, const auto& b) { return a + b; });
+  compare<Native, Ap>("mul" + suffix,
+                      [](const auto& a, const auto& b) { return a * b; });
+  compare<Native, Ap>("div" + suffix,
+                      [](const auto& a, const auto& b) { return a / b; });
+  compare<Native, Ap>("sqrt" + suffix,
+                      [](const auto& a, const auto&) { return sqrt(abs(a)); });
+}
+
+// Element-wise products over structure of arrays storage.
+void bench_array() {
+  auto values = random_floats<vecpp::Dd_float>();
+  vecpp::Dd_float_array a(batch);
+  vecpp::Dd_float_array b(batch);
+  for (std::size_t i = 0; i < batch; ++i) {
+    a.set(i, values[i]);
+    b.set(i, values[batch - 1 - i]);
+  }
+  vecpp::Dd_float_array out(batch);
+  auto calls = bench::rate([&] {
+    vecpp::transform(a, b, out, [](const vecpp::Dd_float& x,
+                                   const vecpp::Dd_float& y) { return x * y; });
+    bench::do_not_optimize(out);
+  });
+  bench::report("mul<Dd_float_array>", calls * batch / 1e6, "Mops/s");
+}
+
+int main() {
+  bench_format<vecpp::Dd_float, vecpp::Ap_float<106, 11>>("<106,11>");
+  bench_format<vecpp::Qd_float, vecpp::Ap_float<212, 11>>("<212,11>");
+  bench_array();
+  return 0;
+}
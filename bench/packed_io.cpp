@@ -0,0 +1,103 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using vecpp::Packed_encoding;
+
+constexpr std::size_t count = 1 << 20;
+
+// Throughput of the packed format, in GB/s of values in memory.
+template <typename T>
+void bench_type(const std::string& name, const std::vector<T>& values) {
+  double gb = double(count * sizeof(T)) / 1e9;
+  for (auto encoding : {Packed_encoding::fixed, Packed_encoding::varint}) {
+    std::string prefix =
+        name + (encoding == Packed_encoding::fixed ? " fixed " : " varint ");
+    std::string bytes;
+    bench::report(prefix + "write", gb * bench::rate([&] {
+                                      std::ostringstream out;
+                                      vecpp::Packed_writer<T> writer(out,
+                                                                     encoding);
+                                      writer.write(values.data(), count);
+                                      writer.close();
+                                      bytes = out.str();
+                                    }),
+                  "GB/s");
+    bench::report(prefix + "size", double(bytes.size()) / count, "bytes/value");
+
+    std::vector<T> read(count, T{0});
+    bench::report(prefix + "read", gb * bench::rate([&] {
+                                     std::istringstream in(bytes);
+                                     vecpp::Packed_reader<T> reader(in);
+                                     reader.read(read.data(), count);
+                                     bench::do_not_optimize(read);
+                                   }),
+                  "GB/s");
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+    if (encoding == Packed_encoding::fixed) {
+      const char* path = "bench_packed_io.bin";
+      std::ofstream(path, std::ios::binary) << bytes;
+      vecpp::Mapped_packed_array<T> mapped(path);
+      bench::report(prefix + "mapped scan", gb * bench::rate([&] {
+                                              for (std::size_t i = 0;
+                                                   i < mapped.size(); ++i) {
+                                                read[i] = mapped[i];
+                                              }
+                                              bench::do_not_optimize(read);
+                                            }),
+                    "GB/s");
+      std::remove(path);
+    }
+#endif
+  }
+}
+
+int main() {
+  using Int12_t = vecpp::Ap_int<12>;
+  std::vector<Int12_t> small;
+  for (std::size_t i = 0; i < count; ++i) {
+    small.push_back(Int12_t(std::int16_t(bench::rng()())));
+  }
+  bench_type("Ap_int<12>", small);
+
+  using Uint192_t = vecpp::Ap_uint<192>;
+  std::vector<Uint192_t> large;
+  for (std::size_t i = 0; i < count; ++i) {
+    large.push_back(bench::random_full_width<Uint192_t>());
+  }
+  bench_type("Ap_uint<192>", large);
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+  const char* path = "bench_column.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    vecpp::write_column(out, large.data(), large.size());
+  }
+  {
+    vecpp::Ap_int_column<192> column(path);
+    double gb = double(count * sizeof(Uint192_t)) / 1e9;
+    Uint192_t half = Uint192_t{1} << 191;
+    bench::report("Ap_int_column<192> count_if",
+                  gb * bench::rate([&] {
+                    bench::do_not_optimize(vecpp::count_if(
+                        column, [&](const Uint192_t& v) { return v >= half; }));
+                  }),
+                  "GB/s");
+    bench::report("Ap_int_column<192> min", gb * bench::rate([&] {
+                                              bench::do_not_optimize(
+                                                  vecpp::min(column));
+                                            }),
+                  "GB/s");
+  }
+  std::remove(path);
+#endif
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <string>
+
+template <std::size_t bits>
+void bench_next_prime() {
+  using U = vecpp::Ap_uint<bits>;
+  auto p = bench::rate(
+      [] {
+        auto r = vecpp::next_prime(bench::random_full_width<U>());
+        bench::do_not_optimize(r);
+      },
+      2.0);
+  bench::report("next_prime<" + std::to_string(bits) + ">", p, "primes/s");
+}
+
+template <std::size_t bits>
+void bench_is_probable_prime() {
+  using U = vecpp::Ap_uint<bits>;
+  // Random odd values, most of which get rejected by trial division.
+  auto c = bench::rate([] {
+    auto v = bench::random_full_width<U>();
+    v.data_[0] |= 1;
+    auto r = vecpp::is_probable_prime(v);
+    bench::do_not_optimize(r);
+  });
+  bench::report("is_probable_prime<" + std::to_string(bits) + ">", c,
+                "candidates/s");
+}
+
+int main() {
+  bench_is_probable_prime<512>();
+  bench_is_probable_prime<1024>();
+  bench_is_probable_prime<2048>();
+
+  bench_next_prime<512>();
+  bench_next_prime<1024>();
+  bench_next_prime<2048>();
+  return 0;
+}
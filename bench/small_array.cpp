@@ -0,0 +1,86 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+constexpr std::size_t count = 1 << 14;
+
+// Batch operations on Small_ap_int_array against the same loop over a
+// std::vector of Small_ap_int.
+template <std::size_t bits, bool is_signed>
+void bench_width() {
+  using Array = vecpp::Small_ap_int_array<bits, is_signed>;
+  using Value = typename Array::Value;
+  using Storage =
+      typename vecpp::detail::Small_storage_selector<bits, is_signed>::type;
+
+  std::vector<Value> a;
+  std::vector<Value> b;
+  for (std::size_t i = 0; i < count; ++i) {
+    a.push_back(Value(Storage(bench::rng()())));
+    b.push_back(Value(Storage(bench::rng()())));
+  }
+
+  std::string prefix = std::to_string(bits) + " bits ";
+  auto report = [&](const std::string& name, double calls) {
+    bench::report(prefix + name, calls * count / 1e6, "Mops/s");
+  };
+
+  std::vector<Value> out(count);
+  std::vector<int> order(count);
+  report("add, vector<Small_ap_int>", bench::rate([&] {
+           for (std::size_t i = 0; i < count; ++i) {
+             out[i] = a[i] + b[i];
+           }
+           bench::do_not_optimize(out);
+         }));
+  report("mul, vector<Small_ap_int>", bench::rate([&] {
+           for (std::size_t i = 0; i < count; ++i) {
+             out[i] = a[i] * b[i];
+           }
+           bench::do_not_optimize(out);
+         }));
+  report("compare, vector<Small_ap_int>", bench::rate([&] {
+           for (std::size_t i = 0; i < count; ++i) {
+             order[i] = (a[i] > b[i]) - (a[i] < b[i]);
+           }
+           bench::do_not_optimize(order);
+         }));
+
+  Array pa;
+  Array pb;
+  Array r;
+  vecpp::pack(a.data(), count, pa);
+  vecpp::pack(b.data(), count, pb);
+  report("pack, Small_ap_int_array", bench::rate([&] {
+           vecpp::pack(a.data(), count, r);
+           bench::do_not_optimize(r);
+         }));
+  report("unpack, Small_ap_int_array", bench::rate([&] {
+           vecpp::unpack(pa, out.data());
+           bench::do_not_optimize(out);
+         }));
+  report("add, Small_ap_int_array", bench::rate([&] {
+           vecpp::add(pa, pb, r);
+           bench::do_not_optimize(r);
+         }));
+  report("mul, Small_ap_int_array", bench::rate([&] {
+           vecpp::mul(pa, pb, r);
+           bench::do_not_optimize(r);
+         }));
+  report("compare, Small_ap_int_array", bench::rate([&] {
+           vecpp::compare(pa, pb, order);
+           bench::do_not_optimize(order);
+         }));
+}
+
+int main() {
+  bench_width<5, false>();
+  bench_width<12, true>();
+  bench_width<16, false>();
+  bench_width<27, true>();
+  return 0;
+}
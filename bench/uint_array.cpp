@@ -0,0 +1,112 @@
+#include "bench_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using vecpp::detail::Isa;
+
+constexpr std::size_t count = 1 << 12;
+
+// Batch operations on Ap_uint_array against the same loop over a
+// std::vector of Large_ap_uint, at every level the CPU supports.
+template <std::size_t bits>
+void bench_width() {
+  using Value = vecpp::Large_ap_uint<bits>;
+  using Array = vecpp::Ap_uint_array<bits>;
+  using Kernels = vecpp::detail::Uint_array_kernels<bits>;
+
+  std::vector<Value> a;
+  std::vector<Value> b;
+  Array sa(count);
+  Array sb(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    a.push_back(bench::random_full_width<Value>());
+    b.push_back(bench::random_full_width<Value>());
+    sa[i] = a.back();
+    sb[i] = b.back();
+  }
+
+  std::string prefix = std::to_string(bits) + " bits ";
+  auto report = [&](const std::string& name, double calls) {
+    bench::report(prefix + name, calls * count / 1e6, "Mops/s");
+  };
+
+  std::vector<Value> out(count, Value{0});
+  std::vector<int> order(count);
+  report("add, vector<Large_ap_uint>", bench::rate([&] {
+           for (std::size_t i = 0; i < count; ++i) {
+             out[i] = a[i] + b[i];
+           }
+           bench::do_not_optimize(out);
+         }));
+  report("mul, vector<Large_ap_uint>", bench::rate([&] {
+           for (std::size_t i = 0; i < count; ++i) {
+             out[i] = a[i] * b[i];
+           }
+           bench::do_not_optimize(out);
+         }));
+  report("compare, vector<Large_ap_uint>", bench::rate([&] {
+           for (std::size_t i = 0; i < count; ++i) {
+             order[i] = a[i].compare(b[i]);
+           }
+           bench::do_not_optimize(order);
+         }));
+
+  for (auto level :
+       {Isa::generic, Isa::avx2, Isa::avx512, Isa::avx512_ifma}) {
+    if (!vecpp::detail::isa_supported(level)) {
+      continue;
+    }
+    std::string suffix =
+        std::string(", Ap_uint_array ") + vecpp::detail::isa_names[int(level)];
+    Array r;
+    report("add" + suffix, bench::rate([&] {
+             Kernels::add(level, sa, sb, r);
+             bench::do_not_optimize(r);
+           }));
+    report("sub" + suffix, bench::rate([&] {
+             Kernels::sub(level, sa, sb, r);
+             bench::do_not_optimize(r);
+           }));
+    report("mul" + suffix, bench::rate([&] {
+             Kernels::mul(level, sa, sb, r);
+             bench::do_not_optimize(r);
+           }));
+    report("compare" + suffix, bench::rate([&] {
+             Kernels::compare(level, sa, sb, order);
+             bench::do_not_optimize(order);
+           }));
+  }
+
+  // Montgomery products modulo a full width odd number.
+  auto n = bench::random_full_width<Value>();
+  n.data_[0] |= 1;
+  vecpp::Montgomery<bits> ctx(n);
+  for (std::size_t i = 0; i < count; ++i) {
+    sa[i] = ctx.to_mont(a[i] % n);
+    sb[i] = ctx.to_mont(b[i] % n);
+  }
+  for (auto level : {Isa::generic, Isa::avx512_ifma}) {
+    if (!vecpp::detail::isa_supported(level)) {
+      continue;
+    }
+    Array r;
+    report(std::string("Montgomery mul, Ap_uint_array ") +
+               vecpp::detail::isa_names[int(level)],
+           bench::rate([&] {
+             vecpp::detail::Montgomery_array<bits>::mul(level, ctx, sa, sb,
+                                                        r);
+             bench::do_not_optimize(r);
+           }));
+  }
+}
+
+int main() {
+  bench_width<128>();
+  bench_width<256>();
+  bench_width<512>();
+  return 0;
+}
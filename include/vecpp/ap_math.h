@@ -2,7 +2,26 @@
 #define VECPP_APMATH_H_INCLUDED
 
 #include "vecpp/ap_math/ap_int.h"
+#include "vecpp/ap_math/ap_int/column.h"
+#include "vecpp/ap_math/ap_int/combinatorics.h"
+#include "vecpp/ap_math/ap_int/dynamic.h"
+#include "vecpp/ap_math/ap_int/lazy.h"
+#include "vecpp/ap_math/ap_int/literals.h"
+#include "vecpp/ap_math/ap_int/limb_pool.h"
+#include "vecpp/ap_math/ap_int/montgomery.h"
+#include "vecpp/ap_math/ap_int/packed_io.h"
+#include "vecpp/ap_math/ap_int/primes.h"
+#include "vecpp/ap_math/ap_int/roots.h"
+#include "vecpp/ap_math/ap_int/small_array.h"
+#include "vecpp/ap_math/ap_int/uint_array.h"
+#include "vecpp/ap_math/ap_decimal.h"
+#include "vecpp/ap_math/ap_fixed.h"
 #include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_float/constants.h"
+#include "vecpp/ap_math/ap_float/elementary.h"
+#include "vecpp/ap_math/ap_float/exact_sum.h"
+#include "vecpp/ap_math/ap_float/minimax.h"
+#include "vecpp/ap_math/ap_float/multi_double.h"
 
 #include "vecpp/ap_math/limits.h"
 
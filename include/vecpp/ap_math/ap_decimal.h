@@ -0,0 +1,978 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_DECIMAL_INCLUDED_H
+#define VECPP_AP_DECIMAL_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_int.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vecpp {
+
+namespace detail {
+template <std::size_t digits, std::int64_t emax>
+struct Ap_decimal_arith;
+}
+
+// A decimal floating point number: (-1)^sign * coefficient * 10^exponent,
+// with a coefficient of at most `digits` decimal digits. Like the BID
+// encoding of IEEE 754-2008, the coefficient is a binary integer.
+//
+// Values are not normalized: 1.0 and 1.00 are distinct members of the same
+// cohort. Exact results use the exponent IEEE 754 prefers (the smaller one
+// for sums, the sum for products, the difference for quotients), inexact
+// ones are correctly rounded to `digits` digits.
+//
+// emax bounds the exponent of the leading digit, 1 - emax is the smallest
+// normal one, with subnormals below. Ap_decimal<7, 96>, Ap_decimal<16, 384>
+// and Ap_decimal<34, 6144> behave like decimal32, decimal64 and decimal128.
+template <std::size_t digits, std::int64_t emax = 6144>
+class Ap_decimal {
+  static_assert(digits > 0);
+  static_assert(emax > 0 && emax < (std::int64_t(1) << 52));
+
+ public:
+  // log2(10) < 3.3220
+  static constexpr std::size_t coefficient_bits =
+      std::max<std::size_t>(128, (digits * 33220 + 9999) / 10000);
+  using Coefficient = Large_ap_uint<coefficient_bits>;
+
+  static constexpr std::int64_t max_exponent = emax;
+  static constexpr std::int64_t min_exponent = 1 - emax;
+  // Range of the exponent of the last digit.
+  static constexpr std::int64_t max_quantum = emax - std::int64_t(digits) + 1;
+  static constexpr std::int64_t min_quantum =
+      min_exponent - std::int64_t(digits) + 1;
+
+  // +0E0
+  constexpr Ap_decimal() = default;
+
+  // Exact when the value fits in digits digits, rounded to nearest even
+  // otherwise.
+  template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  constexpr Ap_decimal(T);
+
+  // [+-]digits[.digits][(e|E)[+-]digits], "inf", "infinity" or "nan", in any
+  // case. Rounded to nearest even, anything else is a NaN.
+  constexpr explicit Ap_decimal(std::string_view);
+
+  // coefficient * 10^exponent, rounded if needed.
+  static constexpr Ap_decimal from_parts(
+      bool negative, const Coefficient& coefficient, std::int64_t exponent,
+      Rounding mode = Rounding::nearest_even);
+
+  static constexpr Ap_decimal infinity(bool negative = false);
+  static constexpr Ap_decimal quiet_nan();
+  // Largest finite value.
+  static constexpr Ap_decimal max();
+
+  constexpr bool is_nan() const { return kind_ == Kind::nan; }
+  constexpr bool is_inf() const { return kind_ == Kind::infinity; }
+  constexpr bool is_finite() const { return kind_ == Kind::finite; }
+  constexpr bool is_zero() const {
+    return is_finite() && coefficient_ == 0;
+  }
+  constexpr bool signbit() const { return negative_; }
+
+  // Both are only meaningful for finite values.
+  constexpr const Coefficient& coefficient() const { return coefficient_; }
+  constexpr std::int64_t exponent() const { return exponent_; }
+
+  // Numerical comparisons: members of a cohort are equal, NaN is unordered.
+  constexpr bool operator==(const Ap_decimal& rhs) const;
+  constexpr bool operator!=(const Ap_decimal& rhs) const;
+  constexpr bool operator<(const Ap_decimal&) const;
+  constexpr bool operator<=(const Ap_decimal&) const;
+  constexpr bool operator>(const Ap_decimal&) const;
+  constexpr bool operator>=(const Ap_decimal&) const;
+
+  constexpr Ap_decimal operator+() const;
+  constexpr Ap_decimal operator-() const;
+
+  constexpr Ap_decimal& operator+=(const Ap_decimal&);
+  constexpr Ap_decimal& operator-=(const Ap_decimal&);
+  constexpr Ap_decimal& operator*=(const Ap_decimal&);
+  constexpr Ap_decimal& operator/=(const Ap_decimal&);
+
+  constexpr Ap_decimal operator+(const Ap_decimal&) const;
+  constexpr Ap_decimal operator-(const Ap_decimal&) const;
+  constexpr Ap_decimal operator*(const Ap_decimal&)const;
+  constexpr Ap_decimal operator/(const Ap_decimal&) const;
+
+ private:
+  friend struct detail::Ap_decimal_arith<digits, emax>;
+
+  enum class Kind : std::uint8_t { finite, infinity, nan };
+
+  constexpr int compare(const Ap_decimal& rhs) const;
+
+  Coefficient coefficient_{0};
+  std::int64_t exponent_ = 0;
+  Kind kind_ = Kind::finite;
+  bool negative_ = false;
+};
+
+namespace detail {
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> power_of_ten(std::size_t k) {
+  Large_ap_uint<bits> result{1};
+  for (std::size_t i = 0; i < k; ++i) {
+    result *= 10;
+  }
+  return result;
+}
+
+template <std::size_t bits, std::size_t... k>
+constexpr std::array<Large_ap_uint<bits>, sizeof...(k)> make_powers_of_ten(
+    std::index_sequence<k...>) {
+  return {{power_of_ten<bits>(k)...}};
+}
+
+// 10^0 to 10^(count - 1), built at compile time, so that scaling by 10^k is
+// a single multiplication or division.
+template <std::size_t bits, std::size_t count>
+inline constexpr std::array<Large_ap_uint<bits>, count> powers_of_ten =
+    make_powers_of_ten<bits>(std::make_index_sequence<count>{});
+
+constexpr std::array<std::uint64_t, 20> make_word_powers_of_ten() {
+  std::array<std::uint64_t, 20> result{};
+  std::uint64_t p = 1;
+  for (auto& v : result) {
+    v = p;
+    p *= 10;
+  }
+  return result;
+}
+
+inline constexpr std::array<std::uint64_t, 20> word_powers_of_ten =
+    make_word_powers_of_ten();
+
+template <std::size_t digits, std::int64_t emax>
+struct Ap_decimal_arith {
+  using Decimal = Ap_decimal<digits, emax>;
+  using Coefficient = typename Decimal::Coefficient;
+  using Kind = typename Decimal::Kind;
+
+  static constexpr std::int64_t p = digits;
+  static constexpr std::int64_t qmin = Decimal::min_quantum;
+  static constexpr std::int64_t qmax = Decimal::max_quantum;
+
+  // Aligned sums have at most 3 digits + 4 digits, and dividends
+  // 2 digits + 1, see add() and div(). One more digit leaves room to double
+  // a remainder.
+  static constexpr std::size_t wide_bits =
+      std::max<std::size_t>(128, ((3 * digits + 5) * 33220 + 9999) / 10000);
+  using Wide = Large_ap_uint<wide_bits>;
+  // floor(wide_bits * log10(2)): 10^wide_digits is the largest power of ten
+  // that fits, and no value has more than wide_digits + 1 digits.
+  static constexpr std::size_t wide_digits =
+      std::size_t(wide_bits * std::uint64_t(30102999566) / 100000000000);
+
+  static constexpr const Wide& pow10(std::size_t k) {
+    return powers_of_ten<wide_bits, wide_digits + 1>[k];
+  }
+
+  static constexpr Wide widen(const Coefficient& c) {
+    Wide result{0};
+    result.data_ = resize<wide_bits>(c.data_);
+    return result;
+  }
+
+  // The single word holding c, or false when it needs more.
+  static constexpr bool single_word(const Coefficient& c, std::uint64_t& out) {
+    for (std::size_t i = 1; i < Coefficient::Storage::words; ++i) {
+      if (c.data_[i] != 0) {
+        return false;
+      }
+    }
+    out = c.data_[0];
+    return true;
+  }
+
+  // Whether v < 10^digits, for a value that fits in a word.
+  static constexpr bool fits(std::uint64_t v) {
+    return digits >= 20 || v < word_powers_of_ten[digits];
+  }
+
+  // Number of decimal digits of v, 0 for 0.
+  static constexpr std::int64_t digit_count(const Wide& v) {
+    std::size_t bit_length = wide_bits - v.data_.count_leading_zeros();
+    if (bit_length == 0) {
+      return 0;
+    }
+    // v >= 2^(bit_length - 1) >= 10^n, 1233 / 4096 < log10(2).
+    std::size_t n = ((bit_length - 1) * 1233) >> 12;
+    while (n < wide_digits && v >= pow10(n + 1)) {
+      ++n;
+    }
+    return std::int64_t(n) + 1;
+  }
+
+  static constexpr Decimal make(bool negative, const Wide& c, std::int64_t q) {
+    Decimal result;
+    result.coefficient_.data_ = resize<Decimal::coefficient_bits>(c.data_);
+    result.exponent_ = q;
+    result.negative_ = negative;
+    return result;
+  }
+
+  static constexpr Decimal make_word(bool negative, std::uint64_t c,
+                                     std::int64_t q) {
+    Decimal result;
+    result.coefficient_ = Coefficient{c};
+    result.exponent_ = q;
+    result.negative_ = negative;
+    return result;
+  }
+
+  static constexpr Decimal nan() {
+    Decimal result;
+    result.kind_ = Kind::nan;
+    return result;
+  }
+
+  static constexpr Decimal infinity(bool negative) {
+    Decimal result;
+    result.kind_ = Kind::infinity;
+    result.negative_ = negative;
+    return result;
+  }
+
+  static constexpr Decimal max(bool negative) {
+    return make(negative, pow10(p) - 1, qmax);
+  }
+
+  static constexpr Decimal overflow(bool negative, Rounding mode) {
+    switch (mode) {
+      case Rounding::toward_zero:
+        return max(negative);
+      case Rounding::upward:
+        return negative ? max(true) : infinity(false);
+      case Rounding::downward:
+        return negative ? infinity(true) : max(false);
+      default:
+        return infinity(negative);
+    }
+  }
+
+  // Whether a truncated quotient gets incremented. side compares the
+  // remainder with half a unit: -1 below, 0 at, 1 above.
+  static constexpr bool round_up(bool negative, bool odd, int side,
+                                 bool inexact, Rounding mode) {
+    switch (mode) {
+      case Rounding::nearest_even:
+        return side > 0 || (side == 0 && odd);
+      case Rounding::nearest_away:
+        return side >= 0;
+      case Rounding::toward_zero:
+        return false;
+      case Rounding::upward:
+        return inexact && !negative;
+      case Rounding::downward:
+        return inexact && negative;
+    }
+    return false;
+  }
+
+  // Divides c by 10^drop, rounding the quotient according to mode. count is
+  // the number of digits of c.
+  static constexpr Wide shift_right(bool negative, const Wide& c,
+                                    std::int64_t drop, std::int64_t count,
+                                    Rounding mode) {
+    Wide quotient{0};
+    Wide remainder = c;
+    // Past count digits, the remainder is c, below half a unit.
+    int side = -1;
+    if (drop <= count) {
+      auto [quot, rem] = c.data_.udivmod(pow10(std::size_t(drop)).data_);
+      quotient.data_ = quot;
+      remainder.data_ = rem;
+      side = (remainder + remainder).compare(pow10(std::size_t(drop)));
+    }
+    bool odd = (quotient.data_[0] & 1) != 0;
+    if (round_up(negative, odd, side, remainder != 0, mode)) {
+      ++quotient;
+    }
+    return quotient;
+  }
+
+  // (-1)^negative * c * 10^q, rounded to digits digits and to the exponent
+  // range. Callers standing for an inexact value by a trailing non-zero
+  // digit make sure that digit is below the rounding position.
+  static constexpr Decimal round(bool negative, Wide c, std::int64_t q,
+                                 Rounding mode) {
+    auto count = digit_count(c);
+    std::int64_t drop = std::max<std::int64_t>(count - p, 0);
+    if (q + drop < qmin) {
+      drop = qmin - q;
+    }
+    if (drop > 0) {
+      c = shift_right(negative, c, drop, count, mode);
+      q += drop;
+      // Rounding up 99...9 carries into one more digit.
+      if (c == pow10(p)) {
+        c = pow10(p - 1);
+        ++q;
+      }
+    }
+
+    if (q > qmax) {
+      if (c == 0) {
+        q = qmax;
+      } else if (digit_count(c) + (q - qmax) <= p) {
+        // Pad with zeros rather than overflowing.
+        c *= pow10(std::size_t(q - qmax));
+        q = qmax;
+      } else {
+        return overflow(negative, mode);
+      }
+    }
+    return make(negative, c, q);
+  }
+
+  // The exact sum of the coefficients, at y's exponent, when both fit in a
+  // word and so does the aligned result. The sign goes to negative.
+  static constexpr bool add_words(const Decimal& x, bool x_neg,
+                                  const Decimal& y, bool y_neg, Rounding mode,
+                                  std::uint64_t& sum, bool& negative) {
+    std::uint64_t cx = 0;
+    std::uint64_t cy = 0;
+    if (!single_word(x.coefficient_, cx) || !single_word(y.coefficient_, cy)) {
+      return false;
+    }
+    std::int64_t d = x.exponent_ - y.exponent_;
+    if (d < 0 || d >= 20) {
+      return false;
+    }
+    auto scaled = Uint128(cx) * word_powers_of_ten[std::size_t(d)];
+    if ((scaled >> 64) != 0) {
+      return false;
+    }
+    cx = std::uint64_t(scaled);
+
+    negative = x_neg;
+    if (x_neg == y_neg) {
+      if (__builtin_add_overflow(cx, cy, &sum)) {
+        return false;
+      }
+    } else if (cx >= cy) {
+      sum = cx - cy;
+    } else {
+      sum = cy - cx;
+      negative = y_neg;
+    }
+    if (!fits(sum)) {
+      return false;
+    }
+    if (sum == 0 && x_neg != y_neg) {
+      negative = mode == Rounding::downward;
+    }
+    return true;
+  }
+
+  static constexpr Decimal add(const Decimal& a, const Decimal& b,
+                               bool subtract, Rounding mode) {
+    bool b_neg = b.negative_ != subtract;
+    if (a.is_nan() || b.is_nan()) {
+      return nan();
+    }
+    if (a.is_inf() || b.is_inf()) {
+      if (a.is_inf() && b.is_inf() && a.negative_ != b_neg) {
+        return nan();
+      }
+      return a.is_inf() ? a : infinity(b_neg);
+    }
+
+    // x gets the larger exponent.
+    const Decimal* x = &a;
+    const Decimal* y = &b;
+    bool x_neg = a.negative_;
+    bool y_neg = b_neg;
+    if (a.exponent_ < b.exponent_) {
+      std::swap(x, y);
+      std::swap(x_neg, y_neg);
+    }
+
+    std::uint64_t word_sum = 0;
+    bool word_negative = false;
+    if (add_words(*x, x_neg, *y, y_neg, mode, word_sum, word_negative)) {
+      return make_word(word_negative, word_sum, y->exponent_);
+    }
+
+    Wide cx = widen(x->coefficient_);
+    Wide cy = widen(y->coefficient_);
+    std::int64_t d = x->exponent_ - y->exponent_;
+    std::int64_t q = y->exponent_;
+    if (cx != 0 && d > 2 * p + 2) {
+      if (cy == 0) {
+        // The exact sum is x, moved as close to y's exponent as it can go.
+        auto shift = std::min(d, p - digit_count(cx));
+        return round(x_neg, cx * pow10(std::size_t(shift)), x->exponent_ - shift,
+                     mode);
+      }
+      // |x + y| > 10^(xq - 1), so rounding happens at 10^(xq - p - 1) or
+      // above, while |y| < 10^(xq - p - 2): any non-zero digit further down
+      // stands for it.
+      d = 2 * p + 3;
+      q = x->exponent_ - d;
+      cy = Wide{1};
+      cx *= pow10(std::size_t(d));
+    } else if (cx != 0) {
+      cx *= pow10(std::size_t(d));
+    }
+
+    Wide sum{0};
+    bool negative = x_neg;
+    if (x_neg == y_neg) {
+      sum = cx + cy;
+    } else if (cx >= cy) {
+      sum = cx - cy;
+    } else {
+      sum = cy - cx;
+      negative = y_neg;
+    }
+    // x + (-x) is +0, or -0 when rounding downward.
+    if (sum == 0 && x_neg != y_neg) {
+      negative = mode == Rounding::downward;
+    }
+    return round(negative, sum, q, mode);
+  }
+
+  static constexpr Decimal mul(const Decimal& a, const Decimal& b,
+                               Rounding mode) {
+    bool negative = a.negative_ != b.negative_;
+    if (a.is_nan() || b.is_nan()) {
+      return nan();
+    }
+    if (a.is_inf() || b.is_inf()) {
+      if (a.is_zero() || b.is_zero()) {
+        return nan();
+      }
+      return infinity(negative);
+    }
+
+    std::int64_t q = a.exponent_ + b.exponent_;
+    std::uint64_t ca = 0;
+    std::uint64_t cb = 0;
+    if (single_word(a.coefficient_, ca) && single_word(b.coefficient_, cb) &&
+        q >= qmin && q <= qmax) {
+      auto product = Uint128(ca) * cb;
+      if ((product >> 64) == 0 && fits(std::uint64_t(product))) {
+        return make_word(negative, std::uint64_t(product), q);
+      }
+    }
+
+    return round(negative, widen(a.coefficient_) * widen(b.coefficient_), q,
+                 mode);
+  }
+
+  static constexpr Decimal div(const Decimal& a, const Decimal& b,
+                               Rounding mode) {
+    bool negative = a.negative_ != b.negative_;
+    if (a.is_nan() || b.is_nan() || (a.is_inf() && b.is_inf())) {
+      return nan();
+    }
+    if (a.is_inf()) {
+      return infinity(negative);
+    }
+    if (b.is_inf()) {
+      return make(negative, Wide{0}, qmin);
+    }
+    if (b.is_zero()) {
+      return a.is_zero() ? nan() : infinity(negative);
+    }
+
+    std::int64_t preferred = a.exponent_ - b.exponent_;
+    Wide ca = widen(a.coefficient_);
+    Wide cb = widen(b.coefficient_);
+    if (ca == 0) {
+      return round(negative, ca, preferred, mode);
+    }
+
+    // Scales the dividend so that the quotient has at least digits + 1
+    // digits.
+    std::int64_t k =
+        std::max<std::int64_t>(0, p + 1 + digit_count(cb) - digit_count(ca));
+    ca *= pow10(std::size_t(k));
+    std::int64_t q = preferred - k;
+
+    Wide quotient{0};
+    Wide remainder{0};
+    auto [quot, rem] = ca.data_.udivmod(cb.data_);
+    quotient.data_ = quot;
+    remainder.data_ = rem;
+    if (remainder == 0) {
+      // Exact: trailing zeros go back into the exponent.
+      while (q < preferred) {
+        auto next = quotient;
+        if (next.data_.divmod_word(10) != 0) {
+          break;
+        }
+        quotient = next;
+        ++q;
+      }
+    } else {
+      quotient = quotient * 10 + 1;
+      --q;
+    }
+    return round(negative, quotient, q, mode);
+  }
+
+  static constexpr Decimal quantize(const Decimal& x, const Decimal& y,
+                                    Rounding mode) {
+    if (x.is_nan() || y.is_nan()) {
+      return nan();
+    }
+    if (x.is_inf() || y.is_inf()) {
+      return x.is_inf() && y.is_inf() ? x : nan();
+    }
+
+    std::int64_t q = y.exponent_;
+    std::int64_t d = x.exponent_ - q;
+    std::uint64_t cx = 0;
+    if (single_word(x.coefficient_, cx) && d > -20 && d < 20) {
+      if (d >= 0) {
+        auto scaled = Uint128(cx) * word_powers_of_ten[std::size_t(d)];
+        if ((scaled >> 64) == 0 && fits(std::uint64_t(scaled))) {
+          return make_word(x.negative_, std::uint64_t(scaled), q);
+        }
+      } else {
+        auto unit = word_powers_of_ten[std::size_t(-d)];
+        auto quotient = cx / unit;
+        auto remainder = cx % unit;
+        auto half = unit / 2;
+        int side = remainder < half ? -1 : remainder == half ? 0 : 1;
+        quotient += round_up(x.negative_, (quotient & 1) != 0, side,
+                             remainder != 0, mode);
+        return make_word(x.negative_, quotient, q);
+      }
+    }
+
+    Wide c = widen(x.coefficient_);
+    auto count = digit_count(c);
+    if (x.exponent_ >= q) {
+      std::int64_t shift = x.exponent_ - q;
+      if (c == 0) {
+        return make(x.negative_, c, q);
+      }
+      if (count + shift > p) {
+        return nan();
+      }
+      return make(x.negative_, c * pow10(std::size_t(shift)), q);
+    }
+
+    c = shift_right(x.negative_, c, q - x.exponent_, count, mode);
+    if (digit_count(c) > p) {
+      return nan();
+    }
+    return make(x.negative_, c, q);
+  }
+
+  // Compares magnitudes of finite values.
+  static constexpr int compare_magnitude(const Decimal& a, const Decimal& b) {
+    Wide ca = widen(a.coefficient_);
+    Wide cb = widen(b.coefficient_);
+    if (ca == 0 || cb == 0) {
+      return (ca != 0) - (cb != 0);
+    }
+    // Exponents of the leading digits.
+    auto lead_a = a.exponent_ + digit_count(ca);
+    auto lead_b = b.exponent_ + digit_count(cb);
+    if (lead_a != lead_b) {
+      return lead_a < lead_b ? -1 : 1;
+    }
+    // Same leading digit position, so exponents are less than digits apart.
+    if (a.exponent_ > b.exponent_) {
+      ca *= pow10(std::size_t(a.exponent_ - b.exponent_));
+    } else {
+      cb *= pow10(std::size_t(b.exponent_ - a.exponent_));
+    }
+    return ca.compare(cb);
+  }
+
+  // Parses the part after the sign.
+  static constexpr Decimal parse(bool negative, std::string_view str) {
+    auto lower = [](char ch) {
+      return ch >= 'A' && ch <= 'Z' ? char(ch - 'A' + 'a') : ch;
+    };
+    auto equals = [&](std::string_view word) {
+      if (str.size() != word.size()) {
+        return false;
+      }
+      for (std::size_t i = 0; i < word.size(); ++i) {
+        if (lower(str[i]) != word[i]) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if (equals("inf") || equals("infinity")) {
+      return infinity(negative);
+    }
+    if (equals("nan")) {
+      return nan();
+    }
+
+    // Keeps digits + 1 significant digits, the rest only matters through
+    // whether it is zero.
+    Wide c{0};
+    std::int64_t q = 0;
+    std::int64_t kept = 0;
+    bool dropped = false;
+    bool sticky = false;
+    bool any_digit = false;
+    bool fraction = false;
+    std::size_t i = 0;
+    for (; i < str.size(); ++i) {
+      char ch = str[i];
+      if (ch == '.' && !fraction) {
+        fraction = true;
+        continue;
+      }
+      if (ch < '0' || ch > '9') {
+        break;
+      }
+      any_digit = true;
+      auto digit = std::uint64_t(ch - '0');
+      if (kept <= p && (kept > 0 || digit != 0)) {
+        c = c * 10 + digit;
+        ++kept;
+        q -= fraction ? 1 : 0;
+      } else if (kept == 0) {
+        // Leading zero.
+        q -= fraction ? 1 : 0;
+      } else {
+        dropped = true;
+        sticky = sticky || digit != 0;
+        q += fraction ? 0 : 1;
+      }
+    }
+    if (!any_digit) {
+      return nan();
+    }
+
+    if (i < str.size() && lower(str[i]) == 'e') {
+      ++i;
+      bool exponent_negative = false;
+      if (i < str.size() && (str[i] == '+' || str[i] == '-')) {
+        exponent_negative = str[i] == '-';
+        ++i;
+      }
+      if (i == str.size()) {
+        return nan();
+      }
+      // Saturates far beyond any exponent range.
+      std::int64_t e = 0;
+      for (; i < str.size() && str[i] >= '0' && str[i] <= '9'; ++i) {
+        e = std::min<std::int64_t>(e * 10 + (str[i] - '0'),
+                                   std::int64_t(1) << 60);
+      }
+      q += exponent_negative ? -e : e;
+    }
+    if (i != str.size()) {
+      return nan();
+    }
+
+    if (dropped) {
+      c = c * 10 + std::uint64_t(sticky);
+      --q;
+    }
+    return round(negative, c, q, Rounding::nearest_even);
+  }
+};
+}  // namespace detail
+
+template <std::size_t digits, std::int64_t emax>
+template <typename T, std::enable_if_t<std::is_integral_v<T>, int>>
+constexpr Ap_decimal<digits, emax>::Ap_decimal(T v) {
+  using Arith = detail::Ap_decimal_arith<digits, emax>;
+  auto magnitude = std::uint64_t(v);
+  if constexpr (std::is_signed_v<T>) {
+    negative_ = v < 0;
+    if (negative_) {
+      magnitude = std::uint64_t(0) - magnitude;
+    }
+  }
+  if (Arith::fits(magnitude)) {
+    coefficient_ = Coefficient{magnitude};
+  } else {
+    *this = Arith::round(negative_, typename Arith::Wide{magnitude}, 0,
+                         Rounding::nearest_even);
+  }
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax>::Ap_decimal(std::string_view str) {
+  bool negative = false;
+  if (!str.empty() && (str[0] == '+' || str[0] == '-')) {
+    negative = str[0] == '-';
+    str.remove_prefix(1);
+  }
+  *this = detail::Ap_decimal_arith<digits, emax>::parse(negative, str);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::from_parts(
+    bool negative, const Coefficient& coefficient, std::int64_t exponent,
+    Rounding mode) {
+  using Arith = detail::Ap_decimal_arith<digits, emax>;
+  return Arith::round(negative, Arith::widen(coefficient), exponent, mode);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::infinity(
+    bool negative) {
+  return detail::Ap_decimal_arith<digits, emax>::infinity(negative);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::quiet_nan() {
+  return detail::Ap_decimal_arith<digits, emax>::nan();
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::max() {
+  return detail::Ap_decimal_arith<digits, emax>::max(false);
+}
+
+// ************************** COMPARISONS ************************** //
+
+// Only meaningful when neither value is a NaN.
+template <std::size_t digits, std::int64_t emax>
+constexpr int Ap_decimal<digits, emax>::compare(const Ap_decimal& rhs) const {
+  using Arith = detail::Ap_decimal_arith<digits, emax>;
+  if (is_zero() && rhs.is_zero()) {
+    return 0;
+  }
+  // Zeros are in the middle whatever their sign.
+  int lhs_sign = is_zero() ? 0 : negative_ ? -1 : 1;
+  int rhs_sign = rhs.is_zero() ? 0 : rhs.negative_ ? -1 : 1;
+  if (lhs_sign != rhs_sign) {
+    return lhs_sign < rhs_sign ? -1 : 1;
+  }
+
+  int magnitude = 0;
+  if (is_inf() || rhs.is_inf()) {
+    magnitude = int(is_inf()) - int(rhs.is_inf());
+  } else {
+    magnitude = Arith::compare_magnitude(*this, rhs);
+  }
+  return negative_ ? -magnitude : magnitude;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr bool Ap_decimal<digits, emax>::operator==(
+    const Ap_decimal& rhs) const {
+  return !is_nan() && !rhs.is_nan() && compare(rhs) == 0;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr bool Ap_decimal<digits, emax>::operator!=(
+    const Ap_decimal& rhs) const {
+  return !(*this == rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr bool Ap_decimal<digits, emax>::operator<(
+    const Ap_decimal& rhs) const {
+  return !is_nan() && !rhs.is_nan() && compare(rhs) < 0;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr bool Ap_decimal<digits, emax>::operator<=(
+    const Ap_decimal& rhs) const {
+  return !is_nan() && !rhs.is_nan() && compare(rhs) <= 0;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr bool Ap_decimal<digits, emax>::operator>(
+    const Ap_decimal& rhs) const {
+  return !is_nan() && !rhs.is_nan() && compare(rhs) > 0;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr bool Ap_decimal<digits, emax>::operator>=(
+    const Ap_decimal& rhs) const {
+  return !is_nan() && !rhs.is_nan() && compare(rhs) >= 0;
+}
+
+// ************************** ARITHMETIC ************************** //
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::operator+()
+    const {
+  return *this;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::operator-()
+    const {
+  auto result = *this;
+  result.negative_ = !negative_;
+  return result;
+}
+
+// Correctly rounded with the given mode.
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> add(const Ap_decimal<digits, emax>& a,
+                                       const Ap_decimal<digits, emax>& b,
+                                       Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_decimal_arith<digits, emax>::add(a, b, false, mode);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> sub(const Ap_decimal<digits, emax>& a,
+                                       const Ap_decimal<digits, emax>& b,
+                                       Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_decimal_arith<digits, emax>::add(a, b, true, mode);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> mul(const Ap_decimal<digits, emax>& a,
+                                       const Ap_decimal<digits, emax>& b,
+                                       Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_decimal_arith<digits, emax>::mul(a, b, mode);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> div(const Ap_decimal<digits, emax>& a,
+                                       const Ap_decimal<digits, emax>& b,
+                                       Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_decimal_arith<digits, emax>::div(a, b, mode);
+}
+
+// x rounded to the exponent of y, e.g. quantize(x, 0.01) for cents. NaN when
+// the result does not fit in digits digits.
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> quantize(
+    const Ap_decimal<digits, emax>& x, const Ap_decimal<digits, emax>& y,
+    Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_decimal_arith<digits, emax>::quantize(x, y, mode);
+}
+
+// Whether both have the same exponent, or are both infinite, or both NaN.
+template <std::size_t digits, std::int64_t emax>
+constexpr bool same_quantum(const Ap_decimal<digits, emax>& x,
+                            const Ap_decimal<digits, emax>& y) {
+  if (!x.is_finite() || !y.is_finite()) {
+    return x.is_nan() == y.is_nan() && x.is_inf() == y.is_inf();
+  }
+  return x.exponent() == y.exponent();
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> abs(const Ap_decimal<digits, emax>& x) {
+  return x.signbit() ? -x : x;
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax>& Ap_decimal<digits, emax>::operator+=(
+    const Ap_decimal& rhs) {
+  return *this = add(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax>& Ap_decimal<digits, emax>::operator-=(
+    const Ap_decimal& rhs) {
+  return *this = sub(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax>& Ap_decimal<digits, emax>::operator*=(
+    const Ap_decimal& rhs) {
+  return *this = mul(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax>& Ap_decimal<digits, emax>::operator/=(
+    const Ap_decimal& rhs) {
+  return *this = div(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::operator+(
+    const Ap_decimal& rhs) const {
+  return add(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::operator-(
+    const Ap_decimal& rhs) const {
+  return sub(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::operator*(
+    const Ap_decimal& rhs) const {
+  return mul(*this, rhs);
+}
+
+template <std::size_t digits, std::int64_t emax>
+constexpr Ap_decimal<digits, emax> Ap_decimal<digits, emax>::operator/(
+    const Ap_decimal& rhs) const {
+  return div(*this, rhs);
+}
+
+// ************************** FORMATTING ************************** //
+
+// IEEE 754 to-scientific-string: plain notation for exponents <= 0 with no
+// more than 5 leading zeros after the point, "1.23E+5" style otherwise.
+template <std::size_t digits, std::int64_t emax>
+std::string to_string(const Ap_decimal<digits, emax>& v) {
+  std::string sign = v.signbit() ? "-" : "";
+  if (v.is_nan()) {
+    return "NaN";
+  }
+  if (v.is_inf()) {
+    return sign + "Infinity";
+  }
+
+  std::ostringstream gen;
+  gen << v.coefficient();
+  std::string c = gen.str();
+  auto count = std::int64_t(c.size());
+  std::int64_t q = v.exponent();
+  std::int64_t adjusted = q + count - 1;
+
+  if (q <= 0 && adjusted >= -6) {
+    if (q == 0) {
+      return sign + c;
+    }
+    if (count > -q) {
+      return sign + c.substr(0, std::size_t(count + q)) + "." +
+             c.substr(std::size_t(count + q));
+    }
+    return sign + "0." + std::string(std::size_t(-q - count), '0') + c;
+  }
+
+  std::string result = sign + c.substr(0, 1);
+  if (count > 1) {
+    result += "." + c.substr(1);
+  }
+  result += adjusted < 0 ? "E-" : "E+";
+  return result + std::to_string(adjusted < 0 ? -adjusted : adjusted);
+}
+
+template <std::size_t digits, std::int64_t emax>
+std::ostream& operator<<(std::ostream& stream,
+                         const Ap_decimal<digits, emax>& v) {
+  return stream << to_string(v);
+}
+}  // namespace vecpp
+
+#endif
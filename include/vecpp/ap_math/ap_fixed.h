@@ -0,0 +1,523 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FIXED_INCLUDED_H
+#define VECPP_AP_FIXED_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_int/int_storage.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace vecpp {
+
+// What happens to results outside of the representable range.
+enum class Overflow {
+  // Two's complement wrap around, like Ap_int.
+  wrap,
+  // Clamped to min() or max().
+  saturate,
+};
+
+namespace detail {
+template <std::size_t int_bits, std::size_t frac_bits, Overflow overflow>
+struct Ap_fixed_arith;
+}
+
+// A signed binary fixed point number, stored as a two's complement integer
+// of int_bits + frac_bits bits holding value * 2^frac_bits. int_bits counts
+// the sign bit, so the range is [-2^(int_bits - 1), 2^(int_bits - 1)) in
+// steps of 2^-frac_bits.
+//
+// Products and quotients are computed at double width, then rounded back to
+// frac_bits: nearest even by default, any vecpp::Rounding through mul() and
+// div(). Sums and differences are exact, up to the overflow policy.
+template <std::size_t int_bits, std::size_t frac_bits,
+          Overflow overflow = Overflow::wrap>
+class Ap_fixed {
+  static_assert(int_bits > 0, "int_bits includes the sign bit");
+
+ public:
+  static constexpr std::size_t bits = int_bits + frac_bits;
+  using Storage = detail::Int_storage<bits, std::uint64_t>;
+
+  // 0
+  constexpr Ap_fixed() = default;
+
+  template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  constexpr Ap_fixed(T);
+
+  // Rounded to frac_bits. NaN becomes 0, infinities saturate whatever the
+  // overflow policy.
+  template <typename T,
+            std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+  constexpr explicit Ap_fixed(T, Rounding mode = Rounding::nearest_even);
+  template <std::size_t M, std::size_t E>
+  constexpr explicit Ap_fixed(const Ap_float<M, E>&,
+                              Rounding mode = Rounding::nearest_even);
+
+  // Rescaling from another format: a shift, rounded when frac_bits drops.
+  template <std::size_t I2, std::size_t F2, Overflow O2>
+  constexpr explicit Ap_fixed(const Ap_fixed<I2, F2, O2>&,
+                              Rounding mode = Rounding::nearest_even);
+
+  // Correctly rounded to nearest even.
+  template <typename T,
+            std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+  constexpr explicit operator T() const;
+  template <std::size_t M, std::size_t E>
+  constexpr explicit operator Ap_float<M, E>() const;
+
+  static constexpr Ap_fixed from_raw(const Storage& raw);
+  constexpr const Storage& raw() const { return raw_; }
+
+  static constexpr Ap_fixed min();
+  static constexpr Ap_fixed max();
+  // 2^-frac_bits
+  static constexpr Ap_fixed epsilon();
+
+  constexpr bool is_zero() const { return raw_.used_words() == 0; }
+  constexpr bool is_negative() const { return raw_.get_bit(bits - 1); }
+
+  constexpr bool operator==(const Ap_fixed& rhs) const;
+  constexpr bool operator!=(const Ap_fixed& rhs) const;
+  constexpr bool operator<(const Ap_fixed&) const;
+  constexpr bool operator<=(const Ap_fixed&) const;
+  constexpr bool operator>(const Ap_fixed&) const;
+  constexpr bool operator>=(const Ap_fixed&) const;
+
+  constexpr Ap_fixed operator+() const;
+  constexpr Ap_fixed operator-() const;
+
+  constexpr Ap_fixed& operator+=(const Ap_fixed&);
+  constexpr Ap_fixed& operator-=(const Ap_fixed&);
+  constexpr Ap_fixed& operator*=(const Ap_fixed&);
+  constexpr Ap_fixed& operator/=(const Ap_fixed&);
+
+  constexpr Ap_fixed operator+(const Ap_fixed&) const;
+  constexpr Ap_fixed operator-(const Ap_fixed&) const;
+  constexpr Ap_fixed operator*(const Ap_fixed&)const;
+  constexpr Ap_fixed operator/(const Ap_fixed&) const;
+
+ private:
+  friend struct detail::Ap_fixed_arith<int_bits, frac_bits, overflow>;
+
+  constexpr int compare(const Ap_fixed& rhs) const;
+
+  Storage raw_{0};
+};
+
+namespace detail {
+template <std::size_t int_bits, std::size_t frac_bits, Overflow overflow>
+struct Ap_fixed_arith {
+  using Fixed = Ap_fixed<int_bits, frac_bits, overflow>;
+  static constexpr std::size_t bits = Fixed::bits;
+  using Storage = typename Fixed::Storage;
+  template <std::size_t b>
+  using Wide = Int_storage<b, std::uint64_t>;
+
+  static constexpr Fixed from_raw(const Storage& raw) {
+    Fixed result;
+    result.raw_ = raw;
+    return result;
+  }
+
+  static constexpr Storage negate(Storage v) {
+    v.invert();
+    v.add(Storage{1});
+    v.clear_unused_bits();
+    return v;
+  }
+
+  static constexpr Fixed min() {
+    Storage raw{0};
+    raw.set_bit(bits - 1);
+    return from_raw(raw);
+  }
+
+  static constexpr Fixed max() {
+    Storage raw{0};
+    raw.invert();
+    raw.clear_unused_bits();
+    raw.get_word(bits - 1) &= ~Storage::mask_bit(bits - 1);
+    return from_raw(raw);
+  }
+
+  // |v|, which only needs the full width for min().
+  static constexpr Storage magnitude(const Fixed& v) {
+    return v.is_negative() ? negate(v.raw_) : v.raw_;
+  }
+
+  // Whether a truncated magnitude gets incremented, from the first dropped
+  // bit and whether anything below it is set.
+  static constexpr bool round_up(bool negative, bool odd, bool half,
+                                 bool sticky, Rounding mode) {
+    switch (mode) {
+      case Rounding::nearest_even:
+        return half && (sticky || odd);
+      case Rounding::nearest_away:
+        return half;
+      case Rounding::toward_zero:
+        return false;
+      case Rounding::upward:
+        return (half || sticky) && !negative;
+      case Rounding::downward:
+        return (half || sticky) && negative;
+    }
+    return false;
+  }
+
+  // (-1)^negative * m, where m is a raw magnitude, with the overflow policy
+  // applied. too_large flags magnitudes that did not even fit in m.
+  template <std::size_t b>
+  static constexpr Fixed fit(bool negative, const Wide<b>& m,
+                             bool too_large = false) {
+    constexpr std::size_t w = std::max(b, bits);
+    auto wide = resize<w>(m);
+    if constexpr (overflow == Overflow::saturate) {
+      // The largest magnitude is 2^(bits - 1) for negative values,
+      // 2^(bits - 1) - 1 for positive ones.
+      Wide<w> limit{0};
+      limit.set_bit(bits - 1);
+      int side = wide.compare(limit);
+      if (too_large || side > 0 || (side == 0 && !negative)) {
+        return negative ? min() : max();
+      }
+    }
+    auto raw = resize<bits>(wide);
+    return from_raw(negative ? negate(raw) : raw);
+  }
+
+  // (-1)^negative * m * 2^shift, in raw units, rounded then fitted.
+  template <std::size_t b>
+  static constexpr Fixed from_magnitude(bool negative, Wide<b> m,
+                                        std::int64_t shift, Rounding mode) {
+    if (shift >= 0) {
+      // Shifted out bits only matter for saturation.
+      std::size_t len = b - m.count_leading_zeros();
+      bool too_large = len != 0 && len + std::size_t(shift) > bits;
+      if (std::size_t(shift) >= std::max(b, bits)) {
+        return fit(negative, Wide<b>{0}, too_large);
+      }
+      auto wide = resize<std::max(b, bits)>(m);
+      wide.lshift(std::uint64_t(shift));
+      return fit(negative, wide, too_large);
+    }
+
+    auto drop = std::size_t(-shift);
+    if (drop > b) {
+      bool sticky = m.used_words() != 0;
+      return fit(negative, Wide<b>{
+                               round_up(negative, false, false, sticky, mode)});
+    }
+    bool half = m.get_bit(drop - 1);
+    bool sticky = m.count_trailing_zeros() < drop - 1;
+    if (drop == b) {
+      m = Wide<b>{0};
+    } else {
+      m.rshift(drop);
+    }
+    // m was shifted down, incrementing it cannot carry out. Adding the
+    // increment rather than branching on it: it is a coin toss.
+    m.add(Wide<b>{round_up(negative, (m[0] & 1) != 0, half, sticky, mode)});
+    return fit(negative, m);
+  }
+
+  // v sign extended by one bit.
+  static constexpr Wide<bits + 1> extend(const Fixed& v) {
+    auto result = resize<bits + 1>(v.raw_);
+    if (v.is_negative()) {
+      result.set_bit(bits);
+    }
+    return result;
+  }
+
+  static constexpr Fixed add(const Fixed& a, const Fixed& b, bool subtract) {
+    if constexpr (overflow == Overflow::wrap) {
+      auto raw = a.raw_;
+      raw.add(subtract ? negate(b.raw_) : b.raw_);
+      raw.clear_unused_bits();
+      return from_raw(raw);
+    } else {
+      // One more bit holds any sum, it fits when its top two bits agree.
+      auto sum = extend(a);
+      auto rhs = extend(b);
+      if (subtract) {
+        rhs.invert();
+        rhs.add(Wide<bits + 1>{1});
+      }
+      sum.add(rhs);
+      sum.clear_unused_bits();
+      bool negative = sum.get_bit(bits);
+      if (negative != sum.get_bit(bits - 1)) {
+        return negative ? min() : max();
+      }
+      return from_raw(resize<bits>(sum));
+    }
+  }
+
+  // The product is computed at double width, with the operands' unused
+  // words skipped, then frac_bits are dropped from it in one shift.
+  static constexpr Fixed mul(const Fixed& a, const Fixed& b, Rounding mode) {
+    bool negative = a.is_negative() != b.is_negative();
+    if constexpr (Storage::words == 1 && frac_bits > 0) {
+      // The double width product is a native one.
+      auto product = Uint128(magnitude(a)[0]) * magnitude(b)[0];
+      bool half = ((product >> (frac_bits - 1)) & 1) != 0;
+      bool sticky =
+          (product & ((Uint128(1) << (frac_bits - 1)) - 1)) != 0;
+      auto q = product >> frac_bits;
+      q += round_up(negative, (q & 1) != 0, half, sticky, mode);
+      return fit(negative, Wide<128>{{std::uint64_t(q),
+                                      std::uint64_t(q >> 64)}});
+    }
+    auto product = resize<2 * bits>(magnitude(a)).mul(
+        resize<2 * bits>(magnitude(b)));
+    return from_magnitude(negative, product, -std::int64_t(frac_bits), mode);
+  }
+
+  static constexpr Fixed div(const Fixed& a, const Fixed& b, Rounding mode) {
+    assert(!b.is_zero() && "Division by zero");
+    bool negative = a.is_negative() != b.is_negative();
+    // |a| * 2^frac_bits, plus one bit so the quotient keeps a rounding bit.
+    constexpr std::size_t w = bits + frac_bits + 1;
+    if constexpr (w <= 128) {
+      auto num = Uint128(magnitude(a)[0]) << (frac_bits + 1);
+      auto den = magnitude(b)[0];
+      auto quot = num / den;
+      bool sticky = num % den != 0;
+      bool half = (quot & 1) != 0;
+      quot >>= 1;
+      quot += round_up(negative, (quot & 1) != 0, half, sticky, mode);
+      return fit(negative, Wide<128>{{std::uint64_t(quot),
+                                      std::uint64_t(quot >> 64)}});
+    }
+    auto num = resize<w>(magnitude(a));
+    num.lshift(frac_bits + 1);
+    auto den = resize<w>(magnitude(b));
+    auto [quot, rem] = num.udivmod(den);
+    // A remainder makes the quotient inexact below its rounding bit.
+    auto q = resize<w + 1>(quot);
+    q.lshift(1);
+    q[0] |= rem.used_words() != 0;
+    return from_magnitude(negative, q, -2, mode);
+  }
+
+  template <std::size_t M, std::size_t E>
+  static constexpr Fixed from_float(const Ap_float<M, E>& v, Rounding mode) {
+    if (v.is_nan()) {
+      return Fixed{};
+    }
+    if (v.is_inf()) {
+      return v.signbit() ? min() : max();
+    }
+    // v = sig * 2^(exponent - M + 1)
+    auto shift = v.exponent() - std::int64_t(M) + 1 + std::int64_t(frac_bits);
+    return from_magnitude(v.signbit(), v.significand(), shift, mode);
+  }
+};
+}  // namespace detail
+
+template <std::size_t I, std::size_t F, Overflow O>
+template <typename T, std::enable_if_t<std::is_integral_v<T>, int>>
+constexpr Ap_fixed<I, F, O>::Ap_fixed(T v) {
+  bool negative = false;
+  auto magnitude = std::uint64_t(v);
+  if constexpr (std::is_signed_v<T>) {
+    negative = v < 0;
+    if (negative) {
+      magnitude = std::uint64_t(0) - magnitude;
+    }
+  }
+  *this = detail::Ap_fixed_arith<I, F, O>::from_magnitude(
+      negative, detail::Int_storage<64, std::uint64_t>{magnitude},
+      std::int64_t(F), Rounding::nearest_even);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int>>
+constexpr Ap_fixed<I, F, O>::Ap_fixed(T v, Rounding mode)
+    : Ap_fixed(typename detail::Native_float<T>::Format(v), mode) {}
+
+template <std::size_t I, std::size_t F, Overflow O>
+template <std::size_t M, std::size_t E>
+constexpr Ap_fixed<I, F, O>::Ap_fixed(const Ap_float<M, E>& v, Rounding mode)
+    : raw_(detail::Ap_fixed_arith<I, F, O>::from_float(v, mode).raw_) {}
+
+template <std::size_t I, std::size_t F, Overflow O>
+template <std::size_t I2, std::size_t F2, Overflow O2>
+constexpr Ap_fixed<I, F, O>::Ap_fixed(const Ap_fixed<I2, F2, O2>& v,
+                                      Rounding mode) {
+  using Arith = detail::Ap_fixed_arith<I, F, O>;
+  using Source = detail::Ap_fixed_arith<I2, F2, O2>;
+  *this = Arith::from_magnitude(v.is_negative(), Source::magnitude(v),
+                                std::int64_t(F) - std::int64_t(F2), mode);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int>>
+constexpr Ap_fixed<I, F, O>::operator T() const {
+  using Format = typename detail::Native_float<T>::Format;
+  return to_native<T>(Format(*this));
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+template <std::size_t M, std::size_t E>
+constexpr Ap_fixed<I, F, O>::operator Ap_float<M, E>() const {
+  using Arith = detail::Ap_fixed_arith<I, F, O>;
+  return detail::Ap_float_arith<M, E>::round(
+      is_negative(), Arith::magnitude(*this), -std::int64_t(F),
+      Rounding::nearest_even);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::from_raw(const Storage& raw) {
+  return detail::Ap_fixed_arith<I, F, O>::from_raw(raw);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::min() {
+  return detail::Ap_fixed_arith<I, F, O>::min();
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::max() {
+  return detail::Ap_fixed_arith<I, F, O>::max();
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::epsilon() {
+  return from_raw(Storage{1});
+}
+
+// ************************** COMPARISONS ************************** //
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr int Ap_fixed<I, F, O>::compare(const Ap_fixed& rhs) const {
+  if (is_negative() != rhs.is_negative()) {
+    return is_negative() ? -1 : 1;
+  }
+  // Same sign: two's complement orders like unsigned.
+  return raw_.compare(rhs.raw_);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr bool Ap_fixed<I, F, O>::operator==(const Ap_fixed& rhs) const {
+  return raw_.compare(rhs.raw_) == 0;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr bool Ap_fixed<I, F, O>::operator!=(const Ap_fixed& rhs) const {
+  return raw_.compare(rhs.raw_) != 0;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr bool Ap_fixed<I, F, O>::operator<(const Ap_fixed& rhs) const {
+  return compare(rhs) < 0;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr bool Ap_fixed<I, F, O>::operator<=(const Ap_fixed& rhs) const {
+  return compare(rhs) <= 0;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr bool Ap_fixed<I, F, O>::operator>(const Ap_fixed& rhs) const {
+  return compare(rhs) > 0;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr bool Ap_fixed<I, F, O>::operator>=(const Ap_fixed& rhs) const {
+  return compare(rhs) >= 0;
+}
+
+// ************************** ARITHMETIC ************************** //
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::operator+() const {
+  return *this;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::operator-() const {
+  return Ap_fixed{} - *this;
+}
+
+// Rounded with the given mode.
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> mul(const Ap_fixed<I, F, O>& a,
+                                const Ap_fixed<I, F, O>& b,
+                                Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_fixed_arith<I, F, O>::mul(a, b, mode);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> div(const Ap_fixed<I, F, O>& a,
+                                const Ap_fixed<I, F, O>& b,
+                                Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_fixed_arith<I, F, O>::div(a, b, mode);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> abs(const Ap_fixed<I, F, O>& x) {
+  return x.is_negative() ? -x : x;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O>& Ap_fixed<I, F, O>::operator+=(
+    const Ap_fixed& rhs) {
+  return *this = *this + rhs;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O>& Ap_fixed<I, F, O>::operator-=(
+    const Ap_fixed& rhs) {
+  return *this = *this - rhs;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O>& Ap_fixed<I, F, O>::operator*=(
+    const Ap_fixed& rhs) {
+  return *this = *this * rhs;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O>& Ap_fixed<I, F, O>::operator/=(
+    const Ap_fixed& rhs) {
+  return *this = *this / rhs;
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::operator+(
+    const Ap_fixed& rhs) const {
+  return detail::Ap_fixed_arith<I, F, O>::add(*this, rhs, false);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::operator-(
+    const Ap_fixed& rhs) const {
+  return detail::Ap_fixed_arith<I, F, O>::add(*this, rhs, true);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::operator*(
+    const Ap_fixed& rhs) const {
+  return mul(*this, rhs);
+}
+
+template <std::size_t I, std::size_t F, Overflow O>
+constexpr Ap_fixed<I, F, O> Ap_fixed<I, F, O>::operator/(
+    const Ap_fixed& rhs) const {
+  return div(*this, rhs);
+}
+}  // namespace vecpp
+
+#endif
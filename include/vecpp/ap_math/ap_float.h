@@ -9,25 +9,104 @@
 #define VECPP_AP_FLOAT_INCLUDED_H
 
 #include "vecpp/ap_math/ap_int.h"
+#include "vecpp/ap_math/ap_int/roots.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <numeric>
+#include <tuple>
+#include <type_traits>
 
 namespace vecpp {
 
+enum class Rounding {
+  nearest_even,
+  nearest_away,
+  toward_zero,
+  upward,
+  downward,
+};
+
+namespace detail {
+template <std::size_t mantissa_bits, std::size_t exponent_bits>
+struct Ap_float_arith;
+}
+
 // APFloats are always binary
 // APFloats are always signed
-// Ap_float<11, 5 is a IEEE754 half
+// Ap_float<11, 5> is a IEEE754 half
 // Ap_float<24, 8> is a IEEE754 float
 // Ap_float<53, 11> is a IEEE754 double
+//
+// mantissa_bits is the precision, leading bit included. Like IEEE754, there
+// are signed zeros, subnormals, infinities and NaN. Every operation is
+// correctly rounded.
+//
+// Values are stored in the IEEE754 interchange encoding, so an Ap_float<M, E>
+// takes M + E bits rounded up to a whole number of words.
 template <std::size_t mantissa_bits, std::size_t exponent_bits>
 class Ap_float {
   static_assert(mantissa_bits > 1);
   static_assert(exponent_bits > 1);
+  static_assert(exponent_bits <= 61, "exponents are handled as std::int64_t");
 
  public:
+  using Significand = detail::Int_storage<mantissa_bits, std::uint64_t>;
+  // sign | biased exponent | significand without its leading bit
+  using Storage =
+      detail::Int_storage<mantissa_bits + exponent_bits, std::uint64_t>;
+
+  static constexpr std::int64_t max_exponent =
+      (std::int64_t(1) << (exponent_bits - 1)) - 1;
+  static constexpr std::int64_t min_exponent = 1 - max_exponent;
+
   constexpr Ap_float() = default;
   constexpr Ap_float(const Ap_float&) = default;
-  constexpr Ap_float(double);
+
+  // Exact when the native format fits, rounded to nearest even otherwise.
+  template <typename T,
+            std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+  constexpr Ap_float(T);
+
+  template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  constexpr Ap_float(T);
+
+  template <std::size_t M2, std::size_t E2>
+  constexpr explicit Ap_float(const Ap_float<M2, E2>&,
+                              Rounding mode = Rounding::nearest_even);
+
+  constexpr Ap_float& operator=(const Ap_float&) = default;
+
+  // Correctly rounded to nearest even, see to_native() for other modes.
+  template <typename T,
+            std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+  constexpr explicit operator T() const;
+
+  static constexpr Ap_float infinity(bool negative = false);
+  static constexpr Ap_float quiet_nan();
+  // Largest finite value.
+  static constexpr Ap_float max();
+
+  static constexpr Ap_float from_encoding(const Storage& bits);
+  constexpr const Storage& encoding() const { return bits_; }
+
+  constexpr bool is_nan() const;
+  constexpr bool is_inf() const;
+  constexpr bool is_finite() const;
+  constexpr bool is_zero() const;
+  constexpr bool signbit() const { return bits_.get_bit(sign_bit); }
+
+  // Exponent of the leading significand bit, min_exponent for subnormals.
+  // Both are only meaningful for finite values.
+  constexpr std::int64_t exponent() const;
+  constexpr Significand significand() const;
 
   constexpr bool operator==(const Ap_float& rhs) const;
   constexpr bool operator!=(const Ap_float& rhs) const;
@@ -39,63 +118,826 @@ class Ap_float {
   constexpr Ap_float operator+() const;
   constexpr Ap_float operator-() const;
 
+  constexpr Ap_float& operator+=(const Ap_float&);
+  constexpr Ap_float& operator-=(const Ap_float&);
+  constexpr Ap_float& operator*=(const Ap_float&);
+  constexpr Ap_float& operator/=(const Ap_float&);
+
+  constexpr Ap_float operator+(const Ap_float&) const;
+  constexpr Ap_float operator-(const Ap_float&) const;
+  constexpr Ap_float operator*(const Ap_float&) const;
+  constexpr Ap_float operator/(const Ap_float&) const;
+
  private:
+  friend struct detail::Ap_float_arith<mantissa_bits, exponent_bits>;
+
+  static constexpr std::size_t trailing_bits = mantissa_bits - 1;
+  static constexpr std::size_t sign_bit = mantissa_bits + exponent_bits - 1;
+  static constexpr std::uint64_t max_biased =
+      (std::uint64_t(1) << exponent_bits) - 1;
+
+  constexpr std::uint64_t biased_exponent() const {
+    return bits_.get_bits(trailing_bits, exponent_bits);
+  }
+  constexpr bool has_trailing_bits() const {
+    return bits_.count_trailing_zeros() < trailing_bits;
+  }
+
   constexpr int compare(const Ap_float& rhs) const;
-  constexpr bool is_negative() const { return m_.is_negative(); }
 
-  enum class State {
-    normal,
-    nan,
-    pos_inf,
-    neg_inf,
+  Storage bits_{};
+};
+
+namespace detail {
+// The arithmetic core. Significands are handled as Int_storage, wide enough
+// for each operation to be exact before the final rounding.
+template <std::size_t M, std::size_t E>
+struct Ap_float_arith {
+  using Float = Ap_float<M, E>;
+  using Significand = typename Float::Significand;
+  template <std::size_t bits>
+  using Wide = Int_storage<bits, std::uint64_t>;
+
+  static constexpr std::int64_t emin = Float::min_exponent;
+  static constexpr std::int64_t emax = Float::max_exponent;
+
+  // A finite non-zero value, with the leading bit of sig at M - 1, and
+  // exponent possibly below emin.
+  struct Unpacked {
+    bool negative;
+    std::int64_t exponent;
+    Significand sig;
+
+    // sig * 2^scale() is the magnitude.
+    constexpr std::int64_t scale() const {
+      return exponent - std::int64_t(M) + 1;
+    }
   };
 
-  // The sign of the mantissa is the sign of the value.
-  Ap_int<mantissa_bits> m_;
-  Ap_int<exponent_bits> e_;
-  State s_ = State::normal;
+  static constexpr Unpacked unpack(const Float& v) {
+    Unpacked result{v.signbit(), v.exponent(), v.significand()};
+    auto lz = result.sig.count_leading_zeros();
+    result.sig.lshift(lz);
+    result.exponent -= std::int64_t(lz);
+    return result;
+  }
+
+  // Only the low M - 1 bits of sig are used.
+  static constexpr Float make(bool negative, std::uint64_t biased,
+                              const Significand& sig) {
+    Float result;
+    // The exponent field overwrites the leading bit.
+    result.bits_ = resize<M + E>(sig);
+    result.bits_.set_bits(Float::trailing_bits, E, biased);
+    if (negative) {
+      result.bits_.set_bit(Float::sign_bit);
+    }
+    return result;
+  }
+
+  // sig * 2^(e - M + 1), with e >= emin, and e == emin for subnormals.
+  static constexpr Float finite(bool negative, std::int64_t e,
+                                const Significand& sig) {
+    bool normal = sig.get_bit(M - 1);
+    return make(negative, normal ? std::uint64_t(e - emin + 1) : 0, sig);
+  }
+
+  static constexpr Float zero(bool negative) {
+    return make(negative, 0, Significand{0});
+  }
+
+  // Sign of x + y when it is exactly zero.
+  static constexpr Float zero_sum(bool x_neg, bool y_neg, Rounding mode) {
+    return zero(x_neg == y_neg ? x_neg : mode == Rounding::downward);
+  }
+
+  static constexpr Float nan() {
+    Significand quiet{0};
+    quiet.set_bit(M - 2);
+    return make(false, Float::max_biased, quiet);
+  }
+
+  static constexpr Float infinity(bool negative) {
+    return make(negative, Float::max_biased, Significand{0});
+  }
+
+  static constexpr Float max_finite(bool negative) {
+    Significand ones{0};
+    ones.invert();
+    return make(negative, Float::max_biased - 1, ones);
+  }
+
+  static constexpr bool round_up(Rounding mode, bool negative, bool lsb,
+                                 bool round, bool sticky) {
+    switch (mode) {
+      case Rounding::nearest_even:
+        return round && (sticky || lsb);
+      case Rounding::nearest_away:
+        return round;
+      case Rounding::toward_zero:
+        return false;
+      case Rounding::upward:
+        return !negative && (round || sticky);
+      case Rounding::downward:
+        return negative && (round || sticky);
+    }
+    return false;
+  }
+
+  static constexpr Float overflow(bool negative, Rounding mode) {
+    bool to_inf = mode == Rounding::nearest_even ||
+                  mode == Rounding::nearest_away ||
+                  (mode == Rounding::upward && !negative) ||
+                  (mode == Rounding::downward && negative);
+    return to_inf ? infinity(negative) : max_finite(negative);
+  }
+
+  // v >>= n, with any bit shifted out or'ed into the lowest bit, so that
+  // later roundings still see that the value is inexact.
+  template <std::size_t bits>
+  static constexpr void shift_right_jam(Wide<bits>& v, std::uint64_t n) {
+    bool sticky = v.count_trailing_zeros() < std::min<std::uint64_t>(n, bits);
+    if (n >= bits) {
+      v = Wide<bits>{0};
+    } else {
+      v.rshift(n);
+    }
+    if (sticky) {
+      v[0] |= 1;
+    }
+  }
+
+  // (-1)^negative * sig * 2^scale, rounded to the format.
+  template <std::size_t bits>
+  static constexpr Float round(bool negative, Wide<bits> sig,
+                               std::int64_t scale, Rounding mode) {
+    std::size_t len = bits - sig.count_leading_zeros();
+    if (len == 0) {
+      return zero(negative);
+    }
+
+    Significand m{0};
+    std::int64_t e = scale + std::int64_t(len) - 1;
+    std::int64_t keep = M;
+    if (e < emin) {
+      // Subnormal, the significand loses the bits below 2^emin's ulp.
+      keep -= emin - e;
+      e = emin;
+    }
+
+    std::int64_t shift = std::int64_t(len) - keep;
+    if (shift <= 0) {
+      m = resize<M>(sig);
+      m.lshift(std::uint64_t(-shift));
+    } else {
+      bool round_bit = false;
+      bool sticky = true;
+      if (keep >= 0) {
+        round_bit = sig.get_bit(std::size_t(shift - 1));
+        sticky = sig.count_trailing_zeros() < std::size_t(shift - 1);
+        sig.rshift(std::uint64_t(shift));
+        m = resize<M>(sig);
+      }
+
+      if (round_up(mode, negative, m[0] & 1, round_bit, sticky)) {
+        m.add(Significand{1});
+        // 2^M wrapped around to 0.
+        if (m.used_words() == 0) {
+          m.set_bit(M - 1);
+          ++e;
+        }
+      }
+    }
+
+    if (e > emax) {
+      return overflow(negative, mode);
+    }
+    return finite(negative, e, m);
+  }
+
+  // x + y, both non-zero. bits must leave at least 65 bits below the
+  // longest operand, plus a carry bit.
+  template <std::size_t bits>
+  static constexpr Float add_finite(bool x_neg, Wide<bits> x,
+                                    std::int64_t x_scale, bool y_neg,
+                                    Wide<bits> y, std::int64_t y_scale,
+                                    Rounding mode) {
+    auto x_len = std::int64_t(bits - x.count_leading_zeros());
+    auto y_len = std::int64_t(bits - y.count_leading_zeros());
+    if (y_scale + y_len > x_scale + x_len) {
+      return add_finite(y_neg, y, y_scale, x_neg, x, x_scale, mode);
+    }
+
+    // The larger operand's leading bit goes right below the carry bit, the
+    // smaller one is aligned on it, so that only bits far below the
+    // rounding point can be lost.
+    auto up = std::int64_t(bits) - 1 - x_len;
+    assert(up >= 65);
+    x.lshift(std::uint64_t(up));
+    std::int64_t scale = x_scale - up;
+
+    std::int64_t d = y_scale - scale;
+    if (d >= 0) {
+      y.lshift(std::uint64_t(d));
+    } else {
+      shift_right_jam(y, std::uint64_t(-d));
+    }
+
+    if (x_neg == y_neg) {
+      x.add(y);
+    } else {
+      int cmp = x.compare(y);
+      if (cmp == 0) {
+        return zero_sum(x_neg, y_neg, mode);
+      }
+      if (cmp < 0) {
+        y.subtract(x);
+        x = y;
+        x_neg = y_neg;
+      } else {
+        x.subtract(y);
+      }
+    }
+    return round(x_neg, x, scale, mode);
+  }
+
+  static constexpr Float add(const Float& a, const Float& b, Rounding mode) {
+    if (a.is_nan() || b.is_nan()) {
+      return nan();
+    }
+    if (a.is_inf()) {
+      return b.is_inf() && a.signbit() != b.signbit() ? nan() : a;
+    }
+    if (b.is_inf()) {
+      return b;
+    }
+    if (a.is_zero()) {
+      return b.is_zero() ? zero_sum(a.signbit(), b.signbit(), mode) : b;
+    }
+    if (b.is_zero()) {
+      return a;
+    }
+
+    constexpr std::size_t bits = M + 66;
+    auto ua = unpack(a);
+    auto ub = unpack(b);
+    return add_finite(ua.negative, resize<bits>(ua.sig), ua.scale(),
+                      ub.negative, resize<bits>(ub.sig), ub.scale(), mode);
+  }
+
+  // Exact product of two significands.
+  static constexpr Wide<2 * M> product(const Unpacked& a, const Unpacked& b) {
+    return resize<2 * M>(a.sig).mul(resize<2 * M>(b.sig));
+  }
+
+  static constexpr Float mul(const Float& a, const Float& b, Rounding mode) {
+    bool negative = a.signbit() != b.signbit();
+    if (a.is_nan() || b.is_nan()) {
+      return nan();
+    }
+    if (a.is_inf() || b.is_inf()) {
+      return a.is_zero() || b.is_zero() ? nan() : infinity(negative);
+    }
+    if (a.is_zero() || b.is_zero()) {
+      return zero(negative);
+    }
+
+    auto ua = unpack(a);
+    auto ub = unpack(b);
+    return round(negative, product(ua, ub), ua.scale() + ub.scale(), mode);
+  }
+
+  static constexpr Float div(const Float& a, const Float& b, Rounding mode) {
+    bool negative = a.signbit() != b.signbit();
+    if (a.is_nan() || b.is_nan()) {
+      return nan();
+    }
+    if (a.is_inf()) {
+      return b.is_inf() ? nan() : infinity(negative);
+    }
+    if (b.is_inf()) {
+      return zero(negative);
+    }
+    if (b.is_zero()) {
+      return a.is_zero() ? nan() : infinity(negative);
+    }
+    if (a.is_zero()) {
+      return zero(negative);
+    }
+
+    // With both significands normalized, the quotient has M + 3 or M + 4
+    // bits, so the remainder can be folded in its lowest bit.
+    constexpr std::size_t extra = M + 3;
+    auto ua = unpack(a);
+    auto ub = unpack(b);
+    auto num = resize<2 * M + 4>(ua.sig);
+    num.lshift(extra);
+    auto qr = num.udivmod(resize<2 * M + 4>(ub.sig));
+    auto q = std::get<0>(qr);
+    if (std::get<1>(qr).used_words() != 0) {
+      q[0] |= 1;
+    }
+    return round(negative, q,
+                 ua.exponent - ub.exponent - std::int64_t(extra), mode);
+  }
+
+  // v / d for a non-zero word d, with a single word division per
+  // significand word instead of a full long division.
+  static constexpr Float div_word(const Float& v, std::uint64_t d,
+                                  Rounding mode) {
+    assert(d != 0);
+    if (!v.is_finite() || v.is_zero()) {
+      return v;
+    }
+
+    // The quotient keeps at least M + 2 bits, so the remainder can be folded
+    // in its lowest bit, below the rounding bit.
+    constexpr std::size_t extra = 66;
+    auto u = unpack(v);
+    auto num = resize<M + extra>(u.sig);
+    num.lshift(extra);
+    if (num.divmod_word(d) != 0) {
+      num[0] |= 1;
+    }
+    return round(u.negative, num, u.scale() - std::int64_t(extra), mode);
+  }
+
+  static constexpr Float fma(const Float& a, const Float& b, const Float& c,
+                             Rounding mode) {
+    bool negative = a.signbit() != b.signbit();
+    if (a.is_nan() || b.is_nan() || c.is_nan()) {
+      return nan();
+    }
+    if (a.is_inf() || b.is_inf()) {
+      if (a.is_zero() || b.is_zero() || (c.is_inf() && c.signbit() != negative)) {
+        return nan();
+      }
+      return infinity(negative);
+    }
+    if (c.is_inf()) {
+      return c;
+    }
+    if (a.is_zero() || b.is_zero()) {
+      return c.is_zero() ? zero_sum(negative, c.signbit(), mode) : c;
+    }
+
+    auto ua = unpack(a);
+    auto ub = unpack(b);
+    auto p = product(ua, ub);
+    auto p_scale = ua.scale() + ub.scale();
+    if (c.is_zero()) {
+      return round(negative, p, p_scale, mode);
+    }
+
+    // The product is exact, so a single rounding happens after the sum.
+    constexpr std::size_t bits = 2 * M + 66;
+    auto uc = unpack(c);
+    return add_finite(negative, resize<bits>(p), p_scale, uc.negative,
+                      resize<bits>(uc.sig), uc.scale(), mode);
+  }
+
+  // v, rounded to this format.
+  template <std::size_t M2, std::size_t E2>
+  static constexpr Float convert(const Ap_float<M2, E2>& v, Rounding mode) {
+    if (v.is_nan()) {
+      return nan();
+    }
+    if (v.is_inf()) {
+      return infinity(v.signbit());
+    }
+    return round(v.signbit(), v.significand(),
+                 v.exponent() - std::int64_t(M2) + 1, mode);
+  }
+
+  // v * 2^n, only rounded when the result is subnormal.
+  static constexpr Float ldexp(const Float& v, std::int64_t n, Rounding mode) {
+    if (!v.is_finite() || v.is_zero()) {
+      return v;
+    }
+    // Any scaling past this limit overflows or underflows all the same.
+    constexpr std::int64_t limit = 2 * (emax + std::int64_t(M) + 2);
+    auto u = unpack(v);
+    return round(u.negative, u.sig, u.scale() + std::clamp(n, -limit, limit),
+                 mode);
+  }
+
+  // v, rounded to an integral value.
+  static constexpr Float nearbyint(const Float& v, Rounding mode) {
+    if (!v.is_finite() || v.is_zero() || v.exponent() >= std::int64_t(M) - 1) {
+      return v;
+    }
+
+    // One extra bit, so that rounding 2^M - 1 up cannot wrap around.
+    auto u = unpack(v);
+    auto shift = std::uint64_t(-u.scale());
+    Wide<M + 1> i{0};
+    bool round_bit = false;
+    bool sticky = true;
+    if (shift <= M) {
+      i = resize<M + 1>(u.sig);
+      round_bit = i.get_bit(shift - 1);
+      sticky = i.count_trailing_zeros() < shift - 1;
+      i.rshift(shift);
+    }
+    if (round_up(mode, u.negative, i[0] & 1, round_bit, sticky)) {
+      i.add(Wide<M + 1>{1});
+    }
+    return round(u.negative, i, 0, mode);
+  }
+
+  // IEEE754 interchange encoding: sign | biased exponent | significand. The
+  // leading significand bit is only stored if explicit_leading_bit is set,
+  // as in x87's extended precision.
+  template <bool explicit_leading_bit>
+  using Encoded = Int_storage<M + E + explicit_leading_bit, std::uint64_t>;
+
+  template <bool explicit_leading_bit>
+  static constexpr Encoded<explicit_leading_bit> encode(const Float& v) {
+    if constexpr (!explicit_leading_bit) {
+      return v.bits_;
+    } else {
+      // The fields above the significand move up by one bit, to make room
+      // for the leading bit, which is set for normals, infinities and NaNs.
+      auto result = resize<M + E + 1>(v.bits_);
+      result.set_bits(M, E + 1, v.bits_.get_bits(M - 1, E + 1));
+      result.set_bits(M - 1, 1, v.biased_exponent() != 0);
+      return result;
+    }
+  }
+
+  template <bool explicit_leading_bit>
+  static constexpr Float decode(const Encoded<explicit_leading_bit>& v) {
+    if constexpr (!explicit_leading_bit) {
+      Float result;
+      result.bits_ = v;
+      return result;
+    } else {
+      bool negative = v.get_bit(M + E);
+      std::uint64_t biased = v.get_bits(M, E);
+      auto sig = resize<M>(v);
+      if (biased == Float::max_biased) {
+        sig[(M - 1) / 64] &= ~(std::uint64_t(1) << ((M - 1) % 64));
+        return sig.used_words() == 0 ? infinity(negative) : nan();
+      }
+      // x87 pseudo-denormals have the leading bit set with a zero exponent,
+      // they have the same value as the smallest normal exponent.
+      if (biased == 0 && sig.get_bit(M - 1)) {
+        biased = 1;
+      }
+      return make(negative, biased, sig);
+    }
+  }
 };
+}  // namespace detail
 
-template <std::size_t M, std::size_t E>
-constexpr Ap_float<M, E>::Ap_float(double v) : m_(0), e_(0), s_(State::normal) {
-  if (std::isnan(v)) {
-    s_ = State::nan;
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define VECPP_AP_FLOAT_HAS_BIT_CAST
+#endif
+#endif
+
+namespace detail {
+// constexpr wherever the compiler provides the builtin.
+template <typename To, typename From>
+constexpr To bit_cast(const From& v) {
+  static_assert(sizeof(To) == sizeof(From));
+#ifdef VECPP_AP_FLOAT_HAS_BIT_CAST
+  return __builtin_bit_cast(To, v);
+#else
+  To result{};
+  std::memcpy(&result, &v, sizeof(To));
+  return result;
+#endif
+}
+
+// The native floating point types, as IEEE754 interchange formats.
+template <typename T>
+struct Native_float {
+  static_assert(std::numeric_limits<T>::is_iec559);
+  using Limits = std::numeric_limits<T>;
+
+  static constexpr std::size_t mantissa_bits = Limits::digits;
+  // max_exponent is one past the largest exponent: 2^(exponent_bits - 1)
+  static constexpr std::size_t exponent_bits =
+      sizeof(unsigned long long) * CHAR_BIT -
+      word_leading_zeros((unsigned long long)(Limits::max_exponent));
+  // x87's extended precision keeps its leading bit.
+  static constexpr bool explicit_leading_bit = mantissa_bits == 64;
+  static constexpr std::size_t bits =
+      mantissa_bits + exponent_bits + explicit_leading_bit;
+
+  using Format = Ap_float<mantissa_bits, exponent_bits>;
+  using Arith = Ap_float_arith<mantissa_bits, exponent_bits>;
+  using Bits = Int_storage<bits, std::uint64_t>;
+
+  static constexpr Bits to_bits(T v) {
+    if constexpr (sizeof(T) == sizeof(std::uint32_t)) {
+      return Bits{bit_cast<std::uint32_t>(v)};
+    } else if constexpr (sizeof(T) == sizeof(std::uint64_t)) {
+      return Bits{bit_cast<std::uint64_t>(v)};
+    } else {
+      // Wider formats come with padding, only the value bytes are read.
+      // Those exist on little-endian targets only.
+      auto bytes = bit_cast<std::array<unsigned char, sizeof(T)>>(v);
+      Bits result{0};
+      for (std::size_t i = 0; i < bits / CHAR_BIT; ++i) {
+        result[i / 8] |= std::uint64_t(bytes[i]) << (8 * (i % 8));
+      }
+      return result;
+    }
   }
+
+  static constexpr T from_bits(const Bits& v) {
+    if constexpr (sizeof(T) == sizeof(std::uint32_t)) {
+      return bit_cast<T>(std::uint32_t(v[0]));
+    } else if constexpr (sizeof(T) == sizeof(std::uint64_t)) {
+      return bit_cast<T>(std::uint64_t(v[0]));
+    } else {
+      std::array<unsigned char, sizeof(T)> bytes{};
+      for (std::size_t i = 0; i < bits / CHAR_BIT; ++i) {
+        bytes[i] = (unsigned char)(v[i / 8] >> (8 * (i % 8)));
+      }
+      return bit_cast<T>(bytes);
+    }
+  }
+
+  static constexpr Format decode(T v) {
+    return Arith::template decode<explicit_leading_bit>(to_bits(v));
+  }
+
+  static constexpr T encode(const Format& v) {
+    return from_bits(Arith::template encode<explicit_leading_bit>(v));
+  }
+};
+}  // namespace detail
+
+template <std::size_t M, std::size_t E>
+template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int>>
+constexpr Ap_float<M, E>::Ap_float(T v) {
+  *this = detail::Ap_float_arith<M, E>::convert(
+      detail::Native_float<T>::decode(v), Rounding::nearest_even);
 }
 
 template <std::size_t M, std::size_t E>
-constexpr int Ap_float<M, E>::compare(const Ap_float& rhs) const {
-  switch (s_) {
-    case State::pos_inf:
-      return rhs.s_ == State::pos_inf ? 0 : 1;
-    case State::neg_inf:
-      return rhs.s_ == State::neg_inf ? 0 : -1;
-    default:
-      break;
+template <std::size_t M2, std::size_t E2>
+constexpr Ap_float<M, E>::Ap_float(const Ap_float<M2, E2>& v, Rounding mode) {
+  *this = detail::Ap_float_arith<M, E>::convert(v, mode);
+}
+
+// v, correctly rounded to the native type T.
+template <typename T, std::size_t M, std::size_t E>
+constexpr T to_native(const Ap_float<M, E>& v,
+                      Rounding mode = Rounding::nearest_even) {
+  using Native = detail::Native_float<T>;
+  return Native::encode(Native::Arith::convert(v, mode));
+}
+
+template <std::size_t M, std::size_t E>
+template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int>>
+constexpr Ap_float<M, E>::operator T() const {
+  return to_native<T>(*this);
+}
+
+// Correctly rounded to nearest even. Only the top two non-zero words are
+// looked at, unless the rest can decide a tie.
+template <std::size_t bits>
+constexpr double to_double(const Large_ap_uint<bits>& v) {
+  using Native = detail::Native_float<double>;
+  using Window = detail::Int_storage<128, std::uint64_t>;
+
+  const auto& w = v.data_;
+  std::size_t n = w.used_words();
+  if (n <= 2) {
+    return Native::encode(Native::Arith::round(false, Window{w[0], w[1]}, 0,
+                                               Rounding::nearest_even));
   }
 
-  auto l_neg = is_negative();
-  auto r_neg = rhs.is_negative();
+  // The top 128 bits, starting at the leading one.
+  std::size_t lz = detail::word_leading_zeros(w[n - 1]);
+  auto shifted = [lz](std::uint64_t hi, std::uint64_t lo) {
+    return lz == 0 ? hi : (hi << lz) | (lo >> (64 - lz));
+  };
+  Window window{shifted(w[n - 2], w[n - 3]), shifted(w[n - 1], w[n - 2])};
+
+  // Anything below bit 74 of the window only matters if the window itself
+  // ends with 74 zeros.
+  constexpr std::uint64_t below_round_hi = (std::uint64_t(1) << 10) - 1;
+  if (window[0] == 0 && (window[1] & below_round_hi) == 0) {
+    bool sticky = (w[n - 3] << lz) != 0;
+    for (std::size_t i = 0; i < n - 3 && !sticky; ++i) {
+      sticky = w[i] != 0;
+    }
+    window[0] |= sticky;
+  }
+
+  auto scale = std::int64_t((n - 2) * 64 - lz);
+  return Native::encode(
+      Native::Arith::round(false, window, scale, Rounding::nearest_even));
+}
 
-  if (l_neg != r_neg) {
-    return l_neg ? -1 : 1;
+template <std::size_t bits>
+constexpr double to_double(const Large_ap_int<bits>& v) {
+  if (v >= 0) {
+    return to_double(detail::to_unsigned(v));
   }
+  return -to_double(detail::to_unsigned(-v));
+}
 
-  auto e_cmp = e_.compare(rhs.e_);
-  if (e_cmp < 0) {
-    return l_neg ? 1 : -1;
+template <std::size_t M, std::size_t E>
+template <typename T, std::enable_if_t<std::is_integral_v<T>, int>>
+constexpr Ap_float<M, E>::Ap_float(T v) {
+  bool negative = false;
+  auto magnitude = std::uint64_t(v);
+  if constexpr (std::is_signed_v<T>) {
+    negative = v < 0;
+    magnitude = negative ? 0 - magnitude : magnitude;
   }
+  *this = detail::Ap_float_arith<M, E>::round(
+      negative, detail::Int_storage<64, std::uint64_t>{magnitude}, 0,
+      Rounding::nearest_even);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::infinity(bool negative) {
+  return detail::Ap_float_arith<M, E>::infinity(negative);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::quiet_nan() {
+  return detail::Ap_float_arith<M, E>::nan();
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::max() {
+  return detail::Ap_float_arith<M, E>::max_finite(false);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::from_encoding(const Storage& bits) {
+  Ap_float result;
+  result.bits_ = bits;
+  return result;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr bool Ap_float<M, E>::is_nan() const {
+  return biased_exponent() == max_biased && has_trailing_bits();
+}
+
+template <std::size_t M, std::size_t E>
+constexpr bool Ap_float<M, E>::is_inf() const {
+  return biased_exponent() == max_biased && !has_trailing_bits();
+}
+
+template <std::size_t M, std::size_t E>
+constexpr bool Ap_float<M, E>::is_finite() const {
+  return biased_exponent() != max_biased;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr bool Ap_float<M, E>::is_zero() const {
+  return bits_.count_trailing_zeros() >= sign_bit;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr std::int64_t Ap_float<M, E>::exponent() const {
+  auto biased = biased_exponent();
+  return biased == 0 ? min_exponent
+                     : std::int64_t(biased) + min_exponent - 1;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr typename Ap_float<M, E>::Significand Ap_float<M, E>::significand()
+    const {
+  // Bit M - 1 is the lowest exponent bit, it becomes the leading bit.
+  auto result = detail::resize<M>(bits_);
+  result.set_bits(M - 1, 1, biased_exponent() != 0);
+  return result;
+}
+
+// ************************** ARITHMETIC ************************** //
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> add(const Ap_float<M, E>& a, const Ap_float<M, E>& b,
+                             Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::add(a, b, mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> sub(const Ap_float<M, E>& a, const Ap_float<M, E>& b,
+                             Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::add(a, -b, mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> mul(const Ap_float<M, E>& a, const Ap_float<M, E>& b,
+                             Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::mul(a, b, mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> div(const Ap_float<M, E>& a, const Ap_float<M, E>& b,
+                             Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::div(a, b, mode);
+}
+
+// a * b + c, with a single rounding.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> fma(const Ap_float<M, E>& a, const Ap_float<M, E>& b,
+                             const Ap_float<M, E>& c,
+                             Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::fma(a, b, c, mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> abs(const Ap_float<M, E>& v) {
+  return v.signbit() ? -v : v;
+}
+
+// v * 2^n, exact unless the result is subnormal or overflows.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> ldexp(const Ap_float<M, E>& v, std::int64_t n,
+                               Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::ldexp(v, n, mode);
+}
+
+// v rounded to an integral value, in the given direction.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> nearbyint(const Ap_float<M, E>& v,
+                                   Rounding mode = Rounding::nearest_even) {
+  return detail::Ap_float_arith<M, E>::nearbyint(v, mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E>& Ap_float<M, E>::operator+=(const Ap_float& rhs) {
+  *this = add(*this, rhs);
+  return *this;
+}
 
-  if (e_cmp > 0) {
-    return l_neg ? -1 : 1;
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E>& Ap_float<M, E>::operator-=(const Ap_float& rhs) {
+  *this = sub(*this, rhs);
+  return *this;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E>& Ap_float<M, E>::operator*=(const Ap_float& rhs) {
+  *this = mul(*this, rhs);
+  return *this;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E>& Ap_float<M, E>::operator/=(const Ap_float& rhs) {
+  *this = div(*this, rhs);
+  return *this;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::operator+(const Ap_float& rhs) const {
+  return add(*this, rhs);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::operator-(const Ap_float& rhs) const {
+  return sub(*this, rhs);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::operator*(const Ap_float& rhs) const {
+  return mul(*this, rhs);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Ap_float<M, E>::operator/(const Ap_float& rhs) const {
+  return div(*this, rhs);
+}
+
+// ************************** COMPARISON ************************** //
+
+// Neither side may be NaN. Both zeros compare equal.
+template <std::size_t M, std::size_t E>
+constexpr int Ap_float<M, E>::compare(const Ap_float& rhs) const {
+  bool neg = signbit();
+  bool rhs_neg = rhs.signbit();
+  if (is_zero()) {
+    return rhs.is_zero() ? 0 : (rhs_neg ? 1 : -1);
+  }
+  if (rhs.is_zero()) {
+    return neg ? -1 : 1;
+  }
+  if (neg != rhs_neg) {
+    return neg ? -1 : 1;
   }
 
-  return m_.compare(rhs.m_);
+  // Without the sign, the encodings are ordered like the magnitudes.
+  int magnitude = detail::resize<M + E - 1>(bits_).compare(
+      detail::resize<M + E - 1>(rhs.bits_));
+  return neg ? -magnitude : magnitude;
 }
 
 template <std::size_t M, std::size_t E>
 constexpr bool Ap_float<M, E>::operator<(const Ap_float& rhs) const {
-  if (s_ == State::nan || rhs.s_ == State::nan) {
+  if (is_nan() || rhs.is_nan()) {
     return false;
   }
   return compare(rhs) < 0;
@@ -103,7 +945,7 @@ constexpr bool Ap_float<M, E>::operator<(const Ap_float& rhs) const {
 
 template <std::size_t M, std::size_t E>
 constexpr bool Ap_float<M, E>::operator<=(const Ap_float& rhs) const {
-  if (s_ == State::nan || rhs.s_ == State::nan) {
+  if (is_nan() || rhs.is_nan()) {
     return false;
   }
   return compare(rhs) <= 0;
@@ -111,7 +953,7 @@ constexpr bool Ap_float<M, E>::operator<=(const Ap_float& rhs) const {
 
 template <std::size_t M, std::size_t E>
 constexpr bool Ap_float<M, E>::operator>(const Ap_float& rhs) const {
-  if (s_ == State::nan || rhs.s_ == State::nan) {
+  if (is_nan() || rhs.is_nan()) {
     return false;
   }
   return compare(rhs) > 0;
@@ -119,33 +961,18 @@ constexpr bool Ap_float<M, E>::operator>(const Ap_float& rhs) const {
 
 template <std::size_t M, std::size_t E>
 constexpr bool Ap_float<M, E>::operator>=(const Ap_float& rhs) const {
-  if (s_ == State::nan || rhs.s_ == State::nan) {
+  if (is_nan() || rhs.is_nan()) {
     return false;
   }
   return compare(rhs) >= 0;
 }
+
 template <std::size_t M, std::size_t E>
 constexpr bool Ap_float<M, E>::operator==(const Ap_float& rhs) const {
-  if (rhs.s_ != s_) {
+  if (is_nan() || rhs.is_nan()) {
     return false;
   }
-
-  switch (s_) {
-    case State::normal:
-      return rhs.m_ == rhs.m_ && e_ == rhs.e_;
-      break;
-    case State::nan:
-      return false;
-      break;
-    case State::pos_inf:
-      return rhs.s_ == State::pos_inf;
-      break;
-    case State::neg_inf:
-      return rhs.s_ == State::neg_inf;
-      break;
-  }
-  assert(false);
-  return false;
+  return compare(rhs) == 0;
 }
 
 template <std::size_t M, std::size_t E>
@@ -161,9 +988,9 @@ constexpr Ap_float<M, E> Ap_float<M, E>::operator+() const {
 template <std::size_t M, std::size_t E>
 constexpr Ap_float<M, E> Ap_float<M, E>::operator-() const {
   Ap_float<M, E> result = *this;
-  result.m_ = -result.m_;
+  result.bits_.get_word(sign_bit) ^= Storage::mask_bit(sign_bit);
   return result;
 }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,425 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FLOAT_CONSTANTS_INCLUDED_H
+#define VECPP_AP_FLOAT_CONSTANTS_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_float/ziv.h"
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/roots.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace vecpp {
+
+enum class Math_constant {
+  pi,
+  e,
+  ln2,
+  ln10,
+};
+
+namespace detail {
+// Constants are computed as fixed point integers, c * 2^frac_bits, with
+// three integral bits.
+template <std::size_t frac_bits>
+using Fixed_point = Int_storage<frac_bits + 3, std::uint64_t>;
+
+// Every generator below is within 16 units of c * 2^frac_bits.
+
+constexpr std::size_t floor_log2(std::uint64_t n) {
+  return 63 - word_leading_zeros(n);
+}
+
+constexpr std::size_t ceil_log2(std::uint64_t n) {
+  return n <= 1 ? 0 : 64 - word_leading_zeros(n - 1);
+}
+
+constexpr std::size_t round_to_words(std::size_t bits) {
+  return (bits + 63) / 64 * 64;
+}
+
+// Returns v. Not constexpr, and opaque to the optimizer through the empty
+// asm statement.
+inline std::uint64_t opaque(std::uint64_t v) {
+#if defined(__GNUC__)
+  asm("" : "+r"(v));
+#endif
+  return v;
+}
+
+// Compilers try to fold calls with constant arguments, for every precision
+// the cache might be asked for, which costs a lot of compile time. Outside
+// of constant evaluation, the generators get their sizes through opaque()
+// instead, which stops the folding attempts at the first call.
+constexpr std::uint64_t fold_barrier(std::uint64_t n) {
+  return is_constant_evaluated() ? n : opaque(n);
+}
+
+template <std::size_t frac_bits, std::size_t bits>
+constexpr Fixed_point<frac_bits> to_fixed_point(const Large_ap_uint<bits>& v) {
+  return resize<frac_bits + 3>(v.data_);
+}
+
+// e = 1 + sum 1 / k!, by binary splitting: the sum of 1 / ((a + 1) ... k)
+// for k in (a, b] is t / q, with q = (a + 1) ... b.
+template <std::size_t bits>
+struct E_split {
+  Large_ap_uint<bits> q;
+  Large_ap_uint<bits> t;
+};
+
+template <std::size_t bits>
+constexpr E_split<bits> e_split(std::uint64_t a, std::uint64_t b) {
+  if (b - a == 1) {
+    return {Large_ap_uint<bits>{b}, Large_ap_uint<bits>{1}};
+  }
+  auto mid = a + (b - a) / 2;
+  auto l = e_split<bits>(a, mid);
+  auto r = e_split<bits>(mid, b);
+  return {l.q * r.q, l.t * r.q + r.t};
+}
+
+// Stops once n! >= 2^(frac_bits + 2), the tail is then below a unit.
+constexpr std::uint64_t e_terms(std::size_t frac_bits) {
+  std::uint64_t n = 1;
+  std::size_t log2_factorial = 0;
+  while (log2_factorial < frac_bits + 2) {
+    ++n;
+    log2_factorial += floor_log2(n);
+  }
+  return n;
+}
+
+constexpr std::size_t e_bits(std::size_t frac_bits) {
+  std::size_t log2_factorial = 0;
+  for (std::uint64_t k = 2; k <= e_terms(frac_bits); ++k) {
+    log2_factorial += ceil_log2(k);
+  }
+  return round_to_words(frac_bits + log2_factorial + 64);
+}
+
+template <std::size_t frac_bits>
+constexpr Fixed_point<frac_bits> e_fixed() {
+  constexpr auto bits = e_bits(frac_bits);
+  auto s = e_split<bits>(0, fold_barrier(e_terms(frac_bits)));
+  return to_fixed_point<frac_bits>(((s.q + s.t) << frac_bits) / s.q);
+}
+
+// atanh(1 / n) = sum 1 / ((2k + 1) n^(2k + 1)), by binary splitting: with
+// m = n^2, the sum of 1 / ((2k + 1) m^k) for k in [a, b) is
+// t / (odd * q), odd being the product of the 2k + 1 and q of the m^k.
+template <std::size_t bits>
+struct Atanh_split {
+  Large_ap_uint<bits> q;
+  Large_ap_uint<bits> odd;
+  Large_ap_uint<bits> t;
+};
+
+template <std::size_t bits>
+constexpr Atanh_split<bits> atanh_split(std::uint64_t m, std::uint64_t a,
+                                        std::uint64_t b) {
+  if (b - a == 1) {
+    return {Large_ap_uint<bits>{a == 0 ? 1 : m}, Large_ap_uint<bits>{2 * a + 1},
+            Large_ap_uint<bits>{1}};
+  }
+  auto mid = a + (b - a) / 2;
+  auto l = atanh_split<bits>(m, a, mid);
+  auto r = atanh_split<bits>(m, mid, b);
+  return {l.q * r.q, l.odd * r.odd, l.t * r.odd * r.q + l.odd * r.t};
+}
+
+// Stops once m^terms >= 2^(frac_bits + 3), the tail is then below a unit.
+constexpr std::uint64_t atanh_terms(std::size_t frac_bits, std::uint64_t n) {
+  auto step = floor_log2(n * n);
+  return (frac_bits + 3 + step - 1) / step;
+}
+
+constexpr std::size_t atanh_bits(std::size_t frac_bits, std::uint64_t n) {
+  auto terms = atanh_terms(frac_bits, n);
+  return round_to_words(frac_bits +
+                        terms * (ceil_log2(n * n) + ceil_log2(2 * terms + 1)) +
+                        64);
+}
+
+// atanh(1 / n) * 2^frac_bits, truncated, within 2 units.
+template <std::size_t frac_bits, std::uint64_t n>
+constexpr Fixed_point<frac_bits> atanh_fixed() {
+  constexpr auto bits = atanh_bits(frac_bits, n);
+  auto s = atanh_split<bits>(n * n, 0, fold_barrier(atanh_terms(frac_bits, n)));
+  return to_fixed_point<frac_bits>((s.t << frac_bits) / (s.odd * s.q * n));
+}
+
+// ln(2) = 2 atanh(1 / 3)
+template <std::size_t frac_bits>
+constexpr Fixed_point<frac_bits> ln2_fixed() {
+  auto result = atanh_fixed<frac_bits, 3>();
+  result.lshift(1);
+  return result;
+}
+
+// ln(10) = 3 ln(2) + ln(5 / 4) = 6 atanh(1 / 3) + 2 atanh(1 / 9)
+template <std::size_t frac_bits>
+constexpr Fixed_point<frac_bits> ln10_fixed() {
+  auto a = atanh_fixed<frac_bits, 3>();
+  auto b = atanh_fixed<frac_bits, 9>();
+  auto result = a;
+  result.lshift(1);
+  result.add(a);
+  result.add(b);
+  result.lshift(1);
+  return result;
+}
+
+// pi = 426880 sqrt(10005) / sum (-1)^k (6k)! (13591409 + 545140134 k) /
+// ((3k)! k!^3 640320^(3k)), the Chudnovsky series, by binary splitting: the
+// terms in [a, b) sum to t / q, p being the product of the term ratios'
+// numerators.
+template <std::size_t bits>
+struct Chudnovsky_split {
+  Large_ap_int<bits> p;
+  Large_ap_int<bits> q;
+  Large_ap_int<bits> t;
+};
+
+// 640320^3 / 24
+constexpr std::int64_t chudnovsky_c3_24 = 10939058860032000;
+
+template <std::size_t bits>
+constexpr Chudnovsky_split<bits> chudnovsky_split(std::uint64_t a,
+                                                  std::uint64_t b) {
+  using Int = Large_ap_int<bits>;
+  if (b - a == 1) {
+    if (a == 0) {
+      return {Int{1}, Int{1}, Int{13591409}};
+    }
+    auto k = std::int64_t(a);
+    auto p = Int{-(6 * k - 5)} * Int{2 * k - 1} * Int{6 * k - 1};
+    auto q = Int{k * k} * Int{k} * Int{chudnovsky_c3_24};
+    return {p, q, p * Int{13591409 + 545140134 * k}};
+  }
+  auto mid = a + (b - a) / 2;
+  auto l = chudnovsky_split<bits>(a, mid);
+  auto r = chudnovsky_split<bits>(mid, b);
+  return {l.p * r.p, l.q * r.q, r.q * l.t + l.p * r.t};
+}
+
+// Every term brings a little over 47 bits.
+constexpr std::uint64_t chudnovsky_terms(std::size_t frac_bits) {
+  return frac_bits / 47 + 2;
+}
+
+// |q| and |p| grow by at most 3 log2(6k) + 54 and 3 log2(6k) bits per term.
+constexpr std::size_t chudnovsky_bits(std::size_t frac_bits) {
+  auto terms = chudnovsky_terms(frac_bits);
+  return round_to_words(frac_bits + terms * (6 * ceil_log2(6 * terms) + 54) +
+                        192);
+}
+
+template <std::size_t frac_bits>
+constexpr Fixed_point<frac_bits> pi_fixed() {
+  constexpr auto bits = chudnovsky_bits(frac_bits);
+  constexpr auto root_bits = round_to_words(2 * frac_bits + 80);
+  auto s = chudnovsky_split<bits>(0, fold_barrier(chudnovsky_terms(frac_bits)));
+
+  // sqrt(10005) * 2^frac_bits
+  Large_ap_uint<root_bits> square{10005};
+  square <<= fold_barrier(2 * frac_bits);
+  Large_ap_uint<bits> root{0};
+  root.data_ = resize<bits>(isqrt(square).data_);
+  auto num = root * Large_ap_uint<bits>{426880} * to_unsigned(s.q);
+  return to_fixed_point<frac_bits>(num / to_unsigned(s.t));
+}
+
+template <std::size_t frac_bits>
+constexpr Fixed_point<frac_bits> constant_fixed(Math_constant c) {
+  switch (c) {
+    case Math_constant::pi:
+      return pi_fixed<frac_bits>();
+    case Math_constant::e:
+      return e_fixed<frac_bits>();
+    case Math_constant::ln2:
+      return ln2_fixed<frac_bits>();
+    case Math_constant::ln10:
+      return ln10_fixed<frac_bits>();
+  }
+  return Fixed_point<frac_bits>{0};
+}
+
+// floor(c * 2^512), least significant word first, in Math_constant order.
+constexpr std::size_t table_frac_bits = 512;
+constexpr std::uint64_t constant_table[4][9] = {
+    {0x3f84d5b5b5470917ULL, 0xc0ac29b7c97c50ddULL, 0xbe5466cf34e90c6cULL,
+     0x452821e638d01377ULL, 0x082efa98ec4e6c89ULL, 0xa4093822299f31d0ULL,
+     0x13198a2e03707344ULL, 0x243f6a8885a308d3ULL, 0x0000000000000003ULL},
+    {0x4f7c7b5757f59584ULL, 0xda06c80abb1185ebULL, 0xf4bf8d8d8c31d763ULL,
+     0x324e7738926cfbe5ULL, 0xa784d9045190cfefULL, 0x62e7160f38b4da56ULL,
+     0xbf7158809cf4f3c7ULL, 0xb7e151628aed2a6aULL, 0x0000000000000002ULL},
+    {0x27573b291169b825ULL, 0xed2eae35c1382144ULL, 0x559552fb4afa1b10ULL,
+     0xe7b876206debac98ULL, 0x8a0d175b8baafa2bULL, 0x40f343267298b62dULL,
+     0xc9e3b39803f2f6afULL, 0xb17217f7d1cf79abULL, 0x0000000000000000ULL},
+    {0xee3de2100b945b59ULL, 0xb1889061042f8b6bULL, 0x31c32f00b17c35a0ULL,
+     0x58bc0b5ec6a04173ULL, 0x0f187a0807c0b5caULL, 0x8a3fb3e76977e43aULL,
+     0xa95b58ae0b4c28a3ULL, 0x4d763776aaa2b05bULL, 0x0000000000000002ULL},
+};
+
+// The 64 bits of words starting at bit pos, zero past the end.
+template <typename Words>
+constexpr std::uint64_t word_at(const Words& words, std::size_t size,
+                                std::size_t pos) {
+  std::size_t w = pos / 64;
+  std::size_t b = pos % 64;
+  if (w >= size) {
+    return 0;
+  }
+  std::uint64_t result = words[w] >> b;
+  if (b != 0 && w + 1 < size) {
+    result |= words[w + 1] << (64 - b);
+  }
+  return result;
+}
+
+// Truncates c * 2^from_bits, held in words, to frac_bits <= from_bits.
+template <std::size_t frac_bits, typename Words>
+constexpr Fixed_point<frac_bits> truncate_fixed(const Words& words,
+                                                std::size_t size,
+                                                std::size_t from_bits) {
+  auto shift = from_bits - frac_bits;
+  Fixed_point<frac_bits> result{0};
+  for (std::size_t i = 0; i < result.words; ++i) {
+    result[i] = word_at(words, size, i * 64 + shift);
+  }
+  result.clear_unused_bits();
+  return result;
+}
+
+// Up to 512 bits, c comes from the table: this keeps the elementary
+// functions affordable in constant evaluation. Past that, it is generated.
+template <std::size_t frac_bits>
+constexpr Fixed_point<frac_bits> fixed_constant(Math_constant c) {
+  if constexpr (frac_bits <= table_frac_bits) {
+    return truncate_fixed<frac_bits>(constant_table[std::size_t(c)], 9,
+                                     table_frac_bits);
+  } else {
+    return constant_fixed<frac_bits>(c);
+  }
+}
+
+// The most precise value of each constant computed so far. Less precise
+// requests are served by truncating it, which costs one more unit of error.
+class Constant_cache {
+ public:
+  static Constant_cache& instance() {
+    static Constant_cache cache;
+    return cache;
+  }
+
+  template <std::size_t frac_bits>
+  Fixed_point<frac_bits> get(Math_constant c) {
+    if (frac_bits <= table_frac_bits) {
+      return fixed_constant<frac_bits>(c);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[std::size_t(c)];
+    if (entry.frac_bits < frac_bits) {
+      auto v = constant_fixed<frac_bits>(c);
+      entry.frac_bits = frac_bits;
+      entry.words.assign(std::begin(v.data_), std::end(v.data_));
+      ++computations_;
+      return v;
+    }
+    return truncate_fixed<frac_bits>(entry.words, entry.words.size(),
+                                     entry.frac_bits);
+  }
+
+  // Number of constants actually computed, rather than served from the
+  // cache.
+  std::size_t computations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return computations_;
+  }
+
+ private:
+  struct Entry {
+    std::size_t frac_bits = 0;
+    std::vector<std::uint64_t> words;
+  };
+
+  mutable std::mutex mutex_;
+  std::array<Entry, 4> entries_;
+  std::size_t computations_ = 0;
+};
+
+// Rounds c * 2^-frac_bits to W. With P + 64 fractional bits, the error of
+// the fixed point value stays far below W's rounding error, so the result
+// is within 2^(1 - P) of c.
+template <typename W, std::size_t frac_bits>
+constexpr Approx<W> round_fixed_constant(const Fixed_point<frac_bits>& c) {
+  using Arith = typename Ap_float_traits<W>::Arith;
+  return {Arith::round(false, c, -std::int64_t(frac_bits),
+                       Rounding::nearest_even),
+          1};
+}
+
+// c, computed afresh in constant evaluation when the table is not enough,
+// from the cache otherwise.
+template <typename W>
+constexpr Approx<W> constant_approx(Math_constant c) {
+  constexpr auto frac_bits = std::size_t(Ap_float_traits<W>::precision) + 64;
+  if (is_constant_evaluated()) {
+    return round_fixed_constant<W, frac_bits>(fixed_constant<frac_bits>(c));
+  }
+  return round_fixed_constant<W, frac_bits>(
+      Constant_cache::instance().get<frac_bits>(c));
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> round_constant(Math_constant c, Rounding mode) {
+  return ziv_round<M, E>(
+      [c](auto tag) {
+        return constant_approx<typename decltype(tag)::type>(c);
+      },
+      mode);
+}
+}  // namespace detail
+
+// The constant c, correctly rounded. Outside of constant evaluation, values
+// come from a process-wide cache: once c has been computed at some
+// precision, every lower precision is rounded from it.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> constant(Math_constant c,
+                                  Rounding mode = Rounding::nearest_even) {
+  return detail::round_constant<M, E>(c, mode);
+}
+
+// The same, computed once per format at compile time.
+template <std::size_t M, std::size_t E>
+inline constexpr Ap_float<M, E> pi_v =
+    detail::round_constant<M, E>(Math_constant::pi, Rounding::nearest_even);
+
+template <std::size_t M, std::size_t E>
+inline constexpr Ap_float<M, E> e_v =
+    detail::round_constant<M, E>(Math_constant::e, Rounding::nearest_even);
+
+template <std::size_t M, std::size_t E>
+inline constexpr Ap_float<M, E> ln2_v =
+    detail::round_constant<M, E>(Math_constant::ln2, Rounding::nearest_even);
+
+template <std::size_t M, std::size_t E>
+inline constexpr Ap_float<M, E> ln10_v =
+    detail::round_constant<M, E>(Math_constant::ln10, Rounding::nearest_even);
+}  // namespace vecpp
+
+#endif
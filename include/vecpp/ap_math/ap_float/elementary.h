@@ -0,0 +1,653 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FLOAT_ELEMENTARY_INCLUDED_H
+#define VECPP_AP_FLOAT_ELEMENTARY_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_float/constants.h"
+#include "vecpp/ap_math/ap_float/ziv.h"
+#include "vecpp/ap_math/ap_int/combinatorics.h"
+#include "vecpp/ap_math/ap_int/roots.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace vecpp {
+
+// Correctly rounded elementary functions, following Ziv's strategy (see
+// ziv.h).
+
+namespace detail {
+// v / d, for the series coefficients.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> divide(const Ap_float<M, E>& v, std::uint64_t d) {
+  return Ap_float_arith<M, E>::div_word(v, d, Rounding::nearest_even);
+}
+
+// n <= 2^error_bits(n)
+constexpr std::int64_t error_bits(std::uint64_t n) {
+  return n == 0 ? 0 : 64 - std::int64_t(word_leading_zeros(n));
+}
+
+constexpr std::int64_t magnitude(std::int64_t v) { return v < 0 ? -v : v; }
+
+// Past this exponent, arguments of sin and cos are not reduced.
+constexpr std::int64_t max_reduction_exponent = 16384;
+
+// sin and cos also need the working precision to go past the argument's
+// exponent, for the reduction by pi / 2.
+constexpr std::size_t ziv_reduction_tiers(std::size_t M, std::size_t E) {
+  auto emax = (std::int64_t(1) << (E - 1)) - 1;
+  auto needed =
+      std::size_t(std::min(emax, max_reduction_exponent)) + 2 * M + 128;
+  std::size_t tiers = ziv_tiers;
+  while (ziv_precision(M, tiers - 1) < needed) {
+    ++tiers;
+  }
+  return tiers;
+}
+
+// The rounding mode that gives -round(-x).
+constexpr Rounding mirror(Rounding mode) {
+  switch (mode) {
+    case Rounding::upward:
+      return Rounding::downward;
+    case Rounding::downward:
+      return Rounding::upward;
+    default:
+      return mode;
+  }
+}
+
+// 0 for non-integers, 1 for even integers, 2 for odd ones. v is finite.
+template <std::size_t M, std::size_t E>
+constexpr int integer_kind(const Ap_float<M, E>& v) {
+  if (v.is_zero() || v.exponent() >= std::int64_t(M)) {
+    return 1;
+  }
+  if (v.exponent() < 0) {
+    return 0;
+  }
+  auto fraction_bits = std::size_t(std::int64_t(M) - 1 - v.exponent());
+  auto sig = v.significand();
+  if (sig.count_trailing_zeros() < fraction_bits) {
+    return 0;
+  }
+  return sig.get_bit(fraction_bits) ? 2 : 1;
+}
+
+// v is integral, with |v| < 2^62.
+template <std::size_t M, std::size_t E>
+constexpr std::int64_t integral_to_int64(const Ap_float<M, E>& v) {
+  if (v.is_zero()) {
+    return 0;
+  }
+  auto sig = v.significand();
+  auto shift = std::int64_t(M) - 1 - v.exponent();
+  std::uint64_t abs_value = 0;
+  if (shift >= 0) {
+    sig.rshift(std::uint64_t(shift));
+    abs_value = sig[0];
+  } else {
+    abs_value = sig[0] << -shift;
+  }
+  return v.signbit() ? -std::int64_t(abs_value) : std::int64_t(abs_value);
+}
+
+// The two low bits of an integral v, as a two's complement integer.
+template <std::size_t M, std::size_t E>
+constexpr unsigned integral_mod4(const Ap_float<M, E>& v) {
+  if (v.is_zero() || v.exponent() > std::int64_t(M)) {
+    return 0;
+  }
+  auto sig = v.significand();
+  auto shift = std::int64_t(M) - 1 - v.exponent();
+  unsigned low = 0;
+  for (std::int64_t b = 0; b < 2; ++b) {
+    auto pos = shift + b;
+    if (pos >= 0 && pos < std::int64_t(M) && sig.get_bit(std::size_t(pos))) {
+      low |= 1u << b;
+    }
+  }
+  return v.signbit() ? (4 - low) % 4 : low;
+}
+
+// 1 + t, for any 0 < |t| < 2^-(M + 1): no rounding boundary lies between
+// 1 + t and 1 ± 2^-(M + 3).
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> one_plus_tiny(bool negative, Rounding mode) {
+  Int_storage<M + 4, std::uint64_t> sig{0};
+  sig.set_bit(M + 3);
+  if (negative) {
+    sig.subtract(Int_storage<M + 4, std::uint64_t>{1});
+  } else {
+    sig.add(Int_storage<M + 4, std::uint64_t>{1});
+  }
+  return Ap_float_arith<M, E>::round(false, sig, -std::int64_t(M) - 3, mode);
+}
+
+// v - t, for a non-zero v and 0 < t < ulp(v) / 8, t having v's sign.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> shrink_tiny(const Ap_float<M, E>& v, Rounding mode) {
+  using Arith = Ap_float_arith<M, E>;
+  auto u = Arith::unpack(v);
+  auto sig = resize<M + 3>(u.sig);
+  sig.lshift(3);
+  sig.subtract(Int_storage<M + 3, std::uint64_t>{1});
+  return Arith::round(u.negative, sig, u.scale() - 3, mode);
+}
+
+// A positive value far below half the smallest subnormal.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> underflow(Rounding mode) {
+  using Arith = Ap_float_arith<M, E>;
+  return Arith::round(false, Int_storage<64, std::uint64_t>{1},
+                      Arith::emin - std::int64_t(M) - 2, mode);
+}
+
+// If v is a perfect square, stores its square root in root.
+template <std::size_t M, std::size_t E>
+constexpr bool exact_sqrt(const Ap_float<M, E>& v, Ap_float<M, E>& root) {
+  using Arith = Ap_float_arith<M, E>;
+  auto u = Arith::unpack(v);
+  auto tz = u.sig.count_trailing_zeros();
+  std::int64_t e2 = u.scale() + std::int64_t(tz);
+  if (e2 % 2 != 0) {
+    return false;
+  }
+  Large_ap_uint<M + 64> odd{0};
+  odd.data_ = resize<M + 64>(u.sig);
+  odd.data_.rshift(tz);
+  auto r = isqrt(odd);
+  if (r * r != odd) {
+    return false;
+  }
+  root = Arith::round(false, r.data_, e2 / 2, Rounding::nearest_even);
+  return true;
+}
+
+template <typename W>
+constexpr Approx<W> ln2_approx() {
+  return constant_approx<W>(Math_constant::ln2);
+}
+
+template <typename W>
+constexpr Approx<W> pi_approx() {
+  return constant_approx<W>(Math_constant::pi);
+}
+
+// exp(x), with x within the range the caller checked for.
+template <typename W>
+constexpr Approx<W> exp_approx(const W& x) {
+  constexpr auto P = Ap_float_traits<W>::precision;
+  auto ln2 = ln2_approx<W>();
+
+  // x = k ln(2) + r, with |r| about ln(2) / 2 at most.
+  W k = nearbyint(x / ln2.value);
+  W r = fma(-k, ln2.value, x);
+
+  // exp(r) = exp(r / 2^s)^(2^s), s balances the series length against the
+  // squarings.
+  auto s = std::int64_t(isqrt_word(std::uint64_t(P))) / 2;
+  W y = ldexp(r, -s);
+  W sum = W(1);
+  W term = W(1);
+  std::uint64_t i = 1;
+  for (; !y.is_zero(); ++i) {
+    term = divide(term * y, i);
+    sum = sum + term;
+    if (term.exponent() < sum.exponent() - P - 2) {
+      break;
+    }
+  }
+  for (std::int64_t j = 0; j < s; ++j) {
+    sum = sum * sum;
+  }
+
+  // Each squaring doubles the relative error. An absolute error on r is a
+  // relative error on exp(r), and r is off by |k| times the error on ln(2).
+  auto n = integral_to_int64(k);
+  auto series = error_bits(3 * i + 4) + s + 1;
+  auto reduction = error_bits(std::uint64_t(magnitude(n))) + ln2.guard + 1;
+  return {ldexp(sum, n), std::max(series, reduction) + 1};
+}
+
+// log(x) for a finite x > 0, x != 1.
+template <typename W>
+constexpr Approx<W> log_approx(const W& x) {
+  constexpr auto P = Ap_float_traits<W>::precision;
+  auto ln2 = ln2_approx<W>();
+
+  // x = 2^e m, with m in [sqrt(1/2), sqrt(2)], so that adding e ln(2) back
+  // cancels at most one bit.
+  auto e = x.exponent();
+  W m = ldexp(x, -e);
+  if (m > W(1.4142135623730951)) {
+    m = ldexp(m, -1);
+    ++e;
+  }
+
+  // log(m) = 2 atanh(t), with t = (m - 1) / (m + 1) and |t| < 0.18. m - 1
+  // is exact.
+  W t = (m - W(1)) / (m + W(1));
+  if (t.is_zero()) {
+    return {W(e) * ln2.value, ln2.guard + 1};
+  }
+  W t2 = t * t;
+  W power = t;
+  W sum = t;
+  std::uint64_t i = 1;
+  for (;; ++i) {
+    power = power * t2;
+    W term = divide(power, 2 * i + 1);
+    sum = sum + term;
+    if (term.exponent() < sum.exponent() - P - 2) {
+      break;
+    }
+  }
+  W log_m = ldexp(sum, 1);
+  auto series = error_bits(4 * i + 8);
+  if (e == 0) {
+    return {log_m, series};
+  }
+  return {fma(W(e), ln2.value, log_m), std::max(series, ln2.guard) + 2};
+}
+
+// sin(x), or cos(x) = sin(x + pi / 2), for a finite non-zero x.
+template <typename W>
+constexpr Approx<W> sin_cos_approx(const W& x, bool cosine) {
+  constexpr auto P = Ap_float_traits<W>::precision;
+  // The quadrant needs every integral bit of x / (pi / 2), this attempt
+  // cannot provide them.
+  if (x.exponent() > P - 8) {
+    return {x, P};
+  }
+
+  auto pi = pi_approx<W>();
+  W half_pi = ldexp(pi.value, -1);
+  W k = nearbyint(x / half_pi);
+  W r = fma(-k, half_pi, x);
+  if (r.is_zero()) {
+    return {x, P};
+  }
+
+  unsigned quadrant = (integral_mod4(k) + (cosine ? 1 : 0)) % 4;
+  bool use_cos = quadrant % 2 == 1;
+
+  // Taylor series of sin(r) or cos(r), |r| <= pi / 4 give or take an ulp.
+  W r2 = r * r;
+  W term = use_cos ? W(1) : r;
+  W sum = term;
+  std::uint64_t n = use_cos ? 0 : 1;
+  std::uint64_t i = 1;
+  for (;; ++i, n += 2) {
+    term = -divide(term * r2, (n + 1) * (n + 2));
+    sum = sum + term;
+    if (term.exponent() < sum.exponent() - P - 2) {
+      break;
+    }
+  }
+  auto guard = error_bits(4 * i + 8);
+
+  // r is off by |k| times the error on pi / 2. cos(r) >= 0.7 absorbs it,
+  // sin(r) only relative to r.
+  if (!k.is_zero()) {
+    auto reduction = k.exponent() + pi.guard + 3;
+    if (!use_cos) {
+      reduction += 1 - r.exponent();
+    }
+    guard = std::max(guard, reduction) + 1;
+  }
+  return {quadrant >= 2 ? -sum : sum, guard};
+}
+
+// atan(x) for a non-zero x.
+template <typename W>
+constexpr Approx<W> atan_approx(const W& x) {
+  constexpr auto P = Ap_float_traits<W>::precision;
+  if (x.is_inf()) {
+    auto pi = pi_approx<W>();
+    return {ldexp(x.signbit() ? -pi.value : pi.value, -1), pi.guard};
+  }
+
+  // atan(a) = pi / 2 - atan(1 / a)
+  W a = abs(x);
+  bool inverted = a > W(1);
+  if (inverted) {
+    a = W(1) / a;
+  }
+
+  // atan(a) = 2 atan(a / (1 + sqrt(1 + a^2))), applied s times.
+  auto s = std::int64_t(isqrt_word(std::uint64_t(P))) / 2;
+  for (std::int64_t j = 0; j < s; ++j) {
+    a = a / (W(1) + sqrt(W(1) + a * a));
+  }
+
+  W a2 = a * a;
+  W power = a;
+  W sum = a;
+  std::uint64_t i = 1;
+  for (;; ++i) {
+    power = power * a2;
+    W term = divide(power, 2 * i + 1);
+    sum = i % 2 == 1 ? sum - term : sum + term;
+    if (term.exponent() < sum.exponent() - P - 2) {
+      break;
+    }
+  }
+  W result = ldexp(sum, s);
+  auto guard = error_bits(4 * i + 4 * std::uint64_t(s) + 12);
+
+  if (inverted) {
+    // The difference is at least pi / 4, twice atan(a) at most.
+    auto pi = pi_approx<W>();
+    result = ldexp(pi.value, -1) - result;
+    guard = std::max(guard, pi.guard) + 2;
+  }
+  return {x.signbit() ? -result : result, guard};
+}
+
+// |x|^y for a finite x > 0, x != 1, and a finite non-zero y.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> pow_magnitude(Ap_float<M, E> x, Ap_float<M, E> y,
+                                       Rounding mode) {
+  using Arith = Ap_float_arith<M, E>;
+
+  // Only integral powers of perfect squares, square roots and so on can be
+  // representable or land right on a midpoint. Anything else is irrational,
+  // and the general case below always settles.
+  while (integer_kind(y) == 0 && exact_sqrt(x, x)) {
+    y = ldexp(y, 1);
+  }
+
+  if (integer_kind(y) != 0) {
+    auto u = Arith::unpack(x);
+    auto tz = u.sig.count_trailing_zeros();
+    auto odd = u.sig;
+    odd.rshift(tz);
+    std::int64_t e2 = u.scale() + std::int64_t(tz);
+    auto odd_len = std::int64_t(M - odd.count_leading_zeros());
+
+    constexpr std::int64_t limit = 4 * (Arith::emax + std::int64_t(M) + 2);
+    if (odd_len == 1) {
+      // x = 2^e2, so x^y = 2^(e2 y), clamped to what over or underflows.
+      std::int64_t scale = 0;
+      if (y.exponent() >= 62 ||
+          magnitude(integral_to_int64(y)) > limit / magnitude(e2)) {
+        scale = (e2 < 0) != y.signbit() ? -limit : limit;
+      } else {
+        scale = e2 * integral_to_int64(y);
+      }
+      return Arith::round(false, Int_storage<64, std::uint64_t>{1}, scale,
+                          mode);
+    }
+
+    // odd^n has at least n (odd_len - 1) + 1 bits, past M + 1 it is neither
+    // representable nor a midpoint.
+    if (y.exponent() < 62) {
+      auto n = magnitude(integral_to_int64(y));
+      if (n * (odd_len - 1) + 1 <= std::int64_t(M) + 1) {
+        constexpr std::size_t bits = 2 * M + 64;
+        Large_ap_uint<bits> base{0};
+        base.data_ = resize<bits>(odd);
+        auto p = pow(base, std::uint64_t(n));
+        if (!y.signbit()) {
+          return Arith::round(false, p.data_, e2 * n, mode);
+        }
+
+        // 1 / odd^n, with M + 3 quotient bits and the remainder folded in
+        // the lowest one.
+        constexpr std::size_t wide_bits = 3 * M + 68;
+        auto shift = std::int64_t(bits - p.data_.count_leading_zeros()) +
+                     std::int64_t(M) + 3;
+        Int_storage<wide_bits, std::uint64_t> num{0};
+        num.set_bit(std::size_t(shift));
+        auto qr = num.udivmod(resize<wide_bits>(p.data_));
+        auto q = std::get<0>(qr);
+        if (std::get<1>(qr).used_words() != 0) {
+          q[0] |= 1;
+        }
+        return Arith::round(false, q, -shift - e2 * n, mode);
+      }
+    }
+  }
+
+  // A first estimate of y log(x) tells apart the results that surely
+  // overflow, underflow, or round like 1 + tiny.
+  using W0 = Ap_float<ziv_precision(M, 0), ziv_exponent_bits(M, E)>;
+  constexpr std::int64_t limit = 2 * (Arith::emax + std::int64_t(M) + 2);
+  auto t0 = W0(y) * log_approx(W0(x)).value;
+  if (t0 > W0(limit)) {
+    return Arith::overflow(false, mode);
+  }
+  if (t0 < W0(-limit)) {
+    return underflow<M, E>(mode);
+  }
+  if (t0.exponent() < -std::int64_t(M) - 4) {
+    return one_plus_tiny<M, E>(t0.signbit(), mode);
+  }
+
+  return ziv_round<M, E>(
+      [&](auto tag) {
+        using W = typename decltype(tag)::type;
+        auto l = log_approx(W(x));
+        W t = W(y) * l.value;
+        auto result = exp_approx(t);
+        // t is off by |t| times the error on log(x).
+        auto argument = t.exponent() + l.guard + 2;
+        return Approx<W>{result.value,
+                         std::max(result.guard, argument) + 2};
+      },
+      mode);
+}
+}  // namespace detail
+
+// ************************** FUNCTIONS ************************** //
+
+// Square root, computed exactly from the integer square root of the
+// significand.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> sqrt(const Ap_float<M, E>& x,
+                              Rounding mode = Rounding::nearest_even) {
+  using Arith = detail::Ap_float_arith<M, E>;
+  if (x.is_nan() || (x.signbit() && !x.is_zero())) {
+    return Ap_float<M, E>::quiet_nan();
+  }
+  if (x.is_zero() || x.is_inf()) {
+    return x;
+  }
+
+  // sig * 2^scale, shifted up by an even amount so that the root has at
+  // least M + 2 bits. The remainder becomes the sticky bit.
+  constexpr std::size_t bits = 2 * M + 68;
+  auto u = Arith::unpack(x);
+  auto shift = std::int64_t(M) + 4 + ((u.scale() ^ std::int64_t(M + 4)) & 1);
+  Large_ap_uint<bits> n{0};
+  n.data_ = detail::resize<bits>(u.sig);
+  n.data_.lshift(std::uint64_t(shift));
+
+  auto r = isqrt(n);
+  auto root = r.data_;
+  if (r * r != n) {
+    root[0] |= 1;
+  }
+  return Arith::round(false, root, (u.scale() - shift) / 2, mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> exp(const Ap_float<M, E>& x,
+                             Rounding mode = Rounding::nearest_even) {
+  using Float = Ap_float<M, E>;
+  using Arith = detail::Ap_float_arith<M, E>;
+  if (x.is_nan()) {
+    return Float::quiet_nan();
+  }
+  if (x.is_inf()) {
+    return x.signbit() ? Float(0) : x;
+  }
+  if (x.is_zero()) {
+    return Float(1);
+  }
+  if (x.exponent() < -std::int64_t(M) - 3) {
+    return detail::one_plus_tiny<M, E>(x.signbit(), mode);
+  }
+
+  // Far enough out that the result surely overflows or underflows.
+  constexpr std::int64_t limit = 2 * (Arith::emax + std::int64_t(M) + 2);
+  if (x > Float(limit)) {
+    return Arith::overflow(false, mode);
+  }
+  if (x < Float(-limit)) {
+    return detail::underflow<M, E>(mode);
+  }
+
+  return detail::ziv_round<M, E>(
+      [&](auto tag) {
+        using W = typename decltype(tag)::type;
+        return detail::exp_approx(W(x));
+      },
+      mode);
+}
+
+// Natural logarithm.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> log(const Ap_float<M, E>& x,
+                             Rounding mode = Rounding::nearest_even) {
+  using Float = Ap_float<M, E>;
+  if (x.is_nan() || (x.signbit() && !x.is_zero())) {
+    return Float::quiet_nan();
+  }
+  if (x.is_zero()) {
+    return Float::infinity(true);
+  }
+  if (x.is_inf()) {
+    return x;
+  }
+  if (x == Float(1)) {
+    return Float(0);
+  }
+
+  return detail::ziv_round<M, E>(
+      [&](auto tag) {
+        using W = typename decltype(tag)::type;
+        return detail::log_approx(W(x));
+      },
+      mode);
+}
+
+// For exponent widths above 15, arguments of 2^16384 and beyond are not
+// reduced, and give NaN.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> sin(const Ap_float<M, E>& x,
+                             Rounding mode = Rounding::nearest_even) {
+  if (!x.is_finite() || x.exponent() >= detail::max_reduction_exponent) {
+    return Ap_float<M, E>::quiet_nan();
+  }
+  if (x.is_zero()) {
+    return x;
+  }
+  // sin(x) = x - x^3 / 6 + ...
+  if (2 * x.exponent() < -std::int64_t(M) - 6) {
+    return detail::shrink_tiny(x, mode);
+  }
+
+  return detail::ziv_round<M, E, detail::ziv_reduction_tiers(M, E)>(
+      [&](auto tag) {
+        using W = typename decltype(tag)::type;
+        return detail::sin_cos_approx(W(x), false);
+      },
+      mode);
+}
+
+// Same argument range as sin().
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> cos(const Ap_float<M, E>& x,
+                             Rounding mode = Rounding::nearest_even) {
+  if (!x.is_finite() || x.exponent() >= detail::max_reduction_exponent) {
+    return Ap_float<M, E>::quiet_nan();
+  }
+  // cos(x) = 1 - x^2 / 2 + ...
+  if (x.is_zero()) {
+    return Ap_float<M, E>(1);
+  }
+  if (2 * x.exponent() < -std::int64_t(M) - 6) {
+    return detail::one_plus_tiny<M, E>(true, mode);
+  }
+
+  return detail::ziv_round<M, E, detail::ziv_reduction_tiers(M, E)>(
+      [&](auto tag) {
+        using W = typename decltype(tag)::type;
+        return detail::sin_cos_approx(W(x), true);
+      },
+      mode);
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> atan(const Ap_float<M, E>& x,
+                              Rounding mode = Rounding::nearest_even) {
+  if (x.is_nan()) {
+    return Ap_float<M, E>::quiet_nan();
+  }
+  if (x.is_zero()) {
+    return x;
+  }
+  // atan(x) = x - x^3 / 3 + ...
+  if (x.is_finite() && 2 * x.exponent() < -std::int64_t(M) - 6) {
+    return detail::shrink_tiny(x, mode);
+  }
+
+  return detail::ziv_round<M, E>(
+      [&](auto tag) {
+        using W = typename decltype(tag)::type;
+        return detail::atan_approx(W(x));
+      },
+      mode);
+}
+
+// x^y, with the special cases of C's pow(). Results that are exactly
+// representable, or exact midpoints, are recognized as such.
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> pow(const Ap_float<M, E>& x, const Ap_float<M, E>& y,
+                             Rounding mode = Rounding::nearest_even) {
+  using Float = Ap_float<M, E>;
+  using Arith = detail::Ap_float_arith<M, E>;
+  Float one(1);
+  if (y.is_zero() || x == one) {
+    return one;
+  }
+  if (x.is_nan() || y.is_nan()) {
+    return Float::quiet_nan();
+  }
+
+  bool odd = y.is_finite() && detail::integer_kind(y) == 2;
+  if (y.is_inf()) {
+    auto ax = abs(x);
+    if (ax == one) {
+      return one;
+    }
+    return (ax < one) == y.signbit() ? Float::infinity() : Float(0);
+  }
+  if (x.is_zero() || x.is_inf()) {
+    bool negative = odd && x.signbit();
+    return x.is_zero() == y.signbit() ? Float::infinity(negative)
+                                      : Arith::zero(negative);
+  }
+  if (x.signbit() && detail::integer_kind(y) == 0) {
+    return Float::quiet_nan();
+  }
+
+  // |x|^y, rounded the way the signed result is.
+  bool negative = x.signbit() && odd;
+  auto result = detail::pow_magnitude(
+      abs(x), y, negative ? detail::mirror(mode) : mode);
+  return negative ? -result : result;
+}
+}  // namespace vecpp
+
+#endif
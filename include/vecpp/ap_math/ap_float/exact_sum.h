@@ -0,0 +1,213 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FLOAT_EXACT_SUM_INCLUDED_H
+#define VECPP_AP_FLOAT_EXACT_SUM_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/roots.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace vecpp {
+
+// A fixed point accumulator wide enough to hold any sum of doubles exactly
+// (Kulisch's long accumulator). Every finite double is a multiple of
+// 2^-1074 below 2^1024, so 2098 bits cover a single one, and the extra bits
+// up to 2176 leave room for 2^77 additions of each sign.
+//
+// Adding a double only touches the two words its significand lands in,
+// plus whatever carry comes out of them, which rarely goes further than
+// the next word. Positive and negative values go to separate accumulators,
+// so that there is no borrow to deal with, nor a branch on the sign.
+class Superaccumulator {
+ public:
+  static constexpr std::size_t bits = 2176;
+  // The accumulator holds the sum * 2^-scale.
+  static constexpr std::int64_t scale = -1074;
+
+  using Storage = Large_ap_int<bits>;
+  static constexpr std::size_t words = bits / 64;
+
+  constexpr Superaccumulator() = default;
+
+  constexpr void add(double v);
+  constexpr void add(const double* values, std::size_t count);
+  constexpr Superaccumulator& operator+=(double v);
+  // Merging is a full width addition.
+  constexpr Superaccumulator& operator+=(const Superaccumulator& rhs);
+
+  // Whether an infinity or a NaN was added.
+  constexpr bool is_finite() const {
+    return !nan_ && !pos_inf_ && !neg_inf_;
+  }
+
+  // The exact sum of the finite values added so far, times 2^1074.
+  constexpr Storage value() const { return sums_[0] - sums_[1]; }
+
+  // The sum, correctly rounded. NaN if a NaN or opposite infinities were
+  // added.
+  template <std::size_t M, std::size_t E>
+  constexpr Ap_float<M, E> round(Rounding mode = Rounding::nearest_even) const;
+  constexpr double to_double(Rounding mode = Rounding::nearest_even) const;
+
+ private:
+  // sums_[0] gets the positive values, sums_[1] the negative ones.
+  Storage sums_[2] = {Storage{0}, Storage{0}};
+  bool nan_ = false;
+  bool pos_inf_ = false;
+  bool neg_inf_ = false;
+  // Sums of -0 alone are -0, sums of +0 alone, or of nothing, are +0.
+  bool only_negative_zeros_ = true;
+  bool only_positive_zeros_ = true;
+};
+
+constexpr void Superaccumulator::add(double v) {
+  constexpr std::uint64_t sign_mask = std::uint64_t(1) << 63;
+  auto encoding = detail::bit_cast<std::uint64_t>(v);
+  auto biased = (encoding >> 52) & 0x7ff;
+  auto sig = encoding & ((std::uint64_t(1) << 52) - 1);
+  bool negative = (encoding >> 63) != 0;
+  only_negative_zeros_ = only_negative_zeros_ && encoding == sign_mask;
+  only_positive_zeros_ = only_positive_zeros_ && encoding == 0;
+  if (biased == 0x7ff) {
+    if (sig != 0) {
+      nan_ = true;
+    } else if (negative) {
+      neg_inf_ = true;
+    } else {
+      pos_inf_ = true;
+    }
+    return;
+  }
+
+  // v = sig * 2^(shift - 1074)
+  std::uint64_t shift = 0;
+  if (biased != 0) {
+    sig |= std::uint64_t(1) << 52;
+    shift = biased - 1;
+  }
+  if (sig == 0) {
+    return;
+  }
+
+  auto& w = sums_[negative].data_;
+  std::size_t word = shift / 64;
+  std::size_t offset = shift % 64;
+  std::uint64_t lo = sig << offset;
+  std::uint64_t hi = offset == 0 ? 0 : sig >> (64 - offset);
+
+  w[word] += lo;
+  std::uint64_t carry = w[word] < lo;
+  std::uint64_t sum = w[word + 1] + hi;
+  std::uint64_t next_carry = sum < hi;
+  sum += carry;
+  next_carry += sum < carry;
+  w[word + 1] = sum;
+  for (std::size_t i = word + 2; next_carry != 0 && i < words; ++i) {
+    next_carry = ++w[i] == 0;
+  }
+}
+
+constexpr void Superaccumulator::add(const double* values, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    add(values[i]);
+  }
+}
+
+constexpr Superaccumulator& Superaccumulator::operator+=(double v) {
+  add(v);
+  return *this;
+}
+
+constexpr Superaccumulator& Superaccumulator::operator+=(
+    const Superaccumulator& rhs) {
+  sums_[0] += rhs.sums_[0];
+  sums_[1] += rhs.sums_[1];
+  nan_ = nan_ || rhs.nan_;
+  pos_inf_ = pos_inf_ || rhs.pos_inf_;
+  neg_inf_ = neg_inf_ || rhs.neg_inf_;
+  only_negative_zeros_ = only_negative_zeros_ && rhs.only_negative_zeros_;
+  only_positive_zeros_ = only_positive_zeros_ && rhs.only_positive_zeros_;
+  return *this;
+}
+
+template <std::size_t M, std::size_t E>
+constexpr Ap_float<M, E> Superaccumulator::round(Rounding mode) const {
+  using Arith = detail::Ap_float_arith<M, E>;
+  if (nan_ || (pos_inf_ && neg_inf_)) {
+    return Arith::nan();
+  }
+  if (pos_inf_ || neg_inf_) {
+    return Arith::infinity(neg_inf_);
+  }
+
+  // Zeros of the same sign add up to that zero. Any other exact zero,
+  // from cancelling terms or mixed signs of zeros, is +0, or -0 when
+  // rounding downward, like x + (-x).
+  auto sum = value();
+  if (sum == 0) {
+    if (only_positive_zeros_ || only_negative_zeros_) {
+      return Arith::zero(!only_positive_zeros_);
+    }
+    return Arith::zero(mode == Rounding::downward);
+  }
+  bool negative = sum < 0;
+  auto magnitude = detail::to_unsigned(negative ? -sum : sum);
+  return Arith::round(negative, magnitude.data_, scale, mode);
+}
+
+constexpr double Superaccumulator::to_double(Rounding mode) const {
+  return to_native<double>(round<53, 11>(mode));
+}
+
+// The sum of values[0, count), correctly rounded.
+constexpr double exact_sum(const double* values, std::size_t count,
+                           Rounding mode = Rounding::nearest_even) {
+  Superaccumulator acc;
+  acc.add(values, count);
+  return acc.to_double(mode);
+}
+
+// Same as exact_sum(), with the values split between threads, each one
+// filling its own accumulator before they are merged.
+inline double parallel_exact_sum(
+    const double* values, std::size_t count,
+    unsigned threads = std::thread::hardware_concurrency(),
+    Rounding mode = Rounding::nearest_even) {
+  // Below that, the threads cost more than they save.
+  constexpr std::size_t min_chunk = 1 << 16;
+  if (threads <= 1 || count < 2 * min_chunk) {
+    return exact_sum(values, count, mode);
+  }
+
+  std::size_t chunk = std::max(min_chunk, (count + threads - 1) / threads);
+  std::vector<std::future<Superaccumulator>> parts;
+  for (std::size_t first = 0; first < count; first += chunk) {
+    std::size_t size = std::min(chunk, count - first);
+    parts.push_back(std::async(std::launch::async, [=] {
+      Superaccumulator acc;
+      acc.add(values + first, size);
+      return acc;
+    }));
+  }
+
+  Superaccumulator result;
+  for (auto& p : parts) {
+    result += p.get();
+  }
+  return result.to_double(mode);
+}
+}  // namespace vecpp
+
+#endif
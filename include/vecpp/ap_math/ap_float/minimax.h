@@ -0,0 +1,232 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FLOAT_MINIMAX_INCLUDED_H
+#define VECPP_AP_FLOAT_MINIMAX_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vecpp {
+
+enum class Minimax_error {
+  absolute,
+  // Relative to |f(x)|, which must not vanish over the interval.
+  relative,
+};
+
+template <std::size_t degree, typename Float>
+struct Minimax_result {
+  // p(x) = coefficients[0] + coefficients[1] x + ...
+  std::array<Float, degree + 1> coefficients;
+  // Largest error of p over the grid.
+  Float error;
+  std::size_t iterations;
+};
+
+namespace detail {
+// Solves a x = b by Gaussian elimination with partial pivoting.
+template <typename W, std::size_t n>
+constexpr std::array<W, n> solve(std::array<std::array<W, n>, n> a,
+                                 std::array<W, n> b) {
+  for (std::size_t col = 0; col < n; ++col) {
+    std::size_t pivot = col;
+    for (std::size_t r = col + 1; r < n; ++r) {
+      if (abs(a[r][col]) > abs(a[pivot][col])) {
+        pivot = r;
+      }
+    }
+    if (pivot != col) {
+      for (std::size_t c = col; c < n; ++c) {
+        W tmp = a[col][c];
+        a[col][c] = a[pivot][c];
+        a[pivot][c] = tmp;
+      }
+      W tmp = b[col];
+      b[col] = b[pivot];
+      b[pivot] = tmp;
+    }
+
+    for (std::size_t r = col + 1; r < n; ++r) {
+      W factor = -(a[r][col] / a[col][col]);
+      for (std::size_t c = col + 1; c < n; ++c) {
+        a[r][c] = fma(factor, a[col][c], a[r][c]);
+      }
+      b[r] = fma(factor, b[col], b[r]);
+    }
+  }
+
+  std::array<W, n> x{};
+  for (std::size_t r = n; r-- > 0;) {
+    W sum = b[r];
+    for (std::size_t c = r + 1; c < n; ++c) {
+      sum = fma(-a[r][c], x[c], sum);
+    }
+    x[r] = sum / a[r][r];
+  }
+  return x;
+}
+
+template <typename W, std::size_t n>
+constexpr W horner(const std::array<W, n>& c, const W& x) {
+  W result = c[n - 1];
+  for (std::size_t j = n - 1; j-- > 0;) {
+    result = fma(result, x, c[j]);
+  }
+  return result;
+}
+
+// Remez exchange over a fixed grid: f is only evaluated once per grid
+// point, and every iteration costs a linear solve plus one polynomial
+// evaluation per grid point, which keeps constant evaluation within the
+// compilers' default step limits. Since the error curve is flat around its
+// extrema, 8 points per oscillation already find them within about 1.5%.
+template <std::size_t degree, std::size_t grid, std::size_t M,
+          std::size_t E, typename F>
+constexpr Minimax_result<degree, Ap_float<M, E>> remez(
+    const F& f, const Ap_float<M, E>& lo, const Ap_float<M, E>& hi,
+    Minimax_error kind, std::size_t max_iterations) {
+  using W = Ap_float<M, E>;
+  constexpr std::size_t n = degree + 2;
+  static_assert(grid >= 2 * n, "the grid must be denser than the reference");
+
+  // s is evenly spaced over [-1, 1], t = s (3 - s^2) / 2 bunches the points
+  // up near the ends, like Chebyshev nodes do, without calling cos().
+  W half = ldexp(hi - lo, -1);
+  W mid = lo + half;
+  bool relative = kind == Minimax_error::relative;
+  std::array<W, grid> xs{};
+  std::array<W, grid> ys{};
+  // 1 / |f(x)|, so that relative errors cost a multiplication per point.
+  std::array<W, grid> weight{};
+  for (std::size_t k = 0; k < grid; ++k) {
+    if (k == 0 || k == grid - 1) {
+      xs[k] = k == 0 ? lo : hi;
+    } else {
+      W s = Ap_float_arith<M, E>::div_word(
+          W(std::int64_t(2 * k) - std::int64_t(grid - 1)), grid - 1,
+          Rounding::nearest_even);
+      W t = ldexp(s * (W(3) - s * s), -1);
+      xs[k] = fma(half, t, mid);
+    }
+    ys[k] = f(xs[k]);
+    if (relative) {
+      weight[k] = W(1) / abs(ys[k]);
+    }
+  }
+
+  // The reference starts evenly spread in s.
+  std::array<std::size_t, n> ref{};
+  for (std::size_t i = 0; i < n; ++i) {
+    ref[i] = (i * (grid - 1) + (n - 1) / 2) / (n - 1);
+  }
+
+  Minimax_result<degree, W> result{};
+  std::array<W, grid> err{};
+  for (result.iterations = 1;; ++result.iterations) {
+    // p(x_i) - f(x_i) = (-1)^i e s(x_i) for the n reference points, with
+    // s(x) = |f(x)| for relative errors, 1 otherwise.
+    std::array<std::array<W, n>, n> a{};
+    std::array<W, n> b{};
+    for (std::size_t i = 0; i < n; ++i) {
+      W power = W(1);
+      for (std::size_t j = 0; j <= degree; ++j) {
+        a[i][j] = power;
+        power = power * xs[ref[i]];
+      }
+      W s = relative ? abs(ys[ref[i]]) : W(1);
+      a[i][degree + 1] = i % 2 == 0 ? -s : s;
+      b[i] = ys[ref[i]];
+    }
+    auto solution = solve(a, b);
+    for (std::size_t j = 0; j <= degree; ++j) {
+      result.coefficients[j] = solution[j];
+    }
+    W levelled = abs(solution[degree + 1]);
+
+    result.error = W(0);
+    for (std::size_t k = 0; k < grid; ++k) {
+      err[k] = horner(result.coefficients, xs[k]) - ys[k];
+      if (relative) {
+        err[k] = err[k] * weight[k];
+      }
+      if (abs(err[k]) > result.error) {
+        result.error = abs(err[k]);
+      }
+    }
+
+    // Done once the extrema are level within 1/64.
+    if (result.iterations >= max_iterations ||
+        result.error - levelled <= ldexp(levelled, -6)) {
+      return result;
+    }
+
+    // Multiple exchange: the largest error of each run of the same sign,
+    // then trimmed from the ends down to n alternating points.
+    std::array<std::size_t, grid> extrema{};
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < grid; ++k) {
+      bool same_run =
+          count != 0 && err[k].signbit() == err[extrema[count - 1]].signbit();
+      if (!same_run) {
+        extrema[count++] = k;
+      } else if (abs(err[k]) > abs(err[extrema[count - 1]])) {
+        extrema[count - 1] = k;
+      }
+    }
+    if (count < n) {
+      return result;
+    }
+
+    std::size_t first = 0;
+    while (count - first > n) {
+      if (abs(err[extrema[first]]) < abs(err[extrema[count - 1]])) {
+        ++first;
+      } else {
+        --count;
+      }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      ref[i] = extrema[first + i];
+    }
+  }
+}
+}  // namespace detail
+
+// Minimax polynomial of the given degree for f over [lo, hi], by the Remez
+// exchange algorithm. f maps an Ap_float<M, E> to one, and should be
+// constexpr for the result to be usable at compile time; M has to leave
+// enough bits below the approximation error for it to be measured.
+template <std::size_t degree, std::size_t grid = 8 * (degree + 2),
+          std::size_t M, std::size_t E, typename F>
+constexpr Minimax_result<degree, Ap_float<M, E>> minimax(
+    const F& f, const Ap_float<M, E>& lo, const Ap_float<M, E>& hi,
+    Minimax_error kind = Minimax_error::absolute,
+    std::size_t max_iterations = 16) {
+  return detail::remez<degree, grid>(f, lo, hi, kind, max_iterations);
+}
+
+// The same coefficients, rounded to a native type.
+template <typename T, std::size_t degree, std::size_t grid = 8 * (degree + 2),
+          std::size_t M, std::size_t E, typename F>
+constexpr std::array<T, degree + 1> minimax_coefficients(
+    const F& f, const Ap_float<M, E>& lo, const Ap_float<M, E>& hi,
+    Minimax_error kind = Minimax_error::absolute,
+    std::size_t max_iterations = 16) {
+  auto fit = minimax<degree, grid>(f, lo, hi, kind, max_iterations);
+  std::array<T, degree + 1> result{};
+  for (std::size_t j = 0; j <= degree; ++j) {
+    result[j] = static_cast<T>(fit.coefficients[j]);
+  }
+  return result;
+}
+}  // namespace vecpp
+
+#endif
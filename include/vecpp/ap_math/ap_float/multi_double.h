@@ -0,0 +1,672 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FLOAT_MULTI_DOUBLE_INCLUDED_H
+#define VECPP_AP_FLOAT_MULTI_DOUBLE_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+#include "vecpp/ap_math/ap_float/elementary.h"
+#include "vecpp/ap_math/ap_float/exact_sum.h"
+#include "vecpp/ap_math/ap_float/ziv.h"
+
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Double-double and quad-double arithmetic: a value is the unevaluated sum
+// of n doubles, each at most half an ulp of the one before, and operations
+// are built from error-free transformations of native doubles, following
+// Hida, Li and Bailey's QD library. That gives about 106 and 212 bits of
+// precision for a fraction of the cost of Ap_float<106, 11> and
+// Ap_float<212, 11>, but no correct rounding: results are within a few
+// units of their last bit, and the exponent range is the one of double.
+
+#if defined(__FMA__) || defined(FP_FAST_FMA)
+#define VECPP_AP_FLOAT_HAS_FMA
+#endif
+
+namespace vecpp {
+
+namespace detail {
+template <std::size_t n>
+struct Multi_double_arith;
+}
+
+template <std::size_t n>
+class alignas(n * sizeof(double)) Multi_double {
+  static_assert(n == 2 || n == 4,
+                "only double-double and quad-double are implemented");
+
+ public:
+  constexpr Multi_double() = default;
+  constexpr Multi_double(const Multi_double&) = default;
+
+  constexpr Multi_double(double v) : parts_{v} {}
+
+  template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  constexpr Multi_double(T);
+
+  // Rounded to nearest, part by part.
+  template <std::size_t M, std::size_t E>
+  constexpr explicit Multi_double(const Ap_float<M, E>&);
+
+  constexpr Multi_double& operator=(const Multi_double&) = default;
+
+  // The exact sum of the parts, correctly rounded.
+  template <std::size_t M, std::size_t E>
+  constexpr explicit operator Ap_float<M, E>() const;
+
+  // The leading part, which is the sum rounded to nearest.
+  constexpr explicit operator double() const { return parts_[0]; }
+
+  static constexpr Multi_double infinity(bool negative = false);
+  static constexpr Multi_double quiet_nan();
+  // Largest finite value.
+  static constexpr Multi_double max();
+
+  // Part i, by decreasing magnitude.
+  constexpr double operator[](std::size_t i) const { return parts_[i]; }
+
+  constexpr bool is_nan() const { return parts_[0] != parts_[0]; }
+  constexpr bool is_inf() const;
+  constexpr bool is_finite() const { return parts_[0] - parts_[0] == 0; }
+  constexpr bool is_zero() const { return parts_[0] == 0; }
+  constexpr bool signbit() const;
+
+  constexpr bool operator==(const Multi_double& rhs) const;
+  constexpr bool operator!=(const Multi_double& rhs) const;
+  constexpr bool operator<(const Multi_double&) const;
+  constexpr bool operator<=(const Multi_double&) const;
+  constexpr bool operator>(const Multi_double&) const;
+  constexpr bool operator>=(const Multi_double&) const;
+
+  constexpr Multi_double operator+() const;
+  constexpr Multi_double operator-() const;
+
+  constexpr Multi_double& operator+=(const Multi_double&);
+  constexpr Multi_double& operator-=(const Multi_double&);
+  constexpr Multi_double& operator*=(const Multi_double&);
+  constexpr Multi_double& operator/=(const Multi_double&);
+
+  constexpr Multi_double operator+(const Multi_double&) const;
+  constexpr Multi_double operator-(const Multi_double&) const;
+  constexpr Multi_double operator*(const Multi_double&) const;
+  constexpr Multi_double operator/(const Multi_double&) const;
+
+ private:
+  friend struct detail::Multi_double_arith<n>;
+
+  // -1, 0 or 1, lexicographically on the parts.
+  constexpr int compare(const Multi_double& rhs) const;
+
+  double parts_[n] = {};
+};
+
+using Dd_float = Multi_double<2>;
+using Qd_float = Multi_double<4>;
+
+namespace detail {
+// x is neither infinite nor NaN.
+constexpr bool is_finite_double(double x) { return x - x == 0; }
+
+// a + b == s + e exactly.
+constexpr double two_sum(double a, double b, double& e) {
+  double s = a + b;
+  double bb = s - a;
+  e = (a - (s - bb)) + (b - bb);
+  return s;
+}
+
+// The same, for |a| >= |b|.
+constexpr double quick_two_sum(double a, double b, double& e) {
+  double s = a + b;
+  e = b - (s - a);
+  return s;
+}
+
+// a == hi + lo, with 26 significant bits in each half.
+constexpr double split(double a, double& lo) {
+  // 2^27 + 1
+  constexpr double splitter = 134217729.0;
+  double t = splitter * a;
+  double hi = t - (t - a);
+  lo = a - hi;
+  return hi;
+}
+
+// a * b == p + e exactly, barring overflow and underflow.
+constexpr double two_prod(double a, double b, double& e) {
+  double p = a * b;
+#ifdef VECPP_AP_FLOAT_HAS_FMA
+  if (!is_constant_evaluated()) {
+    e = std::fma(a, b, -p);
+    return p;
+  }
+#endif
+  // Dekker's product.
+  double a_lo = 0;
+  double b_lo = 0;
+  double a_hi = split(a, a_lo);
+  double b_hi = split(b, b_lo);
+  e = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+  return p;
+}
+
+constexpr double abs_double(double x) { return x < 0 ? -x : x; }
+
+// x * 2^k, exactly unless the result is subnormal or overflows.
+constexpr double scale_double(double x, std::int64_t k) {
+  for (; k > 0; k -= std::min<std::int64_t>(k, 62)) {
+    x *= double(std::uint64_t(1) << std::min<std::int64_t>(k, 62));
+  }
+  for (; k < 0; k += std::min<std::int64_t>(-k, 62)) {
+    x /= double(std::uint64_t(1) << std::min<std::int64_t>(-k, 62));
+  }
+  return x;
+}
+
+template <std::size_t n>
+struct Multi_double_arith {
+  using Float = Multi_double<n>;
+
+  static constexpr Float make(const std::array<double, n>& parts) {
+    Float result;
+    for (std::size_t i = 0; i < n; ++i) {
+      result.parts_[i] = parts[i];
+    }
+    return result;
+  }
+
+  // m overlapping parts, by roughly decreasing magnitude, turned into n
+  // that do not overlap: an error-free sum from the bottom up, then the
+  // errors are carried down from the top.
+  template <std::size_t m>
+  static constexpr Float renormalize(std::array<double, m> c) {
+    if (!is_finite_double(c[0])) {
+      return Float{c[0]};
+    }
+    for (std::size_t i = m - 1; i > 0; --i) {
+      c[i - 1] = two_sum(c[i - 1], c[i], c[i]);
+    }
+
+    Float result;
+    std::size_t k = 0;
+    double s = c[0];
+    for (std::size_t i = 1; i < m; ++i) {
+      double e = 0;
+      double t = quick_two_sum(s, c[i], e);
+      if (e == 0) {
+        s = t;
+        continue;
+      }
+      result.parts_[k++] = t;
+      if (k == n) {
+        return result;
+      }
+      s = e;
+    }
+    result.parts_[k] = s;
+    return result;
+  }
+
+  static constexpr Float add(const Float& a, const Float& b) {
+    if constexpr (n == 2) {
+      double e1 = 0;
+      double e2 = 0;
+      double lead = two_sum(a.parts_[0], b.parts_[0], e1);
+      double t = two_sum(a.parts_[1], b.parts_[1], e2);
+      e1 += t;
+      double s = quick_two_sum(lead, e1, e1);
+      e1 += e2;
+      s = quick_two_sum(s, e1, e1);
+      // Infinities turn the error terms into NaN.
+      return is_finite_double(lead) ? make({s, e1}) : Float{lead};
+    } else {
+      // Parts of the same rank summed pairwise, followed by their errors.
+      // Unlike merging the parts by magnitude, this does not branch.
+      const auto& x = a.parts_;
+      const auto& y = b.parts_;
+      double lead = x[0] + y[0];
+      if (!is_finite_double(lead)) {
+        return Float{lead};
+      }
+      std::array<double, 8> c{};
+      double t0 = 0, t1 = 0, t2 = 0, t3 = 0;
+      c[0] = two_sum(x[0], y[0], t0);
+      c[1] = two_sum(x[1], y[1], t1);
+      c[2] = t0;
+      c[3] = two_sum(x[2], y[2], t2);
+      c[4] = t1;
+      c[5] = two_sum(x[3], y[3], t3);
+      c[6] = t2;
+      c[7] = t3;
+      return renormalize(c);
+    }
+  }
+
+  // (a, b, c) becomes their sum followed by two error terms.
+  static constexpr void three_sum(double& a, double& b, double& c) {
+    double t2 = 0;
+    double t3 = 0;
+    double t1 = two_sum(a, b, t2);
+    a = two_sum(c, t1, t3);
+    b = two_sum(t2, t3, c);
+  }
+
+  static constexpr Float mul(const Float& a, const Float& b) {
+    const auto& x = a.parts_;
+    const auto& y = b.parts_;
+    if constexpr (n == 2) {
+      double e = 0;
+      double lead = two_prod(x[0], y[0], e);
+      e += x[0] * y[1] + x[1] * y[0];
+      double p = quick_two_sum(lead, e, e);
+      return is_finite_double(lead) ? make({p, e}) : Float{lead};
+    } else {
+      // Products down to the third order, with their errors down to the
+      // second, summed one order of magnitude at a time.
+      double q0 = 0, q1 = 0, q2 = 0, q3 = 0, q4 = 0, q5 = 0;
+      double p0 = two_prod(x[0], y[0], q0);
+      if (!is_finite_double(p0)) {
+        return Float{p0};
+      }
+      double p1 = two_prod(x[0], y[1], q1);
+      double p2 = two_prod(x[1], y[0], q2);
+      double p3 = two_prod(x[0], y[2], q3);
+      double p4 = two_prod(x[1], y[1], q4);
+      double p5 = two_prod(x[2], y[0], q5);
+
+      three_sum(p1, p2, q0);
+      three_sum(p2, q1, q2);
+      three_sum(p3, p4, p5);
+
+      double t0 = 0;
+      double t1 = 0;
+      double s0 = two_sum(p2, p3, t0);
+      double s1 = two_sum(q1, p4, t1);
+      double s2 = q2 + p5;
+      s1 = two_sum(s1, t0, t0);
+      s2 += t0 + t1;
+
+      s1 += x[0] * y[3] + x[1] * y[2] + x[2] * y[1] + x[3] * y[0] + q0 + q3 +
+            q4 + q5;
+      return renormalize(std::array<double, 5>{p0, p1, s0, s1, s2});
+    }
+  }
+
+  // a * b, for a double b.
+  static constexpr Float mul_double(const Float& a, double b) {
+    const auto& x = a.parts_;
+    if constexpr (n == 2) {
+      double e = 0;
+      double lead = two_prod(x[0], b, e);
+      e += x[1] * b;
+      double p = quick_two_sum(lead, e, e);
+      return is_finite_double(lead) ? make({p, e}) : Float{lead};
+    } else {
+      double q0 = 0, q1 = 0, q2 = 0;
+      double p0 = two_prod(x[0], b, q0);
+      if (!is_finite_double(p0)) {
+        return Float{p0};
+      }
+      double p1 = two_prod(x[1], b, q1);
+      double p2 = two_prod(x[2], b, q2);
+      double p3 = x[3] * b;
+
+      double s2 = 0;
+      double s1 = two_sum(q0, p1, s2);
+      three_sum(s2, q1, p2);
+      // q1 + q2 + p3, and what is left of its error.
+      double t2 = 0;
+      double t3 = 0;
+      double t1 = two_sum(q1, q2, t2);
+      double s3 = two_sum(p3, t1, t3);
+      double s4 = t2 + t3 + p2;
+      return renormalize(std::array<double, 5>{p0, s1, s2, s3, s4});
+    }
+  }
+
+  static constexpr Float div(const Float& a, const Float& b) {
+    double d = b.parts_[0];
+    double q0 = a.parts_[0] / d;
+    if (!is_finite_double(q0) || !is_finite_double(d)) {
+      return Float{q0};
+    }
+
+    if constexpr (n == 2) {
+      // Long division, one double of the quotient at a time.
+      Float r = a - mul_double(b, q0);
+      double q1 = r.parts_[0] / d;
+      r = r - mul_double(b, q1);
+      double q2 = r.parts_[0] / d;
+      return renormalize(std::array<double, 3>{q0, q1, q2});
+    } else {
+      // A double-double quotient, corrected by the double-double quotient
+      // of what is left. That is half as many dependent steps as a long
+      // division.
+      using Half = Multi_double_arith<2>;
+      auto b_half = Half::make({b.parts_[0], b.parts_[1]});
+      auto q = Half::div(Half::make({a.parts_[0], a.parts_[1]}), b_half);
+      Float r = a - mul(b, make({q[0], q[1], 0, 0}));
+      auto c = Half::div(Half::make({r.parts_[0], r.parts_[1]}), b_half);
+      return renormalize(std::array<double, 4>{q[0], q[1], c[0], c[1]});
+    }
+  }
+
+  static constexpr Float sqrt(const Float& a) {
+    if (a.is_zero() || a.is_nan() || (a.is_inf() && !a.signbit())) {
+      return a;
+    }
+    if (a.signbit()) {
+      return Float::quiet_nan();
+    }
+
+    // Newton's iteration on 1 / sqrt(a), each step doubling the number of
+    // correct bits, then Karp's trick for the last one.
+    double root = 0;
+    if (is_constant_evaluated()) {
+      root = double(vecpp::sqrt(Ap_float<53, 11>{a.parts_[0]}));
+    } else {
+      root = std::sqrt(a.parts_[0]);
+    }
+    Float r{1 / root};
+    Float half_a = ldexp(a, -1);
+    for (std::size_t bits = 53; 2 * bits < 53 * n; bits *= 2) {
+      r = r + r * (Float{0.5} - half_a * r * r);
+    }
+    Float y = a * r;
+    return y + ldexp((a - y * y) * r, -1);
+  }
+
+  static constexpr Float ldexp(const Float& v, std::int64_t k) {
+    Float result;
+    for (std::size_t i = 0; i < n; ++i) {
+      result.parts_[i] = scale_double(v.parts_[i], k);
+    }
+    return result;
+  }
+};
+}  // namespace detail
+
+template <std::size_t n>
+template <typename T, std::enable_if_t<std::is_integral_v<T>, int>>
+constexpr Multi_double<n>::Multi_double(T v) {
+  static_assert(sizeof(T) <= sizeof(std::uint64_t));
+  if constexpr (sizeof(T) <= sizeof(std::uint32_t)) {
+    parts_[0] = double(v);
+  } else {
+    // Both halves fit in a double, and so does the error of their sum.
+    double high = double(v >> 32) * 4294967296.0;
+    double low = double(v & 0xffffffff);
+    parts_[0] = detail::two_sum(high, low, parts_[1]);
+  }
+}
+
+template <std::size_t n>
+template <std::size_t M, std::size_t E>
+constexpr Multi_double<n>::Multi_double(const Ap_float<M, E>& v) {
+  using Float = Ap_float<M, E>;
+  Float rest = v;
+  for (std::size_t i = 0; i < n; ++i) {
+    parts_[i] = to_native<double>(rest);
+    if (!detail::is_finite_double(parts_[i]) || !rest.is_finite()) {
+      *this = Multi_double{parts_[0]};
+      return;
+    }
+    rest = rest - Float(parts_[i]);
+  }
+}
+
+template <std::size_t n>
+template <std::size_t M, std::size_t E>
+constexpr Multi_double<n>::operator Ap_float<M, E>() const {
+  // Trailing zero parts are padding, and would turn -0 into +0.
+  Superaccumulator sum;
+  sum.add(parts_[0]);
+  for (std::size_t i = 1; i < n; ++i) {
+    if (parts_[i] != 0) {
+      sum.add(parts_[i]);
+    }
+  }
+  return sum.round<M, E>();
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::infinity(bool negative) {
+  auto inf = std::numeric_limits<double>::infinity();
+  return Multi_double{negative ? -inf : inf};
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::quiet_nan() {
+  return Multi_double{std::numeric_limits<double>::quiet_NaN()};
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::max() {
+  // Each part is just below half an ulp of the one before.
+  Multi_double result;
+  result.parts_[0] = DBL_MAX;
+  for (std::size_t i = 1; i < n; ++i) {
+    result.parts_[i] = result.parts_[i - 1] * 0x1p-54;
+  }
+  return result;
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::is_inf() const {
+  return is_nan() ? false : !is_finite();
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::signbit() const {
+  return Ap_float<53, 11>{parts_[0]}.signbit();
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> abs(const Multi_double<n>& v) {
+  return v.signbit() ? -v : v;
+}
+
+// a * b + c, rounded twice.
+template <std::size_t n>
+constexpr Multi_double<n> fma(const Multi_double<n>& a,
+                              const Multi_double<n>& b,
+                              const Multi_double<n>& c) {
+  return a * b + c;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> ldexp(const Multi_double<n>& v, std::int64_t k) {
+  return detail::Multi_double_arith<n>::ldexp(v, k);
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> sqrt(const Multi_double<n>& v) {
+  return detail::Multi_double_arith<n>::sqrt(v);
+}
+
+template <std::size_t n>
+constexpr Multi_double<n>& Multi_double<n>::operator+=(
+    const Multi_double& rhs) {
+  *this = *this + rhs;
+  return *this;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n>& Multi_double<n>::operator-=(
+    const Multi_double& rhs) {
+  *this = *this - rhs;
+  return *this;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n>& Multi_double<n>::operator*=(
+    const Multi_double& rhs) {
+  *this = *this * rhs;
+  return *this;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n>& Multi_double<n>::operator/=(
+    const Multi_double& rhs) {
+  *this = *this / rhs;
+  return *this;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::operator+(
+    const Multi_double& rhs) const {
+  return detail::Multi_double_arith<n>::add(*this, rhs);
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::operator-(
+    const Multi_double& rhs) const {
+  return detail::Multi_double_arith<n>::add(*this, -rhs);
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::operator*(
+    const Multi_double& rhs) const {
+  return detail::Multi_double_arith<n>::mul(*this, rhs);
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::operator/(
+    const Multi_double& rhs) const {
+  return detail::Multi_double_arith<n>::div(*this, rhs);
+}
+
+template <std::size_t n>
+constexpr int Multi_double<n>::compare(const Multi_double& rhs) const {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (parts_[i] != rhs.parts_[i]) {
+      return parts_[i] < rhs.parts_[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::operator==(const Multi_double& rhs) const {
+  if (is_nan() || rhs.is_nan()) {
+    return false;
+  }
+  return compare(rhs) == 0;
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::operator!=(const Multi_double& rhs) const {
+  return !(*this == rhs);
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::operator<(const Multi_double& rhs) const {
+  if (is_nan() || rhs.is_nan()) {
+    return false;
+  }
+  return compare(rhs) < 0;
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::operator<=(const Multi_double& rhs) const {
+  if (is_nan() || rhs.is_nan()) {
+    return false;
+  }
+  return compare(rhs) <= 0;
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::operator>(const Multi_double& rhs) const {
+  if (is_nan() || rhs.is_nan()) {
+    return false;
+  }
+  return compare(rhs) > 0;
+}
+
+template <std::size_t n>
+constexpr bool Multi_double<n>::operator>=(const Multi_double& rhs) const {
+  if (is_nan() || rhs.is_nan()) {
+    return false;
+  }
+  return compare(rhs) >= 0;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::operator+() const {
+  return *this;
+}
+
+template <std::size_t n>
+constexpr Multi_double<n> Multi_double<n>::operator-() const {
+  Multi_double result;
+  for (std::size_t i = 0; i < n; ++i) {
+    result.parts_[i] = -parts_[i];
+  }
+  return result;
+}
+
+// Structure of arrays: part i of every value is contiguous, so that loops
+// over many values vectorize, the double-double kernels being branch-free.
+// Multi_double itself is aligned on its size, which keeps each value in a
+// single vector register.
+template <std::size_t n>
+class Multi_double_array {
+ public:
+  explicit Multi_double_array(std::size_t size = 0) { resize(size); }
+
+  std::size_t size() const { return parts_[0].size(); }
+  void resize(std::size_t size) {
+    for (auto& p : parts_) {
+      p.resize(size);
+    }
+  }
+
+  Multi_double<n> get(std::size_t i) const {
+    std::array<double, n> v{};
+    for (std::size_t k = 0; k < n; ++k) {
+      v[k] = parts_[k][i];
+    }
+    return detail::Multi_double_arith<n>::make(v);
+  }
+
+  void set(std::size_t i, const Multi_double<n>& v) {
+    for (std::size_t k = 0; k < n; ++k) {
+      parts_[k][i] = v[k];
+    }
+  }
+
+  double* part(std::size_t k) { return parts_[k].data(); }
+  const double* part(std::size_t k) const { return parts_[k].data(); }
+
+ private:
+  std::array<std::vector<double>, n> parts_;
+};
+
+using Dd_float_array = Multi_double_array<2>;
+using Qd_float_array = Multi_double_array<4>;
+
+// out[i] = op(a[i], b[i]), out may alias a or b.
+template <std::size_t n, typename Op>
+void transform(const Multi_double_array<n>& a, const Multi_double_array<n>& b,
+               Multi_double_array<n>& out, Op op) {
+  assert(a.size() == b.size());
+  out.resize(a.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    out.set(i, op(a.get(i), b.get(i)));
+  }
+}
+}  // namespace vecpp
+
+#endif
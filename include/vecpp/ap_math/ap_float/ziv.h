@@ -0,0 +1,115 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_FLOAT_ZIV_INCLUDED_H
+#define VECPP_AP_FLOAT_ZIV_INCLUDED_H
+
+#include "vecpp/ap_math/ap_float.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Ziv's strategy for correct rounding: a value is approximated in a wider
+// format along with an error bound, and only approximated again at a higher
+// precision when that bound straddles a rounding boundary. The first attempt
+// carries about 64 guard bits, so the retries are rare.
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VECPP_AP_FLOAT_HAS_IS_CONSTANT_EVALUATED
+#endif
+#endif
+
+namespace vecpp {
+namespace detail {
+constexpr bool is_constant_evaluated() {
+#ifdef VECPP_AP_FLOAT_HAS_IS_CONSTANT_EVALUATED
+  return __builtin_is_constant_evaluated();
+#else
+  return true;
+#endif
+}
+
+template <typename T>
+struct Type_tag {
+  using type = T;
+};
+
+template <typename T>
+struct Ap_float_traits;
+
+template <std::size_t M, std::size_t E>
+struct Ap_float_traits<Ap_float<M, E>> {
+  static constexpr std::int64_t precision = M;
+  using Arith = Ap_float_arith<M, E>;
+};
+
+// An approximation of some real x, within |x| * 2^(guard - P), P being the
+// precision of W.
+template <typename W>
+struct Approx {
+  W value;
+  std::int64_t guard;
+};
+
+// Working precision of each attempt, doubling every time.
+constexpr std::size_t ziv_precision(std::size_t M, std::size_t tier) {
+  return (M + 127) / 64 * 64 << tier;
+}
+
+// Room for results up to 2^(±4 (emax + M + 64)), so that nothing overflows
+// or becomes subnormal before the final rounding.
+constexpr std::size_t ziv_exponent_bits(std::size_t M, std::size_t E) {
+  std::uint64_t needed = 4 * ((std::uint64_t(1) << (E - 1)) + M + 64);
+  std::size_t result = E + 2;
+  while (result < 61 && (std::uint64_t(1) << (result - 1)) < needed) {
+    ++result;
+  }
+  return std::min<std::size_t>(result, 61);
+}
+
+constexpr std::size_t ziv_tiers = 3;
+
+// Rounds what eval(Type_tag<W>{}) approximates to Ap_float<M, E>. eval
+// returns an Approx<W> of a finite non-zero value.
+//
+// The result is correctly rounded as soon as a tier's error bound does not
+// straddle a rounding boundary. Past the last tier, it is the approximation
+// rounded in mode, off from x by at most |x| 2^(guard - P) plus the
+// rounding error of mode: half an ulp to nearest, one ulp when directed.
+// The last tier works at 4 times the precision of the first, while the
+// hardest cases of the elementary functions are expected to need about
+// 2M + log2(M) bits, so no argument is known to get there.
+template <std::size_t M, std::size_t E, std::size_t tiers = ziv_tiers,
+          std::size_t tier = 0, typename Eval>
+constexpr Ap_float<M, E> ziv_round(const Eval& eval, Rounding mode) {
+  using Float = Ap_float<M, E>;
+  constexpr auto P = ziv_precision(M, tier);
+  using W = Ap_float<P, ziv_exponent_bits(M, E)>;
+
+  Approx<W> approx = eval(Type_tag<W>{});
+  if (approx.guard + std::int64_t(M) + 2 < std::int64_t(P)) {
+    auto delta = ldexp(abs(approx.value), approx.guard - std::int64_t(P));
+    auto lo = Float(sub(approx.value, delta, Rounding::downward), mode);
+    auto hi = Float(add(approx.value, delta, Rounding::upward), mode);
+    if (lo.encoding().compare(hi.encoding()) == 0) {
+      return lo;
+    }
+  }
+
+  if constexpr (tier + 1 < tiers) {
+    return ziv_round<M, E, tiers, tier + 1>(eval, mode);
+  } else {
+    // Not known to be correctly rounded, within the bound above.
+    return Float(approx.value, mode);
+  }
+}
+}  // namespace detail
+}  // namespace vecpp
+
+#endif
@@ -0,0 +1,177 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_COLUMN_INCLUDED_H
+#define VECPP_AP_INT_COLUMN_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/mapped_file.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+
+// Columns of Ap_uint<bits> values on disk: the 64 bit limbs of each value,
+// least significant first, little endian, one value after the other with
+// no header. bits is a multiple of 64, so every limb is used.
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "Columns are read in place");
+#endif
+
+namespace vecpp {
+
+// Writes count values as a column. False if the stream failed.
+template <std::size_t bits>
+bool write_column(std::ostream& out, const Large_ap_uint<bits>* values,
+                  std::size_t count) {
+  static_assert(bits % 64 == 0, "Column values use every limb");
+  static_assert(sizeof(Large_ap_uint<bits>) == bits / 8,
+                "Values are written in place");
+
+  out.write(reinterpret_cast<const char*>(values),
+            std::streamsize(count * sizeof(Large_ap_uint<bits>)));
+  return bool(out);
+}
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+// Read-only column mapped in memory. Values are Large_ap_uint<bits>
+// references straight onto the mapping, nothing is decoded or copied.
+// is_open() is false if the file could not be mapped, or its size is not a
+// whole number of values. An empty file is an open, empty column.
+template <std::size_t bits>
+class Ap_int_column {
+ public:
+  using Value = Large_ap_uint<bits>;
+  static constexpr std::size_t words = Value::Storage::words;
+
+  static_assert(bits % 64 == 0, "Column values use every limb");
+  static_assert(sizeof(Value) == words * sizeof(std::uint64_t) &&
+                    std::is_standard_layout_v<Value>,
+                "Values are read in place");
+
+  // Sequential iterator, prefetching a few cache lines ahead. The mapping
+  // is also advised as sequential, so the kernel reads ahead of it.
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+
+    static constexpr std::size_t prefetch_bytes = 512;
+
+    Iterator() = default;
+
+    reference operator*() const { return *p_; }
+    pointer operator->() const { return p_; }
+
+    Iterator& operator++() {
+      ++p_;
+      __builtin_prefetch(reinterpret_cast<const char*>(p_) + prefetch_bytes);
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const Iterator& r) const { return p_ == r.p_; }
+    bool operator!=(const Iterator& r) const { return p_ != r.p_; }
+
+   private:
+    friend class Ap_int_column;
+    explicit Iterator(const Value* p) : p_(p) {}
+
+    const Value* p_ = nullptr;
+  };
+
+  explicit Ap_int_column(const char* path) : file_(path, true) {
+    if (file_.size() % sizeof(Value) != 0) {
+      file_.close();
+    }
+  }
+
+  bool is_open() const { return file_.is_open(); }
+  std::size_t size() const { return file_.size() / sizeof(Value); }
+  bool empty() const { return size() == 0; }
+
+  const Value& operator[](std::size_t i) const { return data()[i]; }
+  const Value* data() const {
+    return reinterpret_cast<const Value*>(file_.data());
+  }
+
+  Iterator begin() const { return Iterator(data()); }
+  Iterator end() const { return Iterator(data() + size()); }
+
+ private:
+  detail::Mapped_file file_;
+};
+
+namespace detail {
+// a < b on raw limbs, from the top one down. Most pairs of values differ
+// in their top limb, so this rarely reads more than one.
+template <std::size_t words>
+inline bool column_less(const std::uint64_t* a, const std::uint64_t* b) {
+  for (std::size_t k = words; k-- > 0;) {
+    if (a[k] != b[k]) {
+      return a[k] < b[k];
+    }
+  }
+  return false;
+}
+}  // namespace detail
+
+// Number of values v of the column for which pred(v) is true. pred gets
+// a const Large_ap_uint<bits>& onto the mapping.
+template <std::size_t bits, typename Pred>
+std::size_t count_if(const Ap_int_column<bits>& column, Pred pred) {
+  std::size_t n = 0;
+  for (const auto& v : column) {
+    n += pred(v) ? 1 : 0;
+  }
+  return n;
+}
+
+// Smallest value of a non-empty column, the first one among equals.
+template <std::size_t bits>
+const Large_ap_uint<bits>& min(const Ap_int_column<bits>& column) {
+  constexpr std::size_t words = Ap_int_column<bits>::words;
+  assert(!column.empty());
+
+  const auto* best = &column[0];
+  for (const auto& v : column) {
+    if (detail::column_less<words>(v.limbs(), best->limbs())) {
+      best = &v;
+    }
+  }
+  return *best;
+}
+
+// Largest value of a non-empty column, the first one among equals.
+template <std::size_t bits>
+const Large_ap_uint<bits>& max(const Ap_int_column<bits>& column) {
+  constexpr std::size_t words = Ap_int_column<bits>::words;
+  assert(!column.empty());
+
+  const auto* best = &column[0];
+  for (const auto& v : column) {
+    if (detail::column_less<words>(best->limbs(), v.limbs())) {
+      best = &v;
+    }
+  }
+  return *best;
+}
+#endif
+}  // namespace vecpp
+
+#endif
@@ -0,0 +1,291 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  See the accompanying LICENSE file for licensing details.
+
+#ifndef VECPP_AP_INT_COMBINATORICS_INCLUDED_H
+#define VECPP_AP_INT_COMBINATORICS_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/primes.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace vecpp {
+
+// base^exp, by left to right binary powering.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> pow(const Large_ap_uint<bits>& base,
+                                  std::uint64_t exp) {
+  Large_ap_uint<bits> result{1};
+  if (exp == 0) {
+    return result;
+  }
+  for (std::size_t i = 64 - detail::word_leading_zeros(exp); i-- > 0;) {
+    result *= result;
+    if ((exp >> i) & 1) {
+      result *= base;
+    }
+  }
+  return result;
+}
+
+template <std::size_t bits>
+constexpr Large_ap_int<bits> pow(const Large_ap_int<bits>& base,
+                                 std::uint64_t exp) {
+  Large_ap_int<bits> result{1};
+  if (exp == 0) {
+    return result;
+  }
+  for (std::size_t i = 64 - detail::word_leading_zeros(exp); i-- > 0;) {
+    result *= result;
+    if ((exp >> i) & 1) {
+      result *= base;
+    }
+  }
+  return result;
+}
+
+namespace detail {
+// Below this many factors, a product tree node just multiplies them in.
+constexpr std::uint64_t product_tree_leaf = 16;
+
+// Multiplies as many of the pushed values as fit in a word before touching
+// the large accumulator.
+template <std::size_t bits>
+struct Word_packer {
+  Large_ap_uint<bits> result{1};
+  std::uint64_t pending = 1;
+
+  constexpr void push(std::uint64_t v) {
+    if (pending > ~std::uint64_t(0) / v) {
+      result *= pending;
+      pending = v;
+    } else {
+      pending *= v;
+    }
+  }
+
+  constexpr Large_ap_uint<bits> finish() {
+    result *= pending;
+    pending = 1;
+    return result;
+  }
+};
+
+// Product of the integers in [lo, hi), as a balanced product tree so that
+// both operands of every multiplication have about the same size.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> range_product(std::uint64_t lo,
+                                            std::uint64_t hi) {
+  if (hi - lo <= product_tree_leaf) {
+    Word_packer<bits> packer;
+    for (auto i = lo; i < hi; ++i) {
+      packer.push(i);
+    }
+    return packer.finish();
+  }
+
+  auto mid = lo + (hi - lo) / 2;
+  return range_product<bits>(lo, mid) * range_product<bits>(mid, hi);
+}
+
+// Exponent of p in binomial(n, k): the number of borrows when subtracting k
+// from n in base p (Kummer's theorem).
+constexpr std::uint64_t binomial_exponent(std::uint64_t n, std::uint64_t k,
+                                          std::uint64_t p) {
+  std::uint64_t result = 0;
+  std::uint64_t borrow = 0;
+  while (n != 0) {
+    std::uint64_t n_digit = n % p;
+    std::uint64_t k_digit = k % p + borrow;
+    borrow = n_digit < k_digit ? 1 : 0;
+    result += borrow;
+    n /= p;
+    k /= p;
+  }
+  return result;
+}
+
+// Sieve window for the prime factorisation of binomials. The primes below
+// small_prime_limit can sieve anything below small_prime_limit^2.
+constexpr std::uint64_t binomial_window = small_prime_limit;
+constexpr std::uint64_t binomial_sieve_limit =
+    std::uint64_t(small_prime_limit) * small_prime_limit;
+
+// Product of p^e(p) over the primes p in [lo, hi), where e(p) is the exponent
+// of p in binomial(n, k).
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> binomial_prime_product(std::uint64_t n,
+                                                     std::uint64_t k,
+                                                     std::uint64_t lo,
+                                                     std::uint64_t hi) {
+  if (hi - lo > binomial_window) {
+    auto mid = lo + (hi - lo) / 2;
+    return binomial_prime_product<bits>(n, k, lo, mid) *
+           binomial_prime_product<bits>(n, k, mid, hi);
+  }
+
+  std::array<bool, binomial_window> composite{};
+  for (std::uint64_t q : small_primes) {
+    if (q * q >= hi) {
+      break;
+    }
+    auto first = std::max(q * q, (lo + q - 1) / q * q);
+    for (auto m = first; m < hi; m += q) {
+      composite[m - lo] = true;
+    }
+  }
+
+  Word_packer<bits> packer;
+  for (auto p = std::max<std::uint64_t>(lo, 2); p < hi; ++p) {
+    if (composite[p - lo]) {
+      continue;
+    }
+    // Primes above n - k and below or at n appear exactly once, primes
+    // above n / 2 are only present in that range.
+    auto e = p > n - k ? 1 : (2 * p > n ? 0 : binomial_exponent(n, k, p));
+    for (std::uint64_t i = 0; i < e; ++i) {
+      packer.push(p);
+    }
+  }
+  return packer.finish();
+}
+
+// binomial(n, k) modulo 2^bits by the multiplicative formula. Division is
+// not defined modulo 2^bits, so the odd parts of the numerator and of the
+// denominator are accumulated apart from their powers of two, and the odd
+// denominator is inverted once at the end.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> binomial_incremental(std::uint64_t n,
+                                                   std::uint64_t k) {
+  Large_ap_uint<bits> num{1};
+  Large_ap_uint<bits> den{1};
+  // Exponent of 2 in binomial(n - k + i, i), never negative.
+  std::uint64_t twos = 0;
+  for (std::uint64_t i = 1; i <= k; ++i) {
+    std::uint64_t a = n - k + i;
+    std::size_t a_twos = word_trailing_zeros(a);
+    std::size_t i_twos = word_trailing_zeros(i);
+    num.data_.mul(a >> a_twos);
+    den.data_.mul(i >> i_twos);
+    twos = twos + a_twos - i_twos;
+  }
+  if (twos >= bits) {
+    return Large_ap_uint<bits>{0};
+  }
+
+  // Newton's iteration for 1 / den, each step doubles the correct low bits.
+  // d * d == 1 modulo 8 for any odd d, so the first guess has 3.
+  std::uint64_t d = den.data_[0];
+  std::uint64_t word_inv = d;
+  for (int i = 0; i < 5; ++i) {
+    word_inv *= 2 - d * word_inv;
+  }
+  Large_ap_uint<bits> inv{word_inv};
+  for (std::size_t correct = 64; correct < bits; correct *= 2) {
+    inv *= Large_ap_uint<bits>{2} - den * inv;
+  }
+  return (num * inv) << twos;
+}
+
+// Evaluates the top of a product tree over [lo, hi) on threads, leaf(lo, hi)
+// is called for each chunk.
+template <std::size_t bits, typename Leaf>
+Large_ap_uint<bits> parallel_product(std::uint64_t lo, std::uint64_t hi,
+                                     unsigned threads, Leaf leaf) {
+  std::uint64_t chunk = std::max<std::uint64_t>(1, (hi - lo) / threads);
+  std::vector<std::future<Large_ap_uint<bits>>> parts;
+  for (auto first = lo; first < hi; first += chunk) {
+    auto last = hi - first > chunk + chunk / 2 ? first + chunk : hi;
+    parts.push_back(std::async(std::launch::async, leaf, first, last));
+    if (last == hi) {
+      break;
+    }
+  }
+
+  std::vector<Large_ap_uint<bits>> values;
+  for (auto& p : parts) {
+    values.push_back(p.get());
+  }
+  while (values.size() > 1) {
+    std::size_t out = 0;
+    for (std::size_t i = 0; i + 1 < values.size(); i += 2) {
+      values[out++] = values[i] * values[i + 1];
+    }
+    if (values.size() % 2 == 1) {
+      values[out++] = values.back();
+    }
+    values.resize(out);
+  }
+  return values.front();
+}
+}  // namespace detail
+
+// n!, modulo 2^bits.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> factorial(std::uint64_t n) {
+  if (n < 2) {
+    return Large_ap_uint<bits>{1};
+  }
+  return detail::range_product<bits>(2, n + 1);
+}
+
+// n! / (k! (n - k)!) modulo 2^bits, whatever its size. It is evaluated as
+// the product tree of its prime factorisation, or incrementally for
+// n >= 2^24, past the reach of the sieve.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> binomial(std::uint64_t n, std::uint64_t k) {
+  if (k > n) {
+    return Large_ap_uint<bits>{0};
+  }
+  k = std::min(k, n - k);
+  if (k == 0) {
+    return Large_ap_uint<bits>{1};
+  }
+
+  if (n >= detail::binomial_sieve_limit) {
+    return detail::binomial_incremental<bits>(n, k);
+  }
+  return detail::binomial_prime_product<bits>(n, k, 2, n + 1);
+}
+
+// Same as factorial(), with the top of the product tree spread over threads.
+template <std::size_t bits>
+Large_ap_uint<bits> parallel_factorial(
+    std::uint64_t n, unsigned threads = std::thread::hardware_concurrency()) {
+  if (threads <= 1 || n < 2 * detail::product_tree_leaf * threads) {
+    return factorial<bits>(n);
+  }
+  return detail::parallel_product<bits>(
+      2, n + 1, threads, &detail::range_product<bits>);
+}
+
+// Same as binomial(), with the top of the product tree spread over threads.
+template <std::size_t bits>
+Large_ap_uint<bits> parallel_binomial(
+    std::uint64_t n, std::uint64_t k,
+    unsigned threads = std::thread::hardware_concurrency()) {
+  if (k > n) {
+    return Large_ap_uint<bits>{0};
+  }
+  k = std::min(k, n - k);
+  if (threads <= 1 || k == 0 || n >= detail::binomial_sieve_limit ||
+      n < detail::binomial_window * threads) {
+    return binomial<bits>(n, k);
+  }
+  return detail::parallel_product<bits>(
+      2, n + 1, threads, [n, k](std::uint64_t lo, std::uint64_t hi) {
+        return detail::binomial_prime_product<bits>(n, k, lo, hi);
+      });
+}
+}  // namespace vecpp
+
+#endif
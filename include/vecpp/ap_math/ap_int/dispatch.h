@@ -0,0 +1,317 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_DISPATCH_INCLUDED_H
+#define VECPP_AP_INT_DISPATCH_INCLUDED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+// Kernels for instruction sets beyond the consumer's compiler flags are
+// built with target attributes and picked at run time.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VECPP_AP_INT_HAS_X86_KERNELS
+#include <immintrin.h>
+
+// Int_storage only calls them outside of constant evaluation.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VECPP_AP_INT_HAS_WORD_KERNELS
+#endif
+#endif
+#endif
+
+namespace vecpp {
+namespace detail {
+
+// Instruction sets the kernels can be built for, from least to most
+// capable. Each level only checks for its own features: a CPU with avx2 but
+// no adx still runs the avx2 array kernels and the portable word kernels.
+enum class Isa { generic, adx, avx2, avx512, avx512_ifma };
+
+constexpr const char* isa_names[] = {"generic", "adx", "avx2", "avx512",
+                                     "avx512_ifma"};
+
+inline bool isa_supported(Isa level) {
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+  switch (level) {
+    case Isa::adx:
+      return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+    case Isa::avx2:
+      return __builtin_cpu_supports("avx2");
+    case Isa::avx512:
+      return __builtin_cpu_supports("avx512f");
+    case Isa::avx512_ifma:
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512ifma");
+    default:
+      return true;
+  }
+#else
+  return level == Isa::generic;
+#endif
+}
+
+// The most capable level the running CPU supports, detected once. Setting
+// VECPP_AP_MATH_ISA to one of isa_names caps it, to benchmark the other
+// kernels on the same machine.
+inline Isa isa() {
+  static const Isa level = [] {
+    Isa cap = Isa::avx512_ifma;
+    if (const char* env = std::getenv("VECPP_AP_MATH_ISA")) {
+      for (std::size_t i = 0; i <= std::size_t(Isa::avx512_ifma); ++i) {
+        if (std::string_view(env) == isa_names[i]) {
+          cap = Isa(i);
+        }
+      }
+    }
+    for (auto l = std::size_t(cap); l > 0; --l) {
+      if (isa_supported(Isa(l))) {
+        return Isa(l);
+      }
+    }
+    return Isa::generic;
+  }();
+  return level;
+}
+
+// Word level kernels behind Int_storage<bits, std::uint64_t>, on n >= 1
+// words.
+struct Word_kernels {
+  // r += a, returns the carry.
+  bool (*add)(std::uint64_t* r, const std::uint64_t* a, std::size_t n);
+  // r -= a, returns the borrow.
+  bool (*sub)(std::uint64_t* r, const std::uint64_t* a, std::size_t n);
+  // r *= w, returns the carry word.
+  std::uint64_t (*mul_word)(std::uint64_t* r, std::size_t n, std::uint64_t w);
+  // r += a * w, returns the carry word.
+  std::uint64_t (*addmul)(std::uint64_t* r, const std::uint64_t* a,
+                          std::size_t n, std::uint64_t w);
+  // r = src << shift, r = src >> shift, within n words and with
+  // 0 < shift < 64. r may overlap src on the side the shift moves away from.
+  void (*lshift)(std::uint64_t* r, const std::uint64_t* src, std::size_t n,
+                 unsigned shift);
+  void (*rshift)(std::uint64_t* r, const std::uint64_t* src, std::size_t n,
+                 unsigned shift);
+  // r /= d, returns the remainder.
+  std::uint64_t (*divmod_word)(std::uint64_t* r, std::size_t n,
+                               std::uint64_t d);
+};
+
+#ifdef VECPP_AP_INT_HAS_WORD_KERNELS
+// Carry chains the compiler will not produce from portable code: unrolled
+// adc/sbb loops, mulx with two independent carry flags (adcx, adox), and a
+// plain divq instead of a call to the 128 bit division helper. The loops
+// run on blocks of 4 words, the rest is left to plain code. dec and lea
+// leave CF alone, lea and jrcxz leave OF alone too.
+__extension__ typedef unsigned __int128 Word_kernels_uint128;
+
+inline bool add_words_adx(std::uint64_t* r, const std::uint64_t* a,
+                          std::size_t n) {
+  bool carry = false;
+  if (std::size_t blocks = n / 4) {
+    std::uint64_t t;
+    asm("clc\n"
+        "1:\n\t"
+        "movq (%[a]), %[t]\n\t"
+        "adcq %[t], (%[r])\n\t"
+        "movq 8(%[a]), %[t]\n\t"
+        "adcq %[t], 8(%[r])\n\t"
+        "movq 16(%[a]), %[t]\n\t"
+        "adcq %[t], 16(%[r])\n\t"
+        "movq 24(%[a]), %[t]\n\t"
+        "adcq %[t], 24(%[r])\n\t"
+        "leaq 32(%[a]), %[a]\n\t"
+        "leaq 32(%[r]), %[r]\n\t"
+        "decq %[n]\n\t"
+        "jnz 1b\n\t"
+        "setc %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [n] "+r"(blocks), [t] "=&r"(t),
+          [c] "=r"(carry)
+        :
+        : "cc", "memory");
+  }
+  for (std::size_t i = 0; i < n % 4; ++i) {
+    auto sum = Word_kernels_uint128(r[i]) + a[i] + carry;
+    r[i] = std::uint64_t(sum);
+    carry = (sum >> 64) != 0;
+  }
+  return carry;
+}
+
+inline bool sub_words_adx(std::uint64_t* r, const std::uint64_t* a,
+                          std::size_t n) {
+  bool borrow = false;
+  if (std::size_t blocks = n / 4) {
+    std::uint64_t t;
+    asm("clc\n"
+        "1:\n\t"
+        "movq (%[a]), %[t]\n\t"
+        "sbbq %[t], (%[r])\n\t"
+        "movq 8(%[a]), %[t]\n\t"
+        "sbbq %[t], 8(%[r])\n\t"
+        "movq 16(%[a]), %[t]\n\t"
+        "sbbq %[t], 16(%[r])\n\t"
+        "movq 24(%[a]), %[t]\n\t"
+        "sbbq %[t], 24(%[r])\n\t"
+        "leaq 32(%[a]), %[a]\n\t"
+        "leaq 32(%[r]), %[r]\n\t"
+        "decq %[n]\n\t"
+        "jnz 1b\n\t"
+        "setc %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [n] "+r"(blocks), [t] "=&r"(t),
+          [c] "=r"(borrow)
+        :
+        : "cc", "memory");
+  }
+  for (std::size_t i = 0; i < n % 4; ++i) {
+    auto diff = Word_kernels_uint128(r[i]) - a[i] - borrow;
+    r[i] = std::uint64_t(diff);
+    borrow = (diff >> 64) != 0;
+  }
+  return borrow;
+}
+
+inline std::uint64_t mul_word_adx(std::uint64_t* r, std::size_t n,
+                                  std::uint64_t w) {
+  std::uint64_t carry = 0;
+  if (std::size_t blocks = n / 4) {
+    std::uint64_t l0, l1, h0, h1;
+    asm("clc\n"
+        "1:\n\t"
+        "mulxq (%[r]), %[l0], %[h0]\n\t"
+        "adcq %[carry], %[l0]\n\t"
+        "movq %[l0], (%[r])\n\t"
+        "mulxq 8(%[r]), %[l1], %[h1]\n\t"
+        "adcq %[h0], %[l1]\n\t"
+        "movq %[l1], 8(%[r])\n\t"
+        "mulxq 16(%[r]), %[l0], %[h0]\n\t"
+        "adcq %[h1], %[l0]\n\t"
+        "movq %[l0], 16(%[r])\n\t"
+        "mulxq 24(%[r]), %[l1], %[carry]\n\t"
+        "adcq %[h0], %[l1]\n\t"
+        "movq %[l1], 24(%[r])\n\t"
+        "leaq 32(%[r]), %[r]\n\t"
+        "decq %[n]\n\t"
+        "jnz 1b\n\t"
+        "adcq $0, %[carry]"
+        : [r] "+r"(r), [n] "+r"(blocks), [carry] "+r"(carry), [l0] "=&r"(l0),
+          [l1] "=&r"(l1), [h0] "=&r"(h0), [h1] "=&r"(h1)
+        : "d"(w)
+        : "cc", "memory");
+  }
+  for (std::size_t i = 0; i < n % 4; ++i) {
+    auto p = Word_kernels_uint128(r[i]) * w + carry;
+    r[i] = std::uint64_t(p);
+    carry = std::uint64_t(p >> 64);
+  }
+  return carry;
+}
+
+inline std::uint64_t addmul_adx(std::uint64_t* r, const std::uint64_t* a,
+                                std::size_t n, std::uint64_t w) {
+  std::uint64_t carry = 0;
+  if (std::size_t blocks = n / 4) {
+    std::uint64_t l0, l1, h0, h1;
+    // Adding the high word of the previous product runs on CF, adding r on
+    // OF. Both flags carry into the next word, so they end up in carry.
+    asm("xorl %k[l0], %k[l0]\n"
+        "1:\n\t"
+        "mulxq (%[a]), %[l0], %[h0]\n\t"
+        "adcxq %[carry], %[l0]\n\t"
+        "adoxq (%[r]), %[l0]\n\t"
+        "movq %[l0], (%[r])\n\t"
+        "mulxq 8(%[a]), %[l1], %[h1]\n\t"
+        "adcxq %[h0], %[l1]\n\t"
+        "adoxq 8(%[r]), %[l1]\n\t"
+        "movq %[l1], 8(%[r])\n\t"
+        "mulxq 16(%[a]), %[l0], %[h0]\n\t"
+        "adcxq %[h1], %[l0]\n\t"
+        "adoxq 16(%[r]), %[l0]\n\t"
+        "movq %[l0], 16(%[r])\n\t"
+        "mulxq 24(%[a]), %[l1], %[carry]\n\t"
+        "adcxq %[h0], %[l1]\n\t"
+        "adoxq 24(%[r]), %[l1]\n\t"
+        "movq %[l1], 24(%[r])\n\t"
+        "leaq 32(%[a]), %[a]\n\t"
+        "leaq 32(%[r]), %[r]\n\t"
+        "leaq -1(%[n]), %[n]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "movl $0, %k[l0]\n\t"
+        "adcxq %[l0], %[carry]\n\t"
+        "adoxq %[l0], %[carry]"
+        : [r] "+r"(r), [a] "+r"(a), [n] "+c"(blocks), [carry] "+r"(carry),
+          [l0] "=&r"(l0), [l1] "=&r"(l1), [h0] "=&r"(h0), [h1] "=&r"(h1)
+        : "d"(w)
+        : "cc", "memory");
+  }
+  for (std::size_t i = 0; i < n % 4; ++i) {
+    auto p = Word_kernels_uint128(a[i]) * w + r[i] + carry;
+    r[i] = std::uint64_t(p);
+    carry = std::uint64_t(p >> 64);
+  }
+  return carry;
+}
+
+__attribute__((target("bmi2"))) inline void lshift_words_adx(
+    std::uint64_t* r, const std::uint64_t* src, std::size_t n,
+    unsigned shift) {
+  for (std::size_t i = n - 1; i > 0; --i) {
+    r[i] = (src[i] << shift) | (src[i - 1] >> (64 - shift));
+  }
+  r[0] = src[0] << shift;
+}
+
+__attribute__((target("bmi2"))) inline void rshift_words_adx(
+    std::uint64_t* r, const std::uint64_t* src, std::size_t n,
+    unsigned shift) {
+  for (std::size_t i = 0; i + 1 < n; ++i) {
+    r[i] = (src[i] >> shift) | (src[i + 1] << (64 - shift));
+  }
+  r[n - 1] = src[n - 1] >> shift;
+}
+
+inline std::uint64_t divmod_word_adx(std::uint64_t* r, std::size_t n,
+                                     std::uint64_t d) {
+  std::uint64_t rem = 0;
+  while (n--) {
+    std::uint64_t q = r[n];
+    // rem < d, so the quotient always fits.
+    asm("divq %[d]" : "+a"(q), "+d"(rem) : [d] "r"(d) : "cc");
+    r[n] = q;
+  }
+  return rem;
+}
+
+constexpr Word_kernels adx_word_kernels = {
+    add_words_adx,    sub_words_adx,    mul_word_adx,   addmul_adx,
+    lshift_words_adx, rshift_words_adx, divmod_word_adx};
+
+// Sizes from which the kernels beat the loops in Int_storage, which the
+// compiler inlines and unrolls. Multiplications call addmul once per row,
+// and the shifts gain little from bmi2.
+constexpr std::size_t word_kernels_min_words = 8;
+constexpr std::size_t addmul_kernel_min_words = 16;
+constexpr std::size_t shift_kernels_min_words = 32;
+
+// The kernels for the running CPU, or null when the portable code in
+// Int_storage is the best there is. Chosen on first call.
+inline const Word_kernels* word_kernels() {
+  static const Word_kernels* kernels =
+      isa() >= Isa::adx && isa_supported(Isa::adx) ? &adx_word_kernels
+                                                    : nullptr;
+  return kernels;
+}
+#endif
+}  // namespace detail
+}  // namespace vecpp
+
+#endif
@@ -0,0 +1,551 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_DYNAMIC_INCLUDED_H
+#define VECPP_AP_INT_DYNAMIC_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/int_storage.h"
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/limb_pool.h"
+#include "vecpp/ap_math/ap_int/small.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vecpp {
+
+// Signed integer whose width follows its value. The magnitude is kept as
+// its used words only, least significant first, so operations never touch
+// empty high words. Up to inline_words words are stored in the object
+// itself, larger values come from a std::pmr::memory_resource, by default
+// std::pmr::get_default_resource(). Arithmetic goes through the same word
+// routines as Int_storage.
+//
+// Dyn_ap_int is allocator-aware: it can be given an allocator_type as the
+// last constructor argument, and std::pmr containers pass theirs down. The
+// results of operators use the resource of their left operand. With a
+// Limb_pool for resource, chains of operations stop allocating once the
+// pool has blocks of every size they use, and the temporaries of divisions
+// and conversions to text come from a per thread scratch arena.
+template <std::size_t inline_words = 4>
+class Dyn_ap_int {
+ public:
+  using Word = std::uint64_t;
+  using allocator_type = std::pmr::polymorphic_allocator<Word>;
+  static_assert(inline_words >= 1);
+
+  Dyn_ap_int() = default;
+  explicit Dyn_ap_int(const allocator_type& alloc) : alloc_(alloc) {}
+
+  template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  Dyn_ap_int(T v, const allocator_type& alloc = {}) : alloc_(alloc) {
+    if constexpr (std::is_signed_v<T>) {
+      negative_ = v < 0;
+    }
+    // Two's complement negation, exact for the lowest value too.
+    Word w = Word(v);
+    set_word(negative_ ? ~w + 1 : w);
+  }
+
+  template <std::size_t bits>
+  Dyn_ap_int(const Large_ap_uint<bits>& v, const allocator_type& alloc = {})
+      : alloc_(alloc) {
+    assign_limbs(v.limbs(), Large_ap_uint<bits>::Storage::words);
+  }
+
+  template <std::size_t bits>
+  Dyn_ap_int(const Large_ap_int<bits>& v, const allocator_type& alloc = {})
+      : alloc_(alloc) {
+    bool negative = v.data_.get_bit(bits - 1);
+    // Bits past the width are clear, so the lowest value reads as its own
+    // magnitude.
+    Large_ap_int<bits> magnitude = negative ? -v : v;
+    assign_limbs(magnitude.limbs(), Large_ap_int<bits>::Storage::words);
+    negative_ = negative;
+  }
+
+  template <std::size_t bits, bool is_signed>
+  Dyn_ap_int(const Small_ap_int<bits, is_signed>& v,
+             const allocator_type& alloc = {})
+      : Dyn_ap_int(
+            typename detail::Small_storage_selector<bits, is_signed>::type(v),
+            alloc) {}
+
+  // Decimal, with an optional leading '-'.
+  explicit Dyn_ap_int(std::string_view digits,
+                      const allocator_type& alloc = {});
+
+  // Copies get the default resource unless given one, like std::pmr
+  // containers. Moves keep the resource of other.
+  Dyn_ap_int(const Dyn_ap_int& other) { *this = other; }
+  Dyn_ap_int(const Dyn_ap_int& other, const allocator_type& alloc)
+      : alloc_(alloc) {
+    *this = other;
+  }
+  Dyn_ap_int(Dyn_ap_int&& other) noexcept : alloc_(other.alloc_) {
+    *this = std::move(other);
+  }
+  Dyn_ap_int(Dyn_ap_int&& other, const allocator_type& alloc)
+      : alloc_(alloc) {
+    *this = std::move(other);
+  }
+
+  Dyn_ap_int& operator=(const Dyn_ap_int& other) {
+    if (this != &other) {
+      reserve(other.size_);
+      std::copy(other.data(), other.data() + other.size_, data());
+      size_ = other.size_;
+      negative_ = other.negative_;
+    }
+    return *this;
+  }
+
+  // Copies when the resources differ. Either way other is left zero.
+  Dyn_ap_int& operator=(Dyn_ap_int&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    if (other.heap_ && alloc_ == other.alloc_) {
+      // other gets the old words of this.
+      std::swap(heap_, other.heap_);
+      std::swap(capacity_, other.capacity_);
+    } else {
+      reserve(other.size_);
+      std::copy(other.data(), other.data() + other.size_, data());
+    }
+    size_ = std::exchange(other.size_, 0);
+    negative_ = std::exchange(other.negative_, false);
+    return *this;
+  }
+
+  ~Dyn_ap_int() {
+    if (heap_) {
+      alloc_.deallocate(heap_, capacity_);
+    }
+  }
+
+  allocator_type get_allocator() const { return alloc_; }
+
+  // The value modulo 2^bits, in two's complement for the signed types.
+  template <std::size_t bits>
+  explicit operator Large_ap_uint<bits>() const {
+    Large_ap_uint<bits> result{0};
+    copy_low_words(result.data_);
+    return negative_ ? Large_ap_uint<bits>{0} - result : result;
+  }
+
+  template <std::size_t bits>
+  explicit operator Large_ap_int<bits>() const {
+    Large_ap_int<bits> result{0};
+    copy_low_words(result.data_);
+    return negative_ ? -result : result;
+  }
+
+  template <std::size_t bits, bool is_signed>
+  explicit operator Small_ap_int<bits, is_signed>() const {
+    using Storage =
+        typename detail::Small_storage_selector<bits, is_signed>::type;
+    Word w = size_ == 0 ? 0 : data()[0];
+    return Small_ap_int<bits, is_signed>(Storage(negative_ ? ~w + 1 : w));
+  }
+
+  // Used words of the magnitude, the top one is not 0. Zero has none.
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return heap_ ? capacity_ : inline_words; }
+  bool is_inline() const { return heap_ == nullptr; }
+  const Word* limbs() const { return data(); }
+
+  bool is_negative() const { return negative_; }
+  bool is_zero() const { return size_ == 0; }
+  // Number of bits of the magnitude.
+  std::size_t bit_width() const {
+    return size_ == 0 ? 0
+                      : size_ * 64 - detail::word_leading_zeros(top_word());
+  }
+
+  // Makes room for words words of magnitude.
+  void reserve(std::size_t words);
+
+  int compare(const Dyn_ap_int& rhs) const;
+
+  Dyn_ap_int operator-() const {
+    Dyn_ap_int result(*this, alloc_);
+    result.negative_ = !negative_ && size_ != 0;
+    return result;
+  }
+
+  Dyn_ap_int& operator+=(const Dyn_ap_int& rhs) {
+    add_signed(rhs, rhs.negative_);
+    return *this;
+  }
+  Dyn_ap_int& operator-=(const Dyn_ap_int& rhs) {
+    add_signed(rhs, !rhs.negative_ && rhs.size_ != 0);
+    return *this;
+  }
+  Dyn_ap_int& operator*=(const Dyn_ap_int& rhs) {
+    return *this = *this * rhs;
+  }
+  Dyn_ap_int& operator/=(const Dyn_ap_int& rhs) {
+    divmod(*this, rhs, this, nullptr);
+    return *this;
+  }
+  Dyn_ap_int& operator%=(const Dyn_ap_int& rhs) {
+    divmod(*this, rhs, nullptr, this);
+    return *this;
+  }
+  Dyn_ap_int& operator<<=(std::uint64_t shift);
+  // Rounds toward negative infinity, like the arithmetic shift of
+  // Large_ap_int.
+  Dyn_ap_int& operator>>=(std::uint64_t shift);
+
+  friend Dyn_ap_int operator+(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs) {
+    Dyn_ap_int result(lhs, lhs.alloc_);
+    return result += rhs;
+  }
+  friend Dyn_ap_int operator-(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs) {
+    Dyn_ap_int result(lhs, lhs.alloc_);
+    return result -= rhs;
+  }
+  friend Dyn_ap_int operator*(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs) {
+    Dyn_ap_int result(lhs.alloc_);
+    result.mul(lhs, rhs);
+    return result;
+  }
+  // Truncates toward zero, the remainder takes the sign of lhs.
+  friend Dyn_ap_int operator/(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs) {
+    Dyn_ap_int quot(lhs.alloc_);
+    divmod(lhs, rhs, &quot, nullptr);
+    return quot;
+  }
+  friend Dyn_ap_int operator%(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs) {
+    Dyn_ap_int rem(lhs.alloc_);
+    divmod(lhs, rhs, nullptr, &rem);
+    return rem;
+  }
+  friend Dyn_ap_int operator<<(const Dyn_ap_int& lhs, std::uint64_t shift) {
+    Dyn_ap_int result(lhs, lhs.alloc_);
+    return result <<= shift;
+  }
+  friend Dyn_ap_int operator>>(const Dyn_ap_int& lhs, std::uint64_t shift) {
+    Dyn_ap_int result(lhs, lhs.alloc_);
+    return result >>= shift;
+  }
+
+  friend bool operator==(const Dyn_ap_int& l, const Dyn_ap_int& r) {
+    return l.compare(r) == 0;
+  }
+  friend bool operator!=(const Dyn_ap_int& l, const Dyn_ap_int& r) {
+    return l.compare(r) != 0;
+  }
+  friend bool operator<(const Dyn_ap_int& l, const Dyn_ap_int& r) {
+    return l.compare(r) < 0;
+  }
+  friend bool operator<=(const Dyn_ap_int& l, const Dyn_ap_int& r) {
+    return l.compare(r) <= 0;
+  }
+  friend bool operator>(const Dyn_ap_int& l, const Dyn_ap_int& r) {
+    return l.compare(r) > 0;
+  }
+  friend bool operator>=(const Dyn_ap_int& l, const Dyn_ap_int& r) {
+    return l.compare(r) >= 0;
+  }
+
+  template <std::size_t n>
+  friend std::ostream& operator<<(std::ostream&, const Dyn_ap_int<n>&);
+
+ private:
+  Word* data() { return heap_ ? heap_ : inline_; }
+  const Word* data() const { return heap_ ? heap_ : inline_; }
+  Word top_word() const { return data()[size_ - 1]; }
+
+  void set_word(Word w) {
+    inline_[0] = w;
+    size_ = w != 0;
+  }
+
+  void assign_limbs(const Word* limbs, std::size_t words) {
+    std::size_t used = detail::limbs_used(limbs, words);
+    size_ = 0;
+    reserve(used);
+    std::copy(limbs, limbs + used, data());
+    size_ = used;
+    negative_ = false;
+  }
+
+  // Zero extends the magnitude to words words.
+  void extend(std::size_t words) {
+    reserve(words);
+    std::fill(data() + size_, data() + std::max(size_, words), Word(0));
+    size_ = std::max(size_, words);
+  }
+
+  // Drops the high zero words, zero has no sign.
+  void normalize() {
+    size_ = detail::limbs_used(data(), size_);
+    negative_ = negative_ && size_ != 0;
+  }
+
+  template <typename Storage>
+  void copy_low_words(Storage& out) const {
+    std::copy(data(), data() + std::min(size_, Storage::words), out.data_);
+    out.clear_unused_bits();
+  }
+
+  int compare_magnitude(const Dyn_ap_int& rhs) const {
+    if (size_ != rhs.size_) {
+      return size_ < rhs.size_ ? -1 : 1;
+    }
+    return detail::limbs_compare(data(), rhs.data(), size_);
+  }
+
+  void add_signed(const Dyn_ap_int& rhs, bool rhs_negative);
+  void mul(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs);
+  static void divmod(const Dyn_ap_int& lhs, const Dyn_ap_int& rhs,
+                     Dyn_ap_int* quot, Dyn_ap_int* rem);
+
+  allocator_type alloc_;
+  Word* heap_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t size_ = 0;
+  bool negative_ = false;
+  Word inline_[inline_words];
+};
+
+template <std::size_t inline_words>
+Dyn_ap_int<inline_words>::Dyn_ap_int(std::string_view digits,
+                                     const allocator_type& alloc)
+    : alloc_(alloc) {
+  bool negative = !digits.empty() && digits[0] == '-';
+  if (negative) {
+    digits.remove_prefix(1);
+  }
+  // 19 digits at a time, the most a word holds.
+  while (!digits.empty()) {
+    std::size_t count = std::min<std::size_t>(digits.size(), 19);
+    Word scale = 1;
+    Word chunk = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      assert(digits[i] >= '0' && digits[i] <= '9');
+      scale *= 10;
+      chunk = chunk * 10 + Word(digits[i] - '0');
+    }
+    digits.remove_prefix(count);
+
+    // this = this * scale + chunk, the carry out fits in a word.
+    Word* d = data();
+    Word carry = detail::limbs_mul_word(d, size_, scale);
+    for (std::size_t i = 0; chunk != 0 && i < size_; ++i) {
+      d[i] += chunk;
+      chunk = d[i] < chunk;
+    }
+    carry += chunk;
+    if (carry != 0) {
+      extend(size_ + 1);
+      data()[size_ - 1] = carry;
+    }
+  }
+  negative_ = negative && size_ != 0;
+}
+
+template <std::size_t inline_words>
+void Dyn_ap_int<inline_words>::reserve(std::size_t words) {
+  if (words <= capacity()) {
+    return;
+  }
+  // Geometric growth, so repeated small growths stay cheap.
+  std::size_t capacity = std::max(words, 2 * this->capacity());
+  Word* heap = alloc_.allocate(capacity);
+  std::copy(data(), data() + size_, heap);
+  if (heap_) {
+    alloc_.deallocate(heap_, capacity_);
+  }
+  heap_ = heap;
+  capacity_ = capacity;
+}
+
+template <std::size_t inline_words>
+int Dyn_ap_int<inline_words>::compare(const Dyn_ap_int& rhs) const {
+  if (negative_ != rhs.negative_) {
+    return negative_ ? -1 : 1;
+  }
+  int magnitude = compare_magnitude(rhs);
+  return negative_ ? -magnitude : magnitude;
+}
+
+// this += rhs, with rhs_negative in place of the sign of rhs. rhs may be
+// this.
+template <std::size_t inline_words>
+void Dyn_ap_int<inline_words>::add_signed(const Dyn_ap_int& rhs,
+                                          bool rhs_negative) {
+  std::size_t n = rhs.size_;
+  if (negative_ == rhs_negative) {
+    extend(std::max(size_, n) + 1);
+    Word* d = data();
+    Word carry = detail::limbs_add(d, rhs.data(), n);
+    for (std::size_t i = n; carry != 0; ++i) {
+      d[i] += 1;
+      carry = d[i] == 0;
+    }
+  } else if (compare_magnitude(rhs) >= 0) {
+    Word* d = data();
+    Word borrow = detail::limbs_sub(d, rhs.data(), n);
+    for (std::size_t i = n; borrow != 0; ++i) {
+      borrow = d[i] == 0;
+      d[i] -= 1;
+    }
+  } else {
+    // |rhs| - |this| as -|this| + |rhs| in two's complement over the words
+    // of rhs, the carry out of the top word is dropped.
+    extend(n);
+    Word* d = data();
+    for (std::size_t i = 0; i < n; ++i) {
+      d[i] = ~d[i];
+    }
+    for (std::size_t i = 0; i < n && ++d[i] == 0; ++i) {
+    }
+    detail::limbs_add(d, rhs.data(), n);
+    negative_ = rhs_negative;
+  }
+  normalize();
+}
+
+// Schoolbook multiplication over the used words only. this is neither lhs
+// nor rhs.
+template <std::size_t inline_words>
+void Dyn_ap_int<inline_words>::mul(const Dyn_ap_int& lhs,
+                                   const Dyn_ap_int& rhs) {
+  std::size_t m = lhs.size_;
+  std::size_t n = rhs.size_;
+  size_ = 0;
+  extend(m + n);
+  Word* d = data();
+  for (std::size_t i = 0; i < n; ++i) {
+    // Row i ends one word past the rows before it.
+    d[i + m] = detail::limbs_addmul(d + i, lhs.data(), m, rhs.data()[i]);
+  }
+  negative_ = lhs.negative_ != rhs.negative_;
+  normalize();
+}
+
+template <std::size_t inline_words>
+void Dyn_ap_int<inline_words>::divmod(const Dyn_ap_int& lhs,
+                                      const Dyn_ap_int& rhs,
+                                      Dyn_ap_int* quot, Dyn_ap_int* rem) {
+  assert(rhs.size_ != 0 && "Division by zero");
+  std::size_t m = lhs.size_;
+  std::size_t n = rhs.size_;
+  bool quot_negative = lhs.negative_ != rhs.negative_;
+  bool rem_negative = lhs.negative_;
+
+  Dyn_ap_int q(lhs.alloc_);
+  Dyn_ap_int r(lhs.alloc_);
+  if (lhs.compare_magnitude(rhs) < 0) {
+    r = lhs;
+  } else if (n == 1) {
+    q = lhs;
+    r = Dyn_ap_int(detail::limbs_divmod_word(q.data(), m, rhs.data()[0]));
+  } else {
+    q.extend(m - n + 1);
+    r.extend(n);
+    // The normalized operands.
+    detail::Scratch scratch(m + n + 1);
+    Word* u = scratch.data();
+    detail::limbs_divmod(q.data(), r.data(), lhs.data(), m, rhs.data(), n, u,
+                         u + m + 1);
+  }
+  q.negative_ = quot_negative;
+  r.negative_ = rem_negative;
+  q.normalize();
+  r.normalize();
+  if (quot) {
+    *quot = std::move(q);
+  }
+  if (rem) {
+    *rem = std::move(r);
+  }
+}
+
+template <std::size_t inline_words>
+Dyn_ap_int<inline_words>& Dyn_ap_int<inline_words>::operator<<=(
+    std::uint64_t shift) {
+  if (size_ == 0 || shift == 0) {
+    return *this;
+  }
+  std::size_t word_shift = shift / 64;
+  unsigned bit_shift = unsigned(shift % 64);
+  std::size_t n = size_;
+  extend(n + word_shift + 1);
+  Word* d = data();
+  if (bit_shift != 0) {
+    d[n + word_shift] = d[n - 1] >> (64 - bit_shift);
+    detail::limbs_lshift(d + word_shift, d, n, bit_shift);
+  } else {
+    std::copy_backward(d, d + n, d + n + word_shift);
+  }
+  std::fill(d, d + word_shift, Word(0));
+  normalize();
+  return *this;
+}
+
+template <std::size_t inline_words>
+Dyn_ap_int<inline_words>& Dyn_ap_int<inline_words>::operator>>=(
+    std::uint64_t shift) {
+  if (size_ == 0 || shift == 0) {
+    return *this;
+  }
+  // -((|x| - 1) >> shift) - 1 for negative values.
+  bool negative = negative_;
+  if (negative) {
+    *this += Dyn_ap_int(1);
+  }
+  std::size_t word_shift = std::min<std::uint64_t>(shift / 64, size_);
+  unsigned bit_shift = unsigned(shift % 64);
+  Word* d = data();
+  std::size_t n = size_ - word_shift;
+  if (bit_shift != 0 && n != 0) {
+    detail::limbs_rshift(d, d + word_shift, n, bit_shift);
+  } else {
+    std::copy(d + word_shift, d + size_, d);
+  }
+  size_ = n;
+  normalize();
+  if (negative) {
+    negative_ = size_ != 0;
+    *this -= Dyn_ap_int(1);
+  }
+  return *this;
+}
+
+template <std::size_t inline_words>
+std::ostream& operator<<(std::ostream& stream,
+                         const Dyn_ap_int<inline_words>& num) {
+  // The words, then room for the digits and the sign.
+  std::size_t n = num.size_;
+  std::size_t chars = detail::limbs_decimal_digits(n) + 1;
+  detail::Scratch scratch(n + (chars + 7) / 8);
+  std::uint64_t* words = scratch.data();
+  std::copy(num.data(), num.data() + n, words);
+  char* end = reinterpret_cast<char*>(words + n) + chars;
+  char* first = detail::limbs_to_decimal(words, n, end);
+  if (num.negative_) {
+    *--first = '-';
+  }
+  return stream << std::string_view(first, std::size_t(end - first));
+}
+
+}  // namespace vecpp
+
+#endif
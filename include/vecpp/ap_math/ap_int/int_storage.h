@@ -1,15 +1,44 @@
 #ifndef VECPP_AP_MATH_INT_STORAGE_H_INCLUDED
 #define VECPP_AP_MATH_INT_STORAGE_H_INCLUDED
 
+#include "vecpp/ap_math/ap_int/dispatch.h"
+
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <climits>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_clzll) && __has_builtin(__builtin_ctzll)
+#define VECPP_AP_MATH_HAS_BIT_SCAN
+#endif
+// from_bytes() and to_bytes() copy whole words at run time.
+#if __has_builtin(__builtin_is_constant_evaluated) && \
+    __has_builtin(__builtin_bswap64) && defined(__BYTE_ORDER__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define VECPP_AP_MATH_HAS_WORD_BYTES
+#endif
+#endif
+#endif
 
 namespace vecpp {
+
+// Byte order of the buffers of from_bytes() and to_bytes().
+enum class Endian { little, big };
+
 namespace detail {
 
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 Uint128;
+#endif
+
 template <typename T>
 constexpr T low_half(T v) {
   constexpr T mask_bits = (sizeof(T) * CHAR_BIT) / 2;
@@ -23,6 +52,383 @@ constexpr T high_half(T v) {
   return v >> mask_bits;
 }
 
+// Number of leading zero bits in v. v must not be 0.
+template <typename T>
+constexpr std::size_t word_leading_zeros(T v) {
+  constexpr std::size_t word_bits = sizeof(T) * CHAR_BIT;
+#ifdef VECPP_AP_MATH_HAS_BIT_SCAN
+  if constexpr (word_bits <= sizeof(unsigned long long) * CHAR_BIT) {
+    constexpr std::size_t padding =
+        sizeof(unsigned long long) * CHAR_BIT - word_bits;
+    return std::size_t(__builtin_clzll(v)) - padding;
+  }
+#endif
+  std::size_t result = 0;
+  for (std::size_t half = word_bits / 2; half != 0; half /= 2) {
+    if ((v >> (word_bits - half)) == 0) {
+      result += half;
+      v <<= half;
+    }
+  }
+  return result;
+}
+
+// Number of trailing zero bits in v. v must not be 0.
+template <typename T>
+constexpr std::size_t word_trailing_zeros(T v) {
+  constexpr std::size_t word_bits = sizeof(T) * CHAR_BIT;
+#ifdef VECPP_AP_MATH_HAS_BIT_SCAN
+  if constexpr (word_bits <= sizeof(unsigned long long) * CHAR_BIT) {
+    return std::size_t(__builtin_ctzll(v));
+  }
+#endif
+  // Isolates the lowest set bit.
+  return word_bits - 1 - word_leading_zeros(T(v & (~v + 1)));
+}
+
+// Full product of two words, returns {low, high}.
+template <typename T>
+constexpr std::pair<T, T> mul_wide(T a, T b) {
+#ifdef __SIZEOF_INT128__
+  if constexpr (sizeof(T) == sizeof(std::uint64_t)) {
+    auto p = Uint128(a) * b;
+    return {T(p), T(p >> 64)};
+  }
+#endif
+  constexpr std::size_t half_bits = (sizeof(T) * CHAR_BIT) / 2;
+  T ll = low_half(a) * low_half(b);
+  T lh = low_half(a) * high_half(b);
+  T hl = high_half(a) * low_half(b);
+  T hh = high_half(a) * high_half(b);
+
+  T mid = high_half(ll) + low_half(lh) + low_half(hl);
+  return {(mid << half_bits) | low_half(ll),
+          hh + high_half(lh) + high_half(hl) + high_half(mid)};
+}
+
+// Divides the double-word [hi, lo] by d, returns {quotient, remainder}.
+// hi must be < d so that the quotient fits in a single word.
+template <typename T>
+constexpr std::pair<T, T> div_wide(T hi, T lo, T d) {
+  assert(hi < d);
+#ifdef __SIZEOF_INT128__
+  if constexpr (sizeof(T) == sizeof(std::uint64_t)) {
+    auto num = (Uint128(hi) << 64) | lo;
+    return {T(num / d), T(num % d)};
+  }
+#endif
+  // Knuth's algorithm D on half-words (see Hacker's Delight, divlu).
+  constexpr std::size_t word_bits = sizeof(T) * CHAR_BIT;
+  constexpr std::size_t half_bits = word_bits / 2;
+  constexpr T base = T(1) << half_bits;
+
+  std::size_t s = word_leading_zeros(d);
+  d <<= s;
+  T un32 = s == 0 ? hi : (hi << s) | (lo >> (word_bits - s));
+  T un10 = lo << s;
+
+  T vn1 = high_half(d);
+  T vn0 = low_half(d);
+  T un1 = high_half(un10);
+  T un0 = low_half(un10);
+
+  T q1 = un32 / vn1;
+  T rhat = un32 - q1 * vn1;
+  while (q1 >= base || q1 * vn0 > base * rhat + un1) {
+    --q1;
+    rhat += vn1;
+    if (rhat >= base) {
+      break;
+    }
+  }
+
+  T un21 = un32 * base + un1 - q1 * d;
+  T q0 = un21 / vn1;
+  rhat = un21 - q0 * vn1;
+  while (q0 >= base || q0 * vn0 > base * rhat + un0) {
+    --q0;
+    rhat += vn1;
+    if (rhat >= base) {
+      break;
+    }
+  }
+
+  return {q1 * base + q0, (un21 * base + un0 - q0 * d) >> s};
+}
+
+// The run time kernels when n words are at least min_words, null for other
+// word types and during constant evaluation.
+template <typename Word>
+constexpr const Word_kernels* runtime_word_kernels(
+    std::size_t n, std::size_t min_words = word_kernels_min_words) {
+#ifdef VECPP_AP_INT_HAS_WORD_KERNELS
+  if constexpr (std::is_same_v<Word, std::uint64_t>) {
+    if (n >= min_words && !__builtin_is_constant_evaluated()) {
+      return word_kernels();
+    }
+  }
+#endif
+  (void)n;
+  (void)min_words;
+  return nullptr;
+}
+
+// Routines on runs of n words, least significant first, shared by
+// Int_storage and Dyn_ap_int. Each one picks the run time kernels on its
+// own when n is large enough.
+
+// r += a, returns the carry.
+template <typename Word>
+constexpr bool limbs_add(Word* r, const Word* a, std::size_t n) {
+  if (auto kernels = runtime_word_kernels<Word>(n)) {
+    return kernels->add(r, a, n);
+  }
+
+  // Branch free, random carries would defeat the predictor.
+  Word carry = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    Word sum = r[i] + a[i];
+    Word c = sum < a[i];
+    r[i] = sum + carry;
+    carry = c | (r[i] < carry);
+  }
+  return carry != 0;
+}
+
+// r -= a, returns the borrow.
+template <typename Word>
+constexpr bool limbs_sub(Word* r, const Word* a, std::size_t n) {
+  if (auto kernels = runtime_word_kernels<Word>(n)) {
+    return kernels->sub(r, a, n);
+  }
+
+  Word borrow = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    Word l = r[i];
+    Word diff = l - a[i];
+    Word b = l < a[i];
+    r[i] = diff - borrow;
+    borrow = b | (diff < borrow);
+  }
+  return borrow != 0;
+}
+
+// r *= w, returns the carry word.
+template <typename Word>
+constexpr Word limbs_mul_word(Word* r, std::size_t n, Word w) {
+  if (auto kernels = runtime_word_kernels<Word>(n)) {
+    return kernels->mul_word(r, n, w);
+  }
+
+  Word carry = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    // [ LOW, HIGH ] = MULTIPLIER * SRC[i] + CARRY.
+    auto [low, high] = mul_wide(r[i], w);
+    low += carry;
+    high += low < carry;
+    r[i] = low;
+    carry = high;
+  }
+  return carry;
+}
+
+// r += a * w, returns the carry word.
+template <typename Word>
+constexpr Word limbs_addmul(Word* r, const Word* a, std::size_t n, Word w) {
+  if (auto kernels = runtime_word_kernels<Word>(n, addmul_kernel_min_words)) {
+    return kernels->addmul(r, a, n, w);
+  }
+
+  Word carry = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto [low, high] = mul_wide(a[i], w);
+    low += carry;
+    high += low < carry;
+    low += r[i];
+    high += low < r[i];
+    r[i] = low;
+    carry = high;
+  }
+  return carry;
+}
+
+// r /= d, returns the remainder. d must not be 0.
+template <typename Word>
+constexpr Word limbs_divmod_word(Word* r, std::size_t n, Word d) {
+  assert(d != 0);
+  if (auto kernels = runtime_word_kernels<Word>(n)) {
+    return kernels->divmod_word(r, n, d);
+  }
+
+  Word rem = 0;
+  while (n--) {
+    auto qr = div_wide(rem, r[n], d);
+    r[n] = qr.first;
+    rem = qr.second;
+  }
+  return rem;
+}
+
+// r = src << shift and r = src >> shift within n words, with
+// 0 < shift < bits per word. r may overlap src on the side the shift moves
+// away from.
+template <typename Word>
+constexpr void limbs_lshift(Word* r, const Word* src, std::size_t n,
+                            unsigned shift) {
+  constexpr unsigned bits_per_word = sizeof(Word) * CHAR_BIT;
+  if (auto kernels = runtime_word_kernels<Word>(n, shift_kernels_min_words)) {
+    kernels->lshift(r, src, n, shift);
+    return;
+  }
+
+  for (std::size_t i = n; i-- > 0;) {
+    r[i] = src[i] << shift;
+    if (i > 0) {
+      r[i] |= src[i - 1] >> (bits_per_word - shift);
+    }
+  }
+}
+
+template <typename Word>
+constexpr void limbs_rshift(Word* r, const Word* src, std::size_t n,
+                            unsigned shift) {
+  constexpr unsigned bits_per_word = sizeof(Word) * CHAR_BIT;
+  if (auto kernels = runtime_word_kernels<Word>(n, shift_kernels_min_words)) {
+    kernels->rshift(r, src, n, shift);
+    return;
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    r[i] = src[i] >> shift;
+    if (i + 1 < n) {
+      r[i] |= src[i + 1] << (bits_per_word - shift);
+    }
+  }
+}
+
+template <typename Word>
+constexpr int limbs_compare(const Word* a, const Word* b, std::size_t n) {
+  // Equal high words four at a time, as small values share their zeros.
+  while (n >= 4 && ((a[n - 1] ^ b[n - 1]) | (a[n - 2] ^ b[n - 2]) |
+                    (a[n - 3] ^ b[n - 3]) | (a[n - 4] ^ b[n - 4])) == 0) {
+    n -= 4;
+  }
+  while (n--) {
+    if (a[n] != b[n]) {
+      return (a[n] > b[n]) ? 1 : -1;
+    }
+  }
+  return 0;
+}
+
+// Number of words up to and including the highest non-zero one.
+template <typename Word>
+constexpr std::size_t limbs_used(const Word* a, std::size_t n) {
+  while (n >= 4 && (a[n - 1] | a[n - 2] | a[n - 3] | a[n - 4]) == 0) {
+    n -= 4;
+  }
+  while (n > 0 && a[n - 1] == 0) {
+    --n;
+  }
+  return n;
+}
+
+// Knuth's algorithm D (TAOCP vol. 2, 4.3.1), one quotient word per step.
+// Divides the m words of a by the n words of d, with m >= n >= 2 and
+// d[n - 1] != 0. Writes m - n + 1 quotient words and n remainder words.
+// u and v are scratch space of m + 1 and n words.
+template <typename Word>
+constexpr void limbs_divmod(Word* quot, Word* rem, const Word* a,
+                            std::size_t m, const Word* d, std::size_t n,
+                            Word* u, Word* v) {
+  assert(m >= n && n >= 2 && d[n - 1] != 0);
+  constexpr std::size_t bits_per_word = sizeof(Word) * CHAR_BIT;
+
+  // Normalize so that the divisor's top word has its high bit set, which
+  // keeps each quotient word estimate within 2 of the real value.
+  std::size_t s = word_leading_zeros(d[n - 1]);
+  auto shifted = [s](Word hi, Word lo) {
+    return s == 0 ? hi : (hi << s) | (lo >> (bits_per_word - s));
+  };
+
+  for (std::size_t i = n; i-- > 0;) {
+    v[i] = shifted(d[i], i > 0 ? d[i - 1] : 0);
+  }
+  u[m] = shifted(0, a[m - 1]);
+  for (std::size_t i = m; i-- > 0;) {
+    u[i] = shifted(a[i], i > 0 ? a[i - 1] : 0);
+  }
+
+  for (std::size_t j = m - n + 1; j-- > 0;) {
+    // Estimate from the top two words of the remainder.
+    Word qhat = ~Word(0);
+    Word rhat = 0;
+    bool rhat_overflow = false;
+    if (u[j + n] == v[n - 1]) {
+      rhat = u[j + n - 1] + v[n - 1];
+      rhat_overflow = rhat < v[n - 1];
+    } else {
+      auto qr = div_wide(u[j + n], u[j + n - 1], v[n - 1]);
+      qhat = qr.first;
+      rhat = qr.second;
+    }
+    while (!rhat_overflow) {
+      auto [low, high] = mul_wide(qhat, v[n - 2]);
+      if (high < rhat || (high == rhat && low <= u[j + n - 2])) {
+        break;
+      }
+      --qhat;
+      rhat += v[n - 1];
+      rhat_overflow = rhat < v[n - 1];
+    }
+
+    // u[j, j + n] -= qhat * v
+    Word carry = 0;
+    Word borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      auto [low, high] = mul_wide(qhat, v[i]);
+      low += carry;
+      high += low < carry;
+      carry = high;
+
+      Word diff = u[i + j] - low;
+      Word next_borrow = diff > u[i + j];
+      u[i + j] = diff - borrow;
+      next_borrow += u[i + j] > diff;
+      borrow = next_borrow;
+    }
+    Word diff = u[j + n] - carry;
+    Word next_borrow = diff > u[j + n];
+    u[j + n] = diff - borrow;
+    next_borrow += u[j + n] > diff;
+
+    // The estimate was one too large, add the divisor back.
+    if (next_borrow != 0) {
+      --qhat;
+      carry = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        Word sum = u[i + j] + v[i];
+        Word next_carry = sum < v[i];
+        u[i + j] = sum + carry;
+        next_carry += u[i + j] < sum;
+        carry = next_carry;
+      }
+      u[j + n] += carry;
+    }
+    quot[j] = qhat;
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    rem[i] = s == 0 ? u[i] : (u[i] >> s) | (u[i + 1] << (bits_per_word - s));
+  }
+}
+
+// From this many words on, Int_storage bounds its loops by the used words
+// of the operands, found by scanning down from the top word. Values of any
+// magnitude in a wide storage then cost what their used words cost, and
+// full width values pay one look at their top word.
+constexpr std::size_t used_words_min_words = 16;
+
 template <std::size_t bits, typename Word_t>
 struct Int_storage {
   static_assert(std::is_unsigned_v<Word_t>);
@@ -34,7 +440,6 @@ struct Int_storage {
       ((bits - 1) % bits_per_word) + 1;
 
   static constexpr std::size_t words = 1 + (bits - 1) / bits_per_word;
-  static_assert(words >= 2, "Use a bitfield instead");
 
   constexpr Word& operator[](std::size_t id) { return data_[id]; }
   constexpr const Word& operator[](std::size_t id) const { return data_[id]; }
@@ -69,9 +474,25 @@ struct Int_storage {
     get_word(bit_pos) |= mask_bit(bit_pos);
   }
 
+  constexpr Word get_bits(std::size_t bit_pos, std::size_t count) const;
+  constexpr void set_bits(std::size_t bit_pos, std::size_t count, Word value);
+
   constexpr void clear_unused_bits();
   constexpr void fill_unused_bits();
+  constexpr bool unused_bits_clear() const {
+    constexpr Word mask = ~Word(0) >> (bits_per_word - last_word_bits);
+    return (data_[words - 1] & ~mask) == 0;
+  }
+
+  // The value of the size bytes at data, truncated to bits.
+  constexpr void from_bytes(const std::byte* data, std::size_t size,
+                            Endian order);
+  // Writes the low size bytes, with fill past the last word.
+  constexpr void to_bytes(std::byte* out, std::size_t size, Endian order,
+                          std::byte fill = std::byte{0}) const;
   constexpr std::size_t count_leading_zeros() const;
+  constexpr std::size_t count_trailing_zeros() const;
+  constexpr std::size_t used_words() const;
 
   constexpr void invert();
   constexpr bool add(const Int_storage& rhs);
@@ -81,22 +502,60 @@ struct Int_storage {
   constexpr void binary_xor(const Int_storage& rhs);
   constexpr void lshift(uint64_t rhs);
   constexpr void rshift(uint64_t rhs);
+  constexpr void arshift(uint64_t rhs);
 
   constexpr int compare(const Int_storage& rhs) const;
   constexpr Word mul(Word rhs);
+  constexpr Word addmul(const Int_storage& src, Word rhs, std::size_t offset,
+                        std::size_t src_words = words);
+  constexpr Int_storage mul(const Int_storage& rhs) const;
+  constexpr Word divmod_word(Word rhs);
 
   constexpr std::tuple<Int_storage, Int_storage> udivmod(
       const Int_storage&) const;
 
-  std::array<Word, words> data_;
+  // A built-in array rather than a std::array: its operator[] is a function
+  // call, which every constant evaluation step pays for.
+  Word data_[words];
 };
 
+// count bits starting at bit_pos, count must be at most bits_per_word.
+template <std::size_t bits, typename Word_t>
+constexpr Word_t Int_storage<bits, Word_t>::get_bits(std::size_t bit_pos,
+                                                     std::size_t count) const {
+  assert(count > 0 && count <= bits_per_word && bit_pos + count <= bits);
+  std::size_t w = which_word(bit_pos);
+  std::size_t b = which_bit(bit_pos);
+  Word result = data_[w] >> b;
+  if (b + count > bits_per_word) {
+    result |= data_[w + 1] << (bits_per_word - b);
+  }
+  return count == bits_per_word ? result : result & ((Word(1) << count) - 1);
+}
+
+// Overwrites count bits starting at bit_pos with the low bits of value.
+template <std::size_t bits, typename Word_t>
+constexpr void Int_storage<bits, Word_t>::set_bits(std::size_t bit_pos,
+                                                   std::size_t count,
+                                                   Word value) {
+  assert(count > 0 && count <= bits_per_word && bit_pos + count <= bits);
+  Word mask = count == bits_per_word ? ~Word(0) : (Word(1) << count) - 1;
+  value &= mask;
+  std::size_t w = which_word(bit_pos);
+  std::size_t b = which_bit(bit_pos);
+  data_[w] = (data_[w] & ~(mask << b)) | (value << b);
+  if (b + count > bits_per_word) {
+    std::size_t shift = bits_per_word - b;
+    data_[w + 1] = (data_[w + 1] & ~(mask >> shift)) | (value >> shift);
+  }
+}
+
 template <std::size_t bits, typename Word_t>
 constexpr void Int_storage<bits, Word_t>::clear_unused_bits() {
   constexpr Word word_max = ~Word(0);
   constexpr Word mask = word_max >> (bits_per_word - last_word_bits);
 
-  data_.back() &= mask;
+  data_[words - 1] &= mask;
 }
 
 template <std::size_t bits, typename Word_t>
@@ -104,7 +563,73 @@ constexpr void Int_storage<bits, Word_t>::fill_unused_bits() {
   constexpr Word word_max = ~Word(0);
   constexpr Word mask = word_max >> (bits_per_word - last_word_bits);
 
-  data_.back() |= ~mask;
+  data_[words - 1] |= ~mask;
+}
+
+template <std::size_t bits, typename Word_t>
+constexpr void Int_storage<bits, Word_t>::from_bytes(const std::byte* data,
+                                                     std::size_t size,
+                                                     Endian order) {
+  constexpr std::size_t word_bytes = sizeof(Word);
+  std::size_t n = std::min(size, words * word_bytes);
+  for (auto& w : data_) {
+    w = 0;
+  }
+  std::size_t i = 0;
+#ifdef VECPP_AP_MATH_HAS_WORD_BYTES
+  if constexpr (std::is_same_v<Word, std::uint64_t>) {
+    if (!__builtin_is_constant_evaluated()) {
+      if (order == Endian::little) {
+        std::memcpy(data_, data, n);
+        i = n;
+      } else {
+        // Bytes [i, i + 8) of the value, stored backwards.
+        for (; i + word_bytes <= n; i += word_bytes) {
+          Word w = 0;
+          std::memcpy(&w, data + size - i - word_bytes, word_bytes);
+          data_[i / word_bytes] = __builtin_bswap64(w);
+        }
+      }
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    auto byte = order == Endian::little ? data[i] : data[size - 1 - i];
+    data_[i / word_bytes] |= Word(byte) << (8 * (i % word_bytes));
+  }
+  clear_unused_bits();
+}
+
+template <std::size_t bits, typename Word_t>
+constexpr void Int_storage<bits, Word_t>::to_bytes(std::byte* out,
+                                                   std::size_t size,
+                                                   Endian order,
+                                                   std::byte fill) const {
+  constexpr std::size_t word_bytes = sizeof(Word);
+  std::size_t n = std::min(size, words * word_bytes);
+  std::size_t i = 0;
+#ifdef VECPP_AP_MATH_HAS_WORD_BYTES
+  if constexpr (std::is_same_v<Word, std::uint64_t>) {
+    if (!__builtin_is_constant_evaluated()) {
+      if (order == Endian::little) {
+        std::memcpy(out, data_, n);
+        i = n;
+      } else {
+        for (; i + word_bytes <= n; i += word_bytes) {
+          Word w = __builtin_bswap64(data_[i / word_bytes]);
+          std::memcpy(out + size - i - word_bytes, &w, word_bytes);
+        }
+      }
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    auto byte = fill;
+    if (i < n) {
+      byte = std::byte(data_[i / word_bytes] >> (8 * (i % word_bytes)));
+    }
+    (order == Endian::little ? out[i] : out[size - 1 - i]) = byte;
+  }
 }
 
 template <std::size_t bits, typename Word_t>
@@ -119,16 +644,13 @@ constexpr void Int_storage<bits, Word_t>::invert() {
 // Addition is identical for signed and unsigned.
 template <std::size_t bits, typename Word_t>
 constexpr bool Int_storage<bits, Word_t>::add(const Int_storage& rhs) {
-  bool carry = false;
-  for (std::size_t i = 0; i < words; ++i) {
-    auto l = data_[i];
-    if (carry) {
-      data_[i] += rhs[i] + 1;
-      carry = data_[i] <= l;
-    } else {
-      data_[i] += rhs[i];
-      carry = data_[i] < l;
-    }
+  std::size_t n = words;
+  if constexpr (words >= used_words_min_words) {
+    n = rhs.used_words();
+  }
+  bool carry = limbs_add(data_, rhs.data_, n);
+  for (std::size_t i = n; carry && i < words; ++i) {
+    carry = ++data_[i] == 0;
   }
   clear_unused_bits();
   return carry;
@@ -137,18 +659,16 @@ constexpr bool Int_storage<bits, Word_t>::add(const Int_storage& rhs) {
 // Subtraction is identical for signed and unsigned.
 template <std::size_t bits, typename Word_t>
 constexpr bool Int_storage<bits, Word_t>::subtract(const Int_storage& rhs) {
-  bool carry = false;
-  for (std::size_t i = 0; i < words; ++i) {
-    auto l = data_[i];
-    if (carry) {
-      data_[i] -= rhs.data_[i] + 1;
-      carry = data_[i] >= l;
-    } else {
-      data_[i] -= rhs.data_[i];
-      carry = data_[i] > l;
-    }
+  std::size_t n = words;
+  if constexpr (words >= used_words_min_words) {
+    n = rhs.used_words();
   }
-  return carry;
+  bool borrow = limbs_sub(data_, rhs.data_, n);
+  for (std::size_t i = n; borrow && i < words; ++i) {
+    borrow = data_[i]-- == 0;
+  }
+  clear_unused_bits();
+  return borrow;
 }
 
 template <std::size_t bits, typename Word_t>
@@ -175,185 +695,260 @@ constexpr void Int_storage<bits, Word_t>::lshift(uint64_t rhs) {
   if (rhs == 0) {
     return;
   }
-  std::size_t word_shift = std::min(rhs / bits_per_word, words);
+  std::size_t word_shift = std::min<uint64_t>(rhs / bits_per_word, words);
   std::size_t bit_shift = rhs % bits_per_word;
 
-  auto w = words;
-  while (w-- > word_shift) {
-    data_[w] = data_[w - word_shift] << bit_shift;
-    if (w > word_shift) {
-      data_[w] |= data_[w - word_shift - 1] >> (bits_per_word - bit_shift);
+  auto kernels =
+      runtime_word_kernels<Word>(words, shift_kernels_min_words);
+  if (kernels && bit_shift != 0 && word_shift < words) {
+    kernels->lshift(data_ + word_shift, data_, words - word_shift,
+                    unsigned(bit_shift));
+  } else {
+    auto w = words;
+    while (w-- > word_shift) {
+      data_[w] = data_[w - word_shift] << bit_shift;
+      if (bit_shift != 0 && w > word_shift) {
+        data_[w] |= data_[w - word_shift - 1] >> (bits_per_word - bit_shift);
+      }
     }
   }
   for (std::size_t i = 0; i < word_shift; ++i) {
     data_[i] = 0;
   }
+  clear_unused_bits();
 }
 
+// Logical shift, the vacated high bits are always zero.
 template <std::size_t bits, typename Word_t>
 constexpr void Int_storage<bits, Word_t>::rshift(uint64_t rhs) {
-  bool filling_ones = get_bit(bits - 1);
+  if (rhs == 0) {
+    return;
+  }
+  std::size_t word_shift = std::min<uint64_t>(rhs / bits_per_word, words);
+  std::size_t bit_shift = rhs % bits_per_word;
 
-  if (filling_ones) {
-    fill_unused_bits();
+  auto kernels =
+      runtime_word_kernels<Word>(words, shift_kernels_min_words);
+  if (kernels && bit_shift != 0 && word_shift < words) {
+    kernels->rshift(data_, data_ + word_shift, words - word_shift,
+                    unsigned(bit_shift));
+  } else {
+    for (std::size_t w = 0; w < (words - word_shift); ++w) {
+      data_[w] = data_[w + word_shift] >> bit_shift;
+      if (bit_shift != 0 && w + word_shift + 1 < words) {
+        data_[w] |= data_[w + word_shift + 1] << (bits_per_word - bit_shift);
+      }
+    }
   }
 
-  std::size_t word_shift = std::min(rhs / bits_per_word, words);
-  std::size_t bit_shift = rhs % bits_per_word;
+  for (std::size_t w = words - word_shift; w < words; ++w) {
+    data_[w] = 0;
+  }
+}
 
-  for (std::size_t w = 0; w < (words - word_shift); ++w) {
-    data_[w] = data_[w + word_shift] >> bit_shift;
-    if (w + word_shift + 1 < words) {
-      data_[w] |= data_[w + word_shift + 1] << (bits_per_word - bit_shift);
+// Arithmetic shift, the vacated high bits are copies of the sign bit.
+template <std::size_t bits, typename Word_t>
+constexpr void Int_storage<bits, Word_t>::arshift(uint64_t rhs) {
+  if (rhs == 0) {
+    return;
+  }
+  bool filling_ones = get_bit(bits - 1);
+  if (rhs >= bits) {
+    for (auto& w : data_) {
+      w = filling_ones ? ~Word(0) : Word(0);
     }
+    clear_unused_bits();
+    return;
   }
 
   if (filling_ones) {
-    for (std::size_t w = words - word_shift; w < words; ++w) {
+    fill_unused_bits();
+  }
+
+  rshift(rhs);
+
+  if (filling_ones) {
+    // Every bit from (bits - rhs) upwards must be set.
+    std::size_t first = bits - rhs;
+    std::size_t w = which_word(first);
+    data_[w] |= ~Word(0) << which_bit(first);
+    for (++w; w < words; ++w) {
       data_[w] = ~Word(0);
     }
-
-    Word mask = ~((1 << (bits_per_word - bit_shift)) - 1);
-    data_[words - word_shift - 1] |= mask;
     clear_unused_bits();
   }
 }
 
 template <std::size_t bits, typename Word_t>
 constexpr int Int_storage<bits, Word_t>::compare(const Int_storage& rhs) const {
-  std::size_t parts = words;
-  while (parts) {
-    parts--;
-    if (data_[parts] != rhs[parts]) {
-      return (data_[parts] > rhs[parts]) ? 1 : -1;
-    }
+  return limbs_compare(data_, rhs.data_, words);
+}
+
+template <std::size_t bits, typename Word_t>
+constexpr Word_t Int_storage<bits, Word_t>::mul(Word rhs) {
+  std::size_t n = words;
+  if constexpr (words >= used_words_min_words) {
+    n = used_words();
+  }
+  Word carry = limbs_mul_word(data_, n, rhs);
+  if (n < words) {
+    data_[n] = carry;
+    carry = 0;
   }
+  clear_unused_bits();
+  return carry;
+}
 
-  return 0;
+// this += (src * rhs) << (offset * bits_per_word), truncated to the storage,
+// only looking at the first src_words words of src. Returns the carry out of
+// the last word.
+template <std::size_t bits, typename Word_t>
+constexpr Word_t Int_storage<bits, Word_t>::addmul(const Int_storage& src,
+                                                   Word rhs,
+                                                   std::size_t offset,
+                                                   std::size_t src_words) {
+  std::size_t end = offset + std::min(src_words, words - offset);
+  Word carry = limbs_addmul(data_ + offset, src.data_, end - offset, rhs);
+  for (std::size_t i = end; carry != 0 && i < words; ++i) {
+    data_[i] += carry;
+    carry = data_[i] < carry;
+  }
+  clear_unused_bits();
+  return carry;
 }
 
+// Number of words up to and including the highest non-zero one.
 template <std::size_t bits, typename Word_t>
-constexpr Word_t Int_storage<bits, Word_t>::mul(Word rhs) {
-  Word carry = 0;
-  for (auto& v : data_) {
-    Word low = 0, mid = 0, high = 0;
-    auto src_part = v;
-    // [ LOW, HIGH ] = MULTIPLIER * SRC[i] + DST[i] + CARRY.
-
-    if (src_part == 0 || rhs == 0) {
-      low = carry;
-      high = 0;
-    } else {
-      low = low_half(src_part) * low_half(rhs);
-      high = high_half(src_part) * high_half(rhs);
-
-      mid = low_half(src_part) * high_half(rhs);
-      high += high_half(mid);
-      mid <<= bits_per_word / 2;
-      if (low + mid < low) {
-        ++high;
-      }
-      low += mid;
+constexpr std::size_t Int_storage<bits, Word_t>::used_words() const {
+  return limbs_used(data_, words);
+}
 
-      mid = high_half(src_part) * low_half(rhs);
-      high += high_half(mid);
-      mid <<= bits_per_word / 2;
-      if (low + mid < low) {
-        ++high;
-      }
-      low += mid;
+// Schoolbook multiplication, keeping only the low bits of the product. The
+// loops are bounded by the operands' non-zero words, so small operands are
+// cheap regardless of the storage size.
+template <std::size_t bits, typename Word_t>
+constexpr Int_storage<bits, Word_t> Int_storage<bits, Word_t>::mul(
+    const Int_storage& rhs) const {
+  Int_storage result{0};
+  std::size_t lhs_used = used_words();
+  std::size_t rhs_used = rhs.used_words();
 
-      if (low + carry < low) {
-        high++;
-      }
-      low += carry;
+  for (std::size_t i = 0; i < rhs_used; ++i) {
+    if (rhs[i] != 0) {
+      result.addmul(*this, rhs[i], i, lhs_used);
     }
-    v = low;
-    carry = high;
   }
+  return result;
+}
 
-  clear_unused_bits();
-  return carry;
+// Divides in place by a single word, returns the remainder.
+template <std::size_t bits, typename Word_t>
+constexpr Word_t Int_storage<bits, Word_t>::divmod_word(Word rhs) {
+  // The quotient words above the used ones are 0.
+  if constexpr (words >= used_words_min_words) {
+    return limbs_divmod_word(data_, used_words(), rhs);
+  }
+  return limbs_divmod_word(data_, words, rhs);
 }
 
 template <std::size_t bits, typename Word_t>
 constexpr std::size_t Int_storage<bits, Word_t>::count_leading_zeros() const {
+  // The unused bits of the last word are always clear, so they get counted
+  // along and removed at the end.
+  constexpr std::size_t unused_bits = bits_per_word - last_word_bits;
   std::size_t result = 0;
-
-  if (data_.back() != 0) {
-    constexpr Word mask = Word(1) << (last_word_bits - 1);
-    auto w = data_.back();
-    while (1) {
-      if ((w & mask) != 0) {
-        break;
-      }
-      ++result;
-      w <<= 1;
+  std::size_t w = words;
+  while (w--) {
+    if (data_[w] != 0) {
+      return result + word_leading_zeros(data_[w]) - unused_bits;
     }
-  } else {
-    result += last_word_bits;
+    result += bits_per_word;
+  }
+  return bits;
+}
 
-    for (int i = (int)words - 2; i >= 0; --i) {
-      if (data_[i] == 0) {
-        result += bits_per_word;
-      } else {
-        constexpr Word mask = Word(1) << (bits_per_word - 1);
-        auto w = data_[i];
-        while (1) {
-          if ((w & mask) != 0) {
-            break;
-          }
-          ++result;
-          w <<= 1;
-        }
-        break;
-      }
+// Number of trailing zero bits, bits for a zero value.
+template <std::size_t bits, typename Word_t>
+constexpr std::size_t Int_storage<bits, Word_t>::count_trailing_zeros() const {
+  for (std::size_t w = 0; w < words; ++w) {
+    if (data_[w] != 0) {
+      return w * bits_per_word + word_trailing_zeros(data_[w]);
     }
   }
-  return result;
+  return bits;
 }
 
 template <std::size_t bits, typename Word_t>
 constexpr std::tuple<Int_storage<bits, Word_t>, Int_storage<bits, Word_t>>
 Int_storage<bits, Word_t>::udivmod(const Int_storage& denum) const {
-  // Good old long division
-  auto cmp = compare(denum);
-  if (cmp < 0) {
-    return std::make_tuple(Int_storage<bits, Word_t>{0}, *this);
-  }
-  if (cmp == 0) {
-    return std::make_tuple(Int_storage<bits, Word_t>{1},
-                           Int_storage<bits, Word_t>{0});
-  }
+  std::size_t n = denum.used_words();
+  assert(n != 0 && "Division by zero");
 
-  auto divisor = denum;
+  if (compare(denum) < 0) {
+    return std::make_tuple(Int_storage{0}, *this);
+  }
 
-  auto num_leadind_z = count_leading_zeros();
-  auto den_leadind_z = denum.count_leading_zeros();
-  std::int64_t shift = std::int64_t(den_leadind_z - num_leadind_z);
+  if (n == 1) {
+    auto quot = *this;
+    Word rem = quot.divmod_word(denum[0]);
+    return std::make_tuple(quot, Int_storage{rem});
+  }
 
-  Int_storage result{0};
-  auto remainder = *this;
+  Word u[words + 1]{};
+  Word v[words]{};
+  Int_storage quot{0};
+  Int_storage rem{0};
+  limbs_divmod(quot.data_, rem.data_, data_, used_words(), denum.data_, n, u,
+               v);
+  return std::make_tuple(quot, rem);
+}
 
-  divisor.lshift(Word(shift));
+// Upper bound on the decimal digits of an n words value: 2^64 < 10^20.
+constexpr std::size_t limbs_decimal_digits(std::size_t n) {
+  return 20 * n + 1;
+}
 
-  while (shift >= 0) {
-    if (remainder.compare(denum) < 0) {
-      break;
-    }
-    auto comp = divisor.compare(remainder);
-    if (comp <= 0) {
-      remainder.subtract(divisor);
-      result.set_bit(shift);
-      if (comp == 0) {
-        break;
-      }
+// Decimal digits of the n words at words, which are overwritten, written
+// backwards from end, at most limbs_decimal_digits(n) of them. Returns the
+// first digit. Divides by 10^19 at a time, over the used words only.
+inline char* limbs_to_decimal(std::uint64_t* words, std::size_t n,
+                              char* end) {
+  constexpr std::uint64_t chunk_scale = 10000000000000000000ull;
+
+  char* first = end;
+  n = limbs_used(words, n);
+  while (n != 0) {
+    std::uint64_t chunk = limbs_divmod_word(words, n, chunk_scale);
+    n = limbs_used(words, n);
+    // Chunks below the top one keep their leading zeros.
+    for (int i = 0; i < 19 && (n != 0 || chunk != 0); ++i) {
+      *--first = char('0' + chunk % 10);
+      chunk /= 10;
     }
-    --shift;
-    divisor.rshift(1);
   }
+  if (first == end) {
+    *--first = '0';
+  }
+  return first;
+}
 
-  return std::make_tuple(result, remainder);
+inline std::string limbs_to_decimal(std::uint64_t* words, std::size_t n) {
+  std::string result(limbs_decimal_digits(n), '0');
+  char* first = limbs_to_decimal(words, n, result.data() + result.size());
+  result.erase(0, std::size_t(first - result.data()));
+  return result;
+}
+
+// Copies v into a storage of a different size, zero-extending or truncating.
+template <std::size_t to_bits, std::size_t bits, typename Word_t>
+constexpr Int_storage<to_bits, Word_t> resize(const Int_storage<bits, Word_t>& v) {
+  Int_storage<to_bits, Word_t> result{0};
+  constexpr std::size_t common = std::min(result.words, v.words);
+  for (std::size_t i = 0; i < common; ++i) {
+    result[i] = v[i];
+  }
+  result.clear_unused_bits();
+  return result;
 }
 }
 }
@@ -8,14 +8,19 @@
 
 #include "vecpp/ap_math/ap_int/int_storage.h"
 
-#include <sstream>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <ostream>
 #include <string>
+#include <string_view>
 
 namespace vecpp {
 // This is really simple. An AP int
 template <std::size_t bits>
 struct Large_ap_int {
   using Storage = detail::Int_storage<bits, std::uint64_t>;
+  static_assert(Storage::words >= 2, "Use a Small_ap_int instead");
   using Self = Large_ap_int;
 
   Large_ap_int(){};
@@ -25,6 +30,23 @@ struct Large_ap_int {
   constexpr explicit Large_ap_int(std::int64_t);
   constexpr explicit Large_ap_int(std::string_view);
 
+  // The two's complement integer in the size bytes at data, most
+  // significant last for Endian::little. Bytes past the width of the type
+  // are dropped.
+  static constexpr Large_ap_int from_bytes(const std::byte* data,
+                                           std::size_t size,
+                                           Endian order = Endian::little);
+  // The low size bytes, sign extended.
+  constexpr void to_bytes(std::byte* out, std::size_t size,
+                          Endian order = Endian::little) const;
+
+  // The words of the value, least significant first, in two's complement.
+  // Bits past the width of the type are clear, even for negative values,
+  // and must stay clear when writing through limbs().
+  using Limbs = std::uint64_t[Storage::words];
+  constexpr Limbs& limbs() { return data_.data_; }
+  constexpr const Limbs& limbs() const { return data_.data_; }
+
   constexpr int compare(const Large_ap_int&) const;
   constexpr bool operator==(const Self& r) const { return compare(r) == 0; }
   constexpr bool operator!=(const Self& r) const { return compare(r) != 0; }
@@ -114,6 +136,31 @@ constexpr Large_ap_int<bits>::Large_ap_int(std::int64_t v) : data_{0} {
   }
 }
 
+template <std::size_t bits>
+constexpr Large_ap_int<bits> Large_ap_int<bits>::from_bytes(
+    const std::byte* data, std::size_t size, Endian order) {
+  Large_ap_int result{0};
+  result.data_.from_bytes(data, size, order);
+  // Sign extends a narrower integer.
+  if (size > 0 && 8 * size < bits) {
+    result.data_.lshift(bits - 8 * size);
+    result.data_.arshift(bits - 8 * size);
+  }
+  return result;
+}
+
+template <std::size_t bits>
+constexpr void Large_ap_int<bits>::to_bytes(std::byte* out, std::size_t size,
+                                            Endian order) const {
+  assert(data_.unused_bits_clear());
+  if (!is_negative()) {
+    return data_.to_bytes(out, size, order);
+  }
+  auto filled = data_;
+  filled.fill_unused_bits();
+  filled.to_bytes(out, size, order, std::byte{0xff});
+}
+
 template <std::size_t bits>
 constexpr Large_ap_int<bits>::Large_ap_int(std::string_view v) : data_{0} {
   if (v.empty()) {
@@ -147,6 +194,7 @@ constexpr Large_ap_int<bits>::Large_ap_int(std::string_view v) : data_{0} {
 // lhs > rhs.
 template <std::size_t bits>
 constexpr int Large_ap_int<bits>::compare(const Large_ap_int<bits>& rhs) const {
+  assert(data_.unused_bits_clear() && rhs.data_.unused_bits_clear());
   bool l_neg = is_negative();
   bool r_neg = rhs.is_negative();
 
@@ -159,6 +207,7 @@ constexpr int Large_ap_int<bits>::compare(const Large_ap_int<bits>& rhs) const {
 
 template <std::size_t bits>
 constexpr int Large_ap_int<bits>::compare(std::int64_t rhs) const {
+  assert(data_.unused_bits_clear());
   bool l_neg = is_negative();
   bool r_neg = rhs < 0;
 
@@ -311,34 +360,9 @@ constexpr Large_ap_int<bits> Large_ap_int<bits>::operator*(
 template <std::size_t bits>
 constexpr Large_ap_int<bits> Large_ap_int<bits>::operator*(
     const Large_ap_int& rhs) const {
-  Large_ap_int<bits> a{*this};
-  Large_ap_int<bits> b{rhs};
-
-  bool neg = false;
-
-  if (a.is_negative()) {
-    neg = !neg;
-    a = -a;
-  }
-
-  if (b.is_negative()) {
-    neg = !neg;
-    b = -b;
-  }
-
+  // The low bits of a two's complement product do not depend on the signs.
   Large_ap_int<bits> result{0};
-
-  for (std::size_t i = 0; i < data_.words; ++i) {
-    auto tmp = a;
-    tmp.data_.mul(b.data_[i]);
-
-    tmp <<= (data_.bits_per_word * i);
-    result += tmp;
-  }
-
-  if (neg) {
-    result = -result;
-  }
+  result.data_ = data_.mul(rhs.data_);
   return result;
 }
 
@@ -365,8 +389,7 @@ constexpr Large_ap_int<bits>& Large_ap_int<bits>::operator/=(
     rhs_v = -rhs_v;
   }
 
-  Storage rem{0};
-  std::tie(data_, rem) = data_.udivmod(rhs_v.data_);
+  data_ = std::get<0>(data_.udivmod(rhs_v.data_));
 
   if (neg) {
     *this = -*this;
@@ -410,8 +433,7 @@ constexpr Large_ap_int<bits>& Large_ap_int<bits>::operator%=(
     rhs_v = -rhs_v;
   }
 
-  Storage div{0};
-  std::tie(div, data_) = data_.udivmod(rhs_v.data_);
+  data_ = std::get<1>(data_.udivmod(rhs_v.data_));
 
   if (neg) {
     *this = -*this;
@@ -493,7 +515,7 @@ constexpr Large_ap_int<bits> Large_ap_int<bits>::operator<<(
 template <std::size_t bits>
 constexpr Large_ap_int<bits>& Large_ap_int<bits>::operator>>=(
     std::uint64_t rhs) {
-  data_.rshift(rhs);
+  data_.arshift(rhs);
 
   return *this;
 }
@@ -506,25 +528,15 @@ constexpr Large_ap_int<bits> Large_ap_int<bits>::operator>>(
 
 template <std::size_t bits>
 std::ostream& operator<<(std::ostream& stream, const Large_ap_int<bits>& num) {
+  assert(num.data_.unused_bits_clear());
   Large_ap_int<bits> u_num = num;
   if (num.is_negative()) {
     stream << "-";
     u_num = -u_num;
   }
-
-  std::ostringstream gen;
-
-  Large_ap_int<bits> ten{10};
-  typename Large_ap_int<bits>::Storage rem;
-  while (u_num != 0) {
-    std::tie(u_num.data_, rem) = u_num.data_.udivmod(ten.data_);
-
-    gen << char('0' + rem[0]);
-  }
-
-  std::string result = gen.str();
-  std::reverse(result.begin(), result.end());
-  return stream << result;
+  // The lowest value is its own negation, and reads as its magnitude.
+  return stream << detail::limbs_to_decimal(u_num.data_.data_,
+                                            u_num.data_.words);
 }
 
 }  // namespace vecpp
@@ -8,14 +8,18 @@
 
 #include "vecpp/ap_math/ap_int/int_storage.h"
 
-#include <sstream>
+#include <algorithm>
+#include <cassert>
+#include <ostream>
 #include <string>
+#include <string_view>
 
 namespace vecpp {
 // This is really simple. An AP int
 template <std::size_t bits>
 struct Large_ap_uint {
   using Storage = detail::Int_storage<bits, std::uint64_t>;
+  static_assert(Storage::words >= 2, "Use a Small_ap_int instead");
   using Self = Large_ap_uint;
 
   Large_ap_uint(){};
@@ -25,6 +29,21 @@ struct Large_ap_uint {
   constexpr explicit Large_ap_uint(std::uint64_t);
   constexpr explicit Large_ap_uint(std::string_view);
 
+  // The size bytes at data, most significant last for Endian::little.
+  // Bytes past the width of the type are dropped.
+  static constexpr Large_ap_uint from_bytes(const std::byte* data,
+                                            std::size_t size,
+                                            Endian order = Endian::little);
+  // The low size bytes, zero extended.
+  constexpr void to_bytes(std::byte* out, std::size_t size,
+                          Endian order = Endian::little) const;
+
+  // The words of the value, least significant first. Bits past the width
+  // of the type must stay clear when writing through limbs().
+  using Limbs = std::uint64_t[Storage::words];
+  constexpr Limbs& limbs() { return data_.data_; }
+  constexpr const Limbs& limbs() const { return data_.data_; }
+
   constexpr int compare(const Large_ap_uint&) const;
   constexpr bool operator==(const Self& r) const { return compare(r) == 0; }
   constexpr bool operator!=(const Self& r) const { return compare(r) != 0; }
@@ -103,6 +122,21 @@ constexpr Large_ap_uint<bits>::Large_ap_uint(std::uint64_t v) : data_{0} {
   data_[0] = v;
 }
 
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Large_ap_uint<bits>::from_bytes(
+    const std::byte* data, std::size_t size, Endian order) {
+  Large_ap_uint result{0};
+  result.data_.from_bytes(data, size, order);
+  return result;
+}
+
+template <std::size_t bits>
+constexpr void Large_ap_uint<bits>::to_bytes(std::byte* out, std::size_t size,
+                                             Endian order) const {
+  assert(data_.unused_bits_clear());
+  data_.to_bytes(out, size, order);
+}
+
 template <std::size_t bits>
 constexpr Large_ap_uint<bits>::Large_ap_uint(std::string_view v) : data_{0} {
   if (v.empty()) {
@@ -129,11 +163,13 @@ constexpr Large_ap_uint<bits>::Large_ap_uint(std::string_view v) : data_{0} {
 template <std::size_t bits>
 constexpr int Large_ap_uint<bits>::compare(
     const Large_ap_uint<bits>& rhs) const {
+  assert(data_.unused_bits_clear() && rhs.data_.unused_bits_clear());
   return data_.compare(rhs.data_);
 }
 
 template <std::size_t bits>
 constexpr int Large_ap_uint<bits>::compare(std::uint64_t rhs) const {
+  assert(data_.unused_bits_clear());
   return data_.compare(Large_ap_uint(rhs).data_);
 }
 
@@ -252,18 +288,8 @@ constexpr Large_ap_uint<bits> Large_ap_uint<bits>::operator*(
 template <std::size_t bits>
 constexpr Large_ap_uint<bits> Large_ap_uint<bits>::operator*(
     const Large_ap_uint& rhs) const {
-  Large_ap_uint<bits> a{*this};
-  Large_ap_uint<bits> b{rhs};
-
   Large_ap_uint<bits> result{0};
-
-  for (std::size_t i = 0; i < data_.words; ++i) {
-    auto tmp = a;
-    tmp.data_.mul(b.data_[i]);
-
-    tmp <<= (data_.bits_per_word * i);
-    result += tmp;
-  }
+  result.data_ = data_.mul(rhs.data_);
   return result;
 }
 
@@ -278,8 +304,7 @@ constexpr Large_ap_uint<bits>& Large_ap_uint<bits>::operator/=(
 template <std::size_t bits>
 constexpr Large_ap_uint<bits>& Large_ap_uint<bits>::operator/=(
     const Large_ap_uint& rhs) {
-  Storage rem{0};
-  std::tie(data_, rem) = data_.udivmod(rhs.data_);
+  data_ = std::get<0>(data_.udivmod(rhs.data_));
 
   return *this;
 }
@@ -307,8 +332,7 @@ constexpr Large_ap_uint<bits>& Large_ap_uint<bits>::operator%=(
 template <std::size_t bits>
 constexpr Large_ap_uint<bits>& Large_ap_uint<bits>::operator%=(
     const Large_ap_uint& rhs) {
-  Storage div{0};
-  std::tie(div, data_) = data_.udivmod(rhs.data_);
+  data_ = std::get<1>(data_.udivmod(rhs.data_));
   return *this;
 }
 
@@ -398,21 +422,10 @@ constexpr Large_ap_uint<bits> Large_ap_uint<bits>::operator>>(
 
 template <std::size_t bits>
 std::ostream& operator<<(std::ostream& stream, const Large_ap_uint<bits>& num) {
+  assert(num.data_.unused_bits_clear());
   Large_ap_uint<bits> u_num = num;
-
-  std::ostringstream gen;
-
-  Large_ap_uint<bits> ten{10};
-  typename Large_ap_uint<bits>::Storage rem;
-  while (u_num != 0) {
-    std::tie(u_num.data_, rem) = u_num.data_.udivmod(ten.data_);
-
-    gen << char('0' + rem[0]);
-  }
-
-  std::string result = gen.str();
-  std::reverse(result.begin(), result.end());
-  return stream << result;
+  return stream << detail::limbs_to_decimal(u_num.data_.data_,
+                                            u_num.data_.words);
 }
 
 }  // namespace vecpp
@@ -0,0 +1,255 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_LAZY_INCLUDED_H
+#define VECPP_AP_INT_LAZY_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/small.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vecpp {
+
+namespace detail {
+template <typename T>
+struct Lazy_product {
+  const T* lhs;
+  const T* rhs;
+};
+
+// Sign bits of lhs followed by those of rhs, flipped if negate.
+constexpr std::uint64_t lazy_signs(std::uint64_t lhs, std::size_t lhs_count,
+                                   std::uint64_t rhs, std::size_t rhs_count,
+                                   bool negate) {
+  if (negate) {
+    rhs = ~rhs;
+    if (rhs_count < 64) {
+      rhs &= (std::uint64_t(1) << rhs_count) - 1;
+    }
+  }
+  return lhs_count < 64 ? lhs | (rhs << lhs_count) : lhs;
+}
+}  // namespace detail
+
+// Deferred sum of Large_ap_uint or Large_ap_int values, built from
+// lazy(a), and of products of two of them. Converting it to T evaluates
+// the whole expression at once: the terms in a single pass over the
+// limbs with one carry, then each product accumulated straight into the
+// sum, like a fused multiply-add. The result is the same as with the
+// regular operators, without a temporary per operator.
+//
+// Bit k of negative_terms / negative_products is set if the k-th term /
+// product is subtracted. The shape of the expression is part of its type,
+// only the addresses of the operands are kept, so it has to be evaluated
+// before the end of the full-expression it was built in.
+template <typename T, std::size_t term_count, std::size_t product_count,
+          std::uint64_t negative_terms = 0, std::uint64_t negative_products = 0>
+class Lazy_sum {
+ public:
+  using Storage = typename T::Storage;
+  using Product = detail::Lazy_product<T>;
+
+  static_assert(term_count <= 64 && product_count <= 64,
+                "Too many terms for the sign masks");
+
+  constexpr T eval() const {
+    T result{0};
+    sum_terms(result.data_);
+    for (std::size_t k = 0; k < product_count; ++k) {
+      add_product(result.data_, products[k], is_negative(negative_products, k));
+    }
+    return result;
+  }
+
+  constexpr operator T() const { return eval(); }
+
+  std::array<const T*, term_count> terms;
+  std::array<Product, product_count> products;
+
+ private:
+  static constexpr bool is_negative(std::uint64_t signs, std::size_t k) {
+    return ((signs >> k) & 1) != 0;
+  }
+
+  constexpr void sum_terms(Storage& out) const {
+    // -x == ~x + 1: negative terms are added inverted, and their + 1s
+    // start the carry, which counts the wraparounds of the limb sums.
+    if constexpr (term_count > 2) {
+      const std::uint64_t* limbs[term_count] = {};
+      std::uint64_t carry = 0;
+      for (std::size_t k = 0; k < term_count; ++k) {
+        limbs[k] = &terms[k]->data_[0];
+        carry += is_negative(negative_terms, k) ? 1 : 0;
+      }
+      for (std::size_t i = 0; i < Storage::words; ++i) {
+        std::uint64_t sum = carry;
+        carry = 0;
+        for (std::size_t k = 0; k < term_count; ++k) {
+          std::uint64_t mask = is_negative(negative_terms, k) ? ~0ull : 0;
+          std::uint64_t w = limbs[k][i] ^ mask;
+          sum += w;
+          carry += sum < w ? 1 : 0;
+        }
+        out[i] = sum;
+      }
+      out.clear_unused_bits();
+      return;
+    }
+    std::size_t k = 0;
+    if (term_count > 0 && !is_negative(negative_terms, 0)) {
+      out = terms[0]->data_;
+      k = 1;
+    }
+    for (; k < term_count; ++k) {
+      if (is_negative(negative_terms, k)) {
+        out.subtract(terms[k]->data_);
+      } else {
+        out.add(terms[k]->data_);
+      }
+    }
+  }
+
+  // out +/-= lhs * rhs, truncated. Subtraction goes through
+  // s - p == ~(~s + p), so both share the addmul rows.
+  static constexpr void add_product(Storage& out, const Product& p,
+                                    bool negative) {
+    const Storage& lhs = p.lhs->data_;
+    const Storage& rhs = p.rhs->data_;
+    std::size_t lhs_used = lhs.used_words();
+    std::size_t rhs_used = rhs.used_words();
+
+    if (negative) {
+      out.invert();
+    }
+    for (std::size_t i = 0; i < rhs_used; ++i) {
+      if (rhs[i] != 0) {
+        out.addmul(lhs, rhs[i], i, lhs_used);
+      }
+    }
+    if (negative) {
+      out.invert();
+    }
+  }
+};
+
+// Starts a lazy expression: lazy(a) + b + c - d, lazy(a) * b + c.
+template <std::size_t bits>
+constexpr Lazy_sum<Large_ap_uint<bits>, 1, 0> lazy(
+    const Large_ap_uint<bits>& v) {
+  return {{{&v}}, {}};
+}
+
+template <std::size_t bits>
+constexpr Lazy_sum<Large_ap_int<bits>, 1, 0> lazy(
+    const Large_ap_int<bits>& v) {
+  return {{{&v}}, {}};
+}
+
+// Single word values have nothing to fuse, so that generic code over
+// Ap_int<bits> / Ap_uint<bits> can use lazy() at every width.
+template <std::size_t bits, bool is_signed>
+constexpr Small_ap_int<bits, is_signed> lazy(
+    const Small_ap_int<bits, is_signed>& v) {
+  return v;
+}
+
+namespace detail {
+// lhs + rhs, or lhs - rhs if negate.
+template <bool negate, typename T, std::size_t n1, std::size_t p1,
+          std::uint64_t t1, std::uint64_t q1, std::size_t n2, std::size_t p2,
+          std::uint64_t t2, std::uint64_t q2>
+constexpr auto lazy_join(const Lazy_sum<T, n1, p1, t1, q1>& lhs,
+                         const Lazy_sum<T, n2, p2, t2, q2>& rhs) {
+  Lazy_sum<T, n1 + n2, p1 + p2, lazy_signs(t1, n1, t2, n2, negate),
+           lazy_signs(q1, p1, q2, p2, negate)>
+      result{};
+  for (std::size_t i = 0; i < n1; ++i) {
+    result.terms[i] = lhs.terms[i];
+  }
+  for (std::size_t i = 0; i < n2; ++i) {
+    result.terms[n1 + i] = rhs.terms[i];
+  }
+  for (std::size_t i = 0; i < p1; ++i) {
+    result.products[i] = lhs.products[i];
+  }
+  for (std::size_t i = 0; i < p2; ++i) {
+    result.products[p1 + i] = rhs.products[i];
+  }
+  return result;
+}
+
+template <typename T>
+constexpr Lazy_sum<T, 1, 0> lazy_term(const T& v) {
+  return {{{&v}}, {}};
+}
+}  // namespace detail
+
+template <typename T, std::size_t n1, std::size_t p1, std::uint64_t t1,
+          std::uint64_t q1, std::size_t n2, std::size_t p2, std::uint64_t t2,
+          std::uint64_t q2>
+constexpr auto operator+(const Lazy_sum<T, n1, p1, t1, q1>& lhs,
+                         const Lazy_sum<T, n2, p2, t2, q2>& rhs) {
+  return detail::lazy_join<false>(lhs, rhs);
+}
+
+template <typename T, std::size_t n1, std::size_t p1, std::uint64_t t1,
+          std::uint64_t q1, std::size_t n2, std::size_t p2, std::uint64_t t2,
+          std::uint64_t q2>
+constexpr auto operator-(const Lazy_sum<T, n1, p1, t1, q1>& lhs,
+                         const Lazy_sum<T, n2, p2, t2, q2>& rhs) {
+  return detail::lazy_join<true>(lhs, rhs);
+}
+
+template <typename T, std::size_t n, std::size_t p, std::uint64_t t,
+          std::uint64_t q>
+constexpr auto operator+(const Lazy_sum<T, n, p, t, q>& lhs, const T& rhs) {
+  return detail::lazy_join<false>(lhs, detail::lazy_term(rhs));
+}
+
+template <typename T, std::size_t n, std::size_t p, std::uint64_t t,
+          std::uint64_t q>
+constexpr auto operator-(const Lazy_sum<T, n, p, t, q>& lhs, const T& rhs) {
+  return detail::lazy_join<true>(lhs, detail::lazy_term(rhs));
+}
+
+template <typename T, std::size_t n, std::size_t p, std::uint64_t t,
+          std::uint64_t q>
+constexpr auto operator+(const T& lhs, const Lazy_sum<T, n, p, t, q>& rhs) {
+  return detail::lazy_join<false>(detail::lazy_term(lhs), rhs);
+}
+
+template <typename T, std::size_t n, std::size_t p, std::uint64_t t,
+          std::uint64_t q>
+constexpr auto operator-(const T& lhs, const Lazy_sum<T, n, p, t, q>& rhs) {
+  return detail::lazy_join<true>(detail::lazy_term(lhs), rhs);
+}
+
+// Products are of two plain values: lazy(a) * b, not (lazy(a) + b) * c.
+template <typename T>
+constexpr Lazy_sum<T, 0, 1> operator*(const Lazy_sum<T, 1, 0>& lhs,
+                                      const Lazy_sum<T, 1, 0>& rhs) {
+  return {{}, {{{lhs.terms[0], rhs.terms[0]}}}};
+}
+
+template <typename T>
+constexpr Lazy_sum<T, 0, 1> operator*(const Lazy_sum<T, 1, 0>& lhs,
+                                      const T& rhs) {
+  return {{}, {{{lhs.terms[0], &rhs}}}};
+}
+
+template <typename T>
+constexpr Lazy_sum<T, 0, 1> operator*(const T& lhs,
+                                      const Lazy_sum<T, 1, 0>& rhs) {
+  return {{}, {{{&lhs, rhs.terms[0]}}}};
+}
+}  // namespace vecpp
+
+#endif
@@ -0,0 +1,213 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_LIMB_POOL_INCLUDED_H
+#define VECPP_AP_INT_LIMB_POOL_INCLUDED_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace vecpp {
+
+// Memory resource for the words of long-lived Dyn_ap_int values. Blocks of
+// 2^k words come from per size free lists, refilled a chunk at a time from
+// the upstream resource, so values that keep growing and shrinking through
+// the same sizes stop reaching upstream once every size has been seen.
+// Blocks go back to the free lists, and chunks are only returned upstream
+// by release() or the destructor. Not synchronized, like
+// std::pmr::unsynchronized_pool_resource.
+class Limb_pool : public std::pmr::memory_resource {
+ public:
+  // Blocks of up to 2^(size_classes - 1) words, larger ones are passed
+  // through to upstream.
+  static constexpr std::size_t size_classes = 16;
+  static constexpr std::size_t chunk_bytes = 16384;
+
+  explicit Limb_pool(
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream_(upstream) {}
+
+  Limb_pool(const Limb_pool&) = delete;
+  Limb_pool& operator=(const Limb_pool&) = delete;
+
+  ~Limb_pool() override { release(); }
+
+  // Returns every chunk upstream, blocks still in use become invalid.
+  void release() {
+    while (chunks_) {
+      Chunk* next = chunks_->next;
+      upstream_->deallocate(chunks_, chunks_->bytes, alignof(Chunk));
+      chunks_ = next;
+    }
+    std::fill(std::begin(free_), std::end(free_), nullptr);
+  }
+
+  std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+  // Calls made to the upstream resource so far.
+  std::size_t upstream_allocations() const { return upstream_allocations_; }
+
+ private:
+  struct Free_block {
+    Free_block* next;
+  };
+
+  struct alignas(std::max_align_t) Chunk {
+    Chunk* next;
+    std::size_t bytes;
+  };
+
+  // The smallest k with 2^k words >= bytes and >= alignment. Blocks of
+  // class k sit at multiples of 2^k words from the start of a chunk, so
+  // they are aligned on 2^k words, up to max_align_t.
+  static std::size_t size_class(std::size_t bytes, std::size_t alignment) {
+    std::size_t size = std::max(bytes, alignment);
+    std::size_t k = 0;
+    while ((std::size_t(8) << k) < size) {
+      ++k;
+    }
+    return k;
+  }
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    std::size_t k = size_class(bytes, alignment);
+    if (k >= size_classes || alignment > alignof(std::max_align_t)) {
+      ++upstream_allocations_;
+      return upstream_->allocate(bytes, alignment);
+    }
+    if (!free_[k]) {
+      refill(k);
+    }
+    Free_block* block = free_[k];
+    free_[k] = block->next;
+    return block;
+  }
+
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override {
+    std::size_t k = size_class(bytes, alignment);
+    if (k >= size_classes || alignment > alignof(std::max_align_t)) {
+      upstream_->deallocate(p, bytes, alignment);
+      return;
+    }
+    auto block = static_cast<Free_block*>(p);
+    block->next = free_[k];
+    free_[k] = block;
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  // Carves a new chunk into blocks of class k.
+  void refill(std::size_t k) {
+    std::size_t block_bytes = std::size_t(8) << k;
+    std::size_t count = std::max<std::size_t>(1, chunk_bytes / block_bytes);
+    std::size_t bytes = sizeof(Chunk) + count * block_bytes;
+
+    ++upstream_allocations_;
+    auto chunk =
+        static_cast<Chunk*>(upstream_->allocate(bytes, alignof(Chunk)));
+    chunk->next = chunks_;
+    chunk->bytes = bytes;
+    chunks_ = chunk;
+
+    auto first = reinterpret_cast<char*>(chunk + 1);
+    for (std::size_t i = count; i-- > 0;) {
+      auto block = reinterpret_cast<Free_block*>(first + i * block_bytes);
+      block->next = free_[k];
+      free_[k] = block;
+    }
+  }
+
+  std::pmr::memory_resource* upstream_;
+  Free_block* free_[size_classes] = {};
+  Chunk* chunks_ = nullptr;
+  std::size_t upstream_allocations_ = 0;
+};
+
+namespace detail {
+// Per thread stack of scratch words for the temporaries of one operation,
+// such as the normalized operands of a division. Blocks are kept once
+// allocated, so a thread stops allocating once it has seen its largest
+// operation.
+class Scratch_arena {
+ public:
+  struct Mark {
+    std::size_t block;
+    std::size_t used;
+  };
+
+  Mark mark() const { return {block_, used_}; }
+  void release(Mark m) {
+    block_ = m.block;
+    used_ = m.used;
+  }
+
+  std::uint64_t* allocate(std::size_t words) {
+    while (block_ < blocks_.size() && blocks_[block_].words - used_ < words) {
+      ++block_;
+      used_ = 0;
+    }
+    if (block_ == blocks_.size()) {
+      std::size_t size = std::max<std::size_t>(words, 1024);
+      if (!blocks_.empty()) {
+        size = std::max(size, 2 * blocks_.back().words);
+      }
+      ++upstream_allocations_;
+      blocks_.push_back({std::make_unique<std::uint64_t[]>(size), size});
+    }
+    std::uint64_t* result = blocks_[block_].data.get() + used_;
+    used_ += words;
+    return result;
+  }
+
+  std::size_t upstream_allocations() const { return upstream_allocations_; }
+
+ private:
+  struct Block {
+    std::unique_ptr<std::uint64_t[]> data;
+    std::size_t words;
+  };
+
+  std::vector<Block> blocks_;
+  std::size_t block_ = 0;
+  std::size_t used_ = 0;
+  std::size_t upstream_allocations_ = 0;
+};
+
+inline Scratch_arena& scratch_arena() {
+  thread_local Scratch_arena arena;
+  return arena;
+}
+
+// words scratch words, given back to the arena on destruction.
+class Scratch {
+ public:
+  explicit Scratch(std::size_t words)
+      : mark_(scratch_arena().mark()),
+        data_(scratch_arena().allocate(words)) {}
+  Scratch(const Scratch&) = delete;
+  Scratch& operator=(const Scratch&) = delete;
+  ~Scratch() { scratch_arena().release(mark_); }
+
+  std::uint64_t* data() const { return data_; }
+
+ private:
+  Scratch_arena::Mark mark_;
+  std::uint64_t* data_;
+};
+}  // namespace detail
+}  // namespace vecpp
+
+#endif
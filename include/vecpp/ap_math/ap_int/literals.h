@@ -0,0 +1,135 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  See the accompanying LICENSE file for licensing details.
+
+#ifndef VECPP_AP_INT_LITERALS_INCLUDED_H
+#define VECPP_AP_INT_LITERALS_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace vecpp {
+
+namespace detail {
+// Compile-time parsing of an integer literal's characters. Supports the
+// decimal, hexadecimal, octal and binary forms, as well as digit separators.
+template <char... cs>
+struct Ap_literal {
+  static constexpr char chars[] = {cs...};
+  static constexpr std::size_t count = sizeof...(cs);
+
+  static constexpr bool has_prefix(char lower) {
+    return count > 2 && chars[0] == '0' &&
+           (chars[1] == lower || chars[1] == lower - 'a' + 'A');
+  }
+
+  static constexpr unsigned base() {
+    if (has_prefix('x')) {
+      return 16;
+    }
+    if (has_prefix('b')) {
+      return 2;
+    }
+    if (count > 1 && chars[0] == '0') {
+      return 8;
+    }
+    return 10;
+  }
+
+  static constexpr std::size_t first_digit() {
+    return base() == 16 || base() == 2 ? 2 : 0;
+  }
+
+  static constexpr int digit_value(char c) {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+    }
+    return 16;
+  }
+
+  static constexpr bool valid() {
+    for (std::size_t i = first_digit(); i < count; ++i) {
+      if (chars[i] != '\'' && digit_value(chars[i]) >= int(base())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Every digit adds at most 4 bits, the extra word keeps this a Large type.
+  static constexpr std::size_t max_bits = count * 4 + 64;
+
+  static constexpr Large_ap_uint<max_bits> value() {
+    Large_ap_uint<max_bits> result{0};
+    for (std::size_t i = first_digit(); i < count; ++i) {
+      if (chars[i] != '\'') {
+        result.data_.mul(base());
+        result += std::uint64_t(digit_value(chars[i]));
+      }
+    }
+    return result;
+  }
+
+  static constexpr std::size_t significant_bits() {
+    return max_bits - value().data_.count_leading_zeros();
+  }
+};
+
+template <std::size_t bits, bool is_signed, std::size_t src_bits>
+constexpr auto narrow_literal(const Large_ap_uint<src_bits>& v) {
+  if constexpr (bits > 64) {
+    std::conditional_t<is_signed, Large_ap_int<bits>, Large_ap_uint<bits>>
+        result{0};
+    for (std::size_t i = 0; i < result.data_.words; ++i) {
+      result.data_[i] = v.data_[i];
+    }
+    return result;
+  } else {
+    using Storage = typename Small_storage_selector<bits, is_signed>::type;
+    return Small_ap_int<bits, is_signed>(Storage(v.data_[0]));
+  }
+}
+
+template <bool is_signed, char... cs>
+constexpr auto parse_ap_literal() {
+  using Literal = Ap_literal<cs...>;
+  static_assert(Literal::valid(), "invalid digit in Ap_int literal");
+
+  // Signed literals get an extra bit, so that they stay positive.
+  constexpr std::size_t bits =
+      std::max<std::size_t>(2, Literal::significant_bits() + is_signed);
+  return narrow_literal<bits, is_signed>(Literal::value());
+}
+
+// Variable templates force the parsing to happen at compile time.
+template <bool is_signed, char... cs>
+inline constexpr auto ap_literal = parse_ap_literal<is_signed, cs...>();
+}  // namespace detail
+
+namespace literals {
+// 123456789012345678901234567890_ap is an Ap_int<98>, the smallest width that
+// holds the value. 0xDEADBEEF_apu is an Ap_uint<32>.
+template <char... cs>
+constexpr auto operator"" _ap() {
+  return detail::ap_literal<true, cs...>;
+}
+
+template <char... cs>
+constexpr auto operator"" _apu() {
+  return detail::ap_literal<false, cs...>;
+}
+}  // namespace literals
+}  // namespace vecpp
+
+#endif
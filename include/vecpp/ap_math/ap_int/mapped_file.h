@@ -0,0 +1,92 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_MAPPED_FILE_INCLUDED_H
+#define VECPP_AP_INT_MAPPED_FILE_INCLUDED_H
+
+#include <cstddef>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VECPP_AP_INT_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vecpp {
+namespace detail {
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+// Read-only mapping of a whole file, shared by the on-disk readers.
+// is_open() is false if the file could not be opened or mapped. An empty
+// file is open, with no data, since mmap() rejects zero lengths.
+class Mapped_file {
+ public:
+  Mapped_file() = default;
+
+  // With sequential, the kernel is advised to read ahead of the accesses.
+  Mapped_file(const char* path, bool sequential) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+      if (st.st_size == 0) {
+        open_ = true;
+      } else {
+        void* p = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ,
+                         MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+          if (sequential) {
+            ::madvise(p, std::size_t(st.st_size), MADV_SEQUENTIAL);
+          }
+          data_ = static_cast<const char*>(p);
+          size_ = std::size_t(st.st_size);
+          open_ = true;
+        }
+      }
+    }
+    ::close(fd);
+  }
+
+  Mapped_file(Mapped_file&& other) noexcept { *this = std::move(other); }
+
+  Mapped_file& operator=(Mapped_file&& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(open_, other.open_);
+    return *this;
+  }
+
+  ~Mapped_file() { close(); }
+
+  bool is_open() const { return open_; }
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+  void close() {
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+  }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool open_ = false;
+};
+#endif
+}  // namespace detail
+}  // namespace vecpp
+
+#endif
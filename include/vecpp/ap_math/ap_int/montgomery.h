@@ -0,0 +1,316 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  See the accompanying LICENSE file for licensing details.
+
+#ifndef VECPP_AP_INT_MONTGOMERY_INCLUDED_H
+#define VECPP_AP_INT_MONTGOMERY_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/int_storage.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/uint_array.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace vecpp {
+
+namespace detail {
+template <std::size_t bits>
+struct Montgomery_array;
+}
+
+// Modular arithmetic context for a fixed odd modulus n, with R = 2^(64*words).
+// Values handed to mul(), add(), sub() and pow() must be in Montgomery form
+// (x * R mod n), see to_mont() and from_mont().
+template <std::size_t bits>
+class Montgomery {
+ public:
+  using Value = Large_ap_uint<bits>;
+
+  constexpr explicit Montgomery(const Value& modulus);
+
+  constexpr const Value& modulus() const { return n_; }
+
+  constexpr Value to_mont(const Value& v) const;
+  constexpr Value from_mont(const Value& v) const;
+
+  // 1 and -1 in Montgomery form.
+  constexpr const Value& one() const { return one_; }
+  constexpr Value minus_one() const { return n_ - one_; }
+
+  constexpr Value mul(const Value& a, const Value& b) const;
+  constexpr Value add(const Value& a, const Value& b) const;
+  constexpr Value sub(const Value& a, const Value& b) const;
+  // a / 2 mod n
+  constexpr Value half(const Value& a) const;
+  // base^exp, base in Montgomery form, exp as a plain integer.
+  constexpr Value pow(const Value& base, const Value& exp) const;
+
+  // out[i] = mul(a[i], b[i]), out may alias a or b. Uses the AVX-512 IFMA
+  // kernel when the CPU has it.
+  void mul(const Ap_uint_array<bits>& a, const Ap_uint_array<bits>& b,
+           Ap_uint_array<bits>& out) const;
+
+ private:
+  friend struct detail::Montgomery_array<bits>;
+
+  // Same words as Value, but with no unused bits, so that carries out of
+  // bit (bits - 1) are never lost.
+  using Word = std::uint64_t;
+  static constexpr std::size_t words = Value::Storage::words;
+  using Limbs = detail::Int_storage<words * 64, Word>;
+
+  static constexpr Limbs limbs(const Value& v) {
+    return detail::resize<words * 64>(v.data_);
+  }
+  static constexpr Value value(const Limbs& v) {
+    Value result{0};
+    result.data_ = detail::resize<bits>(v);
+    return result;
+  }
+
+  // a + b mod n, with a, b < n
+  constexpr Limbs add_mod(Limbs a, const Limbs& b) const;
+  constexpr Limbs redc_mul(const Limbs& a, const Limbs& b) const;
+
+  Value n_;
+  Value one_;
+  Value r2_;
+  // -n^-1 mod 2^64
+  Word n_inv_ = 0;
+};
+
+template <std::size_t bits>
+constexpr Montgomery<bits>::Montgomery(const Value& modulus)
+    : n_(modulus), one_(0), r2_(0) {
+  assert((n_.data_[0] & 1) == 1 && n_ > 1);
+
+  // Newton's iteration doubles the number of correct bits each step, and
+  // n * n == 1 mod 8 for any odd n.
+  Word inv = n_.data_[0];
+  for (int i = 0; i < 5; ++i) {
+    inv *= 2 - n_.data_[0] * inv;
+  }
+  n_inv_ = Word(0) - inv;
+
+  // R mod n and R^2 mod n, by repeated doubling.
+  Limbs acc{1};
+  for (std::size_t i = 0; i < words * 64; ++i) {
+    acc = add_mod(acc, acc);
+  }
+  one_ = value(acc);
+  for (std::size_t i = 0; i < words * 64; ++i) {
+    acc = add_mod(acc, acc);
+  }
+  r2_ = value(acc);
+}
+
+template <std::size_t bits>
+constexpr typename Montgomery<bits>::Limbs Montgomery<bits>::add_mod(
+    Limbs a, const Limbs& b) const {
+  auto n = limbs(n_);
+  bool carry = a.add(b);
+  if (carry || a.compare(n) >= 0) {
+    a.subtract(n);
+  }
+  return a;
+}
+
+// Coarsely integrated operand scanning: a * b * R^-1 mod n
+template <std::size_t bits>
+constexpr typename Montgomery<bits>::Limbs Montgomery<bits>::redc_mul(
+    const Limbs& a, const Limbs& b) const {
+  std::array<Word, words + 2> t{};
+  const auto& n = n_.data_;
+
+  for (std::size_t i = 0; i < words; ++i) {
+    // t += a * b[i]
+    Word carry = 0;
+    for (std::size_t j = 0; j < words; ++j) {
+      auto [lo, hi] = detail::mul_wide(a[j], b[i]);
+      lo += t[j];
+      hi += lo < t[j];
+      lo += carry;
+      hi += lo < carry;
+      t[j] = lo;
+      carry = hi;
+    }
+    t[words] += carry;
+    t[words + 1] = t[words] < carry;
+
+    // t = (t + m * n) / 2^64, with m chosen so that the low word cancels.
+    Word m = t[0] * n_inv_;
+    auto [lo, hi] = detail::mul_wide(m, n[0]);
+    lo += t[0];
+    carry = hi + (lo < t[0]);
+    for (std::size_t j = 1; j < words; ++j) {
+      auto [lo_j, hi_j] = detail::mul_wide(m, n[j]);
+      lo_j += t[j];
+      hi_j += lo_j < t[j];
+      lo_j += carry;
+      hi_j += lo_j < carry;
+      t[j - 1] = lo_j;
+      carry = hi_j;
+    }
+    t[words - 1] = t[words] + carry;
+    t[words] = t[words + 1] + (t[words - 1] < carry);
+  }
+
+  Limbs result{0};
+  for (std::size_t i = 0; i < words; ++i) {
+    result[i] = t[i];
+  }
+
+  auto mod = limbs(n_);
+  if (t[words] != 0 || result.compare(mod) >= 0) {
+    result.subtract(mod);
+  }
+  return result;
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::to_mont(const Value& v) const {
+  assert(v < n_);
+  return value(redc_mul(limbs(v), limbs(r2_)));
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::from_mont(
+    const Value& v) const {
+  return value(redc_mul(limbs(v), Limbs{1}));
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::mul(const Value& a,
+                                                    const Value& b) const {
+  return value(redc_mul(limbs(a), limbs(b)));
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::add(const Value& a,
+                                                    const Value& b) const {
+  return value(add_mod(limbs(a), limbs(b)));
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::sub(const Value& a,
+                                                    const Value& b) const {
+  auto result = limbs(a);
+  if (result.subtract(limbs(b))) {
+    result.add(limbs(n_));
+  }
+  return value(result);
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::half(const Value& a) const {
+  auto result = limbs(a);
+  bool carry = false;
+  if (result[0] & 1) {
+    carry = result.add(limbs(n_));
+  }
+  result.rshift(1);
+  if (carry) {
+    result[words - 1] |= Word(1) << 63;
+  }
+  return value(result);
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> Montgomery<bits>::pow(const Value& base,
+                                                    const Value& exp) const {
+  auto b = limbs(base);
+  auto result = limbs(one_);
+
+  std::size_t len = bits - exp.data_.count_leading_zeros();
+  while (len--) {
+    result = redc_mul(result, result);
+    if (exp.data_.get_bit(len)) {
+      result = redc_mul(result, b);
+    }
+  }
+  return value(result);
+}
+
+namespace detail {
+template <std::size_t bits>
+struct Montgomery_array {
+  using Kernels = Uint_array_kernels<bits>;
+  using Array = Ap_uint_array<bits>;
+
+  // Montgomery::mul() of arrays, with the kernels of level.
+  static void mul(Isa level, const Montgomery<bits>& ctx, const Array& a,
+                  const Array& b, Array& out) {
+    typename Kernels::Operands op(a, b, &out);
+    std::size_t i = 0;
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+    if (level == Isa::avx512_ifma) {
+      constexpr std::uint64_t low52 = (std::uint64_t(1) << 52) - 1;
+      i = Kernels::montgomery_mul_ifma(op, ctx.n_.data_, ctx.n_inv_ & low52,
+                                       a.size());
+    }
+#endif
+    (void)level;
+    for (; i < a.size(); ++i) {
+      out.set(i, ctx.mul(a.get(i), b.get(i)));
+    }
+  }
+};
+}  // namespace detail
+
+template <std::size_t bits>
+void Montgomery<bits>::mul(const Ap_uint_array<bits>& a,
+                           const Ap_uint_array<bits>& b,
+                           Ap_uint_array<bits>& out) const {
+  detail::Montgomery_array<bits>::mul(detail::isa(), *this, a, b, out);
+}
+
+// base^exp mod mod
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> powmod(const Large_ap_uint<bits>& base,
+                                     const Large_ap_uint<bits>& exp,
+                                     const Large_ap_uint<bits>& mod) {
+  assert(mod != 0);
+  if (mod == 1) {
+    return Large_ap_uint<bits>{0};
+  }
+
+  if ((mod.data_[0] & 1) == 1) {
+    Montgomery<bits> ctx(mod);
+    return ctx.from_mont(ctx.pow(ctx.to_mont(base % mod), exp));
+  }
+
+  // Even moduli: plain square and multiply on a double-width product.
+  using Wide = Large_ap_uint<bits * 2>;
+  auto widen = [](const Large_ap_uint<bits>& v) {
+    Wide result{0};
+    for (std::size_t i = 0; i < v.data_.words; ++i) {
+      result.data_[i] = v.data_[i];
+    }
+    return result;
+  };
+  auto narrow = [](const Wide& v) {
+    Large_ap_uint<bits> result{0};
+    for (std::size_t i = 0; i < result.data_.words; ++i) {
+      result.data_[i] = v.data_[i];
+    }
+    return result;
+  };
+
+  auto m = widen(mod);
+  auto b = widen(base) % m;
+  auto result = Wide{1};
+  std::size_t len = bits - exp.data_.count_leading_zeros();
+  while (len--) {
+    result = (result * result) % m;
+    if (exp.data_.get_bit(len)) {
+      result = (result * b) % m;
+    }
+  }
+  return narrow(result);
+}
+}  // namespace vecpp
+
+#endif
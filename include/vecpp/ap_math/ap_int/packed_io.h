@@ -0,0 +1,677 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_PACKED_IO_INCLUDED_H
+#define VECPP_AP_INT_PACKED_IO_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/mapped_file.h"
+#include "vecpp/ap_math/ap_int/small.h"
+#include "vecpp/ap_math/ap_int/small_array.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+// Streams of Ap_int<bits> / Ap_uint<bits> values on disk, version 1.
+// Everything is little endian, and the host must be too:
+//
+//   header, 16 bytes:
+//     char[4]  "VPAI"
+//     u16      version, 1
+//     u8       encoding, see Packed_encoding
+//     u8       1 if the values are signed
+//     u32      bits per value
+//     u32      values per chunk, a multiple of 64
+//   chunks, each:
+//     u32      number of values, at most the chunk size
+//     u32      payload bytes
+//     payload, zero padded to a multiple of 8 bytes
+//   a chunk of 0 values, with no payload, ends the stream.
+//
+// Every chunk but the last one holds the chunk size, so a fixed width
+// value is found without reading the chunks before it.
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "The packed format is read and written in place");
+#endif
+
+namespace vecpp {
+
+enum class Packed_encoding : std::uint8_t {
+  // Value i of a chunk takes bits [i * bits, i * bits + bits) of the
+  // payload, read as 64 bit words. Signed values are in two's complement.
+  fixed = 0,
+  // LEB128, 7 bits per byte with the high bit set on all but the last
+  // byte. Signed values are zigzag encoded first: 2x for x >= 0, -2x - 1
+  // for x < 0. Small magnitudes take fewer bytes.
+  varint = 1,
+};
+
+namespace detail {
+
+constexpr char packed_magic[4] = {'V', 'P', 'A', 'I'};
+constexpr std::uint16_t packed_version = 1;
+constexpr std::size_t packed_header_bytes = 16;
+constexpr std::size_t packed_chunk_header_bytes = 8;
+
+struct Packed_header {
+  Packed_encoding encoding;
+  bool is_signed;
+  std::uint32_t bits;
+  std::uint32_t chunk_size;
+
+  void store(char* out) const {
+    std::uint16_t version = packed_version;
+    std::memcpy(out, packed_magic, 4);
+    std::memcpy(out + 4, &version, 2);
+    out[6] = char(encoding);
+    out[7] = char(is_signed);
+    std::memcpy(out + 8, &bits, 4);
+    std::memcpy(out + 12, &chunk_size, 4);
+  }
+
+  // False if in is not a header this version can read.
+  bool load(const char* in) {
+    std::uint16_t version;
+    std::memcpy(&version, in + 4, 2);
+    std::memcpy(&bits, in + 8, 4);
+    std::memcpy(&chunk_size, in + 12, 4);
+    encoding = Packed_encoding(in[6]);
+    is_signed = in[7] != 0;
+    return std::memcmp(in, packed_magic, 4) == 0 &&
+           version == packed_version &&
+           (encoding == Packed_encoding::fixed ||
+            encoding == Packed_encoding::varint) &&
+           chunk_size > 0 && chunk_size % 64 == 0;
+  }
+};
+
+// Bytes of a fixed width payload.
+constexpr std::size_t packed_fixed_bytes(std::size_t count,
+                                         std::size_t bits) {
+  return (count * bits + 63) / 64 * 8;
+}
+
+// ORs the low n bits of limbs, whose bits above n are clear, into the
+// zeroed words at bit offset bit.
+inline void put_bits(std::uint64_t* words, std::size_t bit,
+                     const std::uint64_t* limbs, std::size_t n) {
+  for (std::size_t k = 0; 64 * k < n; ++k) {
+    std::size_t pos = bit + 64 * k;
+    std::size_t shift = pos % 64;
+    std::size_t length = std::min<std::size_t>(64, n - 64 * k);
+    words[pos / 64] |= limbs[k] << shift;
+    if (shift + length > 64) {
+      words[pos / 64 + 1] |= limbs[k] >> (64 - shift);
+    }
+  }
+}
+
+// Bits [bit, bit + n) of words, with 0 < n <= 64. Nothing past them is
+// read.
+inline std::uint64_t get_bits(const std::uint64_t* words, std::size_t bit,
+                              std::size_t n) {
+  std::size_t shift = bit % 64;
+  std::uint64_t v = words[bit / 64] >> shift;
+  if (shift + n > 64) {
+    v |= words[bit / 64 + 1] << (64 - shift);
+  }
+  return n == 64 ? v : v & ((std::uint64_t(1) << n) - 1);
+}
+
+// How each type maps to limbs: the low bits bits, two's complement for
+// signed types, with everything above them clear.
+template <typename T>
+struct Packed_traits;
+
+template <std::size_t b, bool s>
+struct Packed_traits<Small_ap_int<b, s>> {
+  using Value = Small_ap_int<b, s>;
+  using Storage = typename Small_storage_selector<b, s>::type;
+  static constexpr std::size_t bits = b;
+  static constexpr bool is_signed = s;
+  static constexpr std::size_t words = 1;
+  static constexpr bool is_small = true;
+
+  static void to_limbs(const Value& v, std::uint64_t* limbs) {
+    limbs[0] = std::uint64_t(Storage(v)) & Small_ap_int_array<b, s>::mask;
+  }
+
+  static Value from_limbs(const std::uint64_t* limbs) {
+    std::uint64_t v = limbs[0];
+    if (s) {
+      std::uint64_t sign = std::uint64_t(1) << (b - 1);
+      v = (v ^ sign) - sign;
+    }
+    return Value(Storage(v));
+  }
+};
+
+template <typename T, std::size_t b, bool s>
+struct Large_packed_traits {
+  static constexpr std::size_t bits = b;
+  static constexpr bool is_signed = s;
+  static constexpr std::size_t words = T::Storage::words;
+  static constexpr bool is_small = false;
+
+  static void to_limbs(const T& v, std::uint64_t* limbs) {
+    for (std::size_t k = 0; k < words; ++k) {
+      limbs[k] = v.data_[k];
+    }
+  }
+
+  static T from_limbs(const std::uint64_t* limbs) {
+    T v{0};
+    for (std::size_t k = 0; k < words; ++k) {
+      v.data_[k] = limbs[k];
+    }
+    return v;
+  }
+};
+
+template <std::size_t b>
+struct Packed_traits<Large_ap_uint<b>>
+    : Large_packed_traits<Large_ap_uint<b>, b, false> {};
+
+template <std::size_t b>
+struct Packed_traits<Large_ap_int<b>>
+    : Large_packed_traits<Large_ap_int<b>, b, true> {};
+
+// LEB128 of zigzag encoded values. The zigzag form takes one more bit
+// than the value.
+template <typename T>
+struct Packed_varint {
+  using Traits = Packed_traits<T>;
+  static constexpr std::size_t bits = Traits::bits;
+  static constexpr std::size_t words = (bits + 1 + 63) / 64;
+  using Limbs = std::array<std::uint64_t, words>;
+  static constexpr std::size_t max_bytes = (64 * words + 6) / 7;
+
+  // Writes at most max_bytes to out, returns the position after them.
+  static unsigned char* encode(const T& v, unsigned char* out) {
+    Limbs x{};
+    Traits::to_limbs(v, x.data());
+    if (Traits::is_signed) {
+      // (x << 1) ^ (x >> (bits - 1)), over bits + 1 bits.
+      bool negative = (x[(bits - 1) / 64] >> ((bits - 1) % 64)) & 1;
+      std::uint64_t flip = negative ? ~std::uint64_t(0) : 0;
+      for (std::size_t k = words; k-- > 0;) {
+        x[k] = ((x[k] << 1) | (k > 0 ? x[k - 1] >> 63 : 0)) ^ flip;
+      }
+      if ((bits + 1) % 64 != 0) {
+        x[words - 1] &= (std::uint64_t(1) << ((bits + 1) % 64)) - 1;
+      }
+    }
+    if constexpr (words == 1) {
+      std::uint64_t z = x[0];
+      for (; z >= 0x80; z >>= 7) {
+        *out++ = (unsigned char)(z | 0x80);
+      }
+      *out++ = (unsigned char)z;
+      return out;
+    }
+    // Significant bits.
+    std::size_t end = 0;
+    for (std::size_t k = words; k-- > 0;) {
+      if (x[k] != 0) {
+        end = 64 * k;
+        for (auto t = x[k]; t != 0; t >>= 1) {
+          ++end;
+        }
+        break;
+      }
+    }
+    std::size_t bit = 0;
+    do {
+      std::size_t n = std::min<std::size_t>(7, end > bit ? end - bit : 1);
+      auto byte = (unsigned char)(get_bits(x.data(), bit, n));
+      bit += 7;
+      *out++ = bit < end ? byte | 0x80 : byte;
+    } while (bit < end);
+    return out;
+  }
+
+  // Decodes one value from [in, end), returns the position after it, or
+  // null if it runs past end or holds more bits than the type.
+  static const unsigned char* decode(const unsigned char* in,
+                                     const unsigned char* end, T& v) {
+    Limbs x{};
+    for (std::size_t bit = 0;; bit += 7) {
+      if (in == end || bit >= words * 64) {
+        return nullptr;
+      }
+      std::uint64_t byte = *in & 0x7f;
+      x[bit / 64] |= byte << (bit % 64);
+      if (bit % 64 > 57 && bit / 64 + 1 < words) {
+        x[bit / 64 + 1] |= byte >> (64 - bit % 64);
+      }
+      if (!(*in++ & 0x80)) {
+        break;
+      }
+    }
+    std::array<std::uint64_t, Traits::words> limbs{};
+    if (Traits::is_signed) {
+      // x >> 1, negated bitwise when odd.
+      std::uint64_t flip = (x[0] & 1) ? ~std::uint64_t(0) : 0;
+      for (std::size_t k = 0; k < Traits::words; ++k) {
+        std::uint64_t next = k + 1 < words ? x[k + 1] : 0;
+        limbs[k] = ((x[k] >> 1) | (next << 63)) ^ flip;
+      }
+    } else {
+      for (std::size_t k = 0; k < Traits::words; ++k) {
+        limbs[k] = x[k];
+      }
+    }
+    if (bits % 64 != 0) {
+      limbs[Traits::words - 1] &= (std::uint64_t(1) << (bits % 64)) - 1;
+    }
+    v = Traits::from_limbs(limbs.data());
+    return in;
+  }
+};
+
+// Fixed width payload of count values, in words sized to whole blocks of
+// 64 values and zeroed.
+template <typename T>
+void pack_fixed(const T* values, std::size_t count,
+                std::vector<std::uint64_t>& words) {
+  using Traits = Packed_traits<T>;
+  words.assign((count + 63) / 64 * Traits::bits, 0);
+  if constexpr (Traits::is_small) {
+    Small_array_kernels<Traits::bits, Traits::is_signed>::pack(values, count,
+                                                               words.data());
+  } else if constexpr (Traits::bits % 64 == 0) {
+    // Values are whole words.
+    for (std::size_t i = 0; i < count; ++i) {
+      Traits::to_limbs(values[i], words.data() + i * Traits::words);
+    }
+  } else {
+    std::uint64_t limbs[Traits::words];
+    for (std::size_t i = 0; i < count; ++i) {
+      Traits::to_limbs(values[i], limbs);
+      put_bits(words.data(), i * Traits::bits, limbs, Traits::bits);
+    }
+  }
+}
+
+// Value i of a fixed width payload, which is only read where it holds the
+// value.
+template <typename T>
+T get_fixed(const std::uint64_t* words, std::size_t i) {
+  using Traits = Packed_traits<T>;
+  std::uint64_t limbs[Traits::words];
+  std::size_t bit = i * Traits::bits;
+  for (std::size_t k = 0; k < Traits::words; ++k) {
+    std::size_t n = std::min<std::size_t>(64, Traits::bits - 64 * k);
+    limbs[k] = get_bits(words, bit + 64 * k, n);
+  }
+  return Traits::from_limbs(limbs);
+}
+
+// Unpacks a fixed width payload, in words sized to whole blocks of 64.
+template <typename T>
+void unpack_fixed(const std::uint64_t* words, std::size_t count, T* values) {
+  using Traits = Packed_traits<T>;
+  if constexpr (Traits::is_small) {
+    Small_array_kernels<Traits::bits, Traits::is_signed>::unpack(words, count,
+                                                                 values);
+  } else {
+    for (std::size_t i = 0; i < count; ++i) {
+      values[i] = get_fixed<T>(words, i);
+    }
+  }
+}
+}  // namespace detail
+
+// Writes values to a stream in the packed format, a chunk at a time.
+// Errors are reported through the stream's state. close(), or the
+// destructor, writes the last chunk and the end of the stream.
+//
+// chunk_size is rounded up to a multiple of 64, and capped at
+// max_chunk_size(encoding).
+template <typename T>
+class Packed_writer {
+ public:
+  using Traits = detail::Packed_traits<T>;
+
+  explicit Packed_writer(std::ostream& out,
+                         Packed_encoding encoding = Packed_encoding::fixed,
+                         std::uint32_t chunk_size = 1 << 16)
+      : out_(out),
+        header_{encoding, Traits::is_signed, std::uint32_t(Traits::bits),
+                std::uint32_t(std::min<std::uint64_t>(
+                    std::max<std::uint64_t>(
+                        64, (std::uint64_t(chunk_size) + 63) / 64 * 64),
+                    max_chunk_size(encoding)))} {
+    char header[detail::packed_header_bytes];
+    header_.store(header);
+    out_.write(header, sizeof(header));
+    // Chunks larger than the default grow as they fill.
+    pending_.reserve(std::min<std::uint32_t>(header_.chunk_size, 1 << 16));
+  }
+
+  // The largest multiple of 64 values whose payload always fits the 32 bit
+  // size of a chunk header, padding included.
+  static constexpr std::uint32_t max_chunk_size(Packed_encoding encoding) {
+    constexpr std::uint64_t max_bytes = 0xffffffff - 7;
+    std::uint64_t count =
+        encoding == Packed_encoding::fixed
+            ? max_bytes * 8 / Traits::bits
+            : max_bytes / detail::Packed_varint<T>::max_bytes;
+    return std::uint32_t(std::min<std::uint64_t>(count, 0xffffffff) / 64 *
+                         64);
+  }
+
+  Packed_writer(const Packed_writer&) = delete;
+  Packed_writer& operator=(const Packed_writer&) = delete;
+
+  ~Packed_writer() { close(); }
+
+  void write(const T& v) {
+    pending_.push_back(v);
+    if (pending_.size() == header_.chunk_size) {
+      flush_chunk();
+    }
+  }
+
+  void write(const T* values, std::size_t count) {
+    // Whole chunks go out without a copy.
+    if (pending_.empty() && count >= header_.chunk_size) {
+      std::size_t n = count / header_.chunk_size * header_.chunk_size;
+      for (std::size_t i = 0; i < n; i += header_.chunk_size) {
+        write_chunk(values + i, header_.chunk_size);
+      }
+      values += n;
+      count -= n;
+    }
+    while (count > 0) {
+      std::size_t n =
+          std::min<std::size_t>(count, header_.chunk_size - pending_.size());
+      pending_.insert(pending_.end(), values, values + n);
+      values += n;
+      count -= n;
+      if (pending_.size() == header_.chunk_size) {
+        flush_chunk();
+      }
+    }
+  }
+
+  void close() {
+    if (closed_) {
+      return;
+    }
+    flush_chunk();
+    write_chunk_header(0, 0);
+    out_.flush();
+    closed_ = true;
+  }
+
+ private:
+  void write_chunk_header(std::uint32_t count, std::uint32_t bytes) {
+    char header[detail::packed_chunk_header_bytes];
+    std::memcpy(header, &count, 4);
+    std::memcpy(header + 4, &bytes, 4);
+    out_.write(header, sizeof(header));
+  }
+
+  void flush_chunk() {
+    if (!pending_.empty()) {
+      write_chunk(pending_.data(), pending_.size());
+      pending_.clear();
+    }
+  }
+
+  void write_chunk(const T* values, std::size_t n) {
+    auto count = std::uint32_t(n);
+    if (header_.encoding == Packed_encoding::fixed) {
+      detail::pack_fixed(values, count, words_);
+      auto bytes = detail::packed_fixed_bytes(count, Traits::bits);
+      write_chunk_header(count, std::uint32_t(bytes));
+      out_.write(reinterpret_cast<const char*>(words_.data()), bytes);
+    } else {
+      using Varint = detail::Packed_varint<T>;
+      bytes_.resize(count * Varint::max_bytes + 8);
+      unsigned char* end = bytes_.data();
+      for (std::size_t i = 0; i < count; ++i) {
+        end = Varint::encode(values[i], end);
+      }
+      auto size = std::size_t(end - bytes_.data());
+      auto padded = (size + 7) / 8 * 8;
+      std::fill(end, bytes_.data() + padded, 0);
+      write_chunk_header(count, std::uint32_t(size));
+      out_.write(reinterpret_cast<const char*>(bytes_.data()), padded);
+    }
+  }
+
+  std::ostream& out_;
+  detail::Packed_header header_;
+  std::vector<T> pending_;
+  std::vector<std::uint64_t> words_;
+  std::vector<unsigned char> bytes_;
+  bool closed_ = false;
+};
+
+// Reads values written by Packed_writer<T>, a chunk at a time.
+template <typename T>
+class Packed_reader {
+ public:
+  using Traits = detail::Packed_traits<T>;
+
+  explicit Packed_reader(std::istream& in) : in_(in) {
+    char header[detail::packed_header_bytes];
+    failed_ = !in_.read(header, sizeof(header)) || !header_.load(header) ||
+              header_.bits != Traits::bits ||
+              header_.is_signed != Traits::is_signed;
+  }
+
+  Packed_reader(const Packed_reader&) = delete;
+  Packed_reader& operator=(const Packed_reader&) = delete;
+
+  // False once the stream ends, or on an error.
+  bool read(T& v) {
+    if (next_ == chunk_.size() && !read_chunk()) {
+      return false;
+    }
+    v = chunk_[next_++];
+    return true;
+  }
+
+  // Reads up to count values, returns how many were read.
+  std::size_t read(T* values, std::size_t count) {
+    std::size_t done = 0;
+    while (done < count && (next_ < chunk_.size() || read_chunk())) {
+      std::size_t n = std::min(count - done, chunk_.size() - next_);
+      std::copy_n(chunk_.begin() + next_, n, values + done);
+      next_ += n;
+      done += n;
+    }
+    return done;
+  }
+
+  // The stream ended early, or does not hold T values.
+  bool fail() const { return failed_; }
+
+ private:
+  bool read_chunk() {
+    chunk_.clear();
+    next_ = 0;
+    if (failed_ || ended_) {
+      return false;
+    }
+    char header[detail::packed_chunk_header_bytes];
+    std::uint32_t count;
+    std::uint32_t bytes;
+    if (!in_.read(header, sizeof(header))) {
+      failed_ = true;
+      return false;
+    }
+    std::memcpy(&count, header, 4);
+    std::memcpy(&bytes, header + 4, 4);
+    if (count == 0) {
+      ended_ = true;
+      return false;
+    }
+    // Varints take between 1 and max_bytes bytes each.
+    bool size_ok =
+        header_.encoding == Packed_encoding::fixed
+            ? bytes == detail::packed_fixed_bytes(count, Traits::bits)
+            : bytes >= count &&
+                  bytes <= std::uint64_t(count) *
+                               detail::Packed_varint<T>::max_bytes;
+    if (count > header_.chunk_size || !size_ok || !read_payload(bytes)) {
+      failed_ = true;
+      return false;
+    }
+    // Whole blocks of 64 values for unpack_fixed(), the rest stays zero.
+    words_.resize(
+        std::max(words_.size(), (count + 63) / 64 * Traits::bits), 0);
+    chunk_.resize(count, T{0});
+    if (header_.encoding == Packed_encoding::fixed) {
+      detail::unpack_fixed(words_.data(), count, chunk_.data());
+    } else {
+      auto p = reinterpret_cast<const unsigned char*>(words_.data());
+      auto end = p + bytes;
+      for (auto& v : chunk_) {
+        if (!(p = detail::Packed_varint<T>::decode(p, end, v))) {
+          failed_ = true;
+          chunk_.clear();
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Reads bytes bytes, padded to whole words, into words_. The buffer
+  // grows as the data arrives, so that a corrupt size runs into the end
+  // of the stream before it costs a large allocation.
+  bool read_payload(std::size_t bytes) {
+    std::size_t padded = (bytes + 7) / 8 * 8;
+    std::size_t done = 0;
+    words_.clear();
+    while (done < padded) {
+      std::size_t step = std::min(padded - done, std::max<std::size_t>(
+                                                     done, 1 << 16));
+      words_.resize((done + step) / 8);
+      if (!in_.read(reinterpret_cast<char*>(words_.data()) + done,
+                    std::streamsize(step))) {
+        return false;
+      }
+      done += step;
+    }
+    return true;
+  }
+
+  std::istream& in_;
+  detail::Packed_header header_;
+  std::vector<T> chunk_;
+  std::size_t next_ = 0;
+  std::vector<std::uint64_t> words_;
+  bool failed_ = false;
+  bool ended_ = false;
+};
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+// Random access to a fixed width file written by Packed_writer<T>, mapped
+// in memory. Values are decoded from the mapping on access. is_open() is
+// false if the file could not be mapped, or is not such a file.
+template <typename T>
+class Mapped_packed_array {
+ public:
+  using Traits = detail::Packed_traits<T>;
+
+  explicit Mapped_packed_array(const char* path) : file_(path, false) {
+    if (file_.is_open() && !index()) {
+      file_.close();
+      size_ = 0;
+    }
+  }
+
+  Mapped_packed_array(Mapped_packed_array&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  Mapped_packed_array& operator=(Mapped_packed_array&& other) noexcept {
+    std::swap(file_, other.file_);
+    std::swap(size_, other.size_);
+    std::swap(chunk_size_, other.chunk_size_);
+    std::swap(chunk_stride_, other.chunk_stride_);
+    return *this;
+  }
+
+  bool is_open() const { return file_.is_open(); }
+  std::size_t size() const { return size_; }
+
+  T operator[](std::size_t i) const {
+    return detail::get_fixed<T>(chunk_words(i / chunk_size_), i % chunk_size_);
+  }
+
+  // Fixed width payload of chunk c, 8 byte aligned.
+  const std::uint64_t* chunk_words(std::size_t c) const {
+    return reinterpret_cast<const std::uint64_t*>(
+        file_.data() + detail::packed_header_bytes + c * chunk_stride_ +
+        detail::packed_chunk_header_bytes);
+  }
+
+ private:
+  // Checks the header and the chunk sizes.
+  bool index() {
+    const char* data = file_.data();
+    std::size_t file_bytes = file_.size();
+    detail::Packed_header header;
+    if (file_bytes < detail::packed_header_bytes || !header.load(data) ||
+        header.encoding != Packed_encoding::fixed ||
+        header.bits != Traits::bits || header.is_signed != Traits::is_signed) {
+      return false;
+    }
+    chunk_size_ = header.chunk_size;
+    chunk_stride_ = detail::packed_chunk_header_bytes +
+                    detail::packed_fixed_bytes(chunk_size_, Traits::bits);
+    std::size_t pos = detail::packed_header_bytes;
+    bool last = false;
+    for (;;) {
+      std::uint32_t count;
+      std::uint32_t bytes;
+      if (pos + detail::packed_chunk_header_bytes > file_bytes) {
+        return false;
+      }
+      std::memcpy(&count, data + pos, 4);
+      std::memcpy(&bytes, data + pos + 4, 4);
+      if (count == 0) {
+        return true;
+      }
+      // Only the last chunk may be partial.
+      if (last || count > chunk_size_ ||
+          bytes != detail::packed_fixed_bytes(count, Traits::bits)) {
+        return false;
+      }
+      last = count < chunk_size_;
+      pos += detail::packed_chunk_header_bytes + bytes;
+      if (pos > file_bytes) {
+        return false;
+      }
+      size_ += count;
+    }
+  }
+
+  detail::Mapped_file file_;
+  std::size_t size_ = 0;
+  std::size_t chunk_size_ = 0;
+  std::size_t chunk_stride_ = 0;
+};
+#endif
+}  // namespace vecpp
+
+#endif
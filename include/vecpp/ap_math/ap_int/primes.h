@@ -0,0 +1,444 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  See the accompanying LICENSE file for licensing details.
+
+#ifndef VECPP_AP_INT_PRIMES_INCLUDED_H
+#define VECPP_AP_INT_PRIMES_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+#include "vecpp/ap_math/ap_int/montgomery.h"
+#include "vecpp/ap_math/ap_int/roots.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vecpp {
+
+namespace detail {
+constexpr std::size_t small_prime_limit = 4096;
+
+constexpr std::array<bool, small_prime_limit> small_prime_sieve() {
+  std::array<bool, small_prime_limit> composite{};
+  composite[0] = composite[1] = true;
+  for (std::size_t i = 2; i * i < small_prime_limit; ++i) {
+    if (!composite[i]) {
+      for (std::size_t j = i * i; j < small_prime_limit; j += i) {
+        composite[j] = true;
+      }
+    }
+  }
+  return composite;
+}
+
+constexpr std::size_t count_small_primes() {
+  auto composite = small_prime_sieve();
+  std::size_t result = 0;
+  for (bool c : composite) {
+    result += c ? 0 : 1;
+  }
+  return result;
+}
+
+constexpr auto make_small_primes() {
+  auto composite = small_prime_sieve();
+  std::array<std::uint32_t, count_small_primes()> result{};
+  std::size_t next = 0;
+  for (std::size_t i = 0; i < small_prime_limit; ++i) {
+    if (!composite[i]) {
+      result[next++] = std::uint32_t(i);
+    }
+  }
+  return result;
+}
+
+// All primes below small_prime_limit, in increasing order.
+inline constexpr auto small_primes = make_small_primes();
+
+// Calls f(index, v mod small_primes[index]) for every odd small prime, using
+// one multi-word division per group of primes whose product fits in a word.
+template <std::size_t bits, typename F>
+constexpr void for_each_small_prime_residue(const Large_ap_uint<bits>& v,
+                                            F&& f) {
+  std::size_t i = 1;
+  while (i < small_primes.size()) {
+    std::uint64_t product = small_primes[i];
+    std::size_t end = i + 1;
+    while (end < small_primes.size() &&
+           product <= ~std::uint64_t(0) / small_primes[end]) {
+      product *= small_primes[end++];
+    }
+
+    auto tmp = v;
+    std::uint64_t rem = tmp.data_.divmod_word(product);
+    for (; i < end; ++i) {
+      f(i, std::uint32_t(rem % small_primes[i]));
+    }
+  }
+}
+
+// Jacobi symbol (a / n) for odd n.
+constexpr int jacobi_word(std::uint64_t a, std::uint64_t n) {
+  int result = 1;
+  a %= n;
+  while (a != 0) {
+    while ((a & 1) == 0) {
+      a >>= 1;
+      auto r = n & 7;
+      if (r == 3 || r == 5) {
+        result = -result;
+      }
+    }
+    std::uint64_t tmp = a;
+    a = n;
+    n = tmp;
+    if ((a & 3) == 3 && (n & 3) == 3) {
+      result = -result;
+    }
+    a %= n;
+  }
+  return n == 1 ? result : 0;
+}
+
+template <std::size_t bits>
+constexpr int jacobi(std::int64_t a, const Large_ap_uint<bits>& n) {
+  int result = 1;
+  std::uint64_t ua = std::uint64_t(a);
+  if (a < 0) {
+    ua = std::uint64_t(0) - ua;
+    if ((n.data_[0] & 3) == 3) {
+      result = -result;
+    }
+  }
+  if (ua == 0) {
+    return n == 1 ? 1 : 0;
+  }
+
+  while ((ua & 1) == 0) {
+    ua >>= 1;
+    auto r = n.data_[0] & 7;
+    if (r == 3 || r == 5) {
+      result = -result;
+    }
+  }
+  if (ua == 1) {
+    return result;
+  }
+
+  // Quadratic reciprocity brings it back to single words.
+  if ((ua & 3) == 3 && (n.data_[0] & 3) == 3) {
+    result = -result;
+  }
+  auto tmp = n;
+  return result * jacobi_word(tmp.data_.divmod_word(ua), ua);
+}
+
+// Strong probable prime test of n to base, given n - 1 = d * 2^s.
+template <std::size_t bits>
+constexpr bool strong_probable_prime(const Montgomery<bits>& ctx,
+                                     const Large_ap_uint<bits>& base,
+                                     const Large_ap_uint<bits>& d,
+                                     std::size_t s) {
+  auto x = ctx.pow(ctx.to_mont(base), d);
+  auto minus_one = ctx.minus_one();
+  if (x == ctx.one() || x == minus_one) {
+    return true;
+  }
+  for (std::size_t r = 1; r < s; ++r) {
+    x = ctx.mul(x, x);
+    if (x == minus_one) {
+      return true;
+    }
+    if (x == ctx.one()) {
+      return false;
+    }
+  }
+  return false;
+}
+
+// Splits n - 1 into d * 2^s, n must be odd.
+template <std::size_t bits>
+constexpr std::size_t split_even_part(const Large_ap_uint<bits>& n,
+                                      Large_ap_uint<bits>& d) {
+  d = n - 1;
+  std::size_t s = 0;
+  while (!d.data_.get_bit(s)) {
+    ++s;
+  }
+  d >>= s;
+  return s;
+}
+
+// Strong Lucas probable prime test, with Selfridge's parameters (method A).
+template <std::size_t bits>
+constexpr bool strong_lucas_probable_prime(const Large_ap_uint<bits>& n) {
+  using Value = Large_ap_uint<bits>;
+  // No suitable D exists for perfect squares.
+  if (is_perfect_square(n)) {
+    return false;
+  }
+
+  std::int64_t D = 5;
+  while (true) {
+    int j = jacobi(D, n);
+    if (j == -1) {
+      break;
+    }
+    if (j == 0 && n != std::uint64_t(D < 0 ? -D : D)) {
+      return false;
+    }
+    D = D > 0 ? -(D + 2) : -D + 2;
+  }
+  std::int64_t Q = (1 - D) / 4;
+
+  Montgomery<bits> ctx(n);
+  auto to_mont = [&](std::int64_t v) {
+    auto m = ctx.to_mont(Value(std::uint64_t(v < 0 ? -v : v)) % n);
+    return v < 0 ? ctx.sub(Value{0}, m) : m;
+  };
+  auto m_d = to_mont(D);
+  auto m_q = to_mont(Q);
+
+  // n + 1 = d * 2^s
+  Value d = n + 1;
+  std::size_t s = 0;
+  if (d == 0) {
+    // n == 2^bits - 1
+    d = Value{1};
+    s = bits;
+  } else {
+    while (!d.data_.get_bit(s)) {
+      ++s;
+    }
+    d >>= s;
+  }
+
+  // With P = 1:
+  // U(2k) = U(k) V(k),      V(2k) = V(k)^2 - 2 Q^k
+  // U(k+1) = (U(k) + V(k)) / 2,  V(k+1) = (D U(k) + V(k)) / 2
+  auto u = ctx.one();
+  auto v = ctx.one();
+  auto q_k = m_q;
+  std::size_t len = bits - d.data_.count_leading_zeros();
+  for (std::size_t i = len - 1; i-- > 0;) {
+    u = ctx.mul(u, v);
+    v = ctx.sub(ctx.mul(v, v), ctx.add(q_k, q_k));
+    q_k = ctx.mul(q_k, q_k);
+    if (d.data_.get_bit(i)) {
+      auto next_u = ctx.half(ctx.add(u, v));
+      v = ctx.half(ctx.add(ctx.mul(m_d, u), v));
+      u = next_u;
+      q_k = ctx.mul(q_k, m_q);
+    }
+  }
+
+  if (u == 0 || v == 0) {
+    return true;
+  }
+  for (std::size_t r = 1; r < s; ++r) {
+    v = ctx.sub(ctx.mul(v, v), ctx.add(q_k, q_k));
+    if (v == 0) {
+      return true;
+    }
+    q_k = ctx.mul(q_k, q_k);
+  }
+  return false;
+}
+
+constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+  std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Small prime check for values that passed trial division.
+template <std::size_t bits>
+constexpr bool is_small_prime(const Large_ap_uint<bits>& n) {
+  if (n >= small_prime_limit) {
+    return false;
+  }
+  auto v = n.data_[0];
+  for (auto p : small_primes) {
+    if (p == v) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace detail
+
+// Miller-Rabin test. Deterministic for n < 2^64, otherwise performs base 2
+// followed by rounds - 1 pseudo-random bases.
+template <std::size_t bits>
+constexpr bool miller_rabin(const Large_ap_uint<bits>& n,
+                            std::size_t rounds = 25) {
+  using Value = Large_ap_uint<bits>;
+  if (n < 2) {
+    return false;
+  }
+  if ((n.data_[0] & 1) == 0) {
+    return n == 2;
+  }
+
+  constexpr std::uint64_t small_bases[] = {2,  3,  5,  7,  11, 13,
+                                           17, 19, 23, 29, 31, 37};
+  if (n <= 37) {
+    return detail::is_small_prime(n);
+  }
+
+  Montgomery<bits> ctx(n);
+  Value d{0};
+  std::size_t s = detail::split_even_part(n, d);
+
+  if (detail::bit_length(n) <= 64) {
+    for (auto b : small_bases) {
+      if (!detail::strong_probable_prime(ctx, Value{b}, d, s)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (!detail::strong_probable_prime(ctx, Value{2}, d, s)) {
+    return false;
+  }
+
+  // Random bases in [2, 2^(len - 1)), which is always < n - 1.
+  std::size_t len = detail::bit_length(n);
+  std::uint64_t state = n.data_[0] ^ n.data_[1];
+  for (std::size_t r = 1; r < rounds; ++r) {
+    Value base{0};
+    for (std::size_t w = 0; w < base.data_.words; ++w) {
+      base.data_[w] = detail::splitmix64(state);
+    }
+    base.data_.clear_unused_bits();
+    base = (base << (bits - len + 1)) >> (bits - len + 1);
+    if (base < 2) {
+      base = Value{2};
+    }
+    if (!detail::strong_probable_prime(ctx, base, d, s)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Baillie-PSW: strong base 2 test followed by a strong Lucas test. No
+// composite is known to pass it.
+template <std::size_t bits>
+constexpr bool baillie_psw(const Large_ap_uint<bits>& n) {
+  using Value = Large_ap_uint<bits>;
+  if (n < 2) {
+    return false;
+  }
+  if ((n.data_[0] & 1) == 0) {
+    return n == 2;
+  }
+  if (n < 8) {
+    return true;
+  }
+
+  Montgomery<bits> ctx(n);
+  Value d{0};
+  std::size_t s = detail::split_even_part(n, d);
+  if (!detail::strong_probable_prime(ctx, Value{2}, d, s)) {
+    return false;
+  }
+  return detail::strong_lucas_probable_prime(n);
+}
+
+// Trial division by the primes below 4096, then Baillie-PSW, then
+// extra_rounds Miller-Rabin rounds with pseudo-random bases.
+template <std::size_t bits>
+constexpr bool is_probable_prime(const Large_ap_uint<bits>& n,
+                                 std::size_t extra_rounds = 0) {
+  if (n < detail::small_prime_limit) {
+    return detail::is_small_prime(n);
+  }
+  if ((n.data_[0] & 1) == 0) {
+    return false;
+  }
+
+  bool has_factor = false;
+  detail::for_each_small_prime_residue(
+      n, [&](std::size_t, std::uint32_t rem) { has_factor |= rem == 0; });
+  if (has_factor) {
+    return false;
+  }
+  if (n < std::uint64_t(detail::small_prime_limit) *
+              detail::small_prime_limit) {
+    return true;
+  }
+
+  if (!baillie_psw(n)) {
+    return false;
+  }
+  return extra_rounds == 0 || miller_rabin(n, extra_rounds + 1);
+}
+
+// Smallest prime strictly greater than x, or 0 if it does not fit in bits.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> next_prime(const Large_ap_uint<bits>& x) {
+  using Value = Large_ap_uint<bits>;
+  constexpr auto& primes = detail::small_primes;
+
+  if (x < primes.back()) {
+    for (auto p : primes) {
+      if (x < p) {
+        return Value{p};
+      }
+    }
+  }
+
+  // First odd candidate.
+  Value c = x + ((x.data_[0] & 1) ? 2 : 1);
+  if (c < x) {
+    return Value{0};
+  }
+
+  // Candidates are sieved by windows of c, c + 2, ... c + 2 * (window - 1).
+  // The residues of c modulo the small primes are only computed once, and
+  // then advanced as the window moves.
+  constexpr std::size_t window = 4096;
+  std::array<std::uint32_t, primes.size()> residues{};
+  detail::for_each_small_prime_residue(
+      c, [&](std::size_t i, std::uint32_t rem) { residues[i] = rem; });
+
+  while (true) {
+    std::array<bool, window> composite{};
+    for (std::size_t i = 1; i < primes.size(); ++i) {
+      std::uint64_t p = primes[i];
+      // c + 2k == 0 mod p  <=>  k == -c / 2 mod p
+      std::uint64_t k = ((p - residues[i]) % p) * ((p + 1) / 2) % p;
+      for (; k < window; k += p) {
+        composite[k] = true;
+      }
+    }
+
+    for (std::size_t k = 0; k < window; ++k) {
+      if (!composite[k]) {
+        Value candidate = c + 2 * k;
+        if (candidate < c) {
+          return Value{0};
+        }
+        if (baillie_psw(candidate)) {
+          return candidate;
+        }
+      }
+    }
+
+    Value next = c + 2 * window;
+    if (next < c) {
+      return Value{0};
+    }
+    c = next;
+    for (std::size_t i = 1; i < primes.size(); ++i) {
+      residues[i] = (residues[i] + 2 * window) % primes[i];
+    }
+  }
+}
+}  // namespace vecpp
+
+#endif
@@ -0,0 +1,230 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  See the accompanying LICENSE file for licensing details.
+
+#ifndef VECPP_AP_INT_ROOTS_INCLUDED_H
+#define VECPP_AP_INT_ROOTS_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_signed.h"
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace vecpp {
+
+namespace detail {
+// floor(sqrt(v)) for a single word, by plain Newton iteration.
+constexpr std::uint64_t isqrt_word(std::uint64_t v) {
+  if (v < 2) {
+    return v;
+  }
+  std::size_t len = 64 - word_leading_zeros(v);
+  std::uint64_t x = std::uint64_t(1) << ((len + 1) / 2);
+  while (true) {
+    std::uint64_t y = (x + v / x) / 2;
+    if (y >= x) {
+      return x;
+    }
+    x = y;
+  }
+}
+
+// floor(v^(1/n)) for a single word, built bit by bit from the top.
+constexpr std::uint64_t iroot_word(std::uint64_t v, std::uint64_t n) {
+  std::uint64_t result = 0;
+  for (std::size_t b = 64 / n + 1; b-- > 0;) {
+    std::uint64_t candidate = result | (std::uint64_t(1) << b);
+    // candidate^n <= v, computed without overflowing.
+    std::uint64_t acc = 1;
+    bool fits = true;
+    for (std::uint64_t i = 0; i < n && fits; ++i) {
+      if (acc > v / candidate) {
+        fits = false;
+      } else {
+        acc *= candidate;
+      }
+    }
+    if (fits) {
+      result = candidate;
+    }
+  }
+  return result;
+}
+
+// Number of significant bits in v, 0 for v == 0.
+template <std::size_t bits>
+constexpr std::size_t bit_length(const Large_ap_uint<bits>& v) {
+  return bits - v.data_.count_leading_zeros();
+}
+
+// The top 64 bits of v starting at bit position shift.
+template <std::size_t bits>
+constexpr std::uint64_t top_word(const Large_ap_uint<bits>& v,
+                                 std::size_t shift) {
+  return (v >> shift).data_[0];
+}
+
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> to_unsigned(const Large_ap_int<bits>& v) {
+  Large_ap_uint<bits> result{0};
+  result.data_ = v.data_;
+  return result;
+}
+
+template <std::size_t bits>
+constexpr Large_ap_int<bits> to_signed(const Large_ap_uint<bits>& v) {
+  Large_ap_int<bits> result{0};
+  result.data_ = v.data_;
+  return result;
+}
+}  // namespace detail
+
+// floor(log2(v)). v must be > 0.
+template <std::size_t bits>
+constexpr std::size_t ilog2(const Large_ap_uint<bits>& v) {
+  assert(v != 0);
+  return detail::bit_length(v) - 1;
+}
+
+// floor(log10(v)). v must be > 0.
+template <std::size_t bits>
+constexpr std::size_t ilog10(const Large_ap_uint<bits>& v) {
+  assert(v != 0);
+  // v >= 2^(bit_length - 1) >= 10^e, 1233 / 4096 < log10(2). The estimate
+  // can fall short by one or more for long values, so it is corrected
+  // upward. v >= 10 * p is tested as v / 10 >= p, which cannot overflow.
+  std::size_t estimate = ((detail::bit_length(v) - 1) * 1233) >> 12;
+
+  constexpr std::uint64_t ten_19 = 10000000000000000000ULL;
+  Large_ap_uint<bits> p{1};
+  std::size_t e = estimate;
+  for (; e >= 19; e -= 19) {
+    p *= ten_19;
+  }
+  for (; e > 0; --e) {
+    p *= 10;
+  }
+
+  Large_ap_uint<bits> tenth = v / 10;
+  while (tenth >= p) {
+    p *= 10;
+    ++estimate;
+  }
+  return estimate;
+}
+
+// floor(sqrt(v))
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> isqrt(const Large_ap_uint<bits>& v) {
+  std::size_t len = detail::bit_length(v);
+  if (len <= 64) {
+    return Large_ap_uint<bits>{detail::isqrt_word(v.data_[0])};
+  }
+
+  // Seed from the top (even-aligned) word. With top = v >> shift, we have
+  // sqrt(v) < (isqrt(top) + 1) << (shift / 2), so Newton's iteration
+  // decreases monotonically from there, and the seed already carries ~32
+  // correct bits.
+  std::size_t shift = (len - 63) & ~std::size_t(1);
+  std::uint64_t top = detail::top_word(v, shift);
+  Large_ap_uint<bits> x{detail::isqrt_word(top) + 1};
+  x <<= shift / 2;
+
+  while (true) {
+    auto y = (x + v / x) >> 1;
+    if (y >= x) {
+      return x;
+    }
+    x = y;
+  }
+}
+
+// floor(v^(1/n)). n must be > 0.
+template <std::size_t bits>
+constexpr Large_ap_uint<bits> iroot(const Large_ap_uint<bits>& v,
+                                    std::uint64_t n) {
+  assert(n > 0);
+  if (n == 1) {
+    return v;
+  }
+  if (n == 2) {
+    return isqrt(v);
+  }
+
+  std::size_t len = detail::bit_length(v);
+  if (len <= n) {
+    // v < 2^n
+    return Large_ap_uint<bits>{v == 0 ? 0u : 1u};
+  }
+  if (len <= 64) {
+    return Large_ap_uint<bits>{detail::iroot_word(v.data_[0], n)};
+  }
+
+  // Same seeding strategy as isqrt, with shift being a multiple of n.
+  std::size_t shift = ((len - 63 + n - 1) / n) * n;
+  std::uint64_t top = shift < len ? detail::top_word(v, shift) : 0;
+  Large_ap_uint<bits> x{detail::iroot_word(top, n) + 1};
+  x <<= shift / n;
+
+  while (true) {
+    // floor(v / x^(n-1)) by repeated division, which can't overflow.
+    auto q = v;
+    for (std::uint64_t i = 1; i < n && q != 0; ++i) {
+      q /= x;
+    }
+    auto y = (x * (n - 1) + q) / n;
+    if (y >= x) {
+      return x;
+    }
+    x = y;
+  }
+}
+
+template <std::size_t bits>
+constexpr bool is_perfect_square(const Large_ap_uint<bits>& v) {
+  // Squares can only be 0, 1, 4, 9, 16, 17, 25, 33, 36, 41, 49 or 57 mod 64.
+  constexpr std::uint64_t residues_64 = 0x0202021202030213ULL;
+  if (((residues_64 >> (v.data_[0] & 63)) & 1) == 0) {
+    return false;
+  }
+
+  auto r = isqrt(v);
+  return r * r == v;
+}
+
+// Signed versions, v must not be negative.
+template <std::size_t bits>
+constexpr std::size_t ilog2(const Large_ap_int<bits>& v) {
+  assert(v > 0);
+  return ilog2(detail::to_unsigned(v));
+}
+
+template <std::size_t bits>
+constexpr std::size_t ilog10(const Large_ap_int<bits>& v) {
+  assert(v > 0);
+  return ilog10(detail::to_unsigned(v));
+}
+
+template <std::size_t bits>
+constexpr Large_ap_int<bits> isqrt(const Large_ap_int<bits>& v) {
+  assert(v >= 0);
+  return detail::to_signed(isqrt(detail::to_unsigned(v)));
+}
+
+template <std::size_t bits>
+constexpr Large_ap_int<bits> iroot(const Large_ap_int<bits>& v,
+                                   std::uint64_t n) {
+  assert(v >= 0);
+  return detail::to_signed(iroot(detail::to_unsigned(v), n));
+}
+
+template <std::size_t bits>
+constexpr bool is_perfect_square(const Large_ap_int<bits>& v) {
+  return v >= 0 && is_perfect_square(detail::to_unsigned(v));
+}
+}  // namespace vecpp
+
+#endif
@@ -86,6 +86,8 @@ struct Small_ap_int {
   constexpr Small_ap_int(const Small_ap_int&) = default;
   constexpr Small_ap_int& operator=(const Small_ap_int&) = default;
 
+  constexpr explicit operator Storage() const { return v_; }
+
   constexpr bool operator==(const Self& rhs) const { return v_ == rhs.v_; }
   constexpr bool operator!=(const Self& rhs) const { return v_ != rhs.v_; }
   constexpr bool operator>(const Self& rhs) const { return v_ > rhs.v_; }
@@ -0,0 +1,397 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_SMALL_ARRAY_INCLUDED_H
+#define VECPP_AP_INT_SMALL_ARRAY_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/small.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vecpp {
+
+// Array of Small_ap_int<bits, is_signed> stored densely: element i takes
+// bits [i * bits, i * bits + bits) of a little endian stream of 64 bit
+// words. Elements are grouped in blocks of 64, which fill exactly bits
+// words, and the unused tail of the last block is kept at zero.
+template <std::size_t bits, bool is_signed>
+class Small_ap_int_array {
+ public:
+  using Value = Small_ap_int<bits, is_signed>;
+  static constexpr std::size_t block_size = 64;
+  static constexpr std::uint64_t mask =
+      bits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+
+  // Stands in for an element, reads and writes go through get() and set().
+  class Reference {
+   public:
+    operator Value() const { return array_.get(index_); }
+
+    Reference& operator=(const Value& v) {
+      array_.set(index_, v);
+      return *this;
+    }
+    Reference& operator=(const Reference& r) { return *this = Value(r); }
+
+   private:
+    friend class Small_ap_int_array;
+    Reference(Small_ap_int_array& array, std::size_t index)
+        : array_(array), index_(index) {}
+
+    Small_ap_int_array& array_;
+    std::size_t index_;
+  };
+
+  explicit Small_ap_int_array(std::size_t size = 0) { resize(size); }
+
+  std::size_t size() const { return size_; }
+  std::size_t blocks() const { return words_.size() / bits; }
+
+  void resize(std::size_t size) {
+    for (std::size_t i = size; i < std::min(size_, blocks() * block_size);
+         ++i) {
+      store(i, 0);
+    }
+    words_.resize((size + block_size - 1) / block_size * bits);
+    size_ = size;
+  }
+
+  Value get(std::size_t i) const {
+    using Storage = typename detail::Small_storage_selector<bits,
+                                                            is_signed>::type;
+    std::uint64_t v = load(i);
+    if (is_signed) {
+      // Sign extends.
+      std::uint64_t sign = std::uint64_t(1) << (bits - 1);
+      v = (v ^ sign) - sign;
+    }
+    return Value(Storage(v));
+  }
+
+  void set(std::size_t i, const Value& v) {
+    using Storage = typename detail::Small_storage_selector<bits,
+                                                            is_signed>::type;
+    store(i, std::uint64_t(Storage(v)) & mask);
+  }
+
+  Reference operator[](std::size_t i) { return Reference(*this, i); }
+  Value operator[](std::size_t i) const { return get(i); }
+
+  std::uint64_t* data() { return words_.data(); }
+  const std::uint64_t* data() const { return words_.data(); }
+
+ private:
+  std::uint64_t load(std::size_t i) const {
+    std::size_t bit = i * bits;
+    std::size_t w = bit / 64;
+    std::size_t shift = bit % 64;
+    std::uint64_t v = words_[w] >> shift;
+    if (shift + bits > 64) {
+      v |= words_[w + 1] << (64 - shift);
+    }
+    return v & mask;
+  }
+
+  void store(std::size_t i, std::uint64_t v) {
+    std::size_t bit = i * bits;
+    std::size_t w = bit / 64;
+    std::size_t shift = bit % 64;
+    words_[w] = (words_[w] & ~(mask << shift)) | (v << shift);
+    if (shift + bits > 64) {
+      std::size_t rest = 64 - shift;
+      words_[w + 1] = (words_[w + 1] & ~(mask >> rest)) | (v >> rest);
+    }
+  }
+
+  std::vector<std::uint64_t> words_;
+  std::size_t size_ = 0;
+};
+
+namespace detail {
+
+// Packed arrays are worked on a block at a time: both operands are
+// unpacked to one lane of the smallest fitting unsigned type per element,
+// combined lane by lane, and the result packed back. With bits known at
+// compile time the unpack and pack loops become straight shifts and masks,
+// and the lane loops vectorize. Sums and differences skip the lanes, see
+// add().
+template <std::size_t bits, bool is_signed>
+struct Small_array_kernels {
+  using Array = Small_ap_int_array<bits, is_signed>;
+  using Value = typename Array::Value;
+  using Storage = typename Small_storage_selector<bits, is_signed>::type;
+  using Lane = typename Small_storage_selector<bits, false>::type;
+  using Signed_lane = std::make_signed_t<Lane>;
+  // uint8_t and uint16_t products would be computed as int.
+  using Mul_lane =
+      std::conditional_t<(sizeof(Lane) < sizeof(unsigned)), unsigned, Lane>;
+  static constexpr std::size_t block_size = Array::block_size;
+  static constexpr std::uint64_t mask = Array::mask;
+
+  struct Operands {
+    Operands(const Array& a, const Array& b, Array* out)
+        : a(a.data()), b(b.data()), blocks(a.blocks()) {
+      assert(a.size() == b.size());
+      if (out) {
+        out->resize(a.size());
+        this->out = out->data();
+      }
+    }
+
+    const std::uint64_t* a;
+    const std::uint64_t* b;
+    std::uint64_t* out = nullptr;
+    std::size_t blocks;
+  };
+
+  // Element j of the block at w. It is sign extended for signed arrays
+  // when extend is set, which only comparisons need.
+  template <bool extend>
+  static Lane load_lane(const std::uint64_t* w, std::size_t j) {
+    std::size_t bit = j * bits;
+    std::size_t shift = bit % 64;
+    std::uint64_t v = w[bit / 64] >> shift;
+    if (shift + bits > 64) {
+      v |= w[bit / 64 + 1] << (64 - shift);
+    }
+    v &= mask;
+    if (extend && is_signed) {
+      std::uint64_t sign = std::uint64_t(1) << (bits - 1);
+      v = (v ^ sign) - sign;
+    }
+    return Lane(v);
+  }
+
+  static void store_lane(std::uint64_t* w, std::size_t j, Lane lane) {
+    std::size_t bit = j * bits;
+    std::size_t shift = bit % 64;
+    std::uint64_t v = std::uint64_t(lane) & mask;
+    w[bit / 64] |= v << shift;
+    if (shift + bits > 64) {
+      w[bit / 64 + 1] |= v >> (64 - shift);
+    }
+  }
+
+  // Expanded over every j, so that all shifts are constants.
+  template <bool extend, std::size_t... j>
+  static void unpack_block(const std::uint64_t* w, Lane* out,
+                           std::index_sequence<j...>) {
+    ((out[j] = load_lane<extend>(w, j)), ...);
+  }
+
+  template <bool extend>
+  static void unpack_block(const std::uint64_t* w, Lane* out) {
+    unpack_block<extend>(w, out, std::make_index_sequence<block_size>());
+  }
+
+  template <std::size_t... j>
+  static void pack_block(const Lane* in, std::uint64_t* w,
+                         std::index_sequence<j...>) {
+    for (std::size_t k = 0; k < bits; ++k) {
+      w[k] = 0;
+    }
+    (store_lane(w, j, in[j]), ...);
+  }
+
+  static void pack_block(const Lane* in, std::uint64_t* w) {
+    pack_block(in, w, std::make_index_sequence<block_size>());
+  }
+
+  template <typename F>
+  static void apply(Operands op, F f) {
+    Lane x[block_size];
+    Lane y[block_size];
+    for (std::size_t i = 0; i < op.blocks; ++i) {
+      unpack_block<false>(op.a + i * bits, x);
+      unpack_block<false>(op.b + i * bits, y);
+      for (std::size_t j = 0; j < block_size; ++j) {
+        x[j] = f(x[j], y[j]);
+      }
+      pack_block(x, op.out + i * bits);
+    }
+  }
+
+  static constexpr bool straddles = 64 % bits != 0;
+
+  // Top bit of every element, for each word of a block.
+  static constexpr std::array<std::uint64_t, bits> top_bits = [] {
+    std::array<std::uint64_t, bits> result{};
+    for (std::size_t j = 0; j < block_size; ++j) {
+      std::size_t bit = j * bits + bits - 1;
+      result[bit / 64] |= std::uint64_t(1) << (bit % 64);
+    }
+    return result;
+  }();
+
+  // Sums within each word with the top bits of the elements cleared, so
+  // that no carry leaves an element, then xors the top bits back in. A
+  // carry out of a word belongs to the element straddling it, and cannot
+  // go further. Blocks end on an element boundary, so none crosses them.
+  // Lanes are not needed, this works on the packed words directly, and
+  // without straddling elements the loop vectorizes.
+  static void add(Operands op) {
+    for (std::size_t i = 0; i < op.blocks; ++i) {
+      std::uint64_t carry = 0;
+      for (std::size_t k = 0; k < bits; ++k) {
+        std::size_t w = i * bits + k;
+        std::uint64_t x = op.a[w];
+        std::uint64_t y = op.b[w];
+        std::uint64_t low = x & ~top_bits[k];
+        std::uint64_t s = low + (y & ~top_bits[k]);
+        std::uint64_t c = straddles && s < low;
+        op.out[w] = (s + carry) ^ ((x ^ y) & top_bits[k]);
+        carry = c;
+      }
+    }
+  }
+
+  // Same as add(): with the top bits set in a and cleared in b no
+  // borrow leaves an element.
+  static void sub(Operands op) {
+    for (std::size_t i = 0; i < op.blocks; ++i) {
+      std::uint64_t borrow = 0;
+      for (std::size_t k = 0; k < bits; ++k) {
+        std::size_t w = i * bits + k;
+        std::uint64_t x = op.a[w];
+        std::uint64_t y = op.b[w];
+        std::uint64_t high = x | top_bits[k];
+        std::uint64_t low = y & ~top_bits[k];
+        std::uint64_t b = straddles && high < low;
+        op.out[w] = (high - low - borrow) ^ (~(x ^ y) & top_bits[k]);
+        borrow = b;
+      }
+    }
+  }
+
+  static void mul(Operands op) {
+    apply(op, [](Lane x, Lane y) { return Lane(Mul_lane(x) * y); });
+  }
+
+  // out must hold blocks * block_size results.
+  static void compare(Operands op, int* out) {
+    using Compared = std::conditional_t<is_signed, Signed_lane, Lane>;
+    Lane x[block_size];
+    Lane y[block_size];
+    for (std::size_t i = 0; i < op.blocks; ++i) {
+      unpack_block<true>(op.a + i * bits, x);
+      unpack_block<true>(op.b + i * bits, y);
+      for (std::size_t j = 0; j < block_size; ++j) {
+        auto u = Compared(x[j]);
+        auto v = Compared(y[j]);
+        out[i * block_size + j] = (u > v) - (u < v);
+      }
+    }
+  }
+
+  static void pack(const Value* in, std::size_t count, std::uint64_t* out) {
+    Lane x[block_size];
+    for (std::size_t i = 0; i < count; i += block_size) {
+      std::size_t n = std::min(block_size, count - i);
+      for (std::size_t j = 0; j < n; ++j) {
+        x[j] = Lane(Storage(in[i + j]));
+      }
+      std::fill(x + n, x + block_size, Lane(0));
+      pack_block(x, out + i / block_size * bits);
+    }
+  }
+
+  static void unpack(const std::uint64_t* in, std::size_t count,
+                     Value* out) {
+    Lane x[block_size];
+    for (std::size_t i = 0; i < count; i += block_size) {
+      unpack_block<true>(in + i / block_size * bits, x);
+      std::size_t n = std::min(block_size, count - i);
+      for (std::size_t j = 0; j < n; ++j) {
+        out[i + j] = Value(Storage(x[j]));
+      }
+    }
+  }
+
+  static void add(const Array& a, const Array& b, Array& out) {
+    add(Operands(a, b, &out));
+  }
+
+  static void sub(const Array& a, const Array& b, Array& out) {
+    sub(Operands(a, b, &out));
+  }
+
+  static void mul(const Array& a, const Array& b, Array& out) {
+    mul(Operands(a, b, &out));
+  }
+
+  static void compare(const Array& a, const Array& b, std::vector<int>& out) {
+    out.resize(a.blocks() * block_size);
+    compare(Operands(a, b, nullptr), out.data());
+    out.resize(a.size());
+  }
+
+  static void pack(const Value* in, std::size_t count, Array& out) {
+    out.resize(count);
+    pack(in, count, out.data());
+  }
+
+  static void unpack(const Array& in, Value* out) {
+    unpack(in.data(), in.size(), out);
+  }
+};
+}  // namespace detail
+
+// out[i] = a[i] + b[i], wrapping around at bits. out may alias a or b.
+template <std::size_t bits, bool is_signed>
+void add(const Small_ap_int_array<bits, is_signed>& a,
+         const Small_ap_int_array<bits, is_signed>& b,
+         Small_ap_int_array<bits, is_signed>& out) {
+  detail::Small_array_kernels<bits, is_signed>::add(a, b, out);
+}
+
+// out[i] = a[i] - b[i], wrapping around at bits. out may alias a or b.
+template <std::size_t bits, bool is_signed>
+void sub(const Small_ap_int_array<bits, is_signed>& a,
+         const Small_ap_int_array<bits, is_signed>& b,
+         Small_ap_int_array<bits, is_signed>& out) {
+  detail::Small_array_kernels<bits, is_signed>::sub(a, b, out);
+}
+
+// out[i] = a[i] * b[i], keeping the low bits. out may alias a or b.
+template <std::size_t bits, bool is_signed>
+void mul(const Small_ap_int_array<bits, is_signed>& a,
+         const Small_ap_int_array<bits, is_signed>& b,
+         Small_ap_int_array<bits, is_signed>& out) {
+  detail::Small_array_kernels<bits, is_signed>::mul(a, b, out);
+}
+
+// out[i] is -1, 0 or 1 as a[i] is less than, equal to or greater than b[i].
+template <std::size_t bits, bool is_signed>
+void compare(const Small_ap_int_array<bits, is_signed>& a,
+             const Small_ap_int_array<bits, is_signed>& b,
+             std::vector<int>& out) {
+  detail::Small_array_kernels<bits, is_signed>::compare(a, b, out);
+}
+
+// Packs count values into out, resized to count.
+template <std::size_t bits, bool is_signed>
+void pack(const Small_ap_int<bits, is_signed>* values, std::size_t count,
+          Small_ap_int_array<bits, is_signed>& out) {
+  detail::Small_array_kernels<bits, is_signed>::pack(values, count, out);
+}
+
+// Unpacks every element of in to values, which must hold in.size().
+template <std::size_t bits, bool is_signed>
+void unpack(const Small_ap_int_array<bits, is_signed>& in,
+            Small_ap_int<bits, is_signed>* values) {
+  detail::Small_array_kernels<bits, is_signed>::unpack(in, values);
+}
+}  // namespace vecpp
+
+#endif
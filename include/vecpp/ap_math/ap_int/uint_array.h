@@ -0,0 +1,747 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_INT_UINT_ARRAY_INCLUDED_H
+#define VECPP_AP_INT_UINT_ARRAY_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int/large_unsigned.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vecpp {
+namespace detail {
+template <std::size_t bits>
+struct Uint_array_kernels;
+}  // namespace detail
+
+// Structure of arrays of Large_ap_uint<bits>: limb k of every element is
+// stored contiguously, so the batch operations below can work on 4 or 8
+// elements at once.
+template <std::size_t bits>
+class Ap_uint_array {
+ public:
+  using Value = Large_ap_uint<bits>;
+  static constexpr std::size_t words = Value::Storage::words;
+
+  // Stands in for an element, reads and writes go through get() and set().
+  class Reference {
+   public:
+    operator Value() const { return array_.get(index_); }
+
+    Reference& operator=(const Value& v) {
+      array_.set(index_, v);
+      return *this;
+    }
+    Reference& operator=(const Reference& r) { return *this = Value(r); }
+
+   private:
+    friend class Ap_uint_array;
+    Reference(Ap_uint_array& array, std::size_t index)
+        : array_(array), index_(index) {}
+
+    Ap_uint_array& array_;
+    std::size_t index_;
+  };
+
+  explicit Ap_uint_array(std::size_t size = 0) { resize(size); }
+
+  std::size_t size() const { return limbs_[0].size(); }
+  void resize(std::size_t size) {
+    for (auto& l : limbs_) {
+      l.resize(size);
+    }
+  }
+
+  Value get(std::size_t i) const {
+    Value v{0};
+    for (std::size_t k = 0; k < words; ++k) {
+      v.data_[k] = limbs_[k][i];
+    }
+    return v;
+  }
+
+  void set(std::size_t i, const Value& v) {
+    for (std::size_t k = 0; k < words; ++k) {
+      limbs_[k][i] = v.data_[k];
+    }
+  }
+
+  Reference operator[](std::size_t i) { return Reference(*this, i); }
+  Value operator[](std::size_t i) const { return get(i); }
+
+  std::uint64_t* limb(std::size_t k) { return limbs_[k].data(); }
+  const std::uint64_t* limb(std::size_t k) const { return limbs_[k].data(); }
+
+ private:
+  std::array<std::vector<std::uint64_t>, words> limbs_;
+};
+
+namespace detail {
+
+template <std::size_t bits>
+struct Uint_array_kernels {
+  using Array = Ap_uint_array<bits>;
+  using Value = typename Array::Value;
+  static constexpr std::size_t words = Array::words;
+  static constexpr std::size_t digits = 2 * words;
+  static constexpr std::uint64_t top_mask =
+      bits % 64 == 0 ? ~std::uint64_t(0)
+                     : (std::uint64_t(1) << (bits % 64)) - 1;
+
+  // Limb pointers of the operands, out may alias a or b. The kernels take
+  // it by value: vector stores may alias anything, a local copy lets the
+  // pointers stay in registers.
+  struct Operands {
+    Operands(const Array& a, const Array& b, Array* out) {
+      assert(a.size() == b.size());
+      if (out) {
+        out->resize(a.size());
+      }
+      for (std::size_t k = 0; k < words; ++k) {
+        this->a[k] = a.limb(k);
+        this->b[k] = b.limb(k);
+        this->out[k] = out ? out->limb(k) : nullptr;
+      }
+    }
+
+    std::array<const std::uint64_t*, words> a;
+    std::array<const std::uint64_t*, words> b;
+    std::array<std::uint64_t*, words> out;
+  };
+
+  static void add_scalar(Operands op, std::size_t i, std::size_t end) {
+    for (; i < end; ++i) {
+      std::uint64_t carry = 0;
+      for (std::size_t k = 0; k < words; ++k) {
+        std::uint64_t x = op.a[k][i];
+        std::uint64_t s = x + op.b[k][i];
+        std::uint64_t c = s < x;
+        s += carry;
+        carry = c | (s < carry);
+        op.out[k][i] = s;
+      }
+      op.out[words - 1][i] &= top_mask;
+    }
+  }
+
+  static void sub_scalar(Operands op, std::size_t i, std::size_t end) {
+    for (; i < end; ++i) {
+      std::uint64_t borrow = 0;
+      for (std::size_t k = 0; k < words; ++k) {
+        std::uint64_t x = op.a[k][i];
+        std::uint64_t y = op.b[k][i];
+        std::uint64_t d = x - y;
+        std::uint64_t b = x < y;
+        b |= d < borrow;
+        op.out[k][i] = d - borrow;
+        borrow = b;
+      }
+      op.out[words - 1][i] &= top_mask;
+    }
+  }
+
+  static void mul_scalar(Operands op, std::size_t i, std::size_t end) {
+    for (; i < end; ++i) {
+      typename Value::Storage x{0};
+      typename Value::Storage y{0};
+      for (std::size_t k = 0; k < words; ++k) {
+        x[k] = op.a[k][i];
+        y[k] = op.b[k][i];
+      }
+      auto p = x.mul(y);
+      for (std::size_t k = 0; k < words; ++k) {
+        op.out[k][i] = p[k];
+      }
+    }
+  }
+
+  static void compare_scalar(Operands op, int* out, std::size_t i,
+                             std::size_t end) {
+    for (; i < end; ++i) {
+      int r = 0;
+      for (std::size_t k = words; k-- > 0 && r == 0;) {
+        std::uint64_t x = op.a[k][i];
+        std::uint64_t y = op.b[k][i];
+        r = (x > y) - (x < y);
+      }
+      out[i] = r;
+    }
+  }
+
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+  // AVX2 has no unsigned 64 bit compare, flipping the sign bits turns it
+  // into a signed one. Results are all ones or all zeros per lane.
+  __attribute__((target("avx2"))) static __m256i less_avx2(__m256i x,
+                                                            __m256i y) {
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(y, sign),
+                              _mm256_xor_si256(x, sign));
+  }
+
+  __attribute__((target("avx2"))) static __m256i load_avx2(
+      const std::uint64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+
+  __attribute__((target("avx2"))) static void store_avx2(std::uint64_t* p,
+                                                         __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+
+  __attribute__((target("avx2"))) static void add_avx2(Operands op,
+                                                       std::size_t end) {
+    const __m256i top = _mm256_set1_epi64x(std::int64_t(top_mask));
+    std::size_t i = 0;
+    for (; i + 4 <= end; i += 4) {
+      __m256i carry = _mm256_setzero_si256();
+      for (std::size_t k = 0; k < words; ++k) {
+        __m256i x = load_avx2(op.a[k] + i);
+        __m256i s = _mm256_add_epi64(x, load_avx2(op.b[k] + i));
+        __m256i c = less_avx2(s, x);
+        // carry is -1 where set.
+        __m256i t = _mm256_sub_epi64(s, carry);
+        carry = _mm256_or_si256(c, less_avx2(t, s));
+        store_avx2(op.out[k] + i,
+                   k + 1 == words ? _mm256_and_si256(t, top) : t);
+      }
+    }
+    add_scalar(op, i, end);
+  }
+
+  __attribute__((target("avx2"))) static void sub_avx2(Operands op,
+                                                       std::size_t end) {
+    const __m256i top = _mm256_set1_epi64x(std::int64_t(top_mask));
+    std::size_t i = 0;
+    for (; i + 4 <= end; i += 4) {
+      __m256i borrow = _mm256_setzero_si256();
+      for (std::size_t k = 0; k < words; ++k) {
+        __m256i x = load_avx2(op.a[k] + i);
+        __m256i y = load_avx2(op.b[k] + i);
+        __m256i d = _mm256_sub_epi64(x, y);
+        __m256i b = less_avx2(x, y);
+        __m256i t = _mm256_add_epi64(d, borrow);
+        borrow = _mm256_or_si256(b, less_avx2(d, t));
+        store_avx2(op.out[k] + i,
+                   k + 1 == words ? _mm256_and_si256(t, top) : t);
+      }
+    }
+    sub_scalar(op, i, end);
+  }
+
+  // Schoolbook on 32 bit digits, as _mm256_mul_epu32 is the widest
+  // multiply available. Column sums stay well below 2^64.
+  __attribute__((target("avx2"))) static void mul_avx2(Operands op,
+                                                       std::size_t end) {
+    const __m256i low = _mm256_set1_epi64x(0xffffffff);
+    const __m256i top = _mm256_set1_epi64x(std::int64_t(top_mask));
+    std::size_t i = 0;
+    for (; i + 4 <= end; i += 4) {
+      __m256i x[digits];
+      __m256i y[digits];
+      for (std::size_t k = 0; k < words; ++k) {
+        x[2 * k] = load_avx2(op.a[k] + i);
+        x[2 * k + 1] = _mm256_srli_epi64(x[2 * k], 32);
+        y[2 * k] = load_avx2(op.b[k] + i);
+        y[2 * k + 1] = _mm256_srli_epi64(y[2 * k], 32);
+      }
+      __m256i carry = _mm256_setzero_si256();
+      __m256i high = _mm256_setzero_si256();
+      __m256i result[digits];
+      for (std::size_t c = 0; c < digits; ++c) {
+        __m256i sum = _mm256_add_epi64(carry, high);
+        high = _mm256_setzero_si256();
+        for (std::size_t j = 0; j <= c; ++j) {
+          __m256i p = _mm256_mul_epu32(x[j], y[c - j]);
+          sum = _mm256_add_epi64(sum, _mm256_and_si256(p, low));
+          high = _mm256_add_epi64(high, _mm256_srli_epi64(p, 32));
+        }
+        result[c] = _mm256_and_si256(sum, low);
+        carry = _mm256_srli_epi64(sum, 32);
+      }
+      for (std::size_t k = 0; k < words; ++k) {
+        __m256i r = _mm256_or_si256(result[2 * k],
+                                    _mm256_slli_epi64(result[2 * k + 1], 32));
+        store_avx2(op.out[k] + i,
+                   k + 1 == words ? _mm256_and_si256(r, top) : r);
+      }
+    }
+    mul_scalar(op, i, end);
+  }
+
+  __attribute__((target("avx2"))) static void compare_avx2(Operands op,
+                                                           int* out,
+                                                           std::size_t end) {
+    std::size_t i = 0;
+    for (; i + 4 <= end; i += 4) {
+      __m256i result = _mm256_setzero_si256();
+      __m256i decided = _mm256_setzero_si256();
+      for (std::size_t k = words; k-- > 0;) {
+        __m256i x = load_avx2(op.a[k] + i);
+        __m256i y = load_avx2(op.b[k] + i);
+        __m256i lt = less_avx2(x, y);
+        __m256i gt = less_avx2(y, x);
+        // lt - gt is 1 where x > y, -1 where x < y.
+        result = _mm256_or_si256(
+            result, _mm256_andnot_si256(decided, _mm256_sub_epi64(lt, gt)));
+        decided = _mm256_or_si256(decided, _mm256_or_si256(lt, gt));
+        if (_mm256_movemask_pd(_mm256_castsi256_pd(decided)) == 0xf) {
+          break;
+        }
+      }
+      alignas(32) std::int64_t r[4];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(r), result);
+      for (std::size_t j = 0; j < 4; ++j) {
+        out[i + j] = int(r[j]);
+      }
+    }
+    compare_scalar(op, out, i, end);
+  }
+
+  __attribute__((target("avx512f"))) static __m512i load_avx512(
+      const std::uint64_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+
+  // GCC 12 builds the unmasked forms of these on _mm512_undefined_epi32(),
+  // which -Wmaybe-uninitialized flags once inlined at -O3. The zero-masked
+  // forms with every lane selected are the same instructions.
+  template <unsigned n>
+  __attribute__((target("avx512f"))) static __m512i srli_avx512(__m512i x) {
+    return _mm512_maskz_srli_epi64(0xff, x, n);
+  }
+
+  template <unsigned n>
+  __attribute__((target("avx512f"))) static __m512i slli_avx512(__m512i x) {
+    return _mm512_maskz_slli_epi64(0xff, x, n);
+  }
+
+  __attribute__((target("avx512f"))) static __m512i mul_epu32_avx512(
+      __m512i x, __m512i y) {
+    return _mm512_maskz_mul_epu32(0xff, x, y);
+  }
+
+  __attribute__((target("avx512f"))) static __m256i cvtepi64_epi32_avx512(
+      __m512i x) {
+    return _mm512_maskz_cvtepi64_epi32(0xff, x);
+  }
+
+  __attribute__((target("avx512f"))) static __m512i sll_avx512(
+      __m512i x, __m128i count) {
+    return _mm512_maskz_sll_epi64(0xff, x, count);
+  }
+
+  __attribute__((target("avx512f"))) static __m512i srl_avx512(
+      __m512i x, __m128i count) {
+    return _mm512_maskz_srl_epi64(0xff, x, count);
+  }
+
+  __attribute__((target("avx512f"))) static void add_avx512(Operands op,
+                                                           std::size_t end) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i top = _mm512_set1_epi64(std::int64_t(top_mask));
+    std::size_t i = 0;
+    for (; i + 8 <= end; i += 8) {
+      __mmask8 carry = 0;
+      for (std::size_t k = 0; k < words; ++k) {
+        __m512i x = load_avx512(op.a[k] + i);
+        __m512i s = _mm512_add_epi64(x, load_avx512(op.b[k] + i));
+        __mmask8 c = _mm512_cmplt_epu64_mask(s, x);
+        __m512i t = _mm512_mask_add_epi64(s, carry, s, one);
+        carry = c | _mm512_cmplt_epu64_mask(t, s);
+        _mm512_storeu_si512(op.out[k] + i,
+                            k + 1 == words ? _mm512_and_si512(t, top) : t);
+      }
+    }
+    add_scalar(op, i, end);
+  }
+
+  __attribute__((target("avx512f"))) static void sub_avx512(Operands op,
+                                                           std::size_t end) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i top = _mm512_set1_epi64(std::int64_t(top_mask));
+    std::size_t i = 0;
+    for (; i + 8 <= end; i += 8) {
+      __mmask8 borrow = 0;
+      for (std::size_t k = 0; k < words; ++k) {
+        __m512i x = load_avx512(op.a[k] + i);
+        __m512i y = load_avx512(op.b[k] + i);
+        __m512i d = _mm512_sub_epi64(x, y);
+        __mmask8 b = _mm512_cmplt_epu64_mask(x, y);
+        __m512i t = _mm512_mask_sub_epi64(d, borrow, d, one);
+        borrow = b | _mm512_cmplt_epu64_mask(d, t);
+        _mm512_storeu_si512(op.out[k] + i,
+                            k + 1 == words ? _mm512_and_si512(t, top) : t);
+      }
+    }
+    sub_scalar(op, i, end);
+  }
+
+  __attribute__((target("avx512f"))) static void mul_avx512(Operands op,
+                                                           std::size_t end) {
+    const __m512i low = _mm512_set1_epi64(0xffffffff);
+    const __m512i top = _mm512_set1_epi64(std::int64_t(top_mask));
+    std::size_t i = 0;
+    for (; i + 8 <= end; i += 8) {
+      __m512i x[digits];
+      __m512i y[digits];
+      for (std::size_t k = 0; k < words; ++k) {
+        x[2 * k] = load_avx512(op.a[k] + i);
+        x[2 * k + 1] = srli_avx512<32>(x[2 * k]);
+        y[2 * k] = load_avx512(op.b[k] + i);
+        y[2 * k + 1] = srli_avx512<32>(y[2 * k]);
+      }
+      __m512i carry = _mm512_setzero_si512();
+      __m512i high = _mm512_setzero_si512();
+      __m512i result[digits];
+      for (std::size_t c = 0; c < digits; ++c) {
+        __m512i sum = _mm512_add_epi64(carry, high);
+        high = _mm512_setzero_si512();
+        for (std::size_t j = 0; j <= c; ++j) {
+          __m512i p = mul_epu32_avx512(x[j], y[c - j]);
+          sum = _mm512_add_epi64(sum, _mm512_and_si512(p, low));
+          high = _mm512_add_epi64(high, srli_avx512<32>(p));
+        }
+        result[c] = _mm512_and_si512(sum, low);
+        carry = srli_avx512<32>(sum);
+      }
+      for (std::size_t k = 0; k < words; ++k) {
+        __m512i r = _mm512_or_si512(result[2 * k],
+                                    slli_avx512<32>(result[2 * k + 1]));
+        _mm512_storeu_si512(op.out[k] + i,
+                            k + 1 == words ? _mm512_and_si512(r, top) : r);
+      }
+    }
+    mul_scalar(op, i, end);
+  }
+
+  __attribute__((target("avx512f"))) static void compare_avx512(
+      Operands op, int* out, std::size_t end) {
+    std::size_t i = 0;
+    for (; i + 8 <= end; i += 8) {
+      __mmask8 lt = 0;
+      __mmask8 gt = 0;
+      for (std::size_t k = words; k-- > 0;) {
+        __m512i x = load_avx512(op.a[k] + i);
+        __m512i y = load_avx512(op.b[k] + i);
+        __mmask8 decided = lt | gt;
+        lt |= _mm512_mask_cmplt_epu64_mask(__mmask8(~decided), x, y);
+        gt |= _mm512_mask_cmplt_epu64_mask(__mmask8(~decided), y, x);
+        if (__mmask8(lt | gt) == 0xff) {
+          break;
+        }
+      }
+      __m512i r = _mm512_mask_blend_epi64(
+          gt, _mm512_maskz_mov_epi64(lt, _mm512_set1_epi64(-1)),
+          _mm512_set1_epi64(1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                          cvtepi64_epi32_avx512(r));
+    }
+    compare_scalar(op, out, i, end);
+  }
+
+  // Radix 2^52 digits for vpmadd52luq / vpmadd52huq. One more digit than
+  // needed to hold a value, see montgomery_mul_ifma().
+  static constexpr std::size_t digits52 = 64 * words / 52 + 1;
+  static constexpr std::size_t shift52 = 52 * digits52 - 64 * words;
+
+  // digit[j] = bits [52 * j, 52 * j + 52) of limb << shift.
+  __attribute__((target("avx512f"))) static void split52(
+      const __m512i (&limb)[words], __m512i (&digit)[digits52],
+      std::size_t shift) {
+    const __m512i mask = _mm512_set1_epi64((std::int64_t(1) << 52) - 1);
+    for (std::size_t j = 0; j < digits52; ++j) {
+      __m512i d = _mm512_setzero_si512();
+      for (std::size_t k = 0; k < words; ++k) {
+        // Position of limb k relative to the digit.
+        auto pos = std::int64_t(64 * k + shift) - std::int64_t(52 * j);
+        if (pos >= 0 && pos < 52) {
+          auto count = _mm_cvtsi64_si128(pos);
+          d = _mm512_or_si512(d, sll_avx512(limb[k], count));
+        } else if (pos < 0 && pos > -64) {
+          auto count = _mm_cvtsi64_si128(-pos);
+          d = _mm512_or_si512(d, srl_avx512(limb[k], count));
+        }
+      }
+      digit[j] = _mm512_and_si512(d, mask);
+    }
+  }
+
+  // Inverse of split52() with no shift, digits must be below 2^52.
+  __attribute__((target("avx512f"))) static void join52(
+      const __m512i (&digit)[digits52], __m512i (&limb)[words]) {
+    for (std::size_t k = 0; k < words; ++k) {
+      __m512i l = _mm512_setzero_si512();
+      for (std::size_t j = 0; j < digits52; ++j) {
+        auto pos = std::int64_t(52 * j) - std::int64_t(64 * k);
+        if (pos >= 0 && pos < 64) {
+          auto count = _mm_cvtsi64_si128(pos);
+          l = _mm512_or_si512(l, sll_avx512(digit[j], count));
+        } else if (pos < 0 && pos > -52) {
+          auto count = _mm_cvtsi64_si128(-pos);
+          l = _mm512_or_si512(l, srl_avx512(digit[j], count));
+        }
+      }
+      limb[k] = l;
+    }
+  }
+
+  // Propagates the carries of digits that have grown past 52 bits, the
+  // carry out of the top digit is dropped.
+  __attribute__((target("avx512f"))) static void normalize52(
+      __m512i (&digit)[digits52]) {
+    const __m512i mask = _mm512_set1_epi64((std::int64_t(1) << 52) - 1);
+    __m512i carry = _mm512_setzero_si512();
+    for (std::size_t j = 0; j < digits52; ++j) {
+      __m512i d = _mm512_add_epi64(digit[j], carry);
+      carry = srli_avx512<52>(d);
+      digit[j] = _mm512_and_si512(d, mask);
+    }
+  }
+
+  __attribute__((target("avx512f"))) static void load_limbs(
+      const std::array<const std::uint64_t*, words>& p, std::size_t i,
+      __m512i (&limb)[words]) {
+    for (std::size_t k = 0; k < words; ++k) {
+      limb[k] = load_avx512(p[k] + i);
+    }
+  }
+
+  __attribute__((target("avx512f"))) static void store_limbs(
+      const std::array<std::uint64_t*, words>& p, std::size_t i,
+      __m512i (&limb)[words]) {
+    const __m512i top = _mm512_set1_epi64(std::int64_t(top_mask));
+    limb[words - 1] = _mm512_and_si512(limb[words - 1], top);
+    for (std::size_t k = 0; k < words; ++k) {
+      _mm512_storeu_si512(p[k] + i, limb[k]);
+    }
+  }
+
+  // Low digits of the product. Each column gathers fewer than 2 * digits52
+  // terms below 2^52, so nothing overflows before normalize52().
+  __attribute__((target("avx512f,avx512ifma"))) static void mul_ifma(
+      Operands op, std::size_t end) {
+    std::size_t i = 0;
+    for (; i + 8 <= end; i += 8) {
+      __m512i limb[words];
+      __m512i x[digits52];
+      __m512i y[digits52];
+      load_limbs(op.a, i, limb);
+      split52(limb, x, 0);
+      load_limbs(op.b, i, limb);
+      split52(limb, y, 0);
+
+      __m512i acc[digits52];
+      for (auto& d : acc) {
+        d = _mm512_setzero_si512();
+      }
+      for (std::size_t j = 0; j < digits52; ++j) {
+        for (std::size_t k = 0; j + k < digits52; ++k) {
+          acc[j + k] = _mm512_madd52lo_epu64(acc[j + k], x[j], y[k]);
+          if (j + k + 1 < digits52) {
+            acc[j + k + 1] =
+                _mm512_madd52hi_epu64(acc[j + k + 1], x[j], y[k]);
+          }
+        }
+      }
+      normalize52(acc);
+      join52(acc, limb);
+      store_limbs(op.out, i, limb);
+    }
+    mul_scalar(op, i, end);
+  }
+
+  // a * b * 2^-(64 * words) mod n on blocks of 8 lanes, returns the index
+  // of the first element left to the caller. a and b must be below n, and
+  // n_inv is -n^-1 mod 2^52.
+  //
+  // Montgomery reduction by 2^52 per digit divides by 2^(52 * digits52),
+  // so a is shifted left by the difference first. The extra digit keeps
+  // both a << shift52 and the result, below 2n, within digits52 digits.
+  __attribute__((target("avx512f,avx512ifma"))) static std::size_t
+  montgomery_mul_ifma(Operands op, const typename Value::Storage& n,
+                      std::uint64_t n_inv, std::size_t end) {
+    const __m512i mask = _mm512_set1_epi64((std::int64_t(1) << 52) - 1);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i inv = _mm512_set1_epi64(std::int64_t(n_inv));
+    __m512i limb[words];
+    __m512i m[digits52];
+    for (std::size_t k = 0; k < words; ++k) {
+      limb[k] = _mm512_set1_epi64(std::int64_t(n[k]));
+    }
+    split52(limb, m, 0);
+
+    std::size_t i = 0;
+    for (; i + 8 <= end; i += 8) {
+      __m512i x[digits52];
+      __m512i y[digits52];
+      load_limbs(op.a, i, limb);
+      split52(limb, x, shift52);
+      load_limbs(op.b, i, limb);
+      split52(limb, y, 0);
+
+      // Each round adds at most four 52 bit terms to a digit, far from
+      // overflowing 64 bits.
+      __m512i t[digits52 + 1];
+      for (auto& d : t) {
+        d = zero;
+      }
+      for (std::size_t j = 0; j < digits52; ++j) {
+        // t += x[j] * y
+        for (std::size_t k = 0; k < digits52; ++k) {
+          t[k] = _mm512_madd52lo_epu64(t[k], x[j], y[k]);
+          t[k + 1] = _mm512_madd52hi_epu64(t[k + 1], x[j], y[k]);
+        }
+        // t = (t + q * n) / 2^52, with q chosen so that the low digit
+        // cancels.
+        __m512i q = _mm512_madd52lo_epu64(zero, t[0], inv);
+        for (std::size_t k = 0; k < digits52; ++k) {
+          t[k] = _mm512_madd52lo_epu64(t[k], q, m[k]);
+          t[k + 1] = _mm512_madd52hi_epu64(t[k + 1], q, m[k]);
+        }
+        __m512i carry = srli_avx512<52>(t[0]);
+        for (std::size_t k = 0; k < digits52; ++k) {
+          t[k] = t[k + 1];
+        }
+        t[0] = _mm512_add_epi64(t[0], carry);
+        t[digits52] = zero;
+      }
+
+      __m512i r[digits52];
+      for (std::size_t k = 0; k < digits52; ++k) {
+        r[k] = t[k];
+      }
+      normalize52(r);
+
+      // r < 2n, subtract n where that does not borrow.
+      __m512i d[digits52];
+      __m512i borrow = zero;
+      for (std::size_t k = 0; k < digits52; ++k) {
+        __m512i v = _mm512_sub_epi64(_mm512_sub_epi64(r[k], m[k]), borrow);
+        borrow = srli_avx512<63>(v);
+        d[k] = _mm512_and_si512(v, mask);
+      }
+      __mmask8 keep = _mm512_cmpneq_epu64_mask(borrow, zero);
+      for (std::size_t k = 0; k < digits52; ++k) {
+        r[k] = _mm512_mask_blend_epi64(keep, d[k], r[k]);
+      }
+      join52(r, limb);
+      store_limbs(op.out, i, limb);
+    }
+    return i;
+  }
+#endif
+
+  static void add(Isa level, const Array& a, const Array& b,
+                  Array& out) {
+    Operands op(a, b, &out);
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+    switch (level) {
+      case Isa::avx512_ifma:
+      case Isa::avx512:
+        return add_avx512(op, a.size());
+      case Isa::avx2:
+        return add_avx2(op, a.size());
+      default:
+        break;
+    }
+#endif
+    (void)level;
+    add_scalar(op, 0, a.size());
+  }
+
+  static void sub(Isa level, const Array& a, const Array& b,
+                  Array& out) {
+    Operands op(a, b, &out);
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+    switch (level) {
+      case Isa::avx512_ifma:
+      case Isa::avx512:
+        return sub_avx512(op, a.size());
+      case Isa::avx2:
+        return sub_avx2(op, a.size());
+      default:
+        break;
+    }
+#endif
+    (void)level;
+    sub_scalar(op, 0, a.size());
+  }
+
+  static void mul(Isa level, const Array& a, const Array& b,
+                  Array& out) {
+    Operands op(a, b, &out);
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+    switch (level) {
+      case Isa::avx512_ifma:
+        return mul_ifma(op, a.size());
+      case Isa::avx512:
+        return mul_avx512(op, a.size());
+      case Isa::avx2:
+        return mul_avx2(op, a.size());
+      default:
+        break;
+    }
+#endif
+    (void)level;
+    mul_scalar(op, 0, a.size());
+  }
+
+  static void compare(Isa level, const Array& a, const Array& b,
+                      std::vector<int>& out) {
+    Operands op(a, b, nullptr);
+    out.resize(a.size());
+#ifdef VECPP_AP_INT_HAS_X86_KERNELS
+    switch (level) {
+      case Isa::avx512_ifma:
+      case Isa::avx512:
+        return compare_avx512(op, out.data(), a.size());
+      case Isa::avx2:
+        return compare_avx2(op, out.data(), a.size());
+      default:
+        break;
+    }
+#endif
+    (void)level;
+    compare_scalar(op, out.data(), 0, a.size());
+  }
+};
+}  // namespace detail
+
+// out[i] = a[i] + b[i], wrapping around. out may alias a or b.
+template <std::size_t bits>
+void add(const Ap_uint_array<bits>& a, const Ap_uint_array<bits>& b,
+         Ap_uint_array<bits>& out) {
+  detail::Uint_array_kernels<bits>::add(detail::isa(), a, b, out);
+}
+
+// out[i] = a[i] - b[i], wrapping around. out may alias a or b.
+template <std::size_t bits>
+void sub(const Ap_uint_array<bits>& a, const Ap_uint_array<bits>& b,
+         Ap_uint_array<bits>& out) {
+  detail::Uint_array_kernels<bits>::sub(detail::isa(), a, b, out);
+}
+
+// out[i] = a[i] * b[i], keeping the low bits. out may alias a or b.
+template <std::size_t bits>
+void mul(const Ap_uint_array<bits>& a, const Ap_uint_array<bits>& b,
+         Ap_uint_array<bits>& out) {
+  detail::Uint_array_kernels<bits>::mul(detail::isa(), a, b, out);
+}
+
+// out[i] = a[i].compare(b[i]).
+template <std::size_t bits>
+void compare(const Ap_uint_array<bits>& a, const Ap_uint_array<bits>& b,
+             std::vector<int>& out) {
+  detail::Uint_array_kernels<bits>::compare(detail::isa(), a, b, out);
+}
+}  // namespace vecpp
+
+#endif
@@ -27,8 +27,8 @@ struct numeric_limits<vecpp::Small_ap_int<bits, false>>
   static constexpr int digits = bits;
   static constexpr int digits10 = digits * 643L / 2136;
 
-  static constexpr T min() { 0; }
-  static constexpr T lowest() { 0; }
+  static constexpr T min() { return 0; }
+  static constexpr T lowest() { return min(); }
   static constexpr T max() { return ~min(); }
 };
 
@@ -0,0 +1,181 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+
+using Decimal32_t = vecpp::Ap_decimal<7, 96>;
+using Decimal64_t = vecpp::Ap_decimal<16, 384>;
+using Decimal128_t = vecpp::Ap_decimal<34, 6144>;
+
+using vecpp::Rounding;
+
+static_assert(Decimal64_t{"0.1"} + Decimal64_t{"0.2"} == Decimal64_t{"0.3"});
+static_assert(Decimal64_t{1} / Decimal64_t{3} ==
+              Decimal64_t{"0.3333333333333333"});
+static_assert(Decimal128_t{"1.10"} * Decimal128_t{"2.5"} ==
+              Decimal128_t{"2.75"});
+
+namespace {
+template <std::size_t digits, std::int64_t emax>
+std::string str(const vecpp::Ap_decimal<digits, emax>& v) {
+  return vecpp::to_string(v);
+}
+
+template <std::size_t bits>
+std::string str(const vecpp::Large_ap_uint<bits>& v) {
+  std::ostringstream gen;
+  gen << v;
+  return gen.str();
+}
+}  // namespace
+
+TEST_CASE("decimal parsing and formatting", "[apdecimal]") {
+  REQUIRE(str(Decimal64_t{"1.00"}) == "1.00");
+  REQUIRE(str(Decimal64_t{"-0.000123"}) == "-0.000123");
+  REQUIRE(str(Decimal64_t{"123E5"}) == "1.23E+7");
+  REQUIRE(str(Decimal64_t{"0.00000001"}) == "1E-8");
+  REQUIRE(str(Decimal64_t{"-0"}) == "-0");
+  REQUIRE(str(Decimal64_t{"Infinity"}) == "Infinity");
+  REQUIRE(str(-Decimal64_t{"inf"}) == "-Infinity");
+  REQUIRE(Decimal64_t{"nan"}.is_nan());
+  REQUIRE(Decimal64_t{"1.2.3"}.is_nan());
+  REQUIRE(Decimal64_t{"1e"}.is_nan());
+  REQUIRE(Decimal64_t{""}.is_nan());
+
+  // Too many digits are rounded to nearest even.
+  REQUIRE(str(Decimal32_t{"1.2345675"}) == "1.234568");
+  REQUIRE(str(Decimal32_t{"1.2345665"}) == "1.234566");
+  REQUIRE(str(Decimal32_t{"1.23456650000000001"}) == "1.234567");
+  REQUIRE(str(Decimal32_t{"123456789"}) == "1.234568E+8");
+  REQUIRE(str(Decimal32_t{std::int64_t(-123456789)}) == "-1.234568E+8");
+  REQUIRE(str(Decimal64_t{std::uint64_t(-1)}) == "1.844674407370955E+19");
+  REQUIRE(str(Decimal128_t{std::uint64_t(-1)}) == "18446744073709551615");
+}
+
+TEST_CASE("decimal arithmetic", "[apdecimal]") {
+  // Exact results keep the preferred exponent.
+  REQUIRE(str(Decimal64_t{"1.00"} + Decimal64_t{"2.5"}) == "3.50");
+  REQUIRE(str(Decimal64_t{"1.30"} - Decimal64_t{"1.3"}) == "0.00");
+  REQUIRE(str(Decimal64_t{"1.20"} * Decimal64_t{"3.0"}) == "3.600");
+  REQUIRE(str(Decimal64_t{"2.40"} / Decimal64_t{"2"}) == "1.20");
+  REQUIRE(str(Decimal64_t{"1"} / Decimal64_t{"8"}) == "0.125");
+  REQUIRE(str(Decimal64_t{"1000"} / Decimal64_t{"10"}) == "100");
+
+  // Inexact ones are rounded to 16 digits.
+  REQUIRE(str(Decimal64_t{2} / Decimal64_t{3}) == "0.6666666666666667");
+  REQUIRE(str(vecpp::div(Decimal64_t{2}, Decimal64_t{3},
+                         Rounding::toward_zero)) == "0.6666666666666666");
+  REQUIRE(str(vecpp::div(Decimal64_t{-2}, Decimal64_t{3}, Rounding::upward)) ==
+          "-0.6666666666666666");
+  REQUIRE(str(Decimal64_t{"9999999999999999"} + Decimal64_t{1}) ==
+          "1.000000000000000E+16");
+
+  // A far smaller operand only decides the rounding direction.
+  Decimal64_t big{"1E20"};
+  Decimal64_t tiny{"1E-300"};
+  REQUIRE(str(big + tiny) == "1.000000000000000E+20");
+  REQUIRE(str(vecpp::add(big, tiny, Rounding::upward)) ==
+          "1.000000000000001E+20");
+  REQUIRE(str(vecpp::sub(big, tiny, Rounding::downward)) ==
+          "9.999999999999999E+19");
+  REQUIRE(str(big + Decimal64_t{"0E-300"}) == "1.000000000000000E+20");
+
+  // x - x is +0, or -0 when rounding downward.
+  REQUIRE(!(Decimal64_t{"1.5"} - Decimal64_t{"1.5"}).signbit());
+  REQUIRE(vecpp::sub(Decimal64_t{"1.5"}, Decimal64_t{"1.5"}, Rounding::downward)
+              .signbit());
+}
+
+TEST_CASE("decimal arithmetic matches a wider format", "[apdecimal]") {
+  // Decimal128 results on 7 digit operands are exact for + - *, rounding
+  // them to 7 digits must match.
+  std::mt19937_64 gen(11);
+  std::uniform_int_distribution<std::int64_t> coefficient(-9999999, 9999999);
+  std::uniform_int_distribution<int> exponent(-12, 12);
+  auto random_parts = [&] {
+    return std::to_string(coefficient(gen)) + "E" +
+           std::to_string(exponent(gen));
+  };
+  for (int i = 0; i < 2000; ++i) {
+    auto a = random_parts();
+    auto b = random_parts();
+    Decimal32_t a32{a};
+    Decimal32_t b32{b};
+    Decimal128_t a128{a};
+    Decimal128_t b128{b};
+    for (auto mode : {Rounding::nearest_even, Rounding::nearest_away,
+                      Rounding::toward_zero, Rounding::upward,
+                      Rounding::downward}) {
+      auto narrow = [&](const Decimal128_t& v) {
+        return str(Decimal32_t::from_parts(
+            v.signbit(),
+            Decimal32_t::Coefficient{std::string_view{str(v.coefficient())}},
+            v.exponent(), mode));
+      };
+      REQUIRE(str(vecpp::add(a32, b32, mode)) ==
+              narrow(vecpp::add(a128, b128, mode)));
+      REQUIRE(str(vecpp::mul(a32, b32, mode)) ==
+              narrow(vecpp::mul(a128, b128, mode)));
+    }
+  }
+}
+
+TEST_CASE("decimal quantize", "[apdecimal]") {
+  Decimal64_t cents{"0.01"};
+  REQUIRE(str(quantize(Decimal64_t{"2.175"}, cents)) == "2.18");
+  REQUIRE(str(quantize(Decimal64_t{"2.165"}, cents)) == "2.16");
+  REQUIRE(str(quantize(Decimal64_t{"2.165"}, cents, Rounding::nearest_away)) ==
+          "2.17");
+  REQUIRE(str(quantize(Decimal64_t{"-2.161"}, cents, Rounding::downward)) ==
+          "-2.17");
+  REQUIRE(str(quantize(Decimal64_t{"3"}, cents)) == "3.00");
+  REQUIRE(str(quantize(Decimal64_t{"0.004"}, cents)) == "0.00");
+  REQUIRE(str(quantize(Decimal64_t{"1E-200"}, Decimal64_t{"1E+10"})) ==
+          "0E+10");
+  REQUIRE(str(quantize(Decimal128_t{"123456789012345678901234.675"},
+                       Decimal128_t{"0.01"})) ==
+          "123456789012345678901234.68");
+  // Would need 17 digits.
+  REQUIRE(quantize(Decimal64_t{"1E16"}, cents).is_nan());
+  REQUIRE(quantize(Decimal64_t::infinity(), cents).is_nan());
+
+  REQUIRE(same_quantum(Decimal64_t{"1.00"}, Decimal64_t{"9.99"}));
+  REQUIRE(!same_quantum(Decimal64_t{"1.0"}, Decimal64_t{"1.00"}));
+}
+
+TEST_CASE("decimal special values and limits", "[apdecimal]") {
+  auto inf = Decimal64_t::infinity();
+  REQUIRE((inf + Decimal64_t{1}).is_inf());
+  REQUIRE((inf - inf).is_nan());
+  REQUIRE((inf * Decimal64_t{0}).is_nan());
+  REQUIRE((Decimal64_t{1} / Decimal64_t{0}) == inf);
+  REQUIRE((Decimal64_t{-1} / Decimal64_t{0}) == -inf);
+  REQUIRE((Decimal64_t{0} / Decimal64_t{0}).is_nan());
+  REQUIRE((Decimal64_t{1} / inf).is_zero());
+  REQUIRE(Decimal64_t::quiet_nan() != Decimal64_t::quiet_nan());
+
+  REQUIRE(str(Decimal64_t::max()) == "9.999999999999999E+384");
+  REQUIRE((Decimal64_t::max() * Decimal64_t{10}).is_inf());
+  REQUIRE(vecpp::mul(Decimal64_t::max(), Decimal64_t{10},
+                     Rounding::toward_zero) == Decimal64_t::max());
+  // Exponents above the range are padded with zeros when they can be.
+  REQUIRE(str(Decimal64_t{"1E384"}) == "1.000000000000000E+384");
+
+  // Subnormals lose digits, then round to zero.
+  REQUIRE(str(Decimal64_t{"1.234E-396"}) == "1.23E-396");
+  REQUIRE(str(Decimal64_t{"1E-397"} / Decimal64_t{4}) == "2E-398");
+  REQUIRE(str(Decimal64_t{"3E-398"} / Decimal64_t{4}) == "1E-398");
+  REQUIRE(str(Decimal64_t{"1E-398"} / Decimal64_t{4}) == "0E-398");
+  REQUIRE(str(Decimal64_t{"-1E-500"}) == "-0E-398");
+
+  REQUIRE(Decimal64_t{"1.0"} == Decimal64_t{"1.000"});
+  REQUIRE(Decimal64_t{"0"} == Decimal64_t{"-0E5"});
+  REQUIRE(Decimal64_t{"-5"} < Decimal64_t{"0.1"});
+  REQUIRE(Decimal64_t{"1.5E-3"} < Decimal64_t{"2E-3"});
+  REQUIRE(Decimal64_t{"-1E10"} < Decimal64_t{"-9E9"});
+  REQUIRE(-inf < Decimal64_t{"-1E384"});
+  REQUIRE(abs(Decimal64_t{"-2.5"}) == Decimal64_t{"2.5"});
+}
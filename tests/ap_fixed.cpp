@@ -0,0 +1,132 @@
+#include "catch.hpp"
+#include "test_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using vecpp::Overflow;
+using vecpp::Rounding;
+
+using Q16_t = vecpp::Ap_fixed<16, 16>;
+using Q32_t = vecpp::Ap_fixed<32, 32>;
+using Wide_fixed_t = vecpp::Ap_fixed<70, 60>;
+using Saturated_t = vecpp::Ap_fixed<8, 8, Overflow::saturate>;
+using Reference_t = vecpp::Ap_float<256, 19>;
+
+static_assert(Q16_t{1.5} * Q16_t{2.25} == Q16_t{3.375});
+static_assert(double(Q16_t{7} / Q16_t{2}) == 3.5);
+static_assert(double(-Q32_t{0.75}) == -0.75);
+static_assert(Saturated_t::max() + Saturated_t::epsilon() ==
+              Saturated_t::max());
+
+constexpr Rounding all_modes[] = {Rounding::nearest_even,
+                                  Rounding::nearest_away,
+                                  Rounding::toward_zero, Rounding::upward,
+                                  Rounding::downward};
+
+namespace {
+template <typename Fixed>
+Fixed random_value(std::mt19937_64& gen, int max_exponent) {
+  // Two doubles cover the 64 bits of Q32_t and most of Wide_fixed_t.
+  double hi = test::random_double(gen, -20, max_exponent);
+  double lo = hi * test::random_double(gen, -53, -53);
+  return Fixed{Reference_t{hi} + Reference_t{lo}, Rounding::toward_zero};
+}
+
+template <typename Fixed>
+void check_arithmetic(int max_exponent) {
+  std::mt19937_64 gen(Fixed::bits);
+  for (int i = 0; i < 500; ++i) {
+    auto a = random_value<Fixed>(gen, max_exponent);
+    auto b = random_value<Fixed>(gen, max_exponent);
+    if (b.is_zero()) {
+      continue;
+    }
+    auto ra = Reference_t(a);
+    auto rb = Reference_t(b);
+    REQUIRE(Reference_t(a + b) == ra + rb);
+    REQUIRE(Reference_t(a - b) == ra - rb);
+    // The product is exact in the reference, so rounding it once to the
+    // fixed format must match, wrapped around the same way.
+    for (auto mode : all_modes) {
+      REQUIRE(mul(a, b, mode) == Fixed(ra * rb, mode));
+    }
+
+    auto exact = ra / rb;
+    if (abs(exact) >= Reference_t(Fixed::max())) {
+      continue;
+    }
+    // Directed roundings of a directed rounding agree with the exact
+    // quotient rounded once.
+    for (auto mode : {Rounding::toward_zero, Rounding::upward,
+                      Rounding::downward}) {
+      REQUIRE(div(a, b, mode) == Fixed(vecpp::div(ra, rb, mode), mode));
+    }
+    // Nearest: no further from the quotient than the other neighbour.
+    auto down = div(a, b, Rounding::downward);
+    auto up = div(a, b, Rounding::upward);
+    auto nearest = div(a, b);
+    REQUIRE((nearest == down || nearest == up));
+    auto err = [&](const Fixed& q) { return abs(Reference_t(q) - exact); };
+    REQUIRE(err(nearest) <= err(nearest == down ? up : down));
+  }
+}
+}  // namespace
+
+TEST_CASE("fixed point arithmetic", "[apfixed]") {
+  check_arithmetic<Q16_t>(12);
+  check_arithmetic<Q32_t>(28);
+  check_arithmetic<Wide_fixed_t>(60);
+}
+
+TEST_CASE("fixed point conversions", "[apfixed]") {
+  REQUIRE(double(Q16_t{-3}) == -3);
+  REQUIRE(double(Q16_t{0.1}) == 6554 / 65536.0);
+  REQUIRE(double(Q16_t{0.1, Rounding::toward_zero}) == 6553 / 65536.0);
+  REQUIRE(double(Q16_t{-0.1, Rounding::downward}) == -6554 / 65536.0);
+  REQUIRE(Q16_t{std::numeric_limits<double>::quiet_NaN()}.is_zero());
+  REQUIRE(Q16_t{-std::numeric_limits<double>::infinity()} == Q16_t::min());
+  REQUIRE(double(Q16_t::epsilon()) == std::ldexp(1.0, -16));
+  REQUIRE(double(Q32_t::max()) == std::ldexp(1.0, 31));
+  REQUIRE(float(Q32_t{0.375}) == 0.375f);
+
+  // Every Q16_t converts exactly to double and back.
+  std::mt19937_64 gen(1);
+  for (int i = 0; i < 1000; ++i) {
+    auto raw = Q16_t::Storage{gen() & 0xffffffff};
+    auto v = Q16_t::from_raw(raw);
+    REQUIRE(Q16_t{double(v)} == v);
+  }
+
+  // Rescaling is exact when bits are added, rounded when they are dropped.
+  Q32_t x{-1234.5678};
+  REQUIRE(Q32_t{Wide_fixed_t{x}} == x);
+  REQUIRE(Q16_t{x} == Q16_t{-1234.5678});
+  REQUIRE(Q16_t{x, Rounding::toward_zero} > Q16_t{x, Rounding::downward});
+  REQUIRE(Saturated_t{Q32_t{1000}} == Saturated_t::max());
+}
+
+TEST_CASE("fixed point overflow", "[apfixed]") {
+  using Wrapped_t = vecpp::Ap_fixed<8, 8>;
+  REQUIRE(Wrapped_t::max() + Wrapped_t::epsilon() == Wrapped_t::min());
+  REQUIRE(-Wrapped_t::min() == Wrapped_t::min());
+  REQUIRE(Wrapped_t{200} == Wrapped_t{-56});
+  REQUIRE(Wrapped_t{16} * Wrapped_t{9} == Wrapped_t{-112});
+
+  REQUIRE(Saturated_t::min() - Saturated_t::epsilon() == Saturated_t::min());
+  REQUIRE(-Saturated_t::min() == Saturated_t::max());
+  REQUIRE(Saturated_t{200} == Saturated_t::max());
+  REQUIRE(Saturated_t{-128} == Saturated_t::min());
+  REQUIRE(Saturated_t{16} * Saturated_t{9} == Saturated_t::max());
+  REQUIRE(Saturated_t{-16} * Saturated_t{9} == Saturated_t::min());
+  REQUIRE(Saturated_t{-16} * Saturated_t{8} == Saturated_t::min());
+  REQUIRE(Saturated_t{100} / Saturated_t{0.5} == Saturated_t::max());
+  REQUIRE(Saturated_t{100} - Saturated_t{-100} == Saturated_t::max());
+
+  REQUIRE(Q16_t{-2} < Q16_t{1});
+  REQUIRE(Q16_t::min() < Q16_t{-32767});
+  REQUIRE(abs(Q16_t{-2.5}) == Q16_t{2.5});
+}
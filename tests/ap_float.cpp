@@ -2,10 +2,285 @@
 
 #include "vecpp/ap_math.h"
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+
 using float10_10_t = vecpp::Ap_float<10,10>;
+using Float4_t = vecpp::Ap_float<4, 8>;
+using Float24_t = vecpp::Ap_float<24, 8>;
+using Float53_t = vecpp::Ap_float<53, 11>;
+using Float113_t = vecpp::Ap_float<113, 15>;
+
+using vecpp::Rounding;
+
+static_assert(Float113_t{7} * Float113_t{6} == Float113_t{42});
+static_assert(Float113_t{1} / Float113_t{3} < Float113_t{1});
+static_assert((Float53_t{1} / Float53_t{3}).exponent() == -2);
+static_assert(Float53_t{0.1}.significand()[0] == 0x1999999999999AULL);
+static_assert(double(Float53_t{-0.1}) == -0.1);
+static_assert(float(Float53_t{0.1}) == 0.1f);
+static_assert(sizeof(Float53_t) == sizeof(double));
+static_assert(sizeof(Float113_t) == 16);
+static_assert(Float53_t{1.5}.encoding()[0] == 0x3FF8000000000000ULL);
+static_assert(vecpp::Ap_float<11, 5>{-2}.encoding()[0] == 0xC000);
+static_assert(vecpp::to_double(vecpp::Ap_uint<200>{1} << 150) ==
+              1427247692705959881058285969449495136382746624.0);
 
+static double random_double(std::mt19937_64& gen, int max_exp) {
+  std::uniform_real_distribution<double> frac(0.5, 1.0);
+  std::uniform_int_distribution<int> exp(-max_exp, max_exp);
+  double v = std::ldexp(frac(gen), exp(gen));
+  // Some values with short significands, to get exact results and ties.
+  if (gen() % 4 == 0) {
+    v = std::ldexp(std::ceil(std::ldexp(frac(gen), 8)), exp(gen));
+  }
+  return gen() % 2 ? -v : v;
+}
 
 TEST_CASE("construct ap float", "[apfloat]") {
   float10_10_t x{3.2};
   (void)x;
+
+  REQUIRE(Float53_t{0}.is_zero());
+  REQUIRE(Float53_t{1}.exponent() == 0);
+  REQUIRE(Float53_t{-12}.signbit());
+  REQUIRE(double(Float53_t{-12}) == -12.0);
+  REQUIRE(double(Float53_t{std::int64_t(1) << 62}) ==
+          std::ldexp(1.0, 62));
+
+  // Rounded to nearest even.
+  REQUIRE(Float4_t{17} == Float4_t{16});
+  REQUIRE(Float4_t{19} == Float4_t{20});
+}
+
+TEST_CASE("ap float special values", "[apfloat]") {
+  auto inf = Float53_t::infinity();
+  auto nan = Float53_t::quiet_nan();
+  Float53_t one{1};
+  Float53_t zero{0};
+
+  REQUIRE((inf - inf).is_nan());
+  REQUIRE((inf * zero).is_nan());
+  REQUIRE((zero / zero).is_nan());
+  REQUIRE((inf / inf).is_nan());
+  REQUIRE((nan + one).is_nan());
+  REQUIRE(nan != nan);
+
+  REQUIRE(one / zero == inf);
+  REQUIRE(-one / zero == -inf);
+  REQUIRE(one / inf == zero);
+  REQUIRE((-one / inf).signbit());
+  REQUIRE(inf + one == inf);
+  REQUIRE(vecpp::fma(inf, one, -one) == inf);
+  REQUIRE(vecpp::fma(inf, one, -inf).is_nan());
+
+  REQUIRE(-zero == zero);
+  REQUIRE((-zero + -zero).signbit());
+  REQUIRE_FALSE((one - one).signbit());
+  REQUIRE(vecpp::sub(one, one, Rounding::downward).signbit());
+
+  REQUIRE(Float53_t::max() + Float53_t::max() == inf);
+  REQUIRE(vecpp::add(Float53_t::max(), Float53_t::max(),
+                     Rounding::toward_zero) == Float53_t::max());
+  REQUIRE(-inf < -Float53_t::max());
+}
+
+TEST_CASE("ap float rounding modes", "[apfloat]") {
+  // 17 is a tie between 16 and 18 with 4 bits of precision.
+  Float4_t sixteen{16};
+  Float4_t one{1};
+
+  REQUIRE(vecpp::add(sixteen, one, Rounding::nearest_even) == Float4_t{16});
+  REQUIRE(vecpp::add(sixteen, one, Rounding::nearest_away) == Float4_t{18});
+  REQUIRE(vecpp::add(sixteen, one, Rounding::toward_zero) == Float4_t{16});
+  REQUIRE(vecpp::add(sixteen, one, Rounding::upward) == Float4_t{18});
+  REQUIRE(vecpp::add(sixteen, one, Rounding::downward) == Float4_t{16});
+
+  REQUIRE(vecpp::sub(-sixteen, one, Rounding::nearest_even) == Float4_t{-16});
+  REQUIRE(vecpp::sub(-sixteen, one, Rounding::nearest_away) == Float4_t{-18});
+  REQUIRE(vecpp::sub(-sixteen, one, Rounding::toward_zero) == Float4_t{-16});
+  REQUIRE(vecpp::sub(-sixteen, one, Rounding::upward) == Float4_t{-16});
+  REQUIRE(vecpp::sub(-sixteen, one, Rounding::downward) == Float4_t{-18});
+
+  // 1 / 3 = 0.0101..., never a tie.
+  Float113_t third = Float113_t{1} / Float113_t{3};
+  auto sig = third.significand();
+  REQUIRE(third.exponent() == -2);
+  REQUIRE(sig[1] == 0x1555555555555ULL);
+  REQUIRE(sig[0] == 0x5555555555555555ULL);
+  auto third_up = vecpp::div(Float113_t{1}, Float113_t{3}, Rounding::upward);
+  REQUIRE(third_up.significand()[0] == 0x5555555555555556ULL);
+}
+
+TEST_CASE("ap float matches native double", "[apfloat]") {
+  std::mt19937_64 gen{1234};
+  for (int i = 0; i < 2000; ++i) {
+    double a = random_double(gen, 600);
+    double b = random_double(gen, 600);
+    double c = random_double(gen, 600);
+    auto x = Float53_t(a);
+    auto y = Float53_t(b);
+    auto z = Float53_t(c);
+    REQUIRE(double(x) == a);
+
+    REQUIRE(double(x + y) == a + b);
+    REQUIRE(double(x - y) == a - b);
+    REQUIRE(double(x * y) == a * b);
+    REQUIRE(double(x / y) == a / b);
+    REQUIRE(double(vecpp::fma(x, y, z)) == std::fma(a, b, c));
+    // Products of nearby magnitudes, to get cancellations.
+    REQUIRE(double(vecpp::fma(x, y, -(x * y))) ==
+            std::fma(a, b, -(a * b)));
+
+    REQUIRE((x < y) == (a < b));
+    REQUIRE((x == y) == (a == b));
+  }
+}
+
+TEST_CASE("ap float matches native float", "[apfloat]") {
+  std::mt19937_64 gen{4321};
+  for (int i = 0; i < 2000; ++i) {
+    auto a = float(random_double(gen, 60));
+    auto b = float(random_double(gen, 60));
+    auto c = float(random_double(gen, 60));
+    auto x = Float24_t(a);
+    auto y = Float24_t(b);
+    auto z = Float24_t(c);
+
+    // Covers overflows and subnormals.
+    REQUIRE(float(x * y) == double(a * b));
+    REQUIRE(float(x / y) == double(a / b));
+    REQUIRE(float(x + y) == double(a + b));
+    REQUIRE(float(vecpp::fma(x, y, z)) ==
+            double(std::fma(a, b, c)));
+  }
+}
+
+TEST_CASE("ap float directed rounding brackets", "[apfloat]") {
+  std::mt19937_64 gen{99};
+  for (int i = 0; i < 500; ++i) {
+    auto x = Float53_t(random_double(gen, 600));
+    auto y = Float53_t(random_double(gen, 600));
+
+    auto check = [](auto op) {
+      auto near = op(Rounding::nearest_even);
+      auto down = op(Rounding::downward);
+      auto up = op(Rounding::upward);
+      auto zero = op(Rounding::toward_zero);
+      auto away = op(Rounding::nearest_away);
+
+      REQUIRE(down <= near);
+      REQUIRE(near <= up);
+      REQUIRE((away == down || away == up));
+      REQUIRE(zero == (near.signbit() ? up : down));
+      double d = double(down);
+      double u = double(up);
+      REQUIRE((d == u || std::nextafter(d, INFINITY) == u));
+    };
+
+    check([&](Rounding r) { return vecpp::add(x, y, r); });
+    check([&](Rounding r) { return vecpp::mul(x, y, r); });
+    check([&](Rounding r) { return vecpp::div(x, y, r); });
+    check([&](Rounding r) { return vecpp::fma(x, y, x, r); });
+  }
+}
+
+TEST_CASE("ap float native conversions", "[apfloat]") {
+  std::mt19937_64 gen{2024};
+  for (int i = 0; i < 5000; ++i) {
+    // Any bit pattern: subnormals, infinities and NaNs included.
+    std::uint64_t bits = gen();
+    double d = 0;
+    std::memcpy(&d, &bits, sizeof(d));
+    Float53_t x{d};
+    if (std::isnan(d)) {
+      REQUIRE(x.is_nan());
+      REQUIRE(std::isnan(double(x)));
+      continue;
+    }
+    REQUIRE(std::signbit(double(x)) == std::signbit(d));
+    REQUIRE(double(x) == d);
+    REQUIRE(double(Float113_t{d}) == d);
+
+    // Narrowing is correctly rounded.
+    REQUIRE(float(x) == float(d));
+    REQUIRE(float(Float24_t{d}) == float(d));
+    auto down = vecpp::to_native<float>(x, Rounding::downward);
+    auto up = vecpp::to_native<float>(x, Rounding::upward);
+    REQUIRE(double(down) <= d);
+    REQUIRE(d <= double(up));
+    REQUIRE((down == up || std::nextafter(down, INFINITY) == up));
+
+    long double l = (long double)d * (1.0L + std::ldexp(1.0L, -60));
+    REQUIRE((long double)(vecpp::Ap_float<64, 15>{l}) == l);
+    REQUIRE((long double)(Float113_t{l}) == l);
+  }
+
+  REQUIRE(Float53_t{std::numeric_limits<double>::infinity()}.is_inf());
+  REQUIRE(Float53_t{-0.0}.signbit());
+  REQUIRE(double(Float113_t{1e300} * Float113_t{1e300}) ==
+          std::numeric_limits<double>::infinity());
+  REQUIRE(vecpp::to_native<double>(Float113_t{1e300} * Float113_t{1e300},
+                                   Rounding::toward_zero) ==
+          std::numeric_limits<double>::max());
+}
+
+TEST_CASE("ap int to double", "[apfloat][apint]") {
+  using UInt512_t = vecpp::Ap_uint<512>;
+  using Int512_t = vecpp::Ap_int<512>;
+
+  std::mt19937_64 gen{7};
+  for (int i = 0; i < 1000; ++i) {
+    UInt512_t v{0};
+    std::size_t words = 1 + gen() % 8;
+    for (std::size_t w = 0; w < words; ++w) {
+      v.data_[w] = gen() >> (gen() % 64);
+    }
+    std::ostringstream str;
+    str << v;
+    REQUIRE(vecpp::to_double(v) == std::strtod(str.str().c_str(), nullptr));
+  }
+
+  REQUIRE(vecpp::to_double(UInt512_t{0}) == 0.0);
+  REQUIRE(vecpp::to_double(Int512_t{-12}) == -12.0);
+
+  // Ties at the 53rd bit are only decided by the low words.
+  UInt512_t tie = (UInt512_t{1} << 300) + (UInt512_t{1} << 247);
+  REQUIRE(vecpp::to_double(tie) == std::ldexp(1.0, 300));
+  REQUIRE(vecpp::to_double(tie + 1) == std::ldexp(1.0, 300) + std::ldexp(1.0, 248));
+  REQUIRE(vecpp::to_double(-vecpp::detail::to_signed(tie + 1)) ==
+          -std::ldexp(1.0, 300) - std::ldexp(1.0, 248));
+}
+
+TEST_CASE("ap float packed encoding", "[apfloat]") {
+  std::mt19937_64 gen{555};
+  // A quiet and a signalling NaN with payloads, then random patterns.
+  const std::uint64_t nans[] = {0x7FF8000000000001ULL, 0xFFF0000000000001ULL};
+  for (int i = 0; i < 1000; ++i) {
+    std::uint64_t bits = i < 2 ? nans[i] : gen();
+    double d = 0;
+    std::memcpy(&d, &bits, sizeof(d));
+
+    Float53_t x{d};
+    // NaN payloads are not preserved, only NaN-ness.
+    if (std::isnan(d)) {
+      REQUIRE(x.is_nan());
+      REQUIRE(Float53_t::from_encoding(x.encoding()).is_nan());
+      continue;
+    }
+    REQUIRE(x.encoding()[0] == bits);
+    REQUIRE(Float53_t::from_encoding(x.encoding()).encoding()[0] == bits);
+
+    // binary128 has the same layout, with wider fields.
+    Float113_t q{d};
+    REQUIRE(q.encoding()[1] >> 63 == bits >> 63);
+  }
+
+  REQUIRE(Float113_t{1}.encoding()[1] == 0x3FFF000000000000ULL);
+  REQUIRE(Float113_t::infinity(true).encoding()[1] == 0xFFFF000000000000ULL);
+  REQUIRE(Float113_t::max().encoding()[1] == 0x7FFEFFFFFFFFFFFFULL);
 }
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <cmath>
+
+using Float53_t = vecpp::Ap_float<53, 11>;
+using Float113_t = vecpp::Ap_float<113, 15>;
+using Float256_t = vecpp::Ap_float<256, 19>;
+
+using vecpp::Math_constant;
+using vecpp::Rounding;
+
+static_assert(double(vecpp::pi_v<53, 11>) == 3.141592653589793);
+static_assert(double(vecpp::e_v<53, 11>) == 2.718281828459045);
+static_assert(double(vecpp::ln2_v<53, 11>) == 0.6931471805599453);
+static_assert(double(vecpp::ln10_v<53, 11>) == 2.302585092994046);
+static_assert(float(vecpp::pi_v<24, 8>) == 3.14159265f);
+
+namespace {
+Float113_t from_words(std::uint64_t high, std::uint64_t low) {
+  Float113_t::Storage bits{0};
+  bits[0] = low;
+  bits[1] = high;
+  return Float113_t::from_encoding(bits);
+}
+}  // namespace
+
+TEST_CASE("mathematical constants", "[apfloat]") {
+  REQUIRE(vecpp::constant<113, 15>(Math_constant::pi) ==
+          from_words(0x4000921fb54442d1ULL, 0x8469898cc51701b8ULL));
+  REQUIRE(vecpp::constant<113, 15>(Math_constant::e) ==
+          from_words(0x40005bf0a8b14576ULL, 0x95355fb8ac404e7aULL));
+  REQUIRE(vecpp::constant<113, 15>(Math_constant::ln2) ==
+          from_words(0x3ffe62e42fefa39eULL, 0xf35793c7673007e6ULL));
+  REQUIRE(vecpp::constant<113, 15>(Math_constant::ln10) ==
+          from_words(0x400026bb1bbb5551ULL, 0x582dd4adac5705a6ULL));
+
+  // Directed roundings bracket the constant one ulp apart.
+  for (auto c : {Math_constant::pi, Math_constant::e, Math_constant::ln2,
+                 Math_constant::ln10}) {
+    double down = double(vecpp::constant<53, 11>(c, Rounding::downward));
+    double up = double(vecpp::constant<53, 11>(c, Rounding::upward));
+    double nearest = double(vecpp::constant<53, 11>(c));
+    REQUIRE(std::nextafter(down, up) == up);
+    REQUIRE((nearest == down || nearest == up));
+    REQUIRE(double(vecpp::constant<53, 11>(c, Rounding::toward_zero)) == down);
+  }
+
+  // A wider value, rounded again, lands on the binary128 one.
+  REQUIRE(Float113_t(vecpp::constant<256, 19>(Math_constant::pi)) ==
+          vecpp::constant<113, 15>(Math_constant::pi));
+  REQUIRE(vecpp::constant<256, 19>(Math_constant::ln2) ==
+          vecpp::ln2_v<256, 19>);
+}
+
+TEST_CASE("constant generators", "[apfloat]") {
+  // The generators are within a few units of the last bit and the table is
+  // truncated, so both round to the same value a few bits up.
+  using Float448_t = vecpp::Ap_float<448, 15>;
+  for (auto c : {Math_constant::pi, Math_constant::e, Math_constant::ln2,
+                 Math_constant::ln10}) {
+    auto generated = vecpp::detail::round_fixed_constant<Float448_t, 512>(
+        vecpp::detail::constant_fixed<512>(c));
+    auto table = vecpp::detail::round_fixed_constant<Float448_t, 512>(
+        vecpp::detail::fixed_constant<512>(c));
+    REQUIRE(generated.value == table.value);
+  }
+}
+
+TEST_CASE("constant cache", "[apfloat]") {
+  auto& cache = vecpp::detail::Constant_cache::instance();
+
+  auto wide = vecpp::constant<1000, 15>(Math_constant::e);
+  auto computed = cache.computations();
+
+  // Anything less precise is served from the value above.
+  REQUIRE(vecpp::constant<53, 11>(Math_constant::e) == vecpp::e_v<53, 11>);
+  REQUIRE(vecpp::constant<256, 19>(Math_constant::e) == vecpp::e_v<256, 19>);
+  REQUIRE(vecpp::constant<1000, 15>(Math_constant::e) == wide);
+  REQUIRE(cache.computations() == computed);
+
+  REQUIRE(vecpp::Ap_float<1000, 15>(vecpp::constant<1200, 15>(
+              Math_constant::e)) == wide);
+  REQUIRE(cache.computations() == computed + 1);
+}
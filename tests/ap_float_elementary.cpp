@@ -0,0 +1,188 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using Float24_t = vecpp::Ap_float<24, 8>;
+using Float53_t = vecpp::Ap_float<53, 11>;
+using Float113_t = vecpp::Ap_float<113, 15>;
+
+using vecpp::Rounding;
+
+static_assert(double(vecpp::exp(Float53_t{1})) == 2.718281828459045);
+static_assert(double(vecpp::sqrt(Float53_t{2})) == 1.4142135623730951);
+static_assert(double(vecpp::log(Float53_t{2})) == 0.6931471805599453);
+
+namespace {
+Float113_t from_words(std::uint64_t high, std::uint64_t low) {
+  Float113_t::Storage bits{0};
+  bits[0] = low;
+  bits[1] = high;
+  return Float113_t::from_encoding(bits);
+}
+
+// Within half an ulp of a long double reference, give or take its own error.
+bool close_to(double v, long double ref) {
+  auto inf = std::numeric_limits<double>::infinity();
+  long double ulp =
+      std::max(std::nextafter(v, inf) - v, v - std::nextafter(v, -inf));
+  return std::fabs(v - ref) <= ulp / 2 * (1 + 1.0L / 256);
+}
+}  // namespace
+
+TEST_CASE("elementary function values", "[apfloat]") {
+  REQUIRE(double(vecpp::exp(Float53_t{-3.7})) == 0.024723526470339388);
+  REQUIRE(double(vecpp::exp(Float53_t{700})) == 1.0142320547350045e+304);
+  REQUIRE(double(vecpp::log(Float53_t{1e-5})) == -11.512925464970229);
+  REQUIRE(double(vecpp::sin(Float53_t{100})) == -0.50636564110975879);
+  REQUIRE(double(vecpp::cos(Float53_t{10})) == -0.83907152907645244);
+  REQUIRE(double(vecpp::atan(Float53_t{2})) == 1.1071487177940904);
+  REQUIRE(double(vecpp::pow(Float53_t{2.5}, Float53_t{3.3})) ==
+          20.568471942722457);
+
+  // The reduction of large arguments keeps every bit of x.
+  REQUIRE(double(vecpp::sin(Float53_t{1e300})) == -0.81788191211590855);
+  REQUIRE(double(vecpp::cos(Float53_t{1e300})) == -0.57538611195754907);
+
+  REQUIRE(vecpp::sqrt(Float113_t{2}) ==
+          from_words(0x3fff6a09e667f3bcULL, 0xc908b2fb1366ea95ULL));
+  REQUIRE(vecpp::exp(Float113_t{1}) ==
+          from_words(0x40005bf0a8b14576ULL, 0x95355fb8ac404e7aULL));
+  REQUIRE(vecpp::log(Float113_t{2}) ==
+          from_words(0x3ffe62e42fefa39eULL, 0xf35793c7673007e6ULL));
+  REQUIRE(vecpp::atan(Float113_t{1}) * Float113_t{4} ==
+          from_words(0x4000921fb54442d1ULL, 0x8469898cc51701b8ULL));
+}
+
+TEST_CASE("elementary function special values", "[apfloat]") {
+  auto inf = Float53_t::infinity();
+  REQUIRE(vecpp::exp(-inf).is_zero());
+  REQUIRE(vecpp::exp(Float53_t{1000}).is_inf());
+  REQUIRE(vecpp::exp(Float53_t{1000}, Rounding::toward_zero) ==
+          Float53_t::max());
+  REQUIRE(double(vecpp::exp(Float53_t{-745})) == 4.9406564584124654e-324);
+  REQUIRE(vecpp::exp(Float53_t{-1000}).is_zero());
+  REQUIRE(double(vecpp::exp(Float53_t{-1000}, Rounding::upward)) ==
+          4.9406564584124654e-324);
+
+  REQUIRE(vecpp::log(Float53_t{-1}).is_nan());
+  REQUIRE(vecpp::log(Float53_t{0}) == -inf);
+  REQUIRE(vecpp::log(Float53_t{1}).is_zero());
+  REQUIRE(vecpp::sqrt(Float53_t{-0.0}).signbit());
+  REQUIRE(vecpp::sqrt(Float53_t{-1}).is_nan());
+  REQUIRE(vecpp::sin(inf).is_nan());
+  REQUIRE(vecpp::sin(Float53_t{-0.0}).signbit());
+  REQUIRE(double(vecpp::atan(-inf)) == -1.5707963267948966);
+
+  // Tiny arguments only move directed roundings.
+  REQUIRE(double(vecpp::sin(Float53_t{1e-200})) == 1e-200);
+  REQUIRE(double(vecpp::sin(Float53_t{1e-200}, Rounding::downward)) ==
+          std::nextafter(1e-200, 0.0));
+  REQUIRE(double(vecpp::cos(Float53_t{1e-200}, Rounding::downward)) ==
+          std::nextafter(1.0, 0.0));
+  REQUIRE(double(vecpp::exp(Float53_t{-1e-200}, Rounding::upward)) == 1.0);
+
+  REQUIRE(vecpp::pow(Float53_t::quiet_nan(), Float53_t{0}) == Float53_t{1});
+  REQUIRE(vecpp::pow(Float53_t{-1}, inf) == Float53_t{1});
+  REQUIRE(vecpp::pow(Float53_t{-0.0}, Float53_t{-3}) == -inf);
+  REQUIRE(vecpp::pow(Float53_t{-0.0}, Float53_t{-2}) == inf);
+  REQUIRE(vecpp::pow(-inf, Float53_t{3}) == -inf);
+  REQUIRE(vecpp::pow(Float53_t{0.5}, -inf) == inf);
+  REQUIRE(vecpp::pow(Float53_t{-2}, Float53_t{0.5}).is_nan());
+}
+
+TEST_CASE("pow exact results", "[apfloat]") {
+  // Exact results and exact midpoints round like any other value.
+  REQUIRE(double(vecpp::pow(Float53_t{-2}, Float53_t{3})) == -8.0);
+  REQUIRE(double(vecpp::pow(Float53_t{4}, Float53_t{1.5}, Rounding::upward)) ==
+          8.0);
+  REQUIRE(double(vecpp::pow(Float53_t{16}, Float53_t{-0.25})) == 0.5);
+  REQUIRE(double(vecpp::pow(Float53_t{2}, Float53_t{-1074})) ==
+          4.9406564584124654e-324);
+  REQUIRE(double(vecpp::pow(Float53_t{10}, Float53_t{-2}, Rounding::upward)) ==
+          0.01);
+  REQUIRE(double(vecpp::pow(Float53_t{10}, Float53_t{-2},
+                            Rounding::downward)) == std::nextafter(0.01, 0.0));
+  REQUIRE(vecpp::pow(Float24_t{4097}, Float24_t{2}) == Float24_t{16785408});
+  REQUIRE(vecpp::pow(Float24_t{4097}, Float24_t{2}, Rounding::upward) ==
+          Float24_t{16785410});
+}
+
+TEST_CASE("elementary functions are correctly rounded", "[apfloat]") {
+  std::mt19937_64 gen(7);
+  std::uniform_real_distribution<double> frac(0.5, 1.0);
+  std::uniform_int_distribution<int> exponent(-20, 20);
+
+  for (int i = 0; i < 200; ++i) {
+    double x = std::ldexp(frac(gen), exponent(gen));
+    double y = std::ldexp(frac(gen), exponent(gen) / 4);
+    if (i % 2 == 0) {
+      y = -y;
+    }
+    double sx = i % 3 == 0 ? -x : x;
+
+    auto check = [](auto f, long double ref) {
+      double nearest = double(f(Rounding::nearest_even));
+      double down = double(f(Rounding::downward));
+      double up = double(f(Rounding::upward));
+      REQUIRE(close_to(nearest, ref));
+      REQUIRE((nearest == down || nearest == up));
+      REQUIRE(std::nextafter(down, up) == up);
+    };
+
+    if (x < 700) {
+      check([&](Rounding m) { return vecpp::exp(Float53_t{sx}, m); },
+            std::exp((long double)sx));
+    }
+    if (x != 1.0) {
+      check([&](Rounding m) { return vecpp::log(Float53_t{x}, m); },
+            std::log((long double)x));
+      check(
+          [&](Rounding m) {
+            return vecpp::pow(Float53_t{x}, Float53_t{y}, m);
+          },
+          std::pow((long double)x, (long double)y));
+    }
+    check([&](Rounding m) { return vecpp::sin(Float53_t{sx}, m); },
+          std::sin((long double)sx));
+    check([&](Rounding m) { return vecpp::cos(Float53_t{sx}, m); },
+          std::cos((long double)sx));
+    check([&](Rounding m) { return vecpp::atan(Float53_t{sx}, m); },
+          std::atan((long double)sx));
+    REQUIRE(double(vecpp::sqrt(Float53_t{x})) == std::sqrt(x));
+  }
+}
+
+TEST_CASE("ziv rounding past the last tier", "[apfloat]") {
+  // An approximation of the midpoint between 1 and 1 + 2^-52 whose error
+  // bound straddles it, with a single tier: the result is not known to be
+  // correctly rounded, but stays within the documented bound.
+  constexpr std::size_t P = vecpp::detail::ziv_precision(53, 0);
+  using W = vecpp::Ap_float<P, vecpp::detail::ziv_exponent_bits(53, 11)>;
+  W mid = W(1) + vecpp::ldexp(W(1), -53);
+  std::int64_t guard = 10;
+  W delta = vecpp::ldexp(mid, guard - std::int64_t(P));
+  auto eval = [&](auto tag) {
+    using T = typename decltype(tag)::type;
+    return vecpp::detail::Approx<T>{T(mid), guard};
+  };
+
+  for (Rounding mode : {Rounding::nearest_even, Rounding::nearest_away,
+                        Rounding::upward, Rounding::downward,
+                        Rounding::toward_zero}) {
+    bool nearest =
+        mode == Rounding::nearest_even || mode == Rounding::nearest_away;
+    auto r = vecpp::detail::ziv_round<53, 11, 1>(eval, mode);
+    W rounding_error = vecpp::ldexp(W(1), nearest ? -53 : -52);
+    for (W x : {mid - delta, mid, mid + delta}) {
+      REQUIRE(vecpp::abs(W(r) - x) <= rounding_error + delta);
+    }
+  }
+  // x = mid + delta / 2 would round up, the approximation rounds to even.
+  REQUIRE(vecpp::detail::ziv_round<53, 11, 1>(eval, Rounding::nearest_even) ==
+          Float53_t(1));
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using vecpp::Rounding;
+
+namespace {
+constexpr double cancelling_sum() {
+  double values[] = {1e300, 1.0, -1e300, 1e-300};
+  return vecpp::exact_sum(values, 4);
+}
+}  // namespace
+
+static_assert(cancelling_sum() == 1.0);
+
+TEST_CASE("exact sum of doubles", "[apfloat]") {
+  std::mt19937_64 gen(11);
+  std::uniform_real_distribution<double> value(-1, 1);
+  std::uniform_int_distribution<int> exponent(-80, 80);
+  std::vector<double> values;
+  for (int i = 0; i < 2000; ++i) {
+    values.push_back(std::ldexp(value(gen), exponent(gen)));
+  }
+
+  // Wide enough for every partial sum to be exact.
+  using Wide = vecpp::Ap_float<256, 11>;
+  Wide reference{0};
+  for (double v : values) {
+    reference = reference + Wide{v};
+  }
+  for (auto mode : {Rounding::nearest_even, Rounding::upward,
+                    Rounding::downward, Rounding::toward_zero}) {
+    REQUIRE(vecpp::exact_sum(values.data(), values.size(), mode) ==
+            vecpp::to_native<double>(reference, mode));
+  }
+
+  vecpp::Superaccumulator acc;
+  acc.add(values.data(), values.size());
+  REQUIRE(acc.round<256, 11>() == reference);
+  REQUIRE(acc.round<113, 15>() == vecpp::Ap_float<113, 15>(reference));
+}
+
+TEST_CASE("exact sum extremes", "[apfloat]") {
+  double tiny = std::numeric_limits<double>::denorm_min();
+  vecpp::Superaccumulator acc;
+  acc += 1.0;
+  acc += tiny;
+  REQUIRE(acc.to_double() == 1.0);
+  REQUIRE(acc.to_double(Rounding::upward) == std::nextafter(1.0, 2.0));
+  acc += -1.0;
+  REQUIRE(acc.to_double() == tiny);
+
+  // No intermediate overflow.
+  double big[] = {DBL_MAX, DBL_MAX, -DBL_MAX};
+  REQUIRE(vecpp::exact_sum(big, 3) == DBL_MAX);
+  REQUIRE(std::isinf(vecpp::exact_sum(big, 2)));
+  REQUIRE(vecpp::exact_sum(big, 2, Rounding::toward_zero) == DBL_MAX);
+
+  double zeros[] = {-0.0, -0.0, 0.0};
+  REQUIRE(std::signbit(vecpp::exact_sum(zeros, 2)));
+  REQUIRE(!std::signbit(vecpp::exact_sum(zeros, 3)));
+  double cancel[] = {1.5, -1.5};
+  REQUIRE(!std::signbit(vecpp::exact_sum(cancel, 2)));
+  REQUIRE(std::signbit(vecpp::exact_sum(cancel, 2, Rounding::downward)));
+
+  // Downward, only mixed zeros and cancellations give -0.
+  double positive_zeros[] = {0.0, 0.0};
+  REQUIRE(!std::signbit(vecpp::exact_sum(nullptr, 0, Rounding::downward)));
+  REQUIRE(!std::signbit(
+      vecpp::exact_sum(positive_zeros, 1, Rounding::downward)));
+  REQUIRE(!std::signbit(
+      vecpp::exact_sum(positive_zeros, 2, Rounding::downward)));
+  REQUIRE(std::signbit(vecpp::exact_sum(zeros, 2, Rounding::downward)));
+  REQUIRE(std::signbit(vecpp::exact_sum(zeros, 3, Rounding::downward)));
+  vecpp::Superaccumulator positive;
+  positive += 0.0;
+  positive += vecpp::Superaccumulator{};
+  REQUIRE(!std::signbit(positive.to_double(Rounding::downward)));
+  positive += -0.0;
+  REQUIRE(std::signbit(positive.to_double(Rounding::downward)));
+  REQUIRE(!std::signbit(positive.to_double(Rounding::upward)));
+
+  auto inf = std::numeric_limits<double>::infinity();
+  double infinities[] = {inf, 1.0, -inf};
+  REQUIRE(vecpp::exact_sum(infinities, 2) == inf);
+  REQUIRE(std::isnan(vecpp::exact_sum(infinities, 3)));
+  double nan[] = {1.0, std::numeric_limits<double>::quiet_NaN()};
+  REQUIRE(std::isnan(vecpp::exact_sum(nan, 2)));
+}
+
+TEST_CASE("parallel exact sum", "[apfloat]") {
+  std::mt19937_64 gen(12);
+  std::uniform_real_distribution<double> value(-1, 1);
+  std::uniform_int_distribution<int> exponent(-600, 600);
+  std::vector<double> values;
+  for (int i = 0; i < 300000; ++i) {
+    values.push_back(std::ldexp(value(gen), exponent(gen)));
+  }
+
+  double sum = vecpp::exact_sum(values.data(), values.size());
+  REQUIRE(vecpp::parallel_exact_sum(values.data(), values.size(), 4) == sum);
+
+  // Merging accumulators gives the same result as a single one.
+  vecpp::Superaccumulator left;
+  vecpp::Superaccumulator right;
+  left.add(values.data(), 1000);
+  right.add(values.data() + 1000, values.size() - 1000);
+  left += right;
+  REQUIRE(left.to_double() == sum);
+}
@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <cmath>
+
+using Float64_t = vecpp::Ap_float<64, 15>;
+
+namespace {
+struct Exp {
+  constexpr Float64_t operator()(const Float64_t& x) const {
+    return vecpp::exp(x);
+  }
+};
+
+struct Log {
+  constexpr Float64_t operator()(const Float64_t& x) const {
+    return vecpp::log(x);
+  }
+};
+
+// Largest |p(x) - f(x)|, relative to |f(x)| if asked, over a grid much finer
+// than the one of the fit.
+template <typename F, typename Coefs>
+double max_error(const F& f, const Coefs& c, double lo, double hi,
+                 bool relative) {
+  double result = 0;
+  for (int i = 0; i <= 2000; ++i) {
+    Float64_t x{lo + (hi - lo) * i / 2000};
+    Float64_t p{0};
+    for (std::size_t j = c.size(); j-- > 0;) {
+      p = vecpp::fma(p, x, c[j]);
+    }
+    Float64_t y = f(x);
+    Float64_t err = p - y;
+    if (relative) {
+      err = err / y;
+    }
+    result = std::max(result, std::fabs(double(err)));
+  }
+  return result;
+}
+}  // namespace
+
+// Computed entirely at compile time, within the default step limits.
+constexpr auto exp_coefs = vecpp::minimax_coefficients<double, 4>(
+    Exp{}, Float64_t{-0.35}, Float64_t{0.35});
+static_assert(exp_coefs[0] > 0.99999 && exp_coefs[0] < 1.00001);
+
+TEST_CASE("minimax polynomial, absolute error", "[apfloat]") {
+  auto fit = vecpp::minimax<5>(Exp{}, Float64_t{-0.35}, Float64_t{0.35});
+  REQUIRE(fit.iterations <= 4);
+
+  // The error levels out at about 2^-24, and nothing in between the grid
+  // points goes much past it.
+  double levelled = double(fit.error);
+  REQUIRE(levelled > 7e-8);
+  REQUIRE(levelled < 9e-8);
+  double dense = max_error(Exp{}, fit.coefficients, -0.35, 0.35, false);
+  REQUIRE(dense >= levelled);
+  REQUIRE(dense <= levelled * 1.02);
+
+  for (std::size_t j = 0; j < exp_coefs.size(); ++j) {
+    REQUIRE(std::fabs(exp_coefs[j] - 1 / std::tgamma(j + 1.0)) < 1e-2);
+  }
+}
+
+TEST_CASE("minimax polynomial, relative error", "[apfloat]") {
+  auto fit = vecpp::minimax<6>(Log{}, Float64_t{1.5}, Float64_t{3},
+                               vecpp::Minimax_error::relative);
+  double levelled = double(fit.error);
+  double dense = max_error(Log{}, fit.coefficients, 1.5, 3, true);
+  REQUIRE(dense >= levelled);
+  REQUIRE(dense <= levelled * 1.02);
+
+  // A relative fit does better where |log(x)| is small than an absolute one.
+  auto absolute = vecpp::minimax<6>(Log{}, Float64_t{1.5}, Float64_t{3});
+  REQUIRE(max_error(Log{}, absolute.coefficients, 1.5, 3, true) > dense);
+
+  auto floats = vecpp::minimax_coefficients<float, 6>(
+      Log{}, Float64_t{1.5}, Float64_t{3}, vecpp::Minimax_error::relative);
+  for (std::size_t j = 0; j < floats.size(); ++j) {
+    REQUIRE(floats[j] == float(fit.coefficients[j]));
+  }
+}
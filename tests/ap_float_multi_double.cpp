@@ -0,0 +1,129 @@
+#include "catch.hpp"
+#include "test_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cmath>
+#include <random>
+
+using vecpp::Dd_float;
+using vecpp::Qd_float;
+
+using Float106_t = vecpp::Ap_float<106, 11>;
+using Float212_t = vecpp::Ap_float<212, 11>;
+using Reference_t = vecpp::Ap_float<320, 11>;
+
+constexpr Dd_float third = Dd_float{1} / Dd_float{3};
+static_assert(third[0] == 1.0 / 3);
+static_assert(Dd_float{std::int64_t(-(1LL << 62) - 1)}[1] == -1);
+
+constexpr Qd_float qd_third{Float212_t{1} / Float212_t{3}};
+static_assert(Float212_t(qd_third) == Float212_t{1} / Float212_t{3});
+static_assert(Float106_t(sqrt(Dd_float{4})) == Float106_t{2});
+
+namespace {
+// x + y 2^-53 + z 2^-106 + ..., with random parts.
+template <std::size_t n>
+vecpp::Multi_double<n> random_value(std::mt19937_64& gen) {
+  double lead = test::random_double(gen, -30, 30);
+  vecpp::Multi_double<n> result{lead};
+  for (std::size_t i = 1; i < n; ++i) {
+    lead = std::ldexp(lead, -53);
+    result += vecpp::Multi_double<n>{lead * test::random_double(gen, 0, 0)};
+  }
+  return result;
+}
+
+// log2 of the relative error of v.
+template <std::size_t n>
+double error_bits(const vecpp::Multi_double<n>& v, const Reference_t& exact) {
+  Reference_t err = (Reference_t(v) - exact) / exact;
+  return err.is_zero() ? -1000 : std::log2(std::fabs(double(err)));
+}
+
+template <std::size_t n>
+void check_accuracy(double bound) {
+  using Float = vecpp::Multi_double<n>;
+  std::mt19937_64 gen(n);
+  for (int i = 0; i < 1000; ++i) {
+    Float a = random_value<n>(gen);
+    Float b = random_value<n>(gen);
+    if (i % 4 == 0) {
+      // Cancels the leading 80 bits.
+      b = -a + Float{std::ldexp(a[0], -80)};
+    }
+    auto ra = Reference_t(a);
+    auto rb = Reference_t(b);
+    REQUIRE(error_bits(a + b, ra + rb) < bound);
+    REQUIRE(error_bits(a - b, ra - rb) < bound);
+    REQUIRE(error_bits(a * b, ra * rb) < bound);
+    REQUIRE(error_bits(a / b, ra / rb) < bound);
+    REQUIRE(error_bits(sqrt(abs(a)), vecpp::sqrt(abs(ra))) < bound);
+  }
+}
+}  // namespace
+
+TEST_CASE("double-double and quad-double accuracy", "[apfloat]") {
+  check_accuracy<2>(-102);
+  check_accuracy<4>(-204);
+}
+
+TEST_CASE("double-double and quad-double conversions", "[apfloat]") {
+  std::mt19937_64 gen(3);
+  for (int i = 0; i < 100; ++i) {
+    auto x = Float106_t{random_value<2>(gen)[0]} / Float106_t{3};
+    REQUIRE(Float106_t(Dd_float{x}) == x);
+    auto y = Float212_t(random_value<4>(gen)) / Float212_t{7};
+    REQUIRE(Float212_t(Qd_float{y}) == y);
+  }
+
+  // The parts are summed exactly before the rounding.
+  Qd_float tie = Qd_float{1} + Qd_float{std::ldexp(1.0, -212)};
+  REQUIRE(Float212_t(tie) == Float212_t{1});
+  REQUIRE(Float212_t(tie + Qd_float{std::ldexp(1.0, -400)}) > Float212_t{1});
+  REQUIRE(Float212_t(tie - Qd_float{std::ldexp(1.0, -400)}) == Float212_t{1});
+
+  REQUIRE(Dd_float{std::uint64_t(-1)}[0] == 18446744073709551616.0);
+  REQUIRE(Dd_float{std::uint64_t(-1)}[1] == -1);
+  REQUIRE(double(Qd_float{Float212_t{0.1}}) == 0.1);
+}
+
+TEST_CASE("double-double and quad-double special values", "[apfloat]") {
+  auto inf = Dd_float::infinity();
+  REQUIRE((Qd_float::infinity() + Qd_float{1}).is_inf());
+  REQUIRE((Qd_float::infinity() * Qd_float{1}).is_inf());
+  REQUIRE((inf + Dd_float{1}).is_inf());
+  REQUIRE((inf * Dd_float{-2}) == Dd_float::infinity(true));
+  REQUIRE((inf - inf).is_nan());
+  REQUIRE((Dd_float{1} / Dd_float{0}).is_inf());
+  REQUIRE((Dd_float{1} / inf).is_zero());
+  REQUIRE(sqrt(Dd_float{-1}).is_nan());
+  REQUIRE(Qd_float::max().is_finite());
+  REQUIRE((Qd_float::max() * Qd_float{2}).is_inf());
+  REQUIRE(Float106_t(Dd_float{-0.0}).signbit());
+  REQUIRE(Dd_float::quiet_nan() != Dd_float::quiet_nan());
+
+  REQUIRE(Dd_float{1} < Dd_float{1} + Dd_float{std::ldexp(1.0, -100)});
+  REQUIRE(-Qd_float{2} < Qd_float{1});
+  REQUIRE(ldexp(third, 3)[1] == third[1] * 8);
+}
+
+TEST_CASE("double-double arrays", "[apfloat]") {
+  std::mt19937_64 gen(5);
+  vecpp::Dd_float_array a(100);
+  vecpp::Dd_float_array b(100);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a.set(i, random_value<2>(gen));
+    b.set(i, random_value<2>(gen));
+  }
+
+  vecpp::Dd_float_array sum;
+  vecpp::transform(a, b, sum, [](const Dd_float& x, const Dd_float& y) {
+    return x + y;
+  });
+  REQUIRE(sum.size() == a.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    REQUIRE(sum.get(i) == a.get(i) + b.get(i));
+    REQUIRE(sum.part(1)[i] == (a.get(i) + b.get(i))[1]);
+  }
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+TEST_CASE("column scans", "[apint]") {
+  using Uint192_t = vecpp::Ap_uint<192>;
+  std::mt19937_64 gen(7);
+  std::vector<Uint192_t> values;
+  for (int i = 0; i < 1000; ++i) {
+    Uint192_t v{0};
+    for (auto& l : v.limbs()) {
+      l = gen();
+    }
+    // Equal top limbs, so some comparisons go further down.
+    if (i % 3 == 0) {
+      v.limbs()[2] = 42;
+    }
+    values.push_back(v);
+  }
+
+  const char* path = "column_test.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    REQUIRE(vecpp::write_column(out, values.data(), values.size()));
+  }
+  {
+    vecpp::Ap_int_column<192> column(path);
+    REQUIRE(column.is_open());
+    REQUIRE(column.size() == values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      REQUIRE(column[i] == values[i]);
+    }
+    REQUIRE(reinterpret_cast<std::uintptr_t>(column.data()) % 8 == 0);
+
+    std::size_t i = 0;
+    for (const auto& v : column) {
+      REQUIRE(&v == &column[i++]);
+    }
+    REQUIRE(i == values.size());
+
+    Uint192_t half = Uint192_t{1} << 191;
+    std::size_t expected = 0;
+    for (const auto& v : values) {
+      expected += v >= half ? 1 : 0;
+    }
+    REQUIRE(vecpp::count_if(column,
+                            [&](const Uint192_t& v) { return v >= half; }) ==
+            expected);
+
+    Uint192_t lo = values[0];
+    Uint192_t hi = values[0];
+    for (const auto& v : values) {
+      lo = v < lo ? v : lo;
+      hi = v > hi ? v : hi;
+    }
+    REQUIRE(vecpp::min(column) == lo);
+    REQUIRE(vecpp::max(column) == hi);
+
+    vecpp::Ap_int_column<192> moved = std::move(column);
+    REQUIRE(!column.is_open());
+    REQUIRE(moved.size() == values.size());
+  }
+  std::remove(path);
+
+  // Empty, nothing to map.
+  std::ofstream(path, std::ios::binary).close();
+  {
+    vecpp::Ap_int_column<192> column(path);
+    REQUIRE(column.is_open());
+    REQUIRE(column.size() == 0);
+    REQUIRE(column.empty());
+    REQUIRE(column.begin() == column.end());
+    REQUIRE(vecpp::count_if(column, [](const Uint192_t&) { return true; }) ==
+            0);
+  }
+  std::remove(path);
+
+  // Not a whole number of values.
+  std::ofstream(path, std::ios::binary) << "12345";
+  REQUIRE(!vecpp::Ap_int_column<192>(path).is_open());
+  std::remove(path);
+  REQUIRE(!vecpp::Ap_int_column<192>("no/such/file").is_open());
+}
+#endif
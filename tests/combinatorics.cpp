@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+using UInt128_t = vecpp::Ap_uint<128>;
+using UInt320_t = vecpp::Ap_uint<320>;
+using Int320_t = vecpp::Ap_int<320>;
+
+static_assert(vecpp::factorial<128>(30) ==
+              UInt128_t{"265252859812191058636308480000000"});
+static_assert(vecpp::binomial<128>(100, 50) ==
+              UInt128_t{"100891344545564193334812497256"});
+
+TEST_CASE("pow", "[apuint][combinatorics]") {
+  REQUIRE(vecpp::pow(UInt320_t{3}, 0) == 1);
+  REQUIRE(vecpp::pow(UInt320_t{3}, 1) == 3);
+  REQUIRE(vecpp::pow(UInt320_t{3}, 200) ==
+          UInt320_t{"26561398887587476933878132203577962682923345265339449597"
+                    "4574961739092490901302182994384699044001"});
+  REQUIRE(vecpp::pow(Int320_t{-3}, 101) ==
+          Int320_t{"-1546132562196033993109383389296863818106322566003"});
+}
+
+TEST_CASE("factorial", "[apuint][combinatorics]") {
+  REQUIRE(vecpp::factorial<128>(0) == 1);
+  REQUIRE(vecpp::factorial<128>(1) == 1);
+  REQUIRE(vecpp::factorial<128>(20) == UInt128_t{2432902008176640000});
+
+  // Modulo 2^512
+  REQUIRE(vecpp::factorial<512>(100) ==
+          vecpp::Ap_uint<512>{
+              "787225154367686866402486875401144345958215305856355963697624"
+              "691412234391802865040041886091487042953107618784928084430905"
+              "8186545715873172821802917654691840"});
+
+  using UInt20480_t = vecpp::Ap_uint<20480>;
+  UInt20480_t naive{1};
+  for (std::uint64_t i = 2; i <= 2000; ++i) {
+    naive *= i;
+  }
+  REQUIRE(vecpp::factorial<20480>(2000) == naive);
+  REQUIRE(vecpp::parallel_factorial<20480>(2000, 4) == naive);
+}
+
+TEST_CASE("binomial", "[apuint][combinatorics]") {
+  REQUIRE(vecpp::binomial<128>(10, 11) == 0);
+  REQUIRE(vecpp::binomial<128>(10, 0) == 1);
+  REQUIRE(vecpp::binomial<128>(10, 10) == 1);
+  REQUIRE(vecpp::binomial<128>(10, 3) == 120);
+  REQUIRE(vecpp::binomial<128>(200, 7) == UInt128_t{2283896214600});
+
+  // Modulo 2^128
+  REQUIRE(vecpp::binomial<128>(5000, 2500) ==
+          UInt128_t{"106027633562848214092882131144238318560"});
+  REQUIRE(vecpp::binomial<128>(40000, 20000) ==
+          UInt128_t{"72094530839849318757672800145888175072"});
+  REQUIRE(vecpp::parallel_binomial<128>(40000, 20000, 4) ==
+          UInt128_t{"72094530839849318757672800145888175072"});
+
+  // Above the sieve limit
+  REQUIRE(vecpp::binomial<128>(std::uint64_t(1) << 40, 2) ==
+          UInt128_t{"604462909806764831539200"});
+}
+
+TEST_CASE("binomial modulo 2^bits", "[apuint][combinatorics]") {
+  // The low 128 bits of the 256 bit result, on both sides of the point
+  // where the binomial stops fitting in 128 bits, on both code paths.
+  auto low_words = [](const vecpp::Ap_uint<256>& v) {
+    return (UInt128_t{v.limbs()[1]} << 64) | UInt128_t{v.limbs()[0]};
+  };
+  for (std::uint64_t n : {std::uint64_t(150), std::uint64_t(1) << 24,
+                          (std::uint64_t(1) << 40) + 12345}) {
+    std::uint64_t k = 1;
+    while (vecpp::binomial<256>(n, k) < (vecpp::Ap_uint<256>{1} << 128)) {
+      ++k;
+    }
+    for (std::uint64_t j : {k - 1, k, k + 1, k + 7}) {
+      REQUIRE(vecpp::binomial<128>(n, j) ==
+              low_words(vecpp::binomial<256>(n, j)));
+    }
+  }
+  REQUIRE(vecpp::binomial<128>(std::uint64_t(1) << 30, 300) ==
+          low_words(vecpp::binomial<256>(std::uint64_t(1) << 30, 300)));
+}
@@ -0,0 +1,115 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <random>
+#include <vector>
+
+using vecpp::detail::Isa;
+using Words = std::vector<std::uint64_t>;
+
+#ifdef VECPP_AP_INT_HAS_WORD_KERNELS
+namespace {
+// Plain loops on 128 bit intermediates.
+Words random_words(std::mt19937_64& gen, std::size_t n) {
+  Words result(n);
+  for (auto& w : result) {
+    // Runs of all ones make long carry chains.
+    w = gen() % 4 == 0 ? ~std::uint64_t(0) : gen();
+  }
+  return result;
+}
+
+std::uint64_t reference_addmul(Words& r, const Words& a, std::uint64_t w) {
+  std::uint64_t carry = 0;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    auto p = vecpp::detail::Uint128(a[i]) * w + r[i] + carry;
+    r[i] = std::uint64_t(p);
+    carry = std::uint64_t(p >> 64);
+  }
+  return carry;
+}
+}  // namespace
+
+TEST_CASE("word kernels", "[dispatch]") {
+  if (!vecpp::detail::isa_supported(Isa::adx)) {
+    return;
+  }
+  const auto& k = vecpp::detail::adx_word_kernels;
+  std::mt19937_64 gen(5);
+  for (std::size_t n = 1; n < 20; ++n) {
+    for (int rep = 0; rep < 50; ++rep) {
+      auto a = random_words(gen, n);
+      auto b = random_words(gen, n);
+      std::uint64_t w = gen();
+
+      auto sum = a;
+      auto expected = a;
+      Words zero(n, 0);
+      auto carry = reference_addmul(expected, b, 1);
+      REQUIRE(k.add(sum.data(), b.data(), n) == (carry != 0));
+      REQUIRE(sum == expected);
+      REQUIRE(k.sub(sum.data(), b.data(), n) == (carry != 0));
+      REQUIRE(sum == a);
+      REQUIRE(k.sub(zero.data(), a.data(), n) == (a != Words(n, 0)));
+
+      auto prod = a;
+      expected = Words(n, 0);
+      carry = reference_addmul(expected, a, w);
+      REQUIRE(k.mul_word(prod.data(), n, w) == carry);
+      REQUIRE(prod == expected);
+
+      auto acc = a;
+      expected = a;
+      carry = reference_addmul(expected, b, w);
+      REQUIRE(k.addmul(acc.data(), b.data(), n, w) == carry);
+      REQUIRE(acc == expected);
+
+      // Undoes the product above.
+      std::uint64_t d = w | 1;
+      prod = a;
+      auto high = k.mul_word(prod.data(), n, d);
+      prod.push_back(high);
+      REQUIRE(k.divmod_word(prod.data(), n + 1, d) == 0);
+      prod.pop_back();
+      REQUIRE(prod == a);
+
+      unsigned shift = unsigned(gen() % 63 + 1);
+      auto shifted = a;
+      shifted.push_back(0);
+      k.lshift(shifted.data(), shifted.data(), n + 1, shift);
+      k.rshift(shifted.data(), shifted.data(), n + 1, shift);
+      shifted.pop_back();
+      REQUIRE(shifted == a);
+    }
+  }
+}
+#endif
+
+TEST_CASE("dispatched Int_storage operations", "[dispatch]") {
+  // Wide enough to go through the kernels, checked against identities
+  // that only hold if every one of them is right.
+  using Uint_t = vecpp::Large_ap_uint<1000>;
+  std::mt19937_64 gen(6);
+  for (int i = 0; i < 200; ++i) {
+    Uint_t a{0};
+    Uint_t b{0};
+    for (std::size_t k = 0; k < a.data_.words; ++k) {
+      a.data_[k] = gen();
+      b.data_[k] = gen() >> (gen() % 64);
+    }
+    a.data_.clear_unused_bits();
+    b.data_.clear_unused_bits();
+    std::uint64_t w = gen() | 1;
+
+    REQUIRE(a + b - b == a);
+    REQUIRE(b - a + a == b);
+    auto q = a / w;
+    REQUIRE(q * w + a % w == a);
+    REQUIRE((q * w) / w == q);
+    auto shift = gen() % 1000;
+    REQUIRE(((a >> shift) << shift) + (a - ((a >> shift) << shift)) == a);
+    REQUIRE((a << shift) >> shift == (a & ((~Uint_t{0}) >> shift)));
+    REQUIRE((a / b) * b + a % b == a);
+  }
+}
@@ -0,0 +1,247 @@
+#include "catch.hpp"
+#include "test_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <iomanip>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Dyn_t = vecpp::Dyn_ap_int<2>;
+using Int512_t = vecpp::Ap_int<512>;
+
+namespace {
+// Counts the calls to the new / delete resource.
+class Counting_resource : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations = 0;
+  std::size_t live = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    ++live;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override {
+    --live;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+std::string to_string(const Dyn_t& v) {
+  std::ostringstream out;
+  out << v;
+  return out.str();
+}
+}  // namespace
+
+TEST_CASE("dyn int basics", "[apint]") {
+  REQUIRE(Dyn_t().is_zero());
+  REQUIRE(Dyn_t(0).size() == 0);
+  REQUIRE(Dyn_t(-5).is_negative());
+  REQUIRE(Dyn_t(-5) < Dyn_t(3));
+  REQUIRE(Dyn_t(INT64_MIN).limbs()[0] == std::uint64_t(1) << 63);
+  REQUIRE(-Dyn_t(0) == 0);
+  REQUIRE(!(-Dyn_t(0)).is_negative());
+
+  REQUIRE(to_string(Dyn_t(0)) == "0");
+  REQUIRE(to_string(Dyn_t(-1234)) == "-1234");
+  std::string big = "-123456789012345678901234567890123456789012345678901";
+  REQUIRE(to_string(Dyn_t(big)) == big);
+  REQUIRE(Dyn_t("10000000000000000000") == Dyn_t(10000000000000000000ull));
+  std::string nines(57, '9');
+  REQUIRE(to_string(Dyn_t(nines)) == nines);
+  REQUIRE(to_string(Dyn_t("-1" + std::string(38, '0'))) ==
+          "-1" + std::string(38, '0'));
+  std::ostringstream padded;
+  padded << std::setw(6) << Dyn_t(-42);
+  REQUIRE(padded.str() == "   -42");
+
+  // Grows past the inline words, and keeps working when copied or moved.
+  Dyn_t x = 1;
+  REQUIRE(x.is_inline());
+  x <<= 200;
+  REQUIRE(!x.is_inline());
+  REQUIRE(x.size() == 4);
+  REQUIRE(x.bit_width() == 201);
+  Dyn_t y = x;
+  Dyn_t z = std::move(x);
+  REQUIRE(y == z);
+  REQUIRE((z >> 200) == 1);
+  REQUIRE(((z - 1) >> 200) == 0);
+  REQUIRE(((-z) >> 199) == -2);
+  REQUIRE((Dyn_t(-1) >> 10) == -1);
+  REQUIRE(z / z == 1);
+  REQUIRE(z % 7 == 4);
+
+  // Moved-from values are zero, and can be used again.
+  Dyn_t small = 3;
+  Dyn_t large = -(Dyn_t(1) << 300);
+  small = std::move(large);
+  REQUIRE(small == -(Dyn_t(1) << 300));
+  REQUIRE(large.is_zero());
+  REQUIRE(!large.is_negative());
+  large += Dyn_t(1);
+  REQUIRE(large == 1);
+  Dyn_t& alias = large;
+  large = std::move(alias);
+  REQUIRE(large == 1);
+  Dyn_t stolen(std::move(small));
+  REQUIRE(stolen == -(Dyn_t(1) << 300));
+  REQUIRE(small.is_zero());
+  small -= Dyn_t(1) << 200;
+  REQUIRE(small == -(Dyn_t(1) << 200));
+}
+
+TEST_CASE("dyn int matches Ap_int", "[apint]") {
+  std::mt19937_64 gen(5);
+  for (int i = 0; i < 500; ++i) {
+    // Up to 200 bits, so that products fit in 512.
+    Int512_t a = test::random_large<Int512_t>(gen, 200);
+    Int512_t b = test::random_large<Int512_t>(gen, 200);
+    Dyn_t da = a;
+    Dyn_t db = b;
+
+    REQUIRE(Int512_t(da) == a);
+    REQUIRE(Int512_t(da + db) == a + b);
+    REQUIRE(Int512_t(da - db) == a - b);
+    REQUIRE(Int512_t(da * db) == a * b);
+    REQUIRE((da < db) == (a < b));
+    if (b != Int512_t{0}) {
+      REQUIRE(Int512_t(da / db) == a / b);
+      REQUIRE(Int512_t(da % db) == a - a / b * b);
+      REQUIRE(Int512_t(da * db / db) == a);
+    }
+    std::size_t shift = gen() % 130;
+    REQUIRE(Int512_t(da << shift) == a << shift);
+    REQUIRE(Int512_t(da >> shift) == a >> shift);
+    REQUIRE(Dyn_t(to_string(da)) == da);
+  }
+}
+
+TEST_CASE("dyn int conversions", "[apint]") {
+  using Uint130_t = vecpp::Ap_uint<130>;
+  Uint130_t max = ~Uint130_t{0};
+  Dyn_t x = max;
+  REQUIRE(x.bit_width() == 130);
+  REQUIRE(Uint130_t(x) == max);
+  // Wraps around like the fixed width types.
+  REQUIRE(Uint130_t(x + 1) == Uint130_t{0});
+  REQUIRE(Uint130_t(Dyn_t(-1)) == max);
+  REQUIRE(vecpp::Ap_int<130>(Dyn_t(-1)) == vecpp::Ap_int<130>{-1});
+
+  auto lowest = std::numeric_limits<vecpp::Ap_int<130>>::min();
+  Dyn_t y = lowest;
+  REQUIRE(y == -(Dyn_t(1) << 129));
+  REQUIRE(vecpp::Ap_int<130>(y) == lowest);
+
+  vecpp::Ap_int<12> small{-7};
+  REQUIRE(Dyn_t(small) == -7);
+  REQUIRE(vecpp::Ap_int<12>(Dyn_t(-7)) == small);
+  REQUIRE(vecpp::Ap_uint<64>(Dyn_t(-1)) == ~std::uint64_t(0));
+}
+
+TEST_CASE("dyn int allocations", "[apint]") {
+  Counting_resource counting;
+  {
+    vecpp::Limb_pool pool(&counting);
+    Dyn_t::allocator_type alloc(&pool);
+
+    // Past the inline words, so every value is on the heap.
+    Dyn_t a(Dyn_t(1) << 300, alloc);
+    Dyn_t b(Dyn_t(3) << 400, alloc);
+    Dyn_t c(Dyn_t(5) << 250, alloc);
+    a += 12345;
+    Dyn_t x(alloc);
+    Dyn_t q(alloc);
+    Dyn_t r(alloc);
+    std::size_t warm = 0;
+    std::size_t scratch = 0;
+    for (int i = 0; i < 100; ++i) {
+      x = a * b + c;
+      q = x / c;
+      r = x % c;
+      REQUIRE(q * c + r == x);
+      a += 1;
+      if (i == 0) {
+        warm = counting.allocations;
+        scratch = vecpp::detail::scratch_arena().upstream_allocations();
+      }
+    }
+    // Nothing reaches upstream past the first round.
+    REQUIRE(warm > 0);
+    REQUIRE(counting.allocations == warm);
+    REQUIRE(pool.upstream_allocations() == warm);
+    REQUIRE(vecpp::detail::scratch_arena().upstream_allocations() ==
+            scratch);
+    // Printing only takes scratch words once the arena has seen the size.
+    std::ostringstream text;
+    text << x;
+    scratch = vecpp::detail::scratch_arena().upstream_allocations();
+    text << x;
+    REQUIRE(vecpp::detail::scratch_arena().upstream_allocations() ==
+            scratch);
+    REQUIRE(x.get_allocator().resource() == &pool);
+    REQUIRE((x * x).get_allocator().resource() == &pool);
+  }
+  REQUIRE(counting.live == 0);
+
+  // std::pmr containers hand their resource to their elements.
+  std::pmr::vector<Dyn_t> values(&counting);
+  values.emplace_back(Dyn_t(1) << 500);
+  values.push_back(values[0] * 3);
+  REQUIRE(values[1].get_allocator().resource() == &counting);
+  REQUIRE(values[1] == (Dyn_t(3) << 500));
+
+  // Moves between resources copy, and leave the source zero too.
+  Dyn_t other(Dyn_t(-7) << 300, &counting);
+  Dyn_t moved(std::move(values[1]), std::pmr::new_delete_resource());
+  REQUIRE(moved == (Dyn_t(3) << 500));
+  REQUIRE(values[1].is_zero());
+  values[1] += 5;
+  REQUIRE(values[1] == 5);
+  moved = std::move(other);
+  REQUIRE(moved == -(Dyn_t(7) << 300));
+  REQUIRE(moved.get_allocator().resource() == std::pmr::new_delete_resource());
+  REQUIRE(other.is_zero());
+  REQUIRE(!other.is_negative());
+  other -= Dyn_t(1) << 200;
+  REQUIRE(other == -(Dyn_t(1) << 200));
+}
+
+TEST_CASE("limb pool alignment", "[apint]") {
+  Counting_resource counting;
+  vecpp::Limb_pool pool(&counting);
+  struct Block {
+    void* p;
+    std::size_t bytes;
+    std::size_t alignment;
+  };
+  std::vector<Block> blocks;
+  // Enough blocks of each class to go past the first one of a chunk.
+  for (int i = 0; i < 40; ++i) {
+    for (std::size_t bytes : {1, 8, 24, 64, 100000}) {
+      for (std::size_t alignment :
+           {std::size_t(1), std::size_t(8), std::size_t(16),
+            alignof(std::max_align_t), std::size_t(64)}) {
+        void* p = pool.allocate(bytes, alignment);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(p) % alignment == 0);
+        blocks.push_back({p, bytes, alignment});
+      }
+    }
+  }
+  for (const auto& b : blocks) {
+    pool.deallocate(b.p, b.bytes, b.alignment);
+  }
+  pool.release();
+  REQUIRE(counting.live == 0);
+}
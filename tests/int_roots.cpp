@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+using UInt200_t = vecpp::Ap_uint<200>;
+using Int200_t = vecpp::Ap_int<200>;
+
+static_assert(vecpp::isqrt(UInt200_t{"152415787532388367504942236884722755800955129"}) ==
+              UInt200_t{"12345678901234567890123"});
+static_assert(vecpp::ilog10(UInt200_t{"1000000000000000000000000000000"}) == 30);
+
+TEST_CASE("apuint isqrt", "[apuint][roots]") {
+  REQUIRE(vecpp::isqrt(UInt200_t{0}) == 0);
+  REQUIRE(vecpp::isqrt(UInt200_t{1}) == 1);
+  REQUIRE(vecpp::isqrt(UInt200_t{15}) == 3);
+  REQUIRE(vecpp::isqrt(UInt200_t{16}) == 4);
+
+  UInt200_t r{"12345678901234567890123456789"};
+  REQUIRE(vecpp::isqrt(r * r) == r);
+  REQUIRE(vecpp::isqrt(r * r - 1) == r - 1);
+  REQUIRE(vecpp::isqrt(r * r + r * 2) == r);
+
+  auto max = std::numeric_limits<UInt200_t>::max();
+  auto s = vecpp::isqrt(max);
+  REQUIRE(s == (UInt200_t{1} << 100) - 1);
+}
+
+TEST_CASE("apuint iroot", "[apuint][roots]") {
+  REQUIRE(vecpp::iroot(UInt200_t{26}, 3) == 2);
+  REQUIRE(vecpp::iroot(UInt200_t{27}, 3) == 3);
+  REQUIRE(vecpp::iroot(UInt200_t{1}, 150) == 1);
+  REQUIRE(vecpp::iroot(UInt200_t{0}, 5) == 0);
+
+  UInt200_t r{"1234567890123"};
+  auto cube = r * r * r;
+  REQUIRE(vecpp::iroot(cube, 3) == r);
+  REQUIRE(vecpp::iroot(cube - 1, 3) == r - 1);
+  REQUIRE(vecpp::iroot(cube, 1) == cube);
+
+  auto fifth = (UInt200_t{1} << 190);
+  REQUIRE(vecpp::iroot(fifth, 5) == (UInt200_t{1} << 38));
+  REQUIRE(vecpp::iroot(fifth, 7) == 148188386);
+}
+
+TEST_CASE("apuint ilog2 and ilog10", "[apuint][roots]") {
+  REQUIRE(vecpp::ilog2(UInt200_t{1}) == 0);
+  REQUIRE(vecpp::ilog2(UInt200_t{1} << 150) == 150);
+  REQUIRE(vecpp::ilog2((UInt200_t{1} << 150) - 1) == 149);
+
+  REQUIRE(vecpp::ilog10(UInt200_t{1}) == 0);
+  REQUIRE(vecpp::ilog10(UInt200_t{9}) == 0);
+  REQUIRE(vecpp::ilog10(UInt200_t{10}) == 1);
+  REQUIRE(vecpp::ilog10(UInt200_t{"99999999999999999999999999999"}) == 28);
+  REQUIRE(vecpp::ilog10(UInt200_t{"100000000000000000000000000000"}) == 29);
+  REQUIRE(vecpp::ilog10(std::numeric_limits<UInt200_t>::max()) == 60);
+}
+
+TEST_CASE("apuint ilog10 of long values", "[apuint][roots]") {
+  using UInt1024_t = vecpp::Ap_uint<1024>;
+  // log2(10^205) is just below 681, past the reach of the estimate alone.
+  REQUIRE(vecpp::ilog10((UInt1024_t{1} << 681) - 1) == 205);
+
+  UInt1024_t p{1};
+  for (std::size_t k = 1; k <= 308; ++k) {
+    p *= 10;
+    REQUIRE(vecpp::ilog10(p) == k);
+    REQUIRE(vecpp::ilog10(p - 1) == k - 1);
+  }
+  REQUIRE(vecpp::ilog10(std::numeric_limits<UInt1024_t>::max()) == 308);
+}
+
+TEST_CASE("apuint is_perfect_square", "[apuint][roots]") {
+  UInt200_t r{"98765432109876543210"};
+  REQUIRE(vecpp::is_perfect_square(r * r));
+  REQUIRE(!vecpp::is_perfect_square(r * r + 1));
+  REQUIRE(!vecpp::is_perfect_square(r * r + r * 2));
+  REQUIRE(vecpp::is_perfect_square(UInt200_t{0}));
+}
+
+TEST_CASE("apint roots", "[apint][roots]") {
+  Int200_t r{"12345678901234567890123456789"};
+  REQUIRE(vecpp::isqrt(r * r) == r);
+  REQUIRE(vecpp::iroot(r * r, 2) == r);
+  REQUIRE(vecpp::ilog2(Int200_t{1024}) == 10);
+  REQUIRE(vecpp::ilog10(Int200_t{1000}) == 3);
+  REQUIRE(!vecpp::is_perfect_square(Int200_t{-4}));
+}
@@ -275,3 +275,23 @@ TEST_CASE("ostream << apint ", "[apint]") {
   }
 
 }
+
+TEST_CASE("apint bytes", "[apint]") {
+  // Two's complement, sign extended both ways.
+  std::byte in[] = {std::byte{0xff}, std::byte{0xfe}};
+  auto x = Int80_t::from_bytes(in, 2);
+  REQUIRE(x == Int80_t{-257});
+  REQUIRE(Int80_t::from_bytes(in, 2, vecpp::Endian::big) == Int80_t{-2});
+  REQUIRE(x.limbs()[1] == 0xffff);
+
+  std::byte out[12];
+  x.to_bytes(out, 12, vecpp::Endian::big);
+  REQUIRE(out[0] == std::byte{0xff});
+  REQUIRE(out[10] == std::byte{0xfe});
+  REQUIRE(out[11] == std::byte{0xff});
+  REQUIRE(Int80_t::from_bytes(out, 12, vecpp::Endian::big) == x);
+
+  Int80_t{257}.to_bytes(out, 12);
+  REQUIRE(out[1] == std::byte{1});
+  REQUIRE(out[11] == std::byte{0});
+}
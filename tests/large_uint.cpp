@@ -2,6 +2,9 @@
 
 #include "vecpp/ap_math.h"
 
+#include <cstdint>
+#include <sstream>
+
 using UInt80_t = vecpp::Ap_uint<80>;
 
 TEST_CASE("construct ApuInt", "[apuint]") {
@@ -84,3 +87,63 @@ TEST_CASE("ostream << apuint ", "[apuint]") {
   }
 
 }
+
+constexpr std::byte bytes_0102[] = {std::byte{0x01}, std::byte{0x02}};
+static_assert(UInt80_t::from_bytes(bytes_0102, 2) == UInt80_t{0x0201});
+static_assert(UInt80_t::from_bytes(bytes_0102, 2, vecpp::Endian::big) ==
+              UInt80_t{0x0102});
+
+TEST_CASE("apuint bytes", "[apuint]") {
+  using UInt130_t = vecpp::Ap_uint<130>;
+  std::byte in[20];
+  for (std::size_t i = 0; i < 20; ++i) {
+    in[i] = std::byte(i + 1);
+  }
+
+  // Bytes past 130 bits are dropped.
+  auto x = UInt130_t::from_bytes(in, 20);
+  REQUIRE(x.limbs()[0] == 0x0807060504030201);
+  REQUIRE(x.limbs()[1] == 0x100f0e0d0c0b0a09);
+  REQUIRE(x.limbs()[2] == 1);
+  REQUIRE(std::size(x.limbs()) == 3);
+  auto y = UInt130_t::from_bytes(in, 20, vecpp::Endian::big);
+  REQUIRE(y.limbs()[0] == 0x0d0e0f1011121314);
+  REQUIRE(y.limbs()[2] == 0);
+
+  // Wider buffers are zero extended, narrower ones truncated.
+  std::byte out[20];
+  for (auto order : {vecpp::Endian::little, vecpp::Endian::big}) {
+    x.to_bytes(out, 20, order);
+    REQUIRE(UInt130_t::from_bytes(out, 20, order) == x);
+    REQUIRE(out[order == vecpp::Endian::little ? 19 : 0] == std::byte{0});
+    x.to_bytes(out, 3, order);
+    REQUIRE(UInt130_t::from_bytes(out, 3, order) == UInt130_t{0x030201});
+  }
+
+  x.limbs()[1] = 0;
+  x.limbs()[2] = 0;
+  REQUIRE(x == UInt130_t{0x0807060504030201});
+}
+
+TEST_CASE("apuint small magnitudes in wide storage", "[apuint]") {
+  using UInt4096_t = vecpp::Ap_uint<4096>;
+  // Carries and borrows run past the used words of the right operand.
+  UInt4096_t ones = (UInt4096_t{1} << 1000) - UInt4096_t{1};
+  UInt4096_t x = ones + UInt4096_t{1};
+  REQUIRE(x == UInt4096_t{1} << 1000);
+  REQUIRE(x - UInt4096_t{1} == ones);
+  REQUIRE(UInt4096_t{0} - UInt4096_t{1} == ~UInt4096_t{0});
+  REQUIRE(~UInt4096_t{0} + UInt4096_t{1} == UInt4096_t{0});
+
+  REQUIRE(UInt4096_t{17} * std::uint64_t(3) == UInt4096_t{51});
+  REQUIRE((ones * ~std::uint64_t(0)) >> 1000 == ~std::uint64_t(0) - 1);
+  REQUIRE(x / std::uint64_t(1) << 3 == x << 3);
+  REQUIRE(x % std::uint64_t(10) == 6);
+  REQUIRE(UInt4096_t{17} < UInt4096_t{18});
+  REQUIRE((UInt4096_t{17} << 4000) > (UInt4096_t{18} << 3000));
+
+  std::ostringstream out;
+  out << (UInt4096_t{10000000000000000000ull} * UInt4096_t{1000}) << " "
+      << UInt4096_t{0} << " " << UInt4096_t{17};
+  REQUIRE(out.str() == "10000000000000000000000 0 17");
+}
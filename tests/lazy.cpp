@@ -0,0 +1,74 @@
+#include "catch.hpp"
+#include "test_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <random>
+
+using Uint256_t = vecpp::Ap_uint<256>;
+using Uint1000_t = vecpp::Ap_uint<1000>;
+using Int200_t = vecpp::Ap_int<200>;
+
+namespace {
+// Lazy expressions against the regular operators.
+template <typename T>
+void check_lazy(std::mt19937_64& gen) {
+  using vecpp::lazy;
+  for (int i = 0; i < 200; ++i) {
+    T a = test::random_large<T>(gen);
+    T b = test::random_large<T>(gen);
+    T c = test::random_large<T>(gen);
+    T d = test::random_large<T>(gen);
+    T e = test::random_large<T>(gen);
+
+    REQUIRE(T(lazy(a)) == a);
+    REQUIRE(T(lazy(a) + b) == a + b);
+    REQUIRE(T(lazy(a) - b) == a - b);
+    REQUIRE(T(lazy(a) + b + c - d) == a + b + c - d);
+    REQUIRE(T(lazy(a) - b - c - d - e) == a - b - c - d - e);
+    REQUIRE(T(a - (lazy(b) - c + d)) == a - (b - c + d));
+    REQUIRE(T((lazy(a) - b) - (lazy(c) - d)) == (a - b) - (c - d));
+
+    REQUIRE(T(lazy(a) * b) == a * b);
+    REQUIRE(T(lazy(a) * b + c) == a * b + c);
+    REQUIRE(T(c + a * lazy(b)) == c + a * b);
+    REQUIRE(T(c - lazy(a) * b) == c - a * b);
+    REQUIRE(T(lazy(a) * b - c - d) == a * b - c - d);
+    REQUIRE(T(lazy(a) * lazy(b) + lazy(c) * d - e) == a * b + c * d - e);
+    REQUIRE(T(e - (lazy(a) * b - lazy(c) * d)) == e - (a * b - c * d));
+
+    // Operands can alias each other and the result.
+    T expected = a * a + a - b;
+    a = lazy(a) * a + a - b;
+    REQUIRE(a == expected);
+  }
+}
+}  // namespace
+
+TEST_CASE("lazy apuint", "[apuint]") {
+  std::mt19937_64 gen(5);
+  check_lazy<Uint256_t>(gen);
+  check_lazy<Uint1000_t>(gen);
+
+  using vecpp::lazy;
+  Uint256_t a{5}, b{7}, c{11};
+  REQUIRE(Uint256_t(lazy(a) * b + c) == Uint256_t{46});
+  REQUIRE((lazy(a) - b - c).eval() == Uint256_t{0} - Uint256_t{13});
+
+  constexpr Uint256_t x{3}, y{4};
+  static_assert(Uint256_t(lazy(x) * y + x + y - x) == Uint256_t{16}, "");
+}
+
+TEST_CASE("lazy apint", "[apint]") {
+  std::mt19937_64 gen(6);
+  check_lazy<Int200_t>(gen);
+
+  using vecpp::lazy;
+  Int200_t a{-5}, b{7}, c{11};
+  REQUIRE(Int200_t(lazy(a) * b + c) == Int200_t{-24});
+  REQUIRE(Int200_t(c - lazy(a) * b - b) == Int200_t{39});
+
+  // Single word types pass through.
+  vecpp::Ap_int<32> s{-3};
+  REQUIRE(lazy(s) * s + s == 6);
+}
@@ -0,0 +1,37 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+using namespace vecpp::literals;
+
+static_assert(std::is_same_v<decltype(123456789012345678901234567890_ap),
+                             vecpp::Ap_int<98>>);
+static_assert(std::is_same_v<decltype(123456789012345678901234567890_apu),
+                             vecpp::Ap_uint<97>>);
+static_assert(std::is_same_v<decltype(0xDEADBEEF_apu), vecpp::Ap_uint<32>>);
+static_assert(std::is_same_v<decltype(0xDEADBEEF_ap), vecpp::Ap_int<33>>);
+static_assert(std::is_same_v<decltype(0_apu), vecpp::Ap_uint<2>>);
+
+static_assert(123456789012345678901234567890_ap ==
+              vecpp::Ap_int<98>{"123456789012345678901234567890"});
+static_assert(0x1'0000'0000'0000'0000_apu ==
+              vecpp::Ap_uint<65>{1} << 64);
+
+TEST_CASE("Ap_int literals", "[apint][literals]") {
+  REQUIRE(123456789012345678901234567890_ap ==
+          vecpp::Ap_int<98>{"123456789012345678901234567890"});
+  REQUIRE(-123456789012345678901234567890_ap ==
+          vecpp::Ap_int<98>{"-123456789012345678901234567890"});
+
+  REQUIRE(0xDEADBEEFCAFEBABE0123456789ABCDEF_apu ==
+          vecpp::Ap_uint<128>{"295990755076957304698161171062762229231"});
+  REQUIRE(0xdeadbeefcafebabe0123456789abcdef_apu ==
+          vecpp::Ap_uint<128>{"295990755076957304698161171062762229231"});
+
+  REQUIRE(0b1'0000000000'0000000000'0000000000'0000000000'0000000000'0000000000'0000_apu ==
+          vecpp::Ap_uint<65>{1} << 64);
+  REQUIRE(02000000000000000000000_apu == vecpp::Ap_uint<65>{1} << 64);
+
+  REQUIRE(12_ap == vecpp::Ap_int<5>{12});
+  REQUIRE(255_apu == vecpp::Ap_uint<8>{255});
+}
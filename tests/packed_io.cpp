@@ -0,0 +1,208 @@
+#include "catch.hpp"
+#include "test_util.h"
+
+#include "vecpp/ap_math.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using vecpp::Packed_encoding;
+
+namespace {
+template <typename T>
+T random_value(std::mt19937_64& gen) {
+  using Traits = vecpp::detail::Packed_traits<T>;
+  std::uint64_t limbs[Traits::words];
+  test::random_limbs(gen, limbs, Traits::bits, Traits::is_signed);
+  return Traits::from_limbs(limbs);
+}
+
+template <typename T>
+void check_round_trip(Packed_encoding encoding) {
+  std::mt19937_64 gen(vecpp::detail::Packed_traits<T>::bits);
+  std::vector<T> values;
+  // Two full chunks and a partial one.
+  for (int i = 0; i < 300; ++i) {
+    values.push_back(random_value<T>(gen));
+  }
+
+  std::stringstream stream;
+  {
+    vecpp::Packed_writer<T> writer(stream, encoding, 128);
+    writer.write(values[0]);
+    writer.write(values.data() + 1, values.size() - 1);
+  }
+
+  vecpp::Packed_reader<T> reader(stream);
+  std::vector<T> read(values.size() + 1, T{0});
+  REQUIRE(reader.read(read.data(), 10) == 10);
+  REQUIRE(reader.read(read[10]));
+  REQUIRE(reader.read(read.data() + 11, read.size() - 11) ==
+          values.size() - 11);
+  REQUIRE(!reader.read(read.back()));
+  REQUIRE(!reader.fail());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    REQUIRE(read[i] == values[i]);
+  }
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+  if (encoding == Packed_encoding::fixed) {
+    const char* path = "packed_io_test.bin";
+    std::ofstream(path, std::ios::binary) << stream.str();
+    vecpp::Mapped_packed_array<T> mapped(path);
+    REQUIRE(mapped.is_open());
+    REQUIRE(mapped.size() == values.size());
+    for (std::size_t i = values.size(); i-- > 0;) {
+      REQUIRE(mapped[i] == values[i]);
+    }
+    std::remove(path);
+  }
+#endif
+}
+
+template <typename T>
+void check_types() {
+  check_round_trip<T>(Packed_encoding::fixed);
+  check_round_trip<T>(Packed_encoding::varint);
+}
+}  // namespace
+
+TEST_CASE("packed streams round trip", "[apint]") {
+  check_types<vecpp::Ap_uint<5>>();
+  check_types<vecpp::Ap_int<12>>();
+  check_types<vecpp::Ap_int<64>>();
+  check_types<vecpp::Ap_uint<64>>();
+  check_types<vecpp::Ap_uint<100>>();
+  check_types<vecpp::Ap_int<130>>();
+  check_types<vecpp::Ap_uint<192>>();
+}
+
+TEST_CASE("packed stream layout", "[apint]") {
+  using Int_t = vecpp::Ap_int<12>;
+  std::stringstream stream;
+  {
+    vecpp::Packed_writer<Int_t> writer(stream);
+    for (int i = 0; i < 5; ++i) {
+      writer.write(Int_t(std::int16_t(i - 2)));
+    }
+  }
+  // 16 byte header, then 5 values of 12 bits in one word, then the end.
+  std::string bytes = stream.str();
+  REQUIRE(bytes.size() == 16 + 8 + 8 + 8);
+  REQUIRE(bytes.substr(0, 4) == "VPAI");
+  REQUIRE(bytes[24] == '\xfe');
+  REQUIRE(bytes[25] == '\xff');
+  REQUIRE(bytes[26] == '\xff');
+
+  // Varints: -2 -1 0 1 2 zigzag to 3 1 0 2 4, a byte each.
+  std::stringstream varints;
+  {
+    vecpp::Packed_writer<Int_t> writer(varints, Packed_encoding::varint);
+    for (int i = 0; i < 5; ++i) {
+      writer.write(Int_t(std::int16_t(i - 2)));
+    }
+  }
+  REQUIRE(varints.str().substr(16, 13) ==
+          std::string("\x05\0\0\0\x05\0\0\0\x03\x01\x00\x02\x04", 13));
+}
+
+TEST_CASE("packed stream chunk size limit", "[apint]") {
+  using Uint_t = vecpp::Ap_uint<64>;
+  using Writer = vecpp::Packed_writer<Uint_t>;
+  // (2^32 - 8) bytes of 64 bit values, rounded down to 64 values, and
+  // 19 bytes per 65 bit zigzag varint.
+  REQUIRE(Writer::max_chunk_size(Packed_encoding::fixed) ==
+          (std::uint32_t(1) << 29) - 64);
+  REQUIRE(Writer::max_chunk_size(Packed_encoding::varint) ==
+          (0xffffffffu - 7) / 19 / 64 * 64);
+  REQUIRE(vecpp::Packed_writer<vecpp::Ap_uint<5>>::max_chunk_size(
+              Packed_encoding::fixed) == 0xffffffffu / 64 * 64);
+
+  for (auto encoding : {Packed_encoding::fixed, Packed_encoding::varint}) {
+    std::stringstream stream;
+    {
+      Writer writer(stream, encoding, 0xffffffff);
+      writer.write(Uint_t(7));
+      writer.write(Uint_t(~std::uint64_t(0)));
+    }
+    std::uint32_t chunk_size;
+    std::memcpy(&chunk_size, stream.str().data() + 12, 4);
+    REQUIRE(chunk_size == Writer::max_chunk_size(encoding));
+
+    vecpp::Packed_reader<Uint_t> reader(stream);
+    Uint_t v{0};
+    REQUIRE(reader.read(v));
+    REQUIRE(v == Uint_t(7));
+    REQUIRE(reader.read(v));
+    REQUIRE(v == Uint_t(~std::uint64_t(0)));
+    REQUIRE(!reader.read(v));
+    REQUIRE(!reader.fail());
+  }
+}
+
+TEST_CASE("packed stream errors", "[apint]") {
+  using Int_t = vecpp::Ap_int<12>;
+  std::stringstream stream;
+  {
+    vecpp::Packed_writer<Int_t> writer(stream);
+    writer.write(Int_t(std::int16_t(1)));
+  }
+  std::string bytes = stream.str();
+
+  // A different type.
+  std::stringstream other(bytes);
+  vecpp::Packed_reader<vecpp::Ap_uint<12>> wrong_type(other);
+  vecpp::Ap_uint<12> u{0};
+  REQUIRE(!wrong_type.read(u));
+  REQUIRE(wrong_type.fail());
+
+  // A newer version.
+  std::string newer = bytes;
+  newer[4] = 2;
+  std::stringstream newer_stream(newer);
+  vecpp::Packed_reader<Int_t> newer_reader(newer_stream);
+  REQUIRE(newer_reader.fail());
+
+  // Cut short.
+  std::stringstream cut(bytes.substr(0, bytes.size() - 12));
+  vecpp::Packed_reader<Int_t> cut_reader(cut);
+  Int_t v{0};
+  REQUIRE(!cut_reader.read(v));
+  REQUIRE(cut_reader.fail());
+
+  // A chunk claiming far more values than the file holds.
+  std::uint32_t sizes[2] = {60000,
+                            vecpp::detail::packed_fixed_bytes(60000, 12)};
+  std::string long_chunk = bytes;
+  std::memcpy(&long_chunk[vecpp::detail::packed_header_bytes], sizes, 8);
+  std::stringstream long_stream(long_chunk);
+  vecpp::Packed_reader<Int_t> long_reader(long_stream);
+  REQUIRE(!long_reader.read(v));
+  REQUIRE(long_reader.fail());
+
+  // Varint payload sizes outside what count values can take.
+  std::stringstream varint_stream;
+  {
+    vecpp::Packed_writer<Int_t> writer(varint_stream,
+                                       Packed_encoding::varint);
+    writer.write(Int_t(std::int16_t(1)));
+  }
+  for (std::uint32_t size : {0u, 0xfffffff0u}) {
+    std::string corrupt = varint_stream.str();
+    std::memcpy(&corrupt[vecpp::detail::packed_header_bytes + 4], &size, 4);
+    std::stringstream corrupt_stream(corrupt);
+    vecpp::Packed_reader<Int_t> corrupt_reader(corrupt_stream);
+    REQUIRE(!corrupt_reader.read(v));
+    REQUIRE(corrupt_reader.fail());
+  }
+
+#ifdef VECPP_AP_INT_HAS_MMAP
+  REQUIRE(!vecpp::Mapped_packed_array<Int_t>("no/such/file").is_open());
+#endif
+}
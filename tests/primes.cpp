@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+using UInt128_t = vecpp::Ap_uint<128>;
+using UInt256_t = vecpp::Ap_uint<256>;
+
+static_assert(vecpp::detail::small_primes.size() == 564);
+static_assert(vecpp::detail::small_primes.back() == 4093);
+
+TEST_CASE("powmod", "[apuint][primes]") {
+  UInt128_t m{"170141183460469231731687303715884105727"};  // 2^127 - 1
+  UInt128_t b{"123456789012345678901234567890"};
+
+  // Fermat's little theorem
+  REQUIRE(vecpp::powmod(b, m - 1, m) == 1);
+  REQUIRE(vecpp::powmod(b, UInt128_t{0}, m) == 1);
+  REQUIRE(vecpp::powmod(UInt128_t{3}, UInt128_t{5}, UInt128_t{1000}) == 243);
+  REQUIRE(vecpp::powmod(UInt128_t{3}, UInt128_t{100}, UInt128_t{1000}) ==
+          1);
+  REQUIRE(vecpp::powmod(UInt128_t{7}, UInt128_t{1000}, UInt128_t{1001}) ==
+          672);
+
+  UInt128_t e{"98765432109876543210"};
+  REQUIRE(vecpp::powmod(b, e, (UInt128_t{1} << 100) + 12) ==
+          UInt128_t{"188780418764011844372352678880"});
+  REQUIRE(vecpp::powmod(b, e, (UInt128_t{1} << 127) + 3) ==
+          UInt128_t{"87196537833906198151388433591120424630"});
+}
+
+TEST_CASE("miller rabin", "[apuint][primes]") {
+  REQUIRE(!vecpp::miller_rabin(UInt128_t{0}));
+  REQUIRE(!vecpp::miller_rabin(UInt128_t{1}));
+  REQUIRE(vecpp::miller_rabin(UInt128_t{2}));
+  REQUIRE(vecpp::miller_rabin(UInt128_t{37}));
+  REQUIRE(!vecpp::miller_rabin(UInt128_t{561}));
+  // Strong pseudoprime to base 2, caught by the deterministic bases.
+  REQUIRE(!vecpp::miller_rabin(UInt128_t{2047}));
+  REQUIRE(!vecpp::miller_rabin(UInt128_t{"3825123056546413051"}));
+  REQUIRE(vecpp::miller_rabin(UInt128_t{"18446744073709551557"}));
+
+  REQUIRE(vecpp::miller_rabin(
+      UInt128_t{"170141183460469231731687303715884105727"}));
+  REQUIRE(!vecpp::miller_rabin(
+      UInt128_t{"170141183460469231731687303715884105729"}));
+}
+
+TEST_CASE("baillie psw", "[apuint][primes]") {
+  // Strong Lucas pseudoprimes
+  REQUIRE(!vecpp::baillie_psw(UInt128_t{5459}));
+  REQUIRE(!vecpp::baillie_psw(UInt128_t{5777}));
+  REQUIRE(!vecpp::baillie_psw(UInt128_t{10877}));
+  // Strong pseudoprime to base 2
+  REQUIRE(!vecpp::baillie_psw(UInt128_t{2047}));
+  REQUIRE(!vecpp::baillie_psw(UInt128_t{"3825123056546413051"}));
+  // Squares
+  REQUIRE(!vecpp::baillie_psw(UInt128_t{1194649}));
+
+  REQUIRE(vecpp::baillie_psw(UInt128_t{5}));
+  REQUIRE(vecpp::baillie_psw(UInt128_t{4093}));
+  REQUIRE(vecpp::baillie_psw(UInt128_t{"618970019642690137449562111"}));
+}
+
+TEST_CASE("is_probable_prime", "[apuint][primes]") {
+  REQUIRE(!vecpp::is_probable_prime(UInt256_t{1}));
+  REQUIRE(vecpp::is_probable_prime(UInt256_t{2}));
+  REQUIRE(vecpp::is_probable_prime(UInt256_t{4093}));
+  REQUIRE(!vecpp::is_probable_prime(UInt256_t{4095}));
+  REQUIRE(vecpp::is_probable_prime(UInt256_t{4099}));
+
+  UInt256_t m127{"170141183460469231731687303715884105727"};
+  UInt256_t m89{"618970019642690137449562111"};
+  REQUIRE(vecpp::is_probable_prime(m127));
+  REQUIRE(vecpp::is_probable_prime(m127, 5));
+  REQUIRE(!vecpp::is_probable_prime(m127 * m89));
+}
+
+TEST_CASE("next_prime", "[apuint][primes]") {
+  REQUIRE(vecpp::next_prime(UInt256_t{0}) == 2);
+  REQUIRE(vecpp::next_prime(UInt256_t{2}) == 3);
+  REQUIRE(vecpp::next_prime(UInt256_t{4093}) == 4099);
+
+  auto p100 = UInt256_t{1} << 100;
+  REQUIRE(vecpp::next_prime(p100) == p100 + 277);
+
+  auto p200 = UInt256_t{1} << 200;
+  REQUIRE(vecpp::next_prime(p200) == p200 + 235);
+
+  auto p255 = UInt256_t{1} << 255;
+  REQUIRE(vecpp::next_prime(p255) == p255 + 95);
+
+  REQUIRE(vecpp::next_prime(std::numeric_limits<UInt256_t>::max()) == 0);
+}
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+template <std::size_t bits, bool is_signed>
+void check_kernels() {
+  using Array = vecpp::Small_ap_int_array<bits, is_signed>;
+  using Value = typename Array::Value;
+  using Storage =
+      typename vecpp::detail::Small_storage_selector<bits, is_signed>::type;
+
+  // Covers the extremes, so that wrapping around and sign handling show.
+  std::mt19937_64 gen(bits * 2 + is_signed);
+  auto random_value = [&] {
+    switch (gen() % 4) {
+      case 0:
+        return std::numeric_limits<Value>::min();
+      case 1:
+        return std::numeric_limits<Value>::max();
+      default:
+        return Value(Storage(gen()));
+    }
+  };
+
+  // Not a multiple of the block size, so the last block is partial.
+  std::vector<Value> x(150);
+  std::vector<Value> y(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    x[i] = random_value();
+    y[i] = i % 7 == 0 ? x[i] : random_value();
+  }
+
+  Array a;
+  Array b;
+  vecpp::pack(x.data(), x.size(), a);
+  vecpp::pack(y.data(), y.size(), b);
+  REQUIRE(a.size() == x.size());
+
+  std::vector<Value> unpacked(x.size());
+  vecpp::unpack(a, unpacked.data());
+  Array sum;
+  Array diff;
+  Array prod;
+  std::vector<int> order;
+  vecpp::add(a, b, sum);
+  vecpp::sub(a, b, diff);
+  vecpp::mul(a, b, prod);
+  vecpp::compare(a, b, order);
+  REQUIRE(order.size() == x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    REQUIRE(unpacked[i] == x[i]);
+    REQUIRE(a.get(i) == x[i]);
+    REQUIRE(sum.get(i) == x[i] + y[i]);
+    REQUIRE(diff.get(i) == x[i] - y[i]);
+    REQUIRE(prod.get(i) == x[i] * y[i]);
+    REQUIRE(order[i] == (x[i] > y[i]) - (x[i] < y[i]));
+  }
+
+  // The output may be one of the inputs.
+  vecpp::mul(a, b, a);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    REQUIRE(a.get(i) == prod.get(i));
+  }
+  vecpp::sub(a, b, b);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    REQUIRE(b.get(i) == prod.get(i) - y[i]);
+  }
+}
+}  // namespace
+
+TEST_CASE("packed small int array elements", "[apint]") {
+  vecpp::Small_ap_int_array<12, true> a(100);
+  REQUIRE(a.size() == 100);
+  // 64 values of 12 bits fill 12 words.
+  REQUIRE(a.blocks() == 2);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a[i] = vecpp::Ap_int<12>(std::int16_t(i * 41 - 2048));
+  }
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    REQUIRE(a.get(i) == vecpp::Ap_int<12>(std::int16_t(i * 41 - 2048)));
+  }
+  REQUIRE(a.get(0) == std::numeric_limits<vecpp::Ap_int<12>>::min());
+
+  // Elements dropped by a resize read as zero when it grows back.
+  a.resize(70);
+  REQUIRE(a.blocks() == 2);
+  a.resize(100);
+  REQUIRE(a.get(70) == vecpp::Ap_int<12>(0));
+  REQUIRE(a.get(99) == vecpp::Ap_int<12>(0));
+}
+
+TEST_CASE("packed small int array kernels", "[apint]") {
+  check_kernels<3, false>();
+  check_kernels<7, true>();
+  check_kernels<8, false>();
+  check_kernels<12, true>();
+  check_kernels<12, false>();
+  check_kernels<16, true>();
+  check_kernels<27, true>();
+  check_kernels<33, false>();
+  check_kernels<64, false>();
+}
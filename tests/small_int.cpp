@@ -3,10 +3,14 @@
 #include "vecpp/ap_math.h"
 
 using Int4_t = vecpp::Ap_int<4>;
+using Uint4_t = vecpp::Ap_uint<4>;
 
 static_assert(std::numeric_limits<Int4_t>::digits == 4);
 static_assert(std::numeric_limits<Int4_t>::min() == -8);
 static_assert(std::numeric_limits<Int4_t>::max() == 7);
+static_assert(std::numeric_limits<Int4_t>::lowest() == -8);
+static_assert(std::numeric_limits<Uint4_t>::min() == 0);
+static_assert(std::numeric_limits<Uint4_t>::lowest() == 0);
 
 TEST_CASE("construct small ApInt", "[apint]") {
   Int4_t x{3};
@@ -0,0 +1,75 @@
+//  Copyright 2018 Francois Chabot
+//  (francois.chabot.dev@gmail.com)
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  (See accompanying file LICENSE or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VECPP_AP_MATH_TEST_UTIL_INCLUDED_H
+#define VECPP_AP_MATH_TEST_UTIL_INCLUDED_H
+
+#include "vecpp/ap_math/ap_int.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+// Random operands shared by the tests.
+namespace test {
+
+// Fills the (bits + 63) / 64 limbs of a bits bits value, least significant
+// first. One value in three uses the whole width, the others have a length
+// uniform in [1, bits], so that short values, which often take other
+// paths, come up as well. With is_signed, half of them are negative: their
+// bits above the length are set, up to bits.
+inline void random_limbs(std::mt19937_64& gen, std::uint64_t* limbs,
+                         std::size_t bits, bool is_signed) {
+  std::size_t words = (bits + 63) / 64;
+  std::size_t length = gen() % 3 == 0 ? bits : gen() % bits + 1;
+  for (std::size_t k = 0; k < words; ++k) {
+    std::size_t low = 64 * k;
+    limbs[k] = low < length ? gen() : 0;
+    if (low < length && length - low < 64) {
+      limbs[k] &= (std::uint64_t(1) << (length - low)) - 1;
+    }
+  }
+  if (is_signed && gen() % 2 == 0) {
+    for (std::size_t k = 0; k < words; ++k) {
+      limbs[k] = ~limbs[k];
+    }
+  }
+  if (bits % 64 != 0) {
+    limbs[words - 1] &= (std::uint64_t(1) << (bits % 64)) - 1;
+  }
+}
+
+template <typename T>
+struct Is_large_signed : std::false_type {};
+
+template <std::size_t bits>
+struct Is_large_signed<vecpp::Large_ap_int<bits>> : std::true_type {};
+
+// A Large_ap_uint or Large_ap_int of at most max_bits significant bits,
+// negated half of the time if signed.
+template <typename T>
+T random_large(std::mt19937_64& gen, std::size_t max_bits = T::Storage::size) {
+  T v{0};
+  random_limbs(gen, v.limbs(), max_bits, false);
+  if (Is_large_signed<T>::value && gen() % 2 == 0) {
+    v = T{0} - v;
+  }
+  return v;
+}
+
+// A double in (-2^max_exp, 2^max_exp), of magnitude at least 2^(min_exp - 1)
+// most of the time.
+inline double random_double(std::mt19937_64& gen, int min_exp, int max_exp) {
+  std::uniform_real_distribution<double> frac(-1, 1);
+  std::uniform_int_distribution<int> exp(min_exp, max_exp);
+  return std::ldexp(frac(gen), exp(gen));
+}
+}  // namespace test
+
+#endif
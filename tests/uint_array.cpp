@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include "vecpp/ap_math.h"
+
+#include <random>
+#include <vector>
+
+using vecpp::detail::Isa;
+
+namespace {
+template <std::size_t bits>
+vecpp::Large_ap_uint<bits> random_value(std::mt19937_64& gen) {
+  vecpp::Large_ap_uint<bits> v{0};
+  // Mostly full width values, with runs of zero and all one limbs to
+  // exercise long carry chains.
+  for (std::size_t k = 0; k < v.data_.words; ++k) {
+    switch (gen() % 4) {
+      case 0:
+        v.data_[k] = 0;
+        break;
+      case 1:
+        v.data_[k] = ~std::uint64_t(0);
+        break;
+      default:
+        v.data_[k] = gen();
+    }
+  }
+  v.data_.clear_unused_bits();
+  return v;
+}
+
+template <std::size_t bits>
+void check_kernels() {
+  using Array = vecpp::Ap_uint_array<bits>;
+  using Kernels = vecpp::detail::Uint_array_kernels<bits>;
+
+  std::mt19937_64 gen(bits);
+  // Not a multiple of the lane counts, so the scalar tails run too.
+  Array a(101);
+  Array b(a.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a[i] = random_value<bits>(gen);
+    b[i] = i % 5 == 0 ? a.get(i) : random_value<bits>(gen);
+  }
+
+  for (auto level :
+       {Isa::generic, Isa::avx2, Isa::avx512, Isa::avx512_ifma}) {
+    if (!vecpp::detail::isa_supported(level)) {
+      continue;
+    }
+    Array sum;
+    Array diff;
+    Array prod;
+    std::vector<int> order;
+    Kernels::add(level, a, b, sum);
+    Kernels::sub(level, a, b, diff);
+    Kernels::mul(level, a, b, prod);
+    Kernels::compare(level, a, b, order);
+    REQUIRE(sum.size() == a.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      auto x = a.get(i);
+      auto y = b.get(i);
+      REQUIRE(sum.get(i) == x + y);
+      REQUIRE(diff.get(i) == x - y);
+      REQUIRE(prod.get(i) == x * y);
+      REQUIRE(order[i] == x.compare(y));
+    }
+
+    // The output may be one of the inputs.
+    Array c = a;
+    Kernels::add(level, c, b, c);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      REQUIRE(c.get(i) == sum.get(i));
+    }
+  }
+}
+
+template <std::size_t bits>
+void check_montgomery(const vecpp::Large_ap_uint<bits>& n) {
+  using Value = vecpp::Large_ap_uint<bits>;
+  vecpp::Montgomery<bits> ctx(n);
+
+  std::mt19937_64 gen(bits);
+  vecpp::Ap_uint_array<bits> a(37);
+  vecpp::Ap_uint_array<bits> b(a.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a[i] = ctx.to_mont(random_value<bits>(gen) % n);
+    b[i] = ctx.to_mont(random_value<bits>(gen) % n);
+  }
+  a[0] = Value{0};
+  a[1] = n - Value{1};
+  b[1] = n - Value{1};
+
+  for (auto level : {Isa::generic, Isa::avx512_ifma}) {
+    if (!vecpp::detail::isa_supported(level)) {
+      continue;
+    }
+    vecpp::Ap_uint_array<bits> out;
+    vecpp::detail::Montgomery_array<bits>::mul(level, ctx, a, b, out);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      REQUIRE(out.get(i) == ctx.mul(a.get(i), b.get(i)));
+    }
+  }
+}
+}  // namespace
+
+TEST_CASE("uint array elements", "[uint_array]") {
+  vecpp::Ap_uint_array<256> a(3);
+  a[1] = vecpp::Large_ap_uint<256>{"123456789012345678901234567890"};
+  a[2] = a[1];
+  REQUIRE(a.get(0) == 0);
+  REQUIRE(a.get(2) ==
+          vecpp::Large_ap_uint<256>{"123456789012345678901234567890"});
+  REQUIRE(vecpp::Large_ap_uint<256>(a[2]) == a.get(1));
+  REQUIRE(a.limb(1)[2] == a.get(2).data_[1]);
+
+  a.resize(5);
+  REQUIRE(a.size() == 5);
+  REQUIRE(a.get(1) == a.get(2));
+  REQUIRE(a.get(4) == 0);
+}
+
+TEST_CASE("uint array batch operations", "[uint_array]") {
+  check_kernels<128>();
+  check_kernels<200>();
+  check_kernels<256>();
+  check_kernels<512>();
+}
+
+TEST_CASE("uint array montgomery products", "[uint_array]") {
+  using vecpp::Large_ap_uint;
+  // 2^128 - 159
+  check_montgomery(
+      Large_ap_uint<128>{"340282366920938463463374607431768211297"});
+  check_montgomery(Large_ap_uint<128>{"1000000007"});
+  check_montgomery((Large_ap_uint<200>{1} << 199) + Large_ap_uint<200>{9});
+  check_montgomery(~Large_ap_uint<256>{0} - Large_ap_uint<256>{188});
+  check_montgomery((Large_ap_uint<512>{1} << 400) - Large_ap_uint<512>{593});
+}